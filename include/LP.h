@@ -2,10 +2,12 @@
 
 #include "config.hxx"
 #include "factors_storage.hxx"
+#include "factors_partition_storage.hxx"
 #include "messages_storage.hxx"
 #include "message_passing_schedule.hxx"
 #include "message_passing_weight_computation.hxx"
 #include "lp_reparametrization.hxx"
+#include "conflict_free_schedule.hxx"
 #include "factor_container_interface.h"
 #include <vector>
 #include <iostream>
@@ -42,7 +44,7 @@ void compute_pass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, O
 }
 
 template<typename FMC_TYPE>
-class LP : public factors_storage<FMC_TYPE>, public messages_storage<FMC_TYPE> {
+class LP : public factors_storage<FMC_TYPE>, public messages_storage<FMC_TYPE>, public factors_partition_storage {
 public:
    using FMC = FMC_TYPE;
 
@@ -58,11 +60,18 @@ public:
    template<typename MESSAGE_CONTAINER_TYPE, typename LEFT_FACTOR, typename RIGHT_FACTOR, typename... ARGS>
    MESSAGE_CONTAINER_TYPE* add_message(LEFT_FACTOR* l, RIGHT_FACTOR* r, ARGS&&... args);
 
+   // factor relations change the factor orderings and hence the message passing weights
+   void add_factor_relation(FactorTypeAdapter* f1, FactorTypeAdapter* f2);
+   void add_forward_pass_factor_relation(FactorTypeAdapter* f1, FactorTypeAdapter* f2);
+   void add_backward_pass_factor_relation(FactorTypeAdapter* f1, FactorTypeAdapter* f2);
+
    //void ComputeWeights(const lp_reparametrization_mode m);
    void set_reparametrization(const lp_reparametrization r) { repam_mode_ = r; }
    lp_reparametrization get_repam_mode() const { return repam_mode_; }
 
    double LowerBound() const;
+   // move the constant part of each factor's potential into constant_. Done after every pass in single precision.
+   void normalize_potentials();
    void init_primal();
    double EvaluatePrimal() const;
 
@@ -86,18 +95,33 @@ public:
    template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MASK_ITERATOR>
    void ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt, RECEIVE_MASK_ITERATOR receive_it);
 
+   // factor in update ordering together with views on its weights
+   struct factor_update {
+      FactorTypeAdapter* f;
+      weight_slice omega;
+      receive_slice receive_mask;
+   };
+
+   void ComputePass(const std::vector<factor_update>& updates);
+
+   // update factors level by level, factors within one level concurrently. schedule holds positions into updates.
+   void ComputeParallelPass(const std::vector<factor_update>& updates, const two_dim_variable_array<std::size_t>& schedule);
+
    struct message_passing_weight_storage 
    {
-      //message_passing_weight_storage(std::initializer_list<> l) {assert(false);} // TODO: fill out
       weight_array omega_forward, omega_backward;
       receive_array receive_mask_forward, receive_mask_backward;
+      // update orderings interleaved with views into the above weights, such that a pass streams through one contiguous array
+      std::vector<factor_update> forward_updates, backward_updates;
    };
 
+   // returned reference stays valid until factors, messages or factor relations are added
    message_passing_weight_storage& get_message_passing_weight(const lp_reparametrization repam);
+   const two_dim_variable_array<std::size_t>& get_conflict_free_schedule(const Direction d);
 
    double get_constant() const { return constant_; }
 
-   void add_to_constant(const REAL x) { 
+   void add_to_constant(const double x) { 
 #pragma omp critical
       {
          constant_ += x; 
@@ -105,18 +129,23 @@ public:
    }
 
 protected:
+   void invalidate_message_passing_weights();
 
-   //tsl::robin_map<lp_reparametrization, message_passing_weight_storage> message_passing_weights_;
-   std::unordered_map<lp_reparametrization, message_passing_weight_storage> message_passing_weights_;
+   // few reparametrization modes are used in practice, hence linear search. Weights are held by pointer so that references and views into them stay valid.
+   std::vector<std::pair<lp_reparametrization, std::unique_ptr<message_passing_weight_storage>>> message_passing_weights_;
    lp_reparametrization repam_mode_ = lp_reparametrization(lp_reparametrization_mode::Undefined, 0.0);
    std::size_t rounding_iteration_ = 1;
    double constant_ = 0.0;
 
-   TCLAP::ValueArg<std::string> reparametrization_type_arg_; // shared|residual|partition|overlapping_partition
+   TCLAP::ValueArg<std::string> reparametrization_type_arg_; // shared|residual|partition|overlapping_partition|parallel
    TCLAP::ValueArg<INDEX> inner_iteration_number_arg_;
-   enum class reparametrization_type {shared,residual,partition,overlapping_partition};
+   TCLAP::ValueArg<INDEX> partition_size_arg_;
+   enum class reparametrization_type {shared,residual,partition,overlapping_partition,parallel};
    reparametrization_type reparametrization_type_ = reparametrization_type::shared;
 
+   // levels of factors in update ordering that can be updated concurrently, for parallel reparametrization type
+   two_dim_variable_array<std::size_t> forward_conflict_free_schedule_, backward_conflict_free_schedule_;
+
    std::vector<bool> get_inconsistent_mask(const std::size_t no_fatten_rounds = 1);
    template<typename FACTOR_ITERATOR, typename FACTOR_MASK_ITERATOR>
    std::vector<FactorTypeAdapter*> get_masked_factors( FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, FACTOR_MASK_ITERATOR factor_mask_begin, FACTOR_MASK_ITERATOR factor_mask_end);
@@ -125,15 +154,17 @@ protected:
 
 template<typename FMC> 
 LP<FMC>::LP(TCLAP::CmdLine& cmd)
-: reparametrization_type_arg_("","reparametrizationType","message sending type: ", false, "shared", "{shared|residual|partition|overlapping_partition}", cmd)
+: reparametrization_type_arg_("","reparametrizationType","message sending type: ", false, "shared", "{shared|residual|partition|overlapping_partition|parallel}", cmd)
 , inner_iteration_number_arg_("","innerIteration","number of iterations in inner loop in partition reparamtrization, default = 5",false,5,&positiveIntegerConstraint,cmd)
+, partition_size_arg_("","partitionSize","size of factor partitions in KB in partition reparametrization, default = 1024",false,1024,&positiveIntegerConstraint,cmd)
 {}
 
 // make a deep copy of factors and messages. Adjust pointers to messages and factors
 template<typename FMC>
 LP<FMC>::LP(LP& o) // no const because of o.num_lp_threads_arg_.getValue() not being const!
-  : reparametrization_type_arg_("","reparametrizationType","message sending type: ", false, o.reparametrization_type_arg_.getValue(), "{shared|residual|partition|overlapping_partition}" )
+  : reparametrization_type_arg_("","reparametrizationType","message sending type: ", false, o.reparametrization_type_arg_.getValue(), "{shared|residual|partition|overlapping_partition|parallel}" )
 , inner_iteration_number_arg_("","innerIteration","number of iterations in inner loop in partition reparamtrization, default = 5",false,o.inner_iteration_number_arg_.getValue(),&positiveIntegerConstraint) 
+, partition_size_arg_("","partitionSize","size of factor partitions in KB in partition reparametrization, default = 1024",false,o.partition_size_arg_.getValue(),&positiveIntegerConstraint)
 {
   /*
   f_.reserve(o.f_.size());
@@ -205,16 +236,20 @@ inline void LP<FMC>::Begin()
      reparametrization_type_ = reparametrization_type::partition;
    } else if(reparametrization_type_arg_.getValue() == "overlapping_partition") {
      reparametrization_type_ = reparametrization_type::overlapping_partition;
+   } else if(reparametrization_type_arg_.getValue() == "parallel") {
+     reparametrization_type_ = reparametrization_type::parallel;
    } else {
      throw std::runtime_error("reparamerization type not recognized");
    }
+
+   this->set_partition_size(1024*partition_size_arg_.getValue());
 }
 
 template<typename FMC>
 template<typename FACTOR_CONTAINER_TYPE, typename... ARGS>
 FACTOR_CONTAINER_TYPE* LP<FMC>::add_factor(ARGS&&... args)
 {
-   message_passing_weights_.clear();
+   invalidate_message_passing_weights();
    return factors_storage<FMC>::template add_factor<FACTOR_CONTAINER_TYPE>(std::forward<ARGS>(args)...);
 }
 
@@ -222,37 +257,100 @@ template<typename FMC>
 template<typename MESSAGE_CONTAINER_TYPE, typename LEFT_FACTOR, typename RIGHT_FACTOR, typename... ARGS>
 MESSAGE_CONTAINER_TYPE* LP<FMC>::add_message(LEFT_FACTOR* l, RIGHT_FACTOR* r, ARGS&&... args)
 {
-   message_passing_weights_.clear();
+   invalidate_message_passing_weights();
    return messages_storage<FMC>::template add_message<MESSAGE_CONTAINER_TYPE>(l,r, std::forward<ARGS>(args)...);
 }
 
+template<typename FMC>
+void LP<FMC>::add_factor_relation(FactorTypeAdapter* f1, FactorTypeAdapter* f2)
+{
+   add_forward_pass_factor_relation(f1,f2);
+   add_backward_pass_factor_relation(f2,f1);
+}
+
+template<typename FMC>
+void LP<FMC>::add_forward_pass_factor_relation(FactorTypeAdapter* f1, FactorTypeAdapter* f2)
+{
+   invalidate_message_passing_weights();
+   factors_storage<FMC>::add_forward_pass_factor_relation(f1,f2);
+}
+
+template<typename FMC>
+void LP<FMC>::add_backward_pass_factor_relation(FactorTypeAdapter* f1, FactorTypeAdapter* f2)
+{
+   invalidate_message_passing_weights();
+   factors_storage<FMC>::add_backward_pass_factor_relation(f1,f2);
+}
+
+template<typename FMC>
+void LP<FMC>::invalidate_message_passing_weights()
+{
+   message_passing_weights_.clear();
+   if(forward_conflict_free_schedule_.size() > 0)
+      forward_conflict_free_schedule_ = two_dim_variable_array<std::size_t>();
+   if(backward_conflict_free_schedule_.size() > 0)
+      backward_conflict_free_schedule_ = two_dim_variable_array<std::size_t>();
+   this->invalidate_partition();
+}
+
 template<typename FMC>
 inline void LP<FMC>::ComputePass()
 {
-   ComputeForwardPass();
-   ComputeBackwardPass();
+   if(reparametrization_type_ == reparametrization_type::partition || reparametrization_type_ == reparametrization_type::overlapping_partition) {
+      this->set_partition_reparametrization(repam_mode_);
+   }
+   if(reparametrization_type_ == reparametrization_type::partition) {
+      auto [forward_sorting, forward_update_sorting] = this->get_sorted_factors(Direction::forward);
+      this->compute_partition_pass(forward_sorting.begin(), forward_sorting.end(), inner_iteration_number_arg_.getValue());
+   } else if(reparametrization_type_ == reparametrization_type::overlapping_partition) {
+      auto [forward_sorting, forward_update_sorting] = this->get_sorted_factors(Direction::forward);
+      this->compute_overlapping_partition_pass(forward_sorting.begin(), forward_sorting.end(), inner_iteration_number_arg_.getValue());
+   } else {
+      ComputeForwardPass();
+      ComputeBackwardPass();
+   }
+   if constexpr(std::is_same_v<REAL,float>) {
+      normalize_potentials();
+   }
+}
+
+template<typename FMC>
+void LP<FMC>::normalize_potentials()
+{
+   double shift = 0.0;
+#pragma omp parallel for schedule(guided) reduction(+:shift)
+   for(std::size_t i=0; i<this->number_of_factors(); ++i) {
+      shift += this->get_factor(i)->normalize_potential();
+   }
+   constant_ += shift;
 }
 
 template<typename FMC>
 void LP<FMC>::ComputeForwardPass()
 {
-  auto mpw = get_message_passing_weight(repam_mode_);
-  auto [forward_sorting, forward_update_sorting] = this->get_sorted_factors(Direction::forward);
-  ComputePass(forward_update_sorting.begin(), forward_update_sorting.end(), mpw.omega_forward.begin(), mpw.receive_mask_forward.begin()); 
+  const auto& mpw = get_message_passing_weight(repam_mode_);
+  if(reparametrization_type_ == reparametrization_type::parallel) {
+     ComputeParallelPass(mpw.forward_updates, get_conflict_free_schedule(Direction::forward));
+  } else {
+     ComputePass(mpw.forward_updates);
+  }
 }
 
 template<typename FMC>
 void LP<FMC>::ComputeBackwardPass()
 {
-  auto mpw = get_message_passing_weight(repam_mode_);
-  auto [backward_sorting, backward_update_sorting] = this->get_sorted_factors(Direction::backward);
-  ComputePass(backward_update_sorting.begin(), backward_update_sorting.end(), mpw.omega_backward.begin(), mpw.receive_mask_backward.begin()); 
+  const auto& mpw = get_message_passing_weight(repam_mode_);
+  if(reparametrization_type_ == reparametrization_type::parallel) {
+     ComputeParallelPass(mpw.backward_updates, get_conflict_free_schedule(Direction::backward));
+  } else {
+     ComputePass(mpw.backward_updates);
+  }
 }
 
 template<typename FMC>
 void LP<FMC>::ComputeForwardPassAndPrimal()
 {
-  auto mpw = get_message_passing_weight(repam_mode_);
+  auto& mpw = get_message_passing_weight(repam_mode_);
   auto [forward_sorting, forward_update_sorting] = this->get_sorted_factors(Direction::forward);
   ComputePassAndPrimal(forward_update_sorting.begin(), forward_update_sorting.end(), mpw.omega_forward.begin(), mpw.receive_mask_forward.begin());
 }
@@ -260,7 +358,7 @@ void LP<FMC>::ComputeForwardPassAndPrimal()
 template<typename FMC>
 void LP<FMC>::ComputeBackwardPassAndPrimal()
 {
-  auto mpw = get_message_passing_weight(repam_mode_);
+  auto& mpw = get_message_passing_weight(repam_mode_);
   auto [backward_sorting, backward_update_sorting] = this->get_sorted_factors(Direction::backward);
   ComputePassAndPrimal(backward_update_sorting.begin(), backward_update_sorting.end(), mpw.omega_backward.begin(), mpw.receive_mask_backward.begin()); 
 }
@@ -277,8 +375,7 @@ template<typename FACTOR_ITERATOR, typename OMEGA_ITERATOR, typename RECEIVE_MAS
 void LP<FMC>::ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factorItEnd, OMEGA_ITERATOR omegaIt, RECEIVE_MASK_ITERATOR receive_it)
 {
     const std::size_t n = std::distance(factorIt, factorItEnd);
-    //#pragma omp parallel for schedule(static)
-    if(reparametrization_type_ == reparametrization_type::shared || reparametrization_type_ == reparametrization_type::partition || reparametrization_type_ == reparametrization_type::overlapping_partition) {
+    if(reparametrization_type_ == reparametrization_type::shared || reparametrization_type_ == reparametrization_type::partition || reparametrization_type_ == reparametrization_type::overlapping_partition || reparametrization_type_ == reparametrization_type::parallel) {
         for(std::size_t i=0; i<n; ++i) {
             auto* f = *(factorIt + i);
             assert(f->FactorUpdated());
@@ -294,43 +391,101 @@ void LP<FMC>::ComputePass(FACTOR_ITERATOR factorIt, const FACTOR_ITERATOR factor
     }
 }
 
+template<typename FMC>
+void LP<FMC>::ComputePass(const std::vector<factor_update>& updates)
+{
+    if(reparametrization_type_ == reparametrization_type::shared || reparametrization_type_ == reparametrization_type::partition || reparametrization_type_ == reparametrization_type::overlapping_partition || reparametrization_type_ == reparametrization_type::parallel) {
+        for(const auto& u : updates) {
+            assert(u.f->FactorUpdated());
+            u.f->UpdateFactor(u.omega, u.receive_mask);
+        }
+    } else if(reparametrization_type_ == reparametrization_type::residual) {
+        for(const auto& u : updates) {
+            u.f->update_factor_residual(u.omega, u.receive_mask);
+        }
+    } else {
+       throw std::runtime_error("reparametrization type not recognized");
+    }
+}
+
+// Factors in one level share neither messages nor adjacent factors, hence their updates commute.
+// The result is identical to the serial pass over the update ordering and in particular the lower bound does not decrease.
+template<typename FMC>
+void LP<FMC>::ComputeParallelPass(const std::vector<factor_update>& updates, const two_dim_variable_array<std::size_t>& schedule)
+{
+   assert(schedule.no_elements() == updates.size());
+#pragma omp parallel
+   for(std::size_t l=0; l<schedule.size(); ++l) {
+      const auto level = schedule[l];
+#pragma omp for schedule(guided)
+      for(std::size_t k=0; k<level.size(); ++k) {
+         const auto& u = updates[level[k]];
+         assert(u.f->FactorUpdated());
+         u.f->UpdateFactor(u.omega, u.receive_mask);
+      }
+   }
+}
+
+template<typename FMC>
+const two_dim_variable_array<std::size_t>& LP<FMC>::get_conflict_free_schedule(const Direction d)
+{
+   auto [sorting, update_sorting] = this->get_sorted_factors(d);
+   auto& schedule = d == Direction::forward ? forward_conflict_free_schedule_ : backward_conflict_free_schedule_;
+   if(schedule.no_elements() != update_sorting.size()) {
+      schedule = compute_conflict_free_schedule(update_sorting.begin(), update_sorting.end());
+      if(debug()) { std::cout << "conflict free schedule: " << update_sorting.size() << " factors in " << schedule.size() << " levels\n"; }
+   }
+   assert(schedule.no_elements() == update_sorting.size());
+   return schedule;
+}
+
 template<typename FMC>
 typename LP<FMC>::message_passing_weight_storage& 
 LP<FMC>::get_message_passing_weight(const lp_reparametrization repam)
 {
-   auto it = message_passing_weights_.find(repam);
-   if(it != message_passing_weights_.end()) {
-      return it->second;
+   for(auto& w : message_passing_weights_) {
+      if(w.first == repam) {
+         return *w.second;
+      }
+   }
+
+   auto [forward_sorting, forward_update_sorting] = this->get_sorted_factors(Direction::forward);
+   auto [backward_sorting, backward_update_sorting] = this->get_sorted_factors(Direction::backward);
+   const auto leave_percentage = repam.leave_percentage;
+   auto mpw = std::make_unique<message_passing_weight_storage>();
+   if(repam.mode == lp_reparametrization_mode::Anisotropic) {
+      std::tie(mpw->omega_forward, mpw->receive_mask_forward) = compute_anisotropic_weights(forward_sorting.begin(), forward_sorting.end(), leave_percentage);
+      std::tie(mpw->omega_backward, mpw->receive_mask_backward) = compute_anisotropic_weights(backward_sorting.begin(), backward_sorting.end(), leave_percentage);
+   } else if(repam.mode == lp_reparametrization_mode::Uniform) {
+      mpw->omega_forward = compute_isotropic_weights(forward_sorting.begin(), forward_sorting.end(), leave_percentage);
+      omega_valid(forward_update_sorting.begin(), forward_update_sorting.end(), mpw->omega_forward);
+      mpw->omega_backward = compute_isotropic_weights(backward_sorting.begin(), backward_sorting.end(), leave_percentage);
+      omega_valid(backward_update_sorting.begin(), backward_update_sorting.end(), mpw->omega_backward);
+      mpw->receive_mask_forward = compute_full_receive_mask(forward_sorting.begin(), forward_sorting.end());
+      receive_mask_valid(forward_update_sorting.begin(), forward_update_sorting.end(), mpw->receive_mask_forward);
+      mpw->receive_mask_backward = compute_full_receive_mask(backward_sorting.begin(), backward_sorting.end());
+      receive_mask_valid(backward_update_sorting.begin(), backward_update_sorting.end(), mpw->receive_mask_backward);
+   } else if(repam.mode == lp_reparametrization_mode::Anisotropic2) {
+      std::tie(mpw->omega_forward, mpw->receive_mask_forward) = compute_anisotropic_weights_2(forward_sorting.begin(), forward_sorting.end(), leave_percentage);
+      std::tie(mpw->omega_backward, mpw->receive_mask_backward) = compute_anisotropic_weights_2(backward_sorting.begin(), backward_sorting.end(), leave_percentage);
    } else {
-      auto [forward_sorting, forward_update_sorting] = this->get_sorted_factors(Direction::forward);
-      auto [backward_sorting, backward_update_sorting] = this->get_sorted_factors(Direction::backward);
-      const auto leave_percentage = repam.leave_percentage;
-      if(repam.mode == lp_reparametrization_mode::Anisotropic) {
-         auto [omega_forward, receive_mask_forward] = compute_anisotropic_weights(forward_sorting.begin(), forward_sorting.end(), leave_percentage);
-         auto [omega_backward, receive_mask_backward] = compute_anisotropic_weights(backward_sorting.begin(), backward_sorting.end(), leave_percentage);
-         message_passing_weight_storage mpw {omega_forward, omega_backward, receive_mask_forward, receive_mask_backward};
-         message_passing_weights_.insert( std::make_pair(repam, mpw) ); // TODO: move 
-      } else if(repam.mode == lp_reparametrization_mode::Uniform) {
-         auto omega_forward = compute_isotropic_weights(forward_sorting.begin(), forward_sorting.end(), leave_percentage);
-         omega_valid(forward_update_sorting.begin(), forward_update_sorting.end(), omega_forward);
-         auto omega_backward = compute_isotropic_weights(backward_sorting.begin(), backward_sorting.end(), leave_percentage);
-         omega_valid(backward_update_sorting.begin(), backward_update_sorting.end(), omega_backward);
-         auto receive_mask_forward = compute_full_receive_mask(forward_sorting.begin(), forward_sorting.end());
-         receive_mask_valid(forward_update_sorting.begin(), forward_update_sorting.end(), receive_mask_forward);
-         auto receive_mask_backward = compute_full_receive_mask(backward_sorting.begin(), backward_sorting.end());
-         receive_mask_valid(backward_update_sorting.begin(), backward_update_sorting.end(), receive_mask_backward);
-         message_passing_weight_storage mpw {omega_forward, omega_backward, receive_mask_forward, receive_mask_backward};
-         message_passing_weights_.insert( std::make_pair(repam, mpw) ); // TODO: move 
-      } else if(repam.mode == lp_reparametrization_mode::Anisotropic2) {
-         auto [omega_forward, receive_mask_forward] = compute_anisotropic_weights_2(forward_sorting.begin(), forward_sorting.end(), leave_percentage);
-         auto [omega_backward, receive_mask_backward] = compute_anisotropic_weights_2(backward_sorting.begin(), backward_sorting.end(), leave_percentage);
-         message_passing_weight_storage mpw {omega_forward, omega_backward, receive_mask_forward, receive_mask_backward};
-         message_passing_weights_.insert( std::make_pair(repam, mpw) ); // TODO: move 
-      } else {
-         throw std::runtime_error("no reparametrization mode set");
+      throw std::runtime_error("no reparametrization mode set");
+   }
+
+   auto interleave = [](const std::vector<FactorTypeAdapter*>& update_sorting, weight_array& omega, receive_array& receive_mask) {
+      assert(update_sorting.size() == omega.size() && update_sorting.size() == receive_mask.size());
+      std::vector<factor_update> updates;
+      updates.reserve(update_sorting.size());
+      for(std::size_t i=0; i<update_sorting.size(); ++i) {
+         updates.push_back({update_sorting[i], omega[i], receive_mask[i]});
       }
-      return message_passing_weights_[repam];
-   } 
+      return updates;
+   };
+   mpw->forward_updates = interleave(forward_update_sorting, mpw->omega_forward, mpw->receive_mask_forward);
+   mpw->backward_updates = interleave(backward_update_sorting, mpw->omega_backward, mpw->receive_mask_backward);
+
+   message_passing_weights_.push_back({repam, std::move(mpw)});
+   return *message_passing_weights_.back().second;
 }
 
 // check whether messages constraints are satisfied
@@ -46,13 +46,8 @@ public:
       this->add_weights(&x[0], -1.0);
 
       // compute subgradient
-      objective_value = 0.0;
       ConicBundle::DVector subg(x.size(), 0.0); // this is not so nice!
-      for(auto& t : this->trees_) {
-         t.solve();
-         t.compute_mapped_subgradient(subg);
-         objective_value -= t.primal_cost();
-      }
+      objective_value = -this->solve_trees(subg);
       cut_vals.push_back(objective_value);
       subgradients.push_back(subg);
 
@@ -9,5 +9,9 @@ namespace LPMP {
         asymmetric_multiway_cut_instance parse_file(const std::string& filename);
         asymmetric_multiway_cut_instance parse_string(const std::string& string);
 
+        // same as above with the PEGTL grammar instead of the memory mapped parallel reader
+        asymmetric_multiway_cut_instance parse_file_pegtl(const std::string& filename);
+        asymmetric_multiway_cut_instance parse_string_pegtl(const std::string& string);
+
     }
 }
@@ -12,6 +12,7 @@
 #include "cuthill-mckee.h"
 #include "bfs_ordering.hxx"
 #include "minimum_degree_ordering.hxx"
+#include "clique_graph.hxx"
 #include <chrono>
 #include <tsl/robin_map.h>
 #include <tsl/robin_set.h>
@@ -31,6 +32,13 @@ namespace LPMP {
             inequality_type ineq;
             int right_hand_side;
             void normalize() { std::sort(variables.begin(), variables.end()); }
+            void add_variable(const int coefficient, const std::size_t var)
+            {
+                variables.push_back({coefficient, var});
+                if(variables.size() > 1)
+                    if(variables.back() < variables[variables.size()-2])
+                        normalize();
+            }
         };
 
         bool var_exists(const std::string& var) const
@@ -115,12 +123,7 @@ namespace LPMP {
         void add_to_constraint(const int coefficient, const std::size_t var)
         {
             assert(linear_constraints_.size() > 0);
-            auto& constr = linear_constraints_.back();
-            constr.variables.push_back({coefficient, var}); 
-
-            if(constr.variables.size() > 1)
-                if(constr.variables.back() < constr.variables[constr.variables.size()-2])
-                    constr.normalize();
+            linear_constraints_.back().add_variable(coefficient, var);
         }
         void add_to_constraint(const int coefficient, const std::string& var)
         {
@@ -133,6 +136,13 @@ namespace LPMP {
             linear_constraints_.back().right_hand_side = x;
         } 
 
+        // constraint must refer to existing variables
+        void add_constraint(linear_constraint&& constraint)
+        {
+            assert(std::all_of(constraint.variables.begin(), constraint.variables.end(), [&](const auto& v) { return v.var < nr_variables(); }));
+            linear_constraints_.push_back(std::move(constraint));
+        }
+
         std::size_t nr_constraints() const
         {
             return linear_constraints_.size();
@@ -155,6 +165,8 @@ namespace LPMP {
         permutation reorder_bfs();
         permutation reorder_Cuthill_McKee(); 
         permutation reorder_minimum_degree_averaging();
+        // variable i becomes old variable order[i]
+        void reorder(const permutation& order);
 
         private:
             std::vector<linear_constraint> linear_constraints_;
@@ -164,8 +176,8 @@ namespace LPMP {
             tsl::robin_map<std::string, std::size_t> var_name_to_index_;
 
         private:
-            two_dim_variable_array<std::size_t> variable_adjacency_matrix() const;
-            void reorder(const permutation& new_order);
+            // variables are adjacent if they share a constraint
+            clique_graph variable_clique_graph() const;
     };
 
     template<typename ITERATOR>
@@ -250,91 +262,22 @@ namespace LPMP {
             s << "End\n";
         }
 
-    inline two_dim_variable_array<std::size_t> ILP_input::variable_adjacency_matrix() const
+    inline clique_graph ILP_input::variable_clique_graph() const
     {
-        std::vector<Eigen::Triplet<int>> var_constraint_adjacency_list;
+        std::vector<std::size_t> constraint_size;
+        constraint_size.reserve(this->linear_constraints_.size());
+        for(const auto& l : this->linear_constraints_)
+            constraint_size.push_back(l.variables.size());
 
+        two_dim_variable_array<std::size_t> cliques(constraint_size.begin(), constraint_size.end());
         for(std::size_t i=0; i<this->linear_constraints_.size(); ++i) {
             const auto& l = this->linear_constraints_[i];
-            for(const auto& v : l.variables) {
-                var_constraint_adjacency_list.push_back({v.var, i, 1});
-            }
+            for(std::size_t j=0; j<l.variables.size(); ++j)
+                cliques(i,j) = l.variables[j].var;
         }
 
-        Eigen::SparseMatrix<int> A(this->nr_variables(), this->linear_constraints_.size());
-        A.setFromTriplets(var_constraint_adjacency_list.begin(), var_constraint_adjacency_list.end());
-        const auto begin_time = std::chrono::steady_clock::now();
-        const Eigen::SparseMatrix<int> adj_matrix = A*A.transpose();
-        const auto end_time = std::chrono::steady_clock::now();
-        std::cout << "matrix multiplication for adjacency matrix construction took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(end_time - begin_time).count() << " milliseconds\n";
-        assert(adj_matrix.cols() == nr_variables() && adj_matrix.rows() == nr_variables());
-
-        std::vector<std::size_t> adjacency_size(nr_variables(), 0);
-
-        for(std::size_t i=0; i<adj_matrix.outerSize(); ++i) {
-            for(typename Eigen::SparseMatrix<int>::InnerIterator it(adj_matrix,i); it; ++it) {
-                if(it.value() > 0 && i != it.index()) {
-                    adjacency_size[i]++;
-                }
-            }
-        }
-
-        two_dim_variable_array<std::size_t> adjacency(adjacency_size.begin(), adjacency_size.end());
-        std::fill(adjacency_size.begin(), adjacency_size.end(), 0);
-
-        for(std::size_t i=0; i<adj_matrix.outerSize(); ++i) {
-            for(typename Eigen::SparseMatrix<int>::InnerIterator it(adj_matrix,i); it; ++it) {
-                if(it.value() > 0 && i != it.index()) {
-                    adjacency(i,adjacency_size[i]++) = it.index();
-                }
-            }
-        }
-
-        for(std::size_t i=0; i<adjacency.size(); ++i) {
-            assert(std::is_sorted(adjacency[i].begin(), adjacency[i].end()));
-        }
-
-        return adjacency;
-    }
-
-    /*
-    inline two_dim_variable_array<std::size_t> ILP_input::variable_adjacency_matrix() const
-    {
-        //std::unordered_set<std::array<std::size_t,2>> adjacent_vars;
-        tsl::robin_set<std::array<std::size_t,2>> adjacent_vars;
-        for(const auto& l : this->linear_constraints_) {
-            for(std::size_t i=0; i<l.variables.size(); ++i) {
-                for(std::size_t j=i+1; j<l.variables.size(); ++j) {
-                    const std::size_t var1 = l.variables[i].var;
-                    const std::size_t var2 = l.variables[j].var;
-                    adjacent_vars.insert({std::min(var1,var2), std::max(var1, var2)});
-                }
-            }
-        }
-
-        std::vector<std::size_t> adjacency_size(this->nr_variables(),0);
-        for(const auto [i,j] : adjacent_vars) {
-            ++adjacency_size[i];
-            ++adjacency_size[j];
-        }
-
-        two_dim_variable_array<std::size_t> adjacency(adjacency_size.begin(), adjacency_size.end());
-        std::fill(adjacency_size.begin(), adjacency_size.end(), 0);
-        for(const auto e : adjacent_vars) {
-            const auto [i,j] = e;
-            assert(i<j);
-            assert(adjacency_size[i] < adjacency[i].size());
-            assert(adjacency_size[j] < adjacency[j].size());
-            adjacency(i, adjacency_size[i]++) = j;
-            adjacency(j, adjacency_size[j]++) = i;
-        }
-
-        for(std::size_t i=0; i<adjacency.size(); ++i)
-            std::sort(adjacency[i].begin(), adjacency[i].end());
-
-        return adjacency;
+        return clique_graph(this->nr_variables(), std::move(cliques));
     }
-    */ 
 
     inline void ILP_input::reorder(const permutation& order)
     {
@@ -371,21 +314,21 @@ namespace LPMP {
     inline permutation ILP_input::reorder_bfs()
     {
         const auto begin_time = std::chrono::steady_clock::now();
-        const auto adj = variable_adjacency_matrix();
-        const auto after_adjacency_matrix = std::chrono::steady_clock::now();
+        const auto adj = variable_clique_graph();
+        const auto after_clique_graph = std::chrono::steady_clock::now();
         const auto order = bfs_ordering(adj);
         const auto after_bfs = std::chrono::steady_clock::now();
         reorder(order);
         const auto end_time = std::chrono::steady_clock::now();
-        std::cout << "adjacency matrix construction took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(after_adjacency_matrix - begin_time).count() << " milliseconds\n";
-        std::cout << "bfs ordering took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(after_bfs - after_adjacency_matrix).count() << " milliseconds\n";
+        std::cout << "clique graph construction took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(after_clique_graph - begin_time).count() << " milliseconds\n";
+        std::cout << "bfs ordering took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(after_bfs - after_clique_graph).count() << " milliseconds\n";
         std::cout << "reordering variables took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(end_time - after_bfs).count() << " milliseconds\n"; 
         return order;
     }
 
     inline permutation ILP_input::reorder_Cuthill_McKee()
     {
-        const auto adj = variable_adjacency_matrix();
+        const auto adj = variable_clique_graph();
         const auto order = Cuthill_McKee(adj);
         reorder(order);
         return order;
@@ -393,7 +336,7 @@ namespace LPMP {
 
     inline permutation ILP_input::reorder_minimum_degree_averaging()
     {
-        const auto adj = variable_adjacency_matrix();
+        const auto adj = variable_clique_graph();
         const auto order = minimum_degree_ordering(adj);
         reorder(order);
         return order;
@@ -1,4 +1,7 @@
+#pragma once
+
 #include "ILP_input.h"
+#include <cstdint>
 
 namespace LPMP {
 
@@ -7,6 +10,27 @@ namespace LPMP {
         ILP_input parse_file(const std::string& filename);
         ILP_input parse_string(const std::string& input);
 
+        // Same result as above. Memory maps the file, the constraint section is split into nr_chunks pieces tokenized in parallel.
+        // nr_chunks = 0 chooses it from the input size and the number of threads.
+        ILP_input parse_file_streaming(const std::string& filename, const std::size_t nr_chunks = 0);
+        ILP_input parse_string_streaming(const std::string& input, const std::size_t nr_chunks = 0);
+
+        // Identifies the constraint section, i.e. the lines between Subject To and Bounds or End, by its number of constraints and a hash of its text without whitespace.
+        struct constraint_fingerprint {
+            std::uint64_t nr_constraints = 0;
+            std::uint64_t hash = 0;
+            bool operator==(const constraint_fingerprint& o) const { return nr_constraints == o.nr_constraints && hash == o.hash; }
+            bool operator!=(const constraint_fingerprint& o) const { return !(*this == o); }
+        };
+        constraint_fingerprint fingerprint_constraints_file(const std::string& filename);
+        constraint_fingerprint fingerprint_constraints_string(const std::string& input);
+        // fingerprint of the constraint section as written by ILP_input::write
+        constraint_fingerprint fingerprint_constraints(const ILP_input& input);
+
+        // Only the objective is parsed, the constraint section is fingerprinted. Variables not occurring in the objective are not created.
+        ILP_input parse_objective_file(const std::string& filename, constraint_fingerprint& constraints);
+        ILP_input parse_objective_string(const std::string& input, constraint_fingerprint& constraints);
+
     }
 
 }
@@ -41,6 +41,13 @@ public:
     template <typename ITERATOR>
     void set_costs(ITERATOR begin, ITERATOR end);
 
+    // warm start after cost changes, multipliers are ordered by variable and bdd. Imported multipliers are shifted uniformly per variable to sum up to the new costs.
+    std::vector<double> export_Lagrange_multipliers() const;
+    template <typename ITERATOR>
+    void import_Lagrange_multipliers(const std::vector<double> &multipliers, ITERATOR cost_begin, ITERATOR cost_end);
+    template <typename ITERATOR>
+    void update_costs(ITERATOR begin, ITERATOR end) { import_Lagrange_multipliers(export_Lagrange_multipliers(), begin, end); }
+
     std::array<std::size_t, 2> bdd_branch_node_range(const std::size_t bdd_nr) const;
     std::array<std::size_t, 2> bdd_branch_node_range(const std::size_t bdd_nr, const std::size_t variable_index) const;
 
@@ -402,6 +409,46 @@ void bdd_base_consecutive<BDD_BRANCH_INSTRUCTION, BDD_VARIABLE>::set_costs(ITERA
     }
 }
 
+template <typename BDD_BRANCH_INSTRUCTION, typename BDD_VARIABLE>
+std::vector<double> bdd_base_consecutive<BDD_BRANCH_INSTRUCTION, BDD_VARIABLE>::export_Lagrange_multipliers() const
+{
+    std::vector<double> multipliers;
+    multipliers.reserve(Lagrange_multipliers.data().size());
+    for (std::size_t v = 0; v < Lagrange_multipliers.size(); ++v)
+    {
+        for (std::size_t j = 0; j < Lagrange_multipliers[v].size(); ++j)
+        {
+            multipliers.push_back(Lagrange_multipliers(v, j).bdd_variable.cost);
+        }
+    }
+    return multipliers;
+}
+
+template <typename BDD_BRANCH_INSTRUCTION, typename BDD_VARIABLE>
+template <typename ITERATOR>
+void bdd_base_consecutive<BDD_BRANCH_INSTRUCTION, BDD_VARIABLE>::import_Lagrange_multipliers(const std::vector<double> &multipliers, ITERATOR cost_begin, ITERATOR cost_end)
+{
+    assert(multipliers.size() == Lagrange_multipliers.data().size());
+    assert(std::distance(cost_begin, cost_end) <= nr_variables());
+    std::size_t i = 0;
+    for (std::size_t v = 0; v < Lagrange_multipliers.size(); ++v)
+    {
+        const double cost = v < std::distance(cost_begin, cost_end) ? *(cost_begin + v) : 0.0;
+        double sum = 0.0;
+        for (std::size_t j = 0; j < Lagrange_multipliers[v].size(); ++j)
+        {
+            sum += multipliers[i + j];
+        }
+        const double shift = (cost - sum) / Lagrange_multipliers[v].size();
+        for (std::size_t j = 0; j < Lagrange_multipliers[v].size(); ++j)
+        {
+            Lagrange_multipliers(v, j).bdd_variable.cost = multipliers[i + j] + shift;
+            assert(std::isfinite(Lagrange_multipliers(v, j).bdd_variable.cost));
+        }
+        i += Lagrange_multipliers[v].size();
+    }
+}
+
 template<typename BDD_BRANCH_INSTRUCTION, typename BDD_VARIABLE>
 std::array<std::size_t, 2> bdd_base_consecutive<BDD_BRANCH_INSTRUCTION, BDD_VARIABLE>::bdd_branch_node_range(const std::size_t bdd_nr) const
 {
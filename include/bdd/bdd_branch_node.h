@@ -1,37 +1,110 @@
 #pragma once
 #include <array>
+#include <cstdint>
+#include <tuple>
+#include <cmath>
+#include <cassert>
+#include <limits>
+#include <vector>
 #include "bdd_variable.h"
+#include "exp_log_approximation.h"
 
 namespace LPMP {
 
+    ////////////////////////////
+    // Links between BDD nodes //
+    ////////////////////////////
+
+    template<typename T>
+    using bdd_node_pointer = T*;
+
+    // Compact 32 bit replacement for T* between bdd branch nodes held in one contiguous array.
+    // Stores the offset of the target relative to the link's own address in units of 4 bytes, hence addressing +-8GB of nodes.
+    // nullptr and the two terminals are encoded as sentinel offsets.
+    // Links are only valid inside the node array: copying a link to a different allocation (e.g. onto the stack) is not supported, convert it to T* instead.
+    template<typename T>
+    class bdd_node_link {
+        public:
+            bdd_node_link(T* p = nullptr) { set(p); }
+            bdd_node_link(const bdd_node_link& o) { set(o.get()); }
+            bdd_node_link& operator=(const bdd_node_link& o) { set(o.get()); return *this; }
+            bdd_node_link& operator=(T* p) { set(p); return *this; }
+
+            operator T*() const { return get(); }
+            T* operator->() const { assert(offset_ != null_offset && offset_ != terminal_0_offset && offset_ != terminal_1_offset); return get(); }
+            T& operator*() const { return *operator->(); }
+
+            T* get() const;
+
+        private:
+            void set(T* p);
+
+            constexpr static std::int32_t null_offset = 0; // a node never links to itself
+            constexpr static std::int32_t terminal_0_offset = std::numeric_limits<std::int32_t>::min();
+            constexpr static std::int32_t terminal_1_offset = std::numeric_limits<std::int32_t>::min() + 1;
+            constexpr static std::ptrdiff_t unit = 4;
+
+            std::int32_t offset_;
+    };
+
+    template<typename T>
+    T* bdd_node_link<T>::get() const
+    {
+        if(offset_ == null_offset)
+            return nullptr;
+        if(offset_ == terminal_0_offset)
+            return T::terminal_0();
+        if(offset_ == terminal_1_offset)
+            return T::terminal_1();
+        char* self = reinterpret_cast<char*>(const_cast<bdd_node_link<T>*>(this));
+        return reinterpret_cast<T*>(self + unit*std::ptrdiff_t(offset_));
+    }
+
+    template<typename T>
+    void bdd_node_link<T>::set(T* p)
+    {
+        if(p == nullptr) {
+            offset_ = null_offset;
+        } else if(p == T::terminal_0()) {
+            offset_ = terminal_0_offset;
+        } else if(p == T::terminal_1()) {
+            offset_ = terminal_1_offset;
+        } else {
+            const std::ptrdiff_t d = reinterpret_cast<const char*>(p) - reinterpret_cast<const char*>(this);
+            assert(d % unit == 0 && d != 0);
+            assert(d/unit > terminal_1_offset && d/unit <= std::numeric_limits<std::int32_t>::max());
+            offset_ = std::int32_t(d/unit);
+        }
+    }
+
     ///////////////////////////////
     // Base Template Branch Node //
     ///////////////////////////////
 
-    template<typename DERIVED>
+    // LINK is either bdd_node_pointer (raw pointers) or bdd_node_link (compact 32 bit links).
+    template<typename DERIVED, template<typename> class LINK = bdd_node_pointer>
     class bdd_branch_node {
         public:
-            DERIVED* low_outgoing = nullptr;
-            DERIVED* high_outgoing = nullptr;
-            DERIVED* first_low_incoming = nullptr;
-            DERIVED* first_high_incoming = nullptr;
-            DERIVED* next_low_incoming = nullptr;
-            DERIVED* next_high_incoming = nullptr;
+            using link = LINK<DERIVED>;
+
+            link low_outgoing = nullptr;
+            link high_outgoing = nullptr;
+            link first_low_incoming = nullptr;
+            link first_high_incoming = nullptr;
+            link next_low_incoming = nullptr;
+            link next_high_incoming = nullptr;
 
             constexpr static DERIVED* terminal_0() { return static_cast<DERIVED*>(nullptr)+1; }
             constexpr static DERIVED* terminal_1() { return static_cast<DERIVED*>(nullptr)+2; }
 
-            // From C++20
-            friend bool operator==(const bdd_branch_node<DERIVED>& x, const bdd_branch_node<DERIVED>& y);
-
-            static bool is_terminal(DERIVED* p) { return p == terminal_0() || p == terminal_1(); }
+            static bool is_terminal(const DERIVED* p) { return p == terminal_0() || p == terminal_1(); }
             bool is_first() const { return first_low_incoming == nullptr && first_high_incoming == nullptr; }
             bool is_dead_end() const { return low_outgoing == terminal_0() && high_outgoing == terminal_0(); }
             // bool is_initial_state() const { return *this == DERIVED{}; }
     };
 
-    template<typename DERIVED>
-    bool operator==(const bdd_branch_node<DERIVED>& x, const bdd_branch_node<DERIVED>& y)
+    template<typename DERIVED, template<typename> class LINK>
+    bool operator==(const bdd_branch_node<DERIVED, LINK>& x, const bdd_branch_node<DERIVED, LINK>& y)
     {
         const bool equal = (x.low_outgoing == y.low_outgoing &&
             x.high_outgoing == y.high_outgoing &&
@@ -42,8 +115,8 @@ namespace LPMP {
         return equal;
     }
 
-    template<typename DERIVED>
-    void check_bdd_branch_node(const bdd_branch_node<DERIVED>& bdd, const bool last_variable = false, const bool first_variable = false)
+    template<typename DERIVED, template<typename> class LINK>
+    void check_bdd_branch_node(const bdd_branch_node<DERIVED, LINK>& bdd, const bool last_variable = false, const bool first_variable = false)
     {
 #ifdef NDEBUG
         return;
@@ -64,7 +137,7 @@ namespace LPMP {
             assert(bdd.first_high_incoming == nullptr);
         } 
         if(bdd.first_low_incoming != nullptr) {
-            bdd_branch_node<DERIVED>* cur = bdd.first_low_incoming;
+            const DERIVED* cur = bdd.first_low_incoming;
             while(cur != nullptr) {
                 assert(cur < &bdd);
                 assert(cur->low_outgoing == &bdd);
@@ -72,7 +145,7 @@ namespace LPMP {
             }
         }
         if(bdd.first_high_incoming != nullptr) {
-            bdd_branch_node<DERIVED>* cur = bdd.first_high_incoming;
+            const DERIVED* cur = bdd.first_high_incoming;
             while(cur != nullptr) {
                 assert(cur < &bdd);
                 assert(cur->high_outgoing == &bdd);
@@ -86,15 +159,12 @@ namespace LPMP {
     // Optimization Branch Node //
     //////////////////////////////
 
-    template<typename DERIVED>
-    class bdd_branch_node_opt_base : public bdd_branch_node<DERIVED> {
+    template<typename DERIVED, template<typename> class LINK = bdd_node_pointer>
+    class bdd_branch_node_opt_base : public bdd_branch_node<DERIVED, LINK> {
         public:
             double* variable_cost = nullptr;
             double m = 0.0; // intermediate value of shortest path from either terminal or first node (depending on algorithm state)
 
-            // From C++20
-            friend bool operator==(const bdd_branch_node_opt_base<DERIVED>& x, const bdd_branch_node_opt_base<DERIVED>& y);
-
             void backward_step();
             void forward_step();
 
@@ -106,8 +176,8 @@ namespace LPMP {
             std::array<double,2> min_marginal_debug() const;
     };
 
-    template<typename DERIVED>
-    bool operator==(const bdd_branch_node_opt_base<DERIVED>& x, const bdd_branch_node_opt_base<DERIVED>& y)
+    template<typename DERIVED, template<typename> class LINK>
+    bool operator==(const bdd_branch_node_opt_base<DERIVED, LINK>& x, const bdd_branch_node_opt_base<DERIVED, LINK>& y)
     {
         const bool equal = (x.low_outgoing == y.low_outgoing &&
             x.high_outgoing == y.high_outgoing &&
@@ -120,8 +190,8 @@ namespace LPMP {
         return equal;
     }
 
-    template<typename DERIVED>
-    void bdd_branch_node_opt_base<DERIVED>::forward_step()
+    template<typename DERIVED, template<typename> class LINK>
+    void bdd_branch_node_opt_base<DERIVED, LINK>::forward_step()
     {
         check_bdd_branch_node(*this);
 
@@ -135,7 +205,7 @@ namespace LPMP {
 
         // iterate over all incoming low edges 
         {
-            auto* cur = this->first_low_incoming;
+            DERIVED* cur = this->first_low_incoming;
             while(cur != nullptr) {
                 //m = std::min(m, cur->m + *cumulative_sum - *(cur->cumulative_sum));
                 m = std::min(m, cur->m);
@@ -145,7 +215,7 @@ namespace LPMP {
 
         // iterate over all incoming high edges 
         {
-            auto* cur = this->first_high_incoming;
+            DERIVED* cur = this->first_high_incoming;
             while(cur != nullptr) {
                 //m = std::min(m, cur->m + *variable_cost + *cumulative_sum - *(cur->cumulative_sum));
                 m = std::min(m, cur->m + *(cur->variable_cost));
@@ -160,16 +230,16 @@ namespace LPMP {
         check_bdd_branch_node(*this);
     }
 
-    template<typename DERIVED>
-    void bdd_branch_node_opt_base<DERIVED>::backward_step()
+    template<typename DERIVED, template<typename> class LINK>
+    void bdd_branch_node_opt_base<DERIVED, LINK>::backward_step()
     {
         check_bdd_branch_node(*this);
 
         // low edge
         const double low_cost = [&]() {
-            if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0()) {
+            if(this->low_outgoing == DERIVED::terminal_0()) {
                 return std::numeric_limits<double>::infinity();
-            } else if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1()) {
+            } else if(this->low_outgoing == DERIVED::terminal_1()) {
                 //return *cumulative_sum;
                 return 0.0;
             } else {
@@ -180,9 +250,9 @@ namespace LPMP {
 
         // high edge
         const double high_cost = [&]() {
-            if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0()) {
+            if(this->high_outgoing == DERIVED::terminal_0()) {
                 return std::numeric_limits<double>::infinity(); 
-            } else if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1()) {
+            } else if(this->high_outgoing == DERIVED::terminal_1()) {
                 //return *cumulative_sum + *variable_cost; 
                 return *variable_cost; 
             } else {
@@ -203,8 +273,8 @@ namespace LPMP {
         // assert(std::abs(m - cost_from_terminal()) <= 1e-8);
     }
 
-    template<typename DERIVED>
-    double bdd_branch_node_opt_base<DERIVED>::cost_from_first() const
+    template<typename DERIVED, template<typename> class LINK>
+    double bdd_branch_node_opt_base<DERIVED, LINK>::cost_from_first() const
     {
         // TODO: only works if no bdd nodes skips variables
         double c = std::numeric_limits<double>::infinity();
@@ -213,7 +283,7 @@ namespace LPMP {
         
         // iterate over all incoming low edges 
         {
-            auto* cur = this->first_low_incoming;
+            DERIVED* cur = this->first_low_incoming;
             while(cur != nullptr) {
                 c = std::min(c, cur->cost_from_first());
                 cur = cur->next_low_incoming;
@@ -222,7 +292,7 @@ namespace LPMP {
 
         // iterate over all incoming high edges 
         {
-            auto* cur = this->first_high_incoming;
+            DERIVED* cur = this->first_high_incoming;
             while(cur != nullptr) {
                 c = std::min(c, cur->cost_from_first() + *cur->variable_cost);
                 cur = cur->next_high_incoming;
@@ -232,15 +302,15 @@ namespace LPMP {
         return c;
     }
 
-    template<typename DERIVED>
-    double bdd_branch_node_opt_base<DERIVED>::cost_from_terminal() const
+    template<typename DERIVED, template<typename> class LINK>
+    double bdd_branch_node_opt_base<DERIVED, LINK>::cost_from_terminal() const
     {
         // TODO: only works if no bdd nodes skips variables
         // low edge
         const double low_cost = [&]() {
-            if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0()) {
+            if(this->low_outgoing == DERIVED::terminal_0()) {
                 return std::numeric_limits<double>::infinity();
-            } else if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1()) {
+            } else if(this->low_outgoing == DERIVED::terminal_1()) {
                 return 0.0;
             } else {
                 return this->low_outgoing->cost_from_terminal();;
@@ -249,9 +319,9 @@ namespace LPMP {
 
         // high edge
         const double high_cost = [&]() {
-            if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0()) {
+            if(this->high_outgoing == DERIVED::terminal_0()) {
                 return std::numeric_limits<double>::infinity(); 
-            } else if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1()) {
+            } else if(this->high_outgoing == DERIVED::terminal_1()) {
                 return *variable_cost; 
             } else {
                 return this->high_outgoing->cost_from_terminal() + *variable_cost;
@@ -261,32 +331,32 @@ namespace LPMP {
         return std::min(low_cost, high_cost); 
     }
 
-    template<typename DERIVED>
-    std::array<double,2> bdd_branch_node_opt_base<DERIVED>::min_marginal() const
+    template<typename DERIVED, template<typename> class LINK>
+    std::array<double,2> bdd_branch_node_opt_base<DERIVED, LINK>::min_marginal() const
     {
         check_bdd_branch_node(*this);
 
         //std::cout << "in min_marginal() for " << this << ", m = " << m << "\n";
         // assert(std::abs(m - cost_from_first()) <= 1e-8);
-        if(!bdd_branch_node_opt_base<DERIVED>::is_terminal(this->low_outgoing)) {
+        if(!DERIVED::is_terminal(this->low_outgoing)) {
             // assert(std::abs(low_outgoing->m - low_outgoing->cost_from_terminal()) <= 1e-8);
         }
-        if(!bdd_branch_node_opt_base<DERIVED>::is_terminal(this->high_outgoing)) {
+        if(!DERIVED::is_terminal(this->high_outgoing)) {
             // assert(std::abs(high_outgoing->m - high_outgoing->cost_from_terminal()) <= 1e-8);
         }
 
         const double m0 = [&]() {
-            if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0())
+            if(this->low_outgoing == DERIVED::terminal_0())
                 return std::numeric_limits<double>::infinity();
-            if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1())
+            if(this->low_outgoing == DERIVED::terminal_1())
                 return this->m;
             return this->m + this->low_outgoing->m;
         }();
 
         const double m1 = [&]() {
-            if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0())
+            if(this->high_outgoing == DERIVED::terminal_0())
                 return std::numeric_limits<double>::infinity();
-            if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1())
+            if(this->high_outgoing == DERIVED::terminal_1())
                 return this->m + *this->variable_cost;
             return this->m + *this->variable_cost + this->high_outgoing->m;
         }();
@@ -296,25 +366,25 @@ namespace LPMP {
         return {m0,m1};
     }
 
-    template<typename DERIVED>
-    std::array<double,2> bdd_branch_node_opt_base<DERIVED>::min_marginal_debug() const
+    template<typename DERIVED, template<typename> class LINK>
+    std::array<double,2> bdd_branch_node_opt_base<DERIVED, LINK>::min_marginal_debug() const
     {
         check_bdd_branch_node(*this);
 
         const double m_debug = cost_from_first();
 
         const double m0 = [&]() {
-            if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0())
+            if(this->low_outgoing == DERIVED::terminal_0())
                 return std::numeric_limits<double>::infinity();
-            if(this->low_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1())
+            if(this->low_outgoing == DERIVED::terminal_1())
                 return m_debug;
             return m_debug + this->low_outgoing->cost_from_terminal();
         }();
 
         const double m1 = [&]() {
-            if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_0())
+            if(this->high_outgoing == DERIVED::terminal_0())
                 return std::numeric_limits<double>::infinity();
-            if(this->high_outgoing == bdd_branch_node_opt_base<DERIVED>::terminal_1())
+            if(this->high_outgoing == DERIVED::terminal_1())
                 return m_debug + *this->variable_cost;
             return m_debug + *this->variable_cost + this->high_outgoing->cost_from_terminal();
         }();
@@ -327,6 +397,10 @@ namespace LPMP {
     class bdd_branch_node_opt : public bdd_branch_node_opt_base<bdd_branch_node_opt>{
     };
 
+    // same as bdd_branch_node_opt with 32 bit links: 40 instead of 64 bytes
+    class bdd_branch_node_opt_compact : public bdd_branch_node_opt_base<bdd_branch_node_opt_compact, bdd_node_link>{
+    };
+
     //////////////////////////////////////
     // Smoothed Optimization Branch Node
     //////////////////////////////////////
@@ -348,8 +422,26 @@ namespace LPMP {
         double cost_scaling_ = 1.0;
     };
 
-    template<typename DERIVED>
-    class bdd_branch_node_opt_smoothed_base : public bdd_branch_node_opt_base<DERIVED>
+    // exponentials of one batched smoothed step, gathered such that they can be evaluated together
+    struct smooth_step_batch
+    {
+        std::vector<double> exponents; // replaced by their exponentials
+        std::vector<double> weights;
+        std::vector<std::size_t> targets; // offset of bdd node (or exp sum entry) the weighted exponential is added to
+
+        void clear() { exponents.clear(); weights.clear(); targets.clear(); }
+        void push_back(const double exponent, const double weight, const std::size_t target)
+        {
+            exponents.push_back(exponent);
+            weights.push_back(weight);
+            targets.push_back(target);
+        }
+        void exp(const std::size_t degree) { exp_approximation(exponents.data(), exponents.data() + exponents.size(), degree); }
+        std::size_t size() const { return exponents.size(); }
+    };
+
+    template<typename DERIVED, template<typename> class LINK = bdd_node_pointer>
+    class bdd_branch_node_opt_smoothed_base : public bdd_branch_node_opt_base<DERIVED, LINK>
     {
     public:
         // below two are provided by base
@@ -358,9 +450,6 @@ namespace LPMP {
 
         double current_max = 0.0; // intermediate maximum value in the exp sum, used for stabilizing log-sum-exp computation. Also referred to as streamed log sum exp.
 
-        // From C++20
-        friend bool operator==(const bdd_branch_node_opt_smoothed_base &x, const bdd_branch_node_opt_smoothed_base &y);
-
         void smooth_backward_step();
         void smooth_forward_step();
 
@@ -371,13 +460,25 @@ namespace LPMP {
         bdd_branch_node_exp_sum_entry exp_sums() const;
         template <typename BDD_BRANCH_NODE_ITERATOR>
         static bdd_branch_node_exp_sum_entry exp_sums(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end);
+
+        // Batched versions of the above for all nodes of one bdd variable, which do not depend on each other.
+        // Maxima are computed first, afterwards all exponentials are evaluated at once by the vectorized exp_approximation of given degree.
+        template <typename BDD_BRANCH_NODE_ITERATOR>
+        static void batch_smooth_forward_step(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end, smooth_step_batch& batch, const std::size_t degree);
+        template <typename BDD_BRANCH_NODE_ITERATOR>
+        static void batch_smooth_backward_step(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end, smooth_step_batch& batch, const std::size_t degree);
+        template <typename BDD_BRANCH_NODE_ITERATOR>
+        static bdd_branch_node_exp_sum_entry batch_exp_sums(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end, smooth_step_batch& batch, const std::size_t degree);
     };
 
     class bdd_branch_node_opt_smoothed : public bdd_branch_node_opt_smoothed_base<bdd_branch_node_opt_smoothed>
     {};
 
-    template<typename DERIVED>
-    void bdd_branch_node_opt_smoothed_base<DERIVED>::smooth_forward_step()
+    class bdd_branch_node_opt_smoothed_compact : public bdd_branch_node_opt_smoothed_base<bdd_branch_node_opt_smoothed_compact, bdd_node_link>
+    {};
+
+    template<typename DERIVED, template<typename> class LINK>
+    void bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::smooth_forward_step()
     {
         check_bdd_branch_node(*this);
 
@@ -392,7 +493,7 @@ namespace LPMP {
 
         // iterate over all incoming low edges
         {
-            for(auto *cur = this->first_low_incoming; cur != nullptr; cur = cur->next_low_incoming)
+            for(DERIVED* cur = this->first_low_incoming; cur != nullptr; cur = cur->next_low_incoming)
             {
                 if(cur->current_max < current_max)
                 {
@@ -410,7 +511,7 @@ namespace LPMP {
 
         // iterate over all incoming high edges
         {
-            for(auto *cur = this->first_high_incoming; cur != nullptr; cur = cur->next_high_incoming)
+            for(DERIVED* cur = this->first_high_incoming; cur != nullptr; cur = cur->next_high_incoming)
             {
                 if(cur->current_max -*cur->variable_cost < current_max)
                 {
@@ -433,16 +534,16 @@ namespace LPMP {
         check_bdd_branch_node(*this);
     }
 
-    template<typename DERIVED>
-    void bdd_branch_node_opt_smoothed_base<DERIVED>::smooth_backward_step()
+    template<typename DERIVED, template<typename> class LINK>
+    void bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::smooth_backward_step()
     {
         check_bdd_branch_node(*this);
 
         // low edge
         const auto [low_cost, low_max] = [&]() -> std::array<double,2> {
-            if (this->low_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0())
+            if (this->low_outgoing == DERIVED::terminal_0())
                 return {0.0, -std::numeric_limits<double>::infinity()};
-            else if (this->low_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+            else if (this->low_outgoing == DERIVED::terminal_1())
                 return {std::exp(0.0), 0.0};
             else
                 return {this->low_outgoing->m, this->low_outgoing->current_max};
@@ -456,9 +557,9 @@ namespace LPMP {
             //    return {std::exp(-*variable_cost - low_max)), -*variable_cost};
             //else
             //    return {std::exp(-*variable_cost) * high_outgoing->m, -*variable_cost + high_outgoing->current_max};
-            if (this->high_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0())
+            if (this->high_outgoing == DERIVED::terminal_0())
                 return {0.0, -std::numeric_limits<double>::infinity()};
-            else if (this->high_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+            else if (this->high_outgoing == DERIVED::terminal_1())
                 return {std::exp(0.0), 0.0};
             else
                 return {this->high_outgoing->m, this->high_outgoing->current_max};
@@ -496,8 +597,8 @@ namespace LPMP {
         //assert(std::abs(m - cost_from_terminal()) <= 1e-8);
     }
 
-    template<typename DERIVED>
-    double bdd_branch_node_opt_smoothed_base<DERIVED>::smooth_cost_from_first() const
+    template<typename DERIVED, template<typename> class LINK>
+    double bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::smooth_cost_from_first() const
     {
         double c = 0.0;
 
@@ -505,25 +606,25 @@ namespace LPMP {
             return 0.0;
 
         // iterate over all incoming low edges
-        for (auto *cur = this->first_low_incoming; cur != nullptr; cur = cur->next_low_incoming)
+        for (DERIVED* cur = this->first_low_incoming; cur != nullptr; cur = cur->next_low_incoming)
             c += cur->smooth_cost_from_first();
 
         // iterate over all incoming high edges
-        for (auto *cur = this->first_high_incoming; cur != nullptr; cur = cur->next_high_incoming)
+        for (DERIVED* cur = this->first_high_incoming; cur != nullptr; cur = cur->next_high_incoming)
             c += std::exp(-*cur->variable_cost) * cur->smooth_cost_from_first(); // ??
 
         return c;
     }
 
-    template<typename DERIVED>
-    double bdd_branch_node_opt_smoothed_base<DERIVED>::smooth_cost_from_terminal() const
+    template<typename DERIVED, template<typename> class LINK>
+    double bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::smooth_cost_from_terminal() const
     {
         // TODO: only works if no bdd nodes skips variables
         // low edge
         const double low_cost = [&]() {
-            if (this->low_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0())
+            if (this->low_outgoing == DERIVED::terminal_0())
                 return 0.0;
-            else if (this->low_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+            else if (this->low_outgoing == DERIVED::terminal_1())
                 return 1.0;
             else
                 return this->low_outgoing->smooth_cost_from_terminal();
@@ -531,9 +632,9 @@ namespace LPMP {
 
         // high edge
         const double high_cost = [&]() {
-            if (this->high_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0())
+            if (this->high_outgoing == DERIVED::terminal_0())
                 return 0.0;
-            else if (this->high_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+            else if (this->high_outgoing == DERIVED::terminal_1())
                 return std::exp(-*this->variable_cost);
             else
                 return this->high_outgoing->smooth_cost_from_terminal() + std::exp(-*this->variable_cost);
@@ -542,17 +643,17 @@ namespace LPMP {
         return low_cost + high_cost;
     }
 
-    template<typename DERIVED>
-    bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_sums() const
+    template<typename DERIVED, template<typename> class LINK>
+    bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::exp_sums() const
     {
         check_bdd_branch_node(*this);
 
         // assert(std::abs(m - cost_from_first()) <= 1e-8);
-        if (!bdd_branch_node_opt_smoothed_base<DERIVED>::is_terminal(this->low_outgoing))
+        if (!DERIVED::is_terminal(this->low_outgoing))
         {
             //assert(std::abs(low_outgoing->m - low_outgoing->cost_from_terminal()) <= 1e-8);
         }
-        if (!bdd_branch_node_opt_smoothed_base<DERIVED>::is_terminal(this->high_outgoing))
+        if (!DERIVED::is_terminal(this->high_outgoing))
         {
             //assert(std::abs(high_outgoing->m - high_outgoing->cost_from_terminal()) <= 1e-8);
         }
@@ -560,18 +661,18 @@ namespace LPMP {
         bdd_branch_node_exp_sum_entry e;
 
         std::tie(e.sum[0], e.max[0]) = [&]() -> std::tuple<double, double> {
-            if (this->low_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0())
+            if (this->low_outgoing == DERIVED::terminal_0())
                 return {0.0, -std::numeric_limits<double>::infinity()};
-            if (this->low_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+            if (this->low_outgoing == DERIVED::terminal_1())
                 return {this->m, current_max};
             else
                 return {this->m * this->low_outgoing->m, current_max + this->low_outgoing->current_max};
         }();
 
         std::tie(e.sum[1], e.max[1]) = [&]() -> std::tuple<double, double> {
-            if (this->high_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0())
+            if (this->high_outgoing == DERIVED::terminal_0())
                 return {0.0, -std::numeric_limits<double>::infinity()};
-            if (this->high_outgoing == bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+            if (this->high_outgoing == DERIVED::terminal_1())
             {
                 //const double new_max = std::max(this->current_max, this->current_max - *this->variable_cost);
                 //return {this->m * std::exp(-*this->variable_cost + this->current_max - new_max), new_max};
@@ -590,12 +691,12 @@ namespace LPMP {
         assert(e.sum[0] >= 0.0);
         assert(e.sum[1] >= 0.0);
         assert(e.sum[0] > 0 || e.sum[1] > 0);
-        if(this->low_outgoing != bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0() && this->low_outgoing != bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+        if(this->low_outgoing != DERIVED::terminal_0() && this->low_outgoing != DERIVED::terminal_1())
         {
             assert(e.sum[0] > 0);
             assert(std::isfinite(e.max[0]));
         }
-        if (this->high_outgoing != bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_0() && this->high_outgoing != bdd_branch_node_opt_smoothed_base<DERIVED>::terminal_1())
+        if (this->high_outgoing != DERIVED::terminal_0() && this->high_outgoing != DERIVED::terminal_1())
         {
             assert(e.sum[1] > 0);
             assert(std::isfinite(e.max[1]));
@@ -607,9 +708,9 @@ namespace LPMP {
         return e;
     }
 
-template<typename DERIVED>
+template<typename DERIVED, template<typename> class LINK>
 template<typename BDD_BRANCH_NODE_ITERATOR>
-bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_sums(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end)
+bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::exp_sums(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end)
 {
     bdd_branch_node_exp_sum_entry e;
     e.sum = {0.0, 0.0};
@@ -659,6 +760,112 @@ bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_su
     return {s, current_max};
 }
 
+    template<typename DERIVED, template<typename> class LINK>
+    template<typename BDD_BRANCH_NODE_ITERATOR>
+    void bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::batch_smooth_forward_step(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end, smooth_step_batch& batch, const std::size_t degree)
+    {
+        batch.clear();
+        std::size_t i = 0;
+        for(auto it=bdd_node_begin; it!=bdd_node_end; ++it, ++i)
+        {
+            auto& bdd = *it;
+            check_bdd_branch_node(bdd);
+            if(bdd.is_first())
+            {
+                bdd.current_max = 0.0;
+                continue;
+            }
+
+            bdd.current_max = -std::numeric_limits<double>::infinity();
+            for(DERIVED* cur = bdd.first_low_incoming; cur != nullptr; cur = cur->next_low_incoming)
+                bdd.current_max = std::max(bdd.current_max, cur->current_max);
+            for(DERIVED* cur = bdd.first_high_incoming; cur != nullptr; cur = cur->next_high_incoming)
+                bdd.current_max = std::max(bdd.current_max, cur->current_max - *cur->variable_cost);
+            assert(std::isfinite(bdd.current_max));
+
+            for(DERIVED* cur = bdd.first_low_incoming; cur != nullptr; cur = cur->next_low_incoming)
+                batch.push_back(cur->current_max - bdd.current_max, cur->m, i);
+            for(DERIVED* cur = bdd.first_high_incoming; cur != nullptr; cur = cur->next_high_incoming)
+                batch.push_back(cur->current_max - *cur->variable_cost - bdd.current_max, cur->m, i);
+        }
+
+        batch.exp(degree);
+
+        for(auto it=bdd_node_begin; it!=bdd_node_end; ++it)
+            (*it).m = (*it).is_first() ? 1.0 : 0.0;
+        for(std::size_t j=0; j<batch.size(); ++j)
+            bdd_node_begin[batch.targets[j]].m += batch.weights[j] * batch.exponents[j];
+    }
+
+    template<typename DERIVED, template<typename> class LINK>
+    template<typename BDD_BRANCH_NODE_ITERATOR>
+    void bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::batch_smooth_backward_step(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end, smooth_step_batch& batch, const std::size_t degree)
+    {
+        auto outgoing = [](const DERIVED* next) -> std::array<double,2> {
+            if (next == DERIVED::terminal_0())
+                return {0.0, -std::numeric_limits<double>::infinity()};
+            else if (next == DERIVED::terminal_1())
+                return {1.0, 0.0};
+            else
+                return {next->m, next->current_max};
+        };
+
+        // exponents of terminal_0 arcs are -infinity with zero weight
+        batch.clear();
+        std::size_t i = 0;
+        for(auto it=bdd_node_begin; it!=bdd_node_end; ++it, ++i)
+        {
+            auto& bdd = *it;
+            check_bdd_branch_node(bdd);
+            const auto [low_cost, low_max] = outgoing(bdd.low_outgoing);
+            const auto [high_cost, high_max] = outgoing(bdd.high_outgoing);
+            bdd.current_max = std::max(low_max, high_max - *bdd.variable_cost);
+            assert(std::isfinite(bdd.current_max));
+            batch.push_back(low_max - bdd.current_max, low_cost, i);
+            batch.push_back(high_max - *bdd.variable_cost - bdd.current_max, high_cost, i);
+        }
+
+        batch.exp(degree);
+
+        for(auto it=bdd_node_begin; it!=bdd_node_end; ++it)
+            (*it).m = 0.0;
+        for(std::size_t j=0; j<batch.size(); ++j)
+            bdd_node_begin[batch.targets[j]].m += batch.weights[j] * batch.exponents[j];
+    }
+
+    template<typename DERIVED, template<typename> class LINK>
+    template<typename BDD_BRANCH_NODE_ITERATOR>
+    bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED, LINK>::batch_exp_sums(BDD_BRANCH_NODE_ITERATOR bdd_node_begin, BDD_BRANCH_NODE_ITERATOR bdd_node_end, smooth_step_batch& batch, const std::size_t degree)
+    {
+        bdd_branch_node_exp_sum_entry e;
+        e.sum = {0.0, 0.0};
+        e.max = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+
+        batch.clear();
+        for(auto it=bdd_node_begin; it!=bdd_node_end; ++it)
+        {
+            const auto bdd_exp_sums = (*it).exp_sums();
+            for(std::size_t l=0; l<2; ++l)
+            {
+                if(bdd_exp_sums.sum[l] > 0)
+                {
+                    batch.push_back(bdd_exp_sums.max[l], bdd_exp_sums.sum[l], l);
+                    e.max[l] = std::max(e.max[l], bdd_exp_sums.max[l]);
+                }
+            }
+        }
+
+        for(std::size_t j=0; j<batch.size(); ++j)
+            batch.exponents[j] -= e.max[batch.targets[j]];
+        batch.exp(degree);
+        for(std::size_t j=0; j<batch.size(); ++j)
+            e.sum[batch.targets[j]] += batch.weights[j] * batch.exponents[j];
+
+        assert(e.sum[0] > 0);
+        assert(e.sum[1] > 0);
+        return e;
+    }
+
     /*
     std::array<double, 2> bdd_branch_node_opt_smoothed::min_marginal_debug() const
     {
@@ -692,16 +899,14 @@ bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_su
     // Variable Fixing Branch Node
     /////////////////////////////////
 
-    class bdd_branch_node_fix : public bdd_branch_node_opt_smoothed_base<bdd_branch_node_fix> {
+    template<typename DERIVED, template<typename> class LINK = bdd_node_pointer>
+    class bdd_branch_node_fix_base : public bdd_branch_node_opt_smoothed_base<DERIVED, LINK> {
         public:
-            bdd_branch_node_fix* prev_low_incoming = nullptr;
-            bdd_branch_node_fix* prev_high_incoming = nullptr;
+            LINK<DERIVED> prev_low_incoming = nullptr;
+            LINK<DERIVED> prev_high_incoming = nullptr;
 
             bdd_variable_fix* bdd_var;
 
-            // From C++20
-            friend bool operator==(const bdd_branch_node_fix& x, const bdd_branch_node_fix& y);
-
             void count_forward_step();
             void count_backward_step();
 
@@ -709,7 +914,8 @@ bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_su
             double count_high();
     };
 
-    bool operator==(const bdd_branch_node_fix& x, const bdd_branch_node_fix& y)
+    template<typename DERIVED, template<typename> class LINK>
+    bool operator==(const bdd_branch_node_fix_base<DERIVED, LINK>& x, const bdd_branch_node_fix_base<DERIVED, LINK>& y)
     {
         const bool equal = (x.low_outgoing == y.low_outgoing &&
             x.high_outgoing == y.high_outgoing &&
@@ -723,67 +929,49 @@ bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_su
         return equal;
     }
 
-    // template<typename DERIVED>
-    // class bdd_branch_node_fix_base : virtual public bdd_branch_node<DERIVED> {
-    //     public:
-    //         DERIVED* prev_low_incoming = nullptr;
-    //         DERIVED* prev_high_incoming = nullptr;
-
-    //         bdd_variable_fix* bdd_var;
-
-    //         // From C++20
-    //         friend bool operator==(const DERIVED& x, const DERIVED& y);
-
-    // };
-
-    // template<typename DERIVED>
-    // bool operator==(const DERIVED& x, const DERIVED& y)
-    // {
-    //     const bool equal = ((bdd_branch_node<DERIVED>) x == (bdd_branch_node<DERIVED>) y &&
-    //         x.prev_low_incoming == y.prev_low_incoming &&
-    //         x.prev_high_incoming == y.prev_high_incoming &&
-    //         x.bdd_var == y.bdd_var);
-    //     return equal;
-    // }
+    class bdd_branch_node_fix : public bdd_branch_node_fix_base<bdd_branch_node_fix> {
+    };
 
-    // class bdd_branch_node_fix : public bdd_branch_node_opt_base<bdd_branch_node_fix>, public bdd_branch_node_fix_base<bdd_branch_node_fix> {
-    // };
+    class bdd_branch_node_fix_compact : public bdd_branch_node_fix_base<bdd_branch_node_fix_compact, bdd_node_link> {
+    };
 
-    void bdd_branch_node_fix::count_forward_step()
+    template<typename DERIVED, template<typename> class LINK>
+    void bdd_branch_node_fix_base<DERIVED, LINK>::count_forward_step()
     {
         if(this->is_first()) {
-            m = 1.0;
+            this->m = 1.0;
             return;
         }
 
-        m = 0.0;
+        this->m = 0.0;
 
         // iterate over all incoming low edges 
         {
-            auto* cur = this->first_low_incoming;
+            DERIVED* cur = this->first_low_incoming;
             while(cur != nullptr) {
-                m += cur->m;
+                this->m += cur->m;
                 cur = cur->next_low_incoming;
             }
         }
 
         // iterate over all incoming high edges 
         {
-            auto* cur = this->first_high_incoming;
+            DERIVED* cur = this->first_high_incoming;
             while(cur != nullptr) {
-                m += cur->m;
+                this->m += cur->m;
                 cur = cur->next_high_incoming;
             }
         }
     }
 
-    void bdd_branch_node_fix::count_backward_step()
+    template<typename DERIVED, template<typename> class LINK>
+    void bdd_branch_node_fix_base<DERIVED, LINK>::count_backward_step()
     {
         // low edge
         const double low_count = [&]() {
-            if(this->low_outgoing == bdd_branch_node_fix::terminal_0()) {
+            if(this->low_outgoing == DERIVED::terminal_0()) {
                 return 0.0;
-            } else if(this->low_outgoing == bdd_branch_node_fix::terminal_1()) {
+            } else if(this->low_outgoing == DERIVED::terminal_1()) {
                 return 1.0;
             } else {
                 return this->low_outgoing->m;
@@ -792,36 +980,38 @@ bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_su
 
         // high edge
         const double high_count = [&]() {
-            if(this->high_outgoing == bdd_branch_node_fix::terminal_0()) {
+            if(this->high_outgoing == DERIVED::terminal_0()) {
                 return 0.0; 
-            } else if(this->high_outgoing == bdd_branch_node_fix::terminal_1()) {
+            } else if(this->high_outgoing == DERIVED::terminal_1()) {
                 return 1.0; 
             } else {
                 return this->high_outgoing->m;
             }
         }();
 
-        m = low_count + high_count;
+        this->m = low_count + high_count;
     }
 
-    double bdd_branch_node_fix::count_low()
+    template<typename DERIVED, template<typename> class LINK>
+    double bdd_branch_node_fix_base<DERIVED, LINK>::count_low()
     {
-        if (this->low_outgoing == bdd_branch_node_fix::terminal_0())
+        if (this->low_outgoing == DERIVED::terminal_0())
             return 0.0;
-        else if (this->low_outgoing == bdd_branch_node_fix::terminal_1())
-            return m;
+        else if (this->low_outgoing == DERIVED::terminal_1())
+            return this->m;
         else
-            return m * this->low_outgoing->m;
+            return this->m * this->low_outgoing->m;
     }
 
-    double bdd_branch_node_fix::count_high()
+    template<typename DERIVED, template<typename> class LINK>
+    double bdd_branch_node_fix_base<DERIVED, LINK>::count_high()
     {
-        if (this->high_outgoing == bdd_branch_node_fix::terminal_0())
+        if (this->high_outgoing == DERIVED::terminal_0())
             return 0.0;
-        else if (this->high_outgoing == bdd_branch_node_fix::terminal_1())
-            return m;
+        else if (this->high_outgoing == DERIVED::terminal_1())
+            return this->m;
         else
-            return m * this->high_outgoing->m;
+            return this->m * this->high_outgoing->m;
     }
 
     // bdd branch node with individual arc costs, for use in decomposition bdd base (since there are Lagrange multipliers for individual arcs)
@@ -832,9 +1022,6 @@ bdd_branch_node_exp_sum_entry bdd_branch_node_opt_smoothed_base<DERIVED>::exp_su
             double high_cost = std::numeric_limits<double>::infinity();
             double m = 0.0; // intermediate value of shortest path from either terminal or first node (depending on algorithm state)
 
-            // From C++20
-            friend bool operator==(const bdd_branch_node_opt_base<DERIVED>& x, const bdd_branch_node_opt_base<DERIVED>& y);
-
             void backward_step();
             void forward_step();
 
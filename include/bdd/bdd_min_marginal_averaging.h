@@ -27,11 +27,12 @@ namespace LPMP {
     struct bdd_min_marginal_averaging_options {
         bdd_min_marginal_averaging_options(TCLAP::CmdLine& cmd);
 
+        // Transfers the parsed command line values. Only the first call does so, hence options set directly afterwards are kept.
         void init();
 
         enum class averaging_type {classic, SRMP} averaging_type = averaging_type::classic;
         enum class variable_order {input, bfs, cuthill, mindegree} variable_order = variable_order::input;
-        enum class fixing_order {marginals_absolute, marginals_up, marginals_down, marginals_reduction} fixing_order = fixing_order::marginals_up;
+        enum class fixing_order {marginals_absolute, marginals_up, marginals_down, marginals_reduction, portfolio} fixing_order = fixing_order::marginals_up;
         enum class fixing_value {marginal, reduction, one, zero} fixing_value = fixing_value::marginal;
 
         private:
@@ -39,6 +40,7 @@ namespace LPMP {
             TCLAP::ValueArg<std::string> order_arg;
             TCLAP::ValueArg<std::string> fixing_order_arg;
             TCLAP::ValueArg<std::string> fixing_value_arg;
+            bool initialized_ = false;
     };
 
     ////////////////////////////////////////////////////
@@ -54,7 +56,7 @@ namespace LPMP {
             template<typename BDD_VARIABLES_ITERATOR>
                 void add_bdd(BDD::node_ref bdd, BDD_VARIABLES_ITERATOR bdd_vars_begin, BDD_VARIABLES_ITERATOR bdd_vars_end, BDD::bdd_mgr& bdd_mgr);
 
-            //void init(const ILP_input& input);
+            void init(const ILP_input& input);
             void init();
 
             std::size_t nr_variables() const { return bdd_variables_.size(); }
@@ -70,6 +72,10 @@ namespace LPMP {
             void forward_run();
 
             const BDD_VARIABLE &get_bdd_variable(const std::size_t var, const std::size_t bdd_index) const;
+            // holds no constraints if the BDDs were read from a snapshot
+            const ILP_input& ilp_input() const { return ilp_input_; }
+            // options are read from the command line on first access, changes made through the returned reference are kept when initializing
+            bdd_min_marginal_averaging_options& get_options() { options.init(); return options; }
             const BDD_BRANCH_NODE &get_bdd_branch_node(const std::size_t var, const std::size_t bdd_index, const std::size_t bdd_node_index) const;
 
         protected:
@@ -86,6 +92,11 @@ namespace LPMP {
             std::vector<BDD_BRANCH_NODE> bdd_branch_nodes_;
             two_dim_variable_array<BDD_VARIABLE> bdd_variables_;
 
+            void init_bdd_storage();
+            void init_bdd_storage(ILP_input&& input);
+            template<typename FINGERPRINT>
+                void init_bdd_storage(ILP_input&& input, FINGERPRINT constraint_fingerprint);
+            void init_bdd_storage_from_snapshot(ILP_input&& objective, const ILP_parser::constraint_fingerprint& constraints);
             void init_branch_nodes();
 
             ILP_input ilp_input_;
@@ -94,12 +105,16 @@ namespace LPMP {
             bdd_min_marginal_averaging_options options;
 
             TCLAP::ValueArg<std::string> input_file_arg_; // TODO: move to ILP_input or some wrapper around it.
+            TCLAP::ValueArg<std::string> write_snapshot_arg_;
+            TCLAP::ValueArg<std::string> read_snapshot_arg_;
 
     };
 
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::bdd_base(TCLAP::CmdLine& cmd)
-        : input_file_arg_("i","input","input file",true,"", "", cmd),
+        : input_file_arg_("i","input","input file",false,"", "", cmd),
+        write_snapshot_arg_("","write_bdd_snapshot","write compiled BDDs to file",false,"","file",cmd),
+        read_snapshot_arg_("","bdd_snapshot","use BDDs compiled before instead of converting constraints, only the objective is taken from the input file",false,"","file",cmd),
         options(cmd),
         bdd_storage_(cmd)
     {}
@@ -129,24 +144,61 @@ namespace LPMP {
         bdd_storage_.add_bdd(bdd_mgr, bdd, bdd_vars_begin, bdd_vars_end); 
     }
 
-    /*
+    // input given directly instead of as file, other command line options apply
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     void bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init(const ILP_input& input)
     {
-        bdd_storage_.init(input);
-        //bdd_preprocessor bdd_pre(input);
-        //bdd_pre.coalesce_bdd_collection();
-        //bdd_storage_ = bdd_storage(bdd_pre.get_bdd_collection());
-        std::cout << "bdd storage: nr bdds = " << bdd_storage_.nr_bdds() << "\n";
-
+        init_bdd_storage(ILP_input(input));
         init_branch_nodes();
     }
-    */
 
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     void bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init()
     {
-        ilp_input_ = ILP_parser::parse_file(input_file_arg_.getValue());
+        init_bdd_storage();
+        init_branch_nodes();
+    }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    void bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init_bdd_storage()
+    {
+        if(input_file_arg_.getValue().empty())
+            throw std::runtime_error("no input file given");
+        const std::string& filename = input_file_arg_.getValue();
+        if(!read_snapshot_arg_.getValue().empty()) {
+            options.init();
+            ILP_parser::constraint_fingerprint constraints;
+            ILP_input objective = ILP_parser::parse_objective_file(filename, constraints);
+            init_bdd_storage_from_snapshot(std::move(objective), constraints);
+            return;
+        }
+        ILP_input input = ILP_parser::parse_file_streaming(filename);
+        init_bdd_storage(std::move(input), [&]() { return ILP_parser::fingerprint_constraints_file(filename); });
+    }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    void bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init_bdd_storage(ILP_input&& input)
+    {
+        if(!read_snapshot_arg_.getValue().empty()) {
+            options.init();
+            const ILP_parser::constraint_fingerprint constraints = ILP_parser::fingerprint_constraints(input);
+            ILP_input objective;
+            for(std::size_t i=0; i<input.nr_variables(); ++i)
+                objective.add_to_objective(input.objective(i), input.get_var_name(i));
+            init_bdd_storage_from_snapshot(std::move(objective), constraints);
+            return;
+        }
+        init_bdd_storage(std::move(input), [&]() { return ILP_parser::fingerprint_constraints(input); });
+    }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    template<typename FINGERPRINT>
+    void bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init_bdd_storage(ILP_input&& input, FINGERPRINT constraint_fingerprint)
+    {
+        options.init();
+        // the fingerprint refers to the constraints before reordering
+        const ILP_parser::constraint_fingerprint constraints = write_snapshot_arg_.getValue().empty() ? ILP_parser::constraint_fingerprint{} : constraint_fingerprint();
+        ilp_input_ = std::move(input);
 
         if (options.variable_order == bdd_min_marginal_averaging_options::variable_order::bfs)
             ilp_input_.reorder_bfs();
@@ -157,7 +209,32 @@ namespace LPMP {
 
         bdd_storage_.init(ilp_input_);
 
-        init_branch_nodes();
+        if(!write_snapshot_arg_.getValue().empty()) {
+            std::vector<std::string> variable_names;
+            variable_names.reserve(ilp_input_.nr_variables());
+            for(std::size_t i=0; i<ilp_input_.nr_variables(); ++i)
+                variable_names.push_back(ilp_input_.get_var_name(i));
+            bdd_storage_.write_snapshot(write_snapshot_arg_.getValue(), variable_names, constraints);
+        }
+    }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    void bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init_bdd_storage_from_snapshot(ILP_input&& objective, const ILP_parser::constraint_fingerprint& constraints)
+    {
+        // variables are indexed in the order of the snapshot, constraints are only present as BDDs
+        const std::vector<std::string> variable_names = bdd_storage_.read_snapshot(read_snapshot_arg_.getValue(), constraints);
+        ilp_input_ = ILP_input();
+        for(const std::string& var : variable_names) {
+            if(ilp_input_.var_exists(var))
+                throw std::runtime_error("bdd snapshot contains duplicate variables");
+            ilp_input_.add_new_variable(var);
+        }
+        for(std::size_t i=0; i<objective.nr_variables(); ++i) {
+            const std::string& var = objective.get_var_name(i);
+            if(!ilp_input_.var_exists(var))
+                throw std::runtime_error("variable " + var + " of input file not present in bdd snapshot");
+            ilp_input_.add_to_objective(objective.objective(i), ilp_input_.get_var_index(var));
+        }
     }
 
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
@@ -507,6 +584,7 @@ namespace LPMP {
     class bdd_mma_base;
 
     typedef bdd_mma_base<bdd_variable_mma, bdd_branch_node_opt> bdd_min_marginal_averaging;
+    typedef bdd_mma_base<bdd_variable_mma, bdd_branch_node_opt_compact> bdd_min_marginal_averaging_compact;
 
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     class bdd_mma_base : public bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE> //, public bdd_solver_interface // virtual base class not really needed
@@ -515,12 +593,20 @@ namespace LPMP {
         using bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::bdd_base;
         bdd_mma_base(const bdd_mma_base &) = delete; // no copy constructor because of pointers in bdd_branch_node
 
-        //void init(const ILP_input &input);
+        void init(const ILP_input &input);
         void init();
 
         template <typename ITERATOR>
         void set_costs(ITERATOR begin, ITERATOR end);
 
+        // Warm start after cost changes: the dual state are the costs of all bdd variables, ordered by variable and bdd index.
+        // When importing, the multipliers of each variable are shifted uniformly such that they sum up to the new costs. Hence the old reparametrization stays feasible and only the cost difference needs to be propagated.
+        std::vector<double> export_Lagrange_multipliers() const;
+        template <typename ITERATOR>
+        void import_Lagrange_multipliers(const std::vector<double>& multipliers, ITERATOR cost_begin, ITERATOR cost_end);
+        template <typename ITERATOR>
+        void update_costs(ITERATOR begin, ITERATOR end) { import_Lagrange_multipliers(export_Lagrange_multipliers(), begin, end); }
+
         template <typename ITERATOR>
         bool check_feasibility(ITERATOR var_begin, ITERATOR var_end) const;
         template <typename ITERATOR>
@@ -533,6 +619,12 @@ namespace LPMP {
 
         double compute_upper_bound(const std::vector<char> &primal_solution) const;
 
+        // min-marginal differences m[1]-m[0] of each variable summed over its bdds, backward messages must be up to date
+        std::vector<double> total_min_marginals() { return total_min_marginals([](const std::size_t) { return false; }); }
+        // variables for which skip(var) holds get zero
+        template<typename SKIP>
+        std::vector<double> total_min_marginals(SKIP skip);
+
         void min_marginal_averaging_iteration();
         void min_marginal_averaging_forward();
         void min_marginal_averaging_backward();
@@ -571,13 +663,17 @@ namespace LPMP {
        :
             averaging_arg("a","averaging","averaging type",false,"classic","{classic|SRMP}", cmd),
             order_arg("o","order","variable order",false,"input","{input|bfs|cuthill|mindegree}", cmd),
-            fixing_order_arg("f","fixing","variable fixing order",false,"up","{abs|up|down|reduction}", cmd),
+            fixing_order_arg("f","fixing","variable fixing order, portfolio runs all orders concurrently",false,"up","{abs|up|down|reduction|portfolio}", cmd),
             fixing_value_arg("v","value","variable fixing preferred value",false,"marginal","{marginal|reduction|one|zero}", cmd)
 
         {}
 
    void bdd_min_marginal_averaging_options::init() 
    {
+            if(initialized_)
+                return;
+            initialized_ = true;
+
             if(averaging_arg.getValue() == "classic")
                 averaging_type = bdd_min_marginal_averaging_options::averaging_type::classic;
             else if(averaging_arg.getValue() == "SRMP")
@@ -604,6 +700,8 @@ namespace LPMP {
                 fixing_order = bdd_min_marginal_averaging_options::fixing_order::marginals_down;
             else if(fixing_order_arg.getValue() == "reduction")
                 fixing_order = bdd_min_marginal_averaging_options::fixing_order::marginals_reduction;
+            else if(fixing_order_arg.getValue() == "portfolio")
+                fixing_order = bdd_min_marginal_averaging_options::fixing_order::portfolio;
             else
                 throw std::runtime_error("variable fixing order not recognized");
 
@@ -632,15 +730,13 @@ namespace LPMP {
         costs_.resize(this->nr_variables(), std::numeric_limits<double>::infinity());
     }
 
-    /*
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     void bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init(const ILP_input& input)
     {
         bdd_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init(input);
         init_costs();
-        set_costs(input.objective().begin(), input.objective().end());
+        set_costs(this->ilp_input_.objective().begin(), this->ilp_input_.objective().end());
     }
-    */
 
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     void bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init()
@@ -793,6 +889,26 @@ namespace LPMP {
             return evaluate(primal_solution.begin(), primal_solution.end());
     }
 
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    template<typename SKIP>
+    std::vector<double> bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::total_min_marginals(SKIP skip)
+    {
+        std::vector<double> total_min_marginals;
+        total_min_marginals.reserve(this->nr_variables());
+        for(std::size_t var=0; var<this->nr_variables(); ++var) {
+            double total_min_marg = 0.0;
+            for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index) {
+                this->forward_step(var,bdd_index);
+                if(skip(var))
+                    continue;
+                const std::array<double,2> min_marg = min_marginal(var,bdd_index);
+                total_min_marg += min_marg[1] - min_marg[0];
+            }
+            total_min_marginals.push_back(total_min_marg);
+        }
+        return total_min_marginals;
+    }
+
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     void bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::min_marginal_averaging_iteration()
     {
@@ -1099,6 +1215,41 @@ namespace LPMP {
             this->backward_run();
         }
 
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+        std::vector<double> bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::export_Lagrange_multipliers() const
+        {
+            std::vector<double> multipliers;
+            multipliers.reserve(this->bdd_variables_.data().size());
+            for(std::size_t v=0; v<this->nr_variables(); ++v)
+                for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(v); ++bdd_index)
+                    multipliers.push_back(this->bdd_variables_(v,bdd_index).cost);
+            return multipliers;
+        }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    template<typename ITERATOR>
+        void bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::import_Lagrange_multipliers(const std::vector<double>& multipliers, ITERATOR cost_begin, ITERATOR cost_end)
+        {
+            assert(multipliers.size() == this->bdd_variables_.data().size());
+            std::fill(costs_.begin(), costs_.end(), 0.0);
+            assert(std::distance(cost_begin,cost_end) <= this->nr_variables());
+            std::copy(cost_begin, cost_end, costs_.begin());
+
+            std::size_t i = 0;
+            for(std::size_t v=0; v<this->nr_variables(); ++v) {
+                double sum = 0.0;
+                for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(v); ++bdd_index)
+                    sum += multipliers[i + bdd_index];
+                const double shift = (costs_[v] - sum) / this->nr_bdds(v);
+                for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(v); ++bdd_index) {
+                    this->bdd_variables_(v,bdd_index).cost = multipliers[i + bdd_index] + shift;
+                    assert(std::isfinite(this->bdd_variables_(v,bdd_index).cost));
+                }
+                i += this->nr_bdds(v);
+            }
+            this->backward_run();
+        }
+
     template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
     template<typename ITERATOR>
         bool bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::check_feasibility(ITERATOR var_begin, ITERATOR var_end) const
@@ -1118,7 +1269,7 @@ namespace LPMP {
                     for(std::size_t bdd_node_index=bdd_var.first_node_index; bdd_node_index<bdd_var.last_node_index; ++bdd_node_index) {
                         if(bdd_nbranch_node_marks[bdd_node_index] == 1) {
                             const auto& bdd = this->bdd_branch_nodes_[bdd_node_index];
-                            const auto* bdd_next_index = [&]() {
+                            const BDD_BRANCH_NODE* bdd_next_index = [&]() -> const BDD_BRANCH_NODE* {
                                 if(val == false)
                                     return bdd.low_outgoing;
                                 else 
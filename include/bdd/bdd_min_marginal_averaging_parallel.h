@@ -0,0 +1,195 @@
+#pragma once
+
+#include "bdd_min_marginal_averaging.h"
+#include <omp.h>
+#include <vector>
+#include <array>
+#include <iostream>
+
+namespace LPMP {
+
+    // Min-marginal averaging on BDDs split into pieces lying in disjoint variable intervals (see bdd_storage::split_bdds).
+    // Forward and backward passes of each interval run on their own thread.
+    // Split variables are shared by two pieces in different intervals. After each iteration their Lagrange multipliers are exchanged such that the min-marginals of both pieces agree.
+    // The exchange is applied by each interval when its forward pass reaches the split variable. Thus messages stay exact and costs of both pieces sum to zero whenever the lower bound is computed.
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    class bdd_mma_parallel_base : public bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>
+    {
+        public:
+            bdd_mma_parallel_base(TCLAP::CmdLine& cmd);
+
+            void init();
+
+            template<typename ITERATOR>
+                void set_costs(ITERATOR begin, ITERATOR end);
+
+            // warm start, see bdd_mma_base. Costs are given in input variable order, pending split variable exchanges are part of the dual state.
+            std::vector<double> export_Lagrange_multipliers() const;
+            template<typename ITERATOR>
+                void import_Lagrange_multipliers(const std::vector<double>& multipliers, ITERATOR cost_begin, ITERATOR cost_end);
+            template<typename ITERATOR>
+                void update_costs(ITERATOR begin, ITERATOR end) { import_Lagrange_multipliers(export_Lagrange_multipliers(), begin, end); }
+
+            // classic averaging only
+            void iteration();
+
+            std::size_t nr_intervals() const { return decomposition_.interval_variables.size(); }
+            std::size_t nr_split_variables() const { return split_variables_.size(); }
+
+        private:
+            double forward_backward_pass(const std::size_t interval, std::vector<std::array<double,2>>& min_marginals);
+            void exchange_split_variable_multipliers();
+
+            TCLAP::ValueArg<std::size_t> nr_intervals_arg_;
+
+            bdd_storage::interval_decomposition decomposition_;
+            std::vector<std::size_t> split_variables_;
+            // per split variable and piece: min-marginal difference from last backward pass, cost change to apply in next forward pass
+            std::vector<std::array<double,2>> split_marginal_diff_;
+            std::vector<std::array<double,2>> split_cost_delta_;
+    };
+
+    using bdd_min_marginal_averaging_parallel = bdd_mma_parallel_base<bdd_variable_mma, bdd_branch_node_opt>;
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::bdd_mma_parallel_base(TCLAP::CmdLine& cmd)
+        : bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>(cmd),
+        nr_intervals_arg_("","nr_intervals","number of variable intervals optimized in parallel, default is number of threads",false,0,"integer",cmd)
+    {}
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    void bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::init()
+    {
+        this->init_bdd_storage();
+        const std::size_t nr_intervals = nr_intervals_arg_.getValue() > 0 ? nr_intervals_arg_.getValue() : omp_get_max_threads();
+        decomposition_ = this->bdd_storage_.split_bdds(nr_intervals);
+        this->init_branch_nodes();
+        this->init_costs();
+
+        split_variables_.clear();
+        for(std::size_t interval=0; interval<this->nr_intervals(); ++interval)
+            for(const std::size_t var : decomposition_.right_split_variables[interval])
+                split_variables_.push_back(var);
+        std::sort(split_variables_.begin(), split_variables_.end());
+        for(const std::size_t var : split_variables_)
+            assert(this->nr_bdds(var) == 2);
+        split_marginal_diff_.clear();
+        split_marginal_diff_.resize(this->nr_variables(), {0.0, 0.0});
+        split_cost_delta_.clear();
+        split_cost_delta_.resize(this->nr_variables(), {0.0, 0.0});
+
+        if(diagnostics())
+            std::cout << "split bdds into " << this->nr_intervals() << " intervals with " << split_variables_.size() << " split variables\n";
+
+        set_costs(this->ilp_input_.objective().begin(), this->ilp_input_.objective().end());
+    }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    template<typename ITERATOR>
+        void bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::set_costs(ITERATOR begin, ITERATOR end)
+        {
+            assert(std::distance(begin, end) <= decomposition_.variable_index.size());
+            std::vector<double> costs(this->nr_variables(), 0.0);
+            for(auto it=begin; it!=end; ++it)
+                costs[decomposition_.variable_index[std::distance(begin, it)]] = *it;
+            bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::set_costs(costs.begin(), costs.end());
+            std::fill(split_cost_delta_.begin(), split_cost_delta_.end(), std::array<double,2>{0.0, 0.0});
+        }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+        std::vector<double> bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::export_Lagrange_multipliers() const
+        {
+            std::vector<double> multipliers = bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::export_Lagrange_multipliers();
+            std::size_t i = 0;
+            for(std::size_t var=0; var<this->nr_variables(); ++var) {
+                for(std::size_t bdd_index=0; bdd_index<std::min(this->nr_bdds(var), std::size_t(2)); ++bdd_index)
+                    multipliers[i + bdd_index] += split_cost_delta_[var][bdd_index]; // zero for variables that are not split
+                i += this->nr_bdds(var);
+            }
+            return multipliers;
+        }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    template<typename ITERATOR>
+        void bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::import_Lagrange_multipliers(const std::vector<double>& multipliers, ITERATOR cost_begin, ITERATOR cost_end)
+        {
+            assert(std::distance(cost_begin, cost_end) <= decomposition_.variable_index.size());
+            std::vector<double> costs(this->nr_variables(), 0.0);
+            for(auto it=cost_begin; it!=cost_end; ++it)
+                costs[decomposition_.variable_index[std::distance(cost_begin, it)]] = *it;
+            bdd_mma_base<BDD_VARIABLE, BDD_BRANCH_NODE>::import_Lagrange_multipliers(multipliers, costs.begin(), costs.end());
+            std::fill(split_cost_delta_.begin(), split_cost_delta_.end(), std::array<double,2>{0.0, 0.0});
+        }
+
+    // Split variables of this interval are covered by only one piece in it: bdd_index 1 for left split variables (piece starts with decoder), bdd_index 0 for right ones (piece ends with encoder).
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    double bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::forward_backward_pass(const std::size_t interval, std::vector<std::array<double,2>>& min_marginals)
+    {
+        const auto& left_split_vars = decomposition_.left_split_variables[interval];
+        const auto& right_split_vars = decomposition_.right_split_variables[interval];
+        const std::size_t first_var = decomposition_.interval_variables[interval][0];
+        const std::size_t last_var = decomposition_.interval_variables[interval][1];
+
+        // forward messages of nodes of the split variable do not depend on its cost, hence the cost can be changed right after the forward step
+        auto forward_split_variable = [&](const std::size_t var, const std::size_t bdd_index) {
+            this->forward_step(var, bdd_index);
+            this->bdd_variables_(var, bdd_index).cost += split_cost_delta_[var][bdd_index];
+            split_cost_delta_[var][bdd_index] = 0.0;
+        };
+
+        for(const std::size_t var : left_split_vars)
+            forward_split_variable(var, 1);
+        for(std::size_t var=first_var; var<last_var; ++var)
+            this->min_marginal_averaging_step_forward(var, min_marginals);
+        for(const std::size_t var : right_split_vars)
+            forward_split_variable(var, 0);
+
+        double lb = 0.0;
+        auto backward_split_variable = [&](const std::size_t var, const std::size_t bdd_index) {
+            const std::array<double,2> m = this->min_marginal(var, bdd_index);
+            split_marginal_diff_[var][bdd_index] = m[1] - m[0];
+            this->backward_step(var, bdd_index);
+            lb += this->lower_bound_backward(var, bdd_index);
+        };
+
+        for(std::ptrdiff_t i=std::ptrdiff_t(right_split_vars.size())-1; i>=0; --i)
+            backward_split_variable(right_split_vars[i], 0);
+        for(std::ptrdiff_t var=std::ptrdiff_t(last_var)-1; var>=std::ptrdiff_t(first_var); --var) {
+            this->min_marginal_averaging_step_backward(var, min_marginals);
+            for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index)
+                lb += this->lower_bound_backward(var, bdd_index);
+        }
+        for(std::ptrdiff_t i=std::ptrdiff_t(left_split_vars.size())-1; i>=0; --i)
+            backward_split_variable(left_split_vars[i], 1);
+
+        return lb;
+    }
+
+    // shift costs such that both min-marginal differences move towards their average. Changes of both pieces sum to zero.
+    // Min-marginals are one pass old when the change is applied, a full averaging step oscillates. Hence only half of it is taken.
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    void bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::exchange_split_variable_multipliers()
+    {
+        for(const std::size_t var : split_variables_) {
+            const double delta = 0.25*(split_marginal_diff_[var][1] - split_marginal_diff_[var][0]);
+            assert(std::isfinite(delta));
+            split_cost_delta_[var][0] += delta;
+            split_cost_delta_[var][1] -= delta;
+        }
+    }
+
+    template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+    void bdd_mma_parallel_base<BDD_VARIABLE, BDD_BRANCH_NODE>::iteration()
+    {
+        assert(this->options.averaging_type == bdd_min_marginal_averaging_options::averaging_type::classic);
+        double lb = 0.0;
+#pragma omp parallel for schedule(dynamic) reduction(+:lb)
+        for(std::size_t interval=0; interval<nr_intervals(); ++interval) {
+            std::vector<std::array<double,2>> min_marginals;
+            lb += forward_backward_pass(interval, min_marginals);
+        }
+        exchange_split_variable_multipliers();
+        this->lower_bound_ = lb;
+    }
+
+}
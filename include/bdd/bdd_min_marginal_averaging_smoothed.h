@@ -32,6 +32,8 @@ public:
     void smooth_iteration();
 
     void set_cost_scaling(const double scale);
+    // degree of vectorized exp/log approximation used in batched smoothed passes, 0 means exact scalar passes
+    void set_exp_approximation(const std::size_t degree);
 
 private:
     //void init_costs(); // copy from bdd_min_marginal_averaging
@@ -49,12 +51,25 @@ private:
     static double average_exp_sums(ITERATOR exp_sums_begin, ITERATOR exp_sums_end);
 
     void update_Lagrange_multiplier(const std::size_t var, const std::size_t bdd_index, const bdd_branch_node_exp_sum_entry exp_sums, const double average_exp_sums);
+    void batch_update_Lagrange_multipliers(const std::size_t var, const std::vector<bdd_branch_node_exp_sum_entry>& exp_sums);
 
     double cost_scaling_ = 1.0;
+    std::size_t exp_approximation_degree_ = 0;
+    mutable smooth_step_batch batch_;
+    std::vector<double> log_sums_;
 };
 
 class bdd_min_marginal_averaging_smoothed : public bdd_min_marginal_averaging_smoothed_base<bdd_variable_mma, bdd_branch_node_opt_smoothed>
-{};
+{
+public:
+    using bdd_min_marginal_averaging_smoothed_base<bdd_variable_mma, bdd_branch_node_opt_smoothed>::bdd_min_marginal_averaging_smoothed_base;
+};
+
+class bdd_min_marginal_averaging_smoothed_compact : public bdd_min_marginal_averaging_smoothed_base<bdd_variable_mma, bdd_branch_node_opt_smoothed_compact>
+{
+public:
+    using bdd_min_marginal_averaging_smoothed_base<bdd_variable_mma, bdd_branch_node_opt_smoothed_compact>::bdd_min_marginal_averaging_smoothed_base;
+};
 
 
 template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
@@ -161,6 +176,11 @@ void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::sm
     // iterate over all bdd nodes and make forward step
     const std::size_t first_node_index = bdd_var.first_node_index;
     const std::size_t last_node_index = bdd_var.last_node_index;
+    if (exp_approximation_degree_ > 0)
+    {
+        BDD_BRANCH_NODE::batch_smooth_forward_step(this->bdd_branch_nodes_.begin() + first_node_index, this->bdd_branch_nodes_.begin() + last_node_index, batch_, exp_approximation_degree_);
+        return;
+    }
     for (std::size_t i = first_node_index; i < last_node_index; ++i)
         this->bdd_branch_nodes_[i].smooth_forward_step();
 }
@@ -176,6 +196,11 @@ void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::sm
     // iterate over all bdd nodes and make forward step
     const std::ptrdiff_t first_node_index = bdd_var.first_node_index;
     const std::ptrdiff_t last_node_index = bdd_var.last_node_index;
+    if (exp_approximation_degree_ > 0)
+    {
+        BDD_BRANCH_NODE::batch_smooth_backward_step(this->bdd_branch_nodes_.begin() + first_node_index, this->bdd_branch_nodes_.begin() + last_node_index, batch_, exp_approximation_degree_);
+        return;
+    }
     for (std::ptrdiff_t i = last_node_index - 1; i >= first_node_index; --i)
     {
         check_bdd_branch_node(this->bdd_branch_nodes_[i], var + 1 == this->nr_variables(), var == 0);
@@ -240,6 +265,14 @@ void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::se
     // TODO: backward run must be performed
 }
 
+template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::set_exp_approximation(const std::size_t degree)
+{
+    if (degree > max_exp_log_approximation_degree)
+        throw std::runtime_error("exp approximation degree must be at most " + std::to_string(max_exp_log_approximation_degree));
+    exp_approximation_degree_ = degree;
+}
+
 template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
 bdd_branch_node_exp_sum_entry bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::exp_sums(const std::size_t var, const std::size_t bdd_index) const
 {
@@ -248,6 +281,8 @@ bdd_branch_node_exp_sum_entry bdd_min_marginal_averaging_smoothed_base<BDD_VARIA
     const auto &bdd_var = this->bdd_variables_(var, bdd_index);
     auto first_bdd_it = this->bdd_branch_nodes_.begin() + bdd_var.first_node_index;
     auto last_bdd_it = this->bdd_branch_nodes_.begin() + bdd_var.last_node_index;
+    if (exp_approximation_degree_ > 0)
+        return BDD_BRANCH_NODE::batch_exp_sums(first_bdd_it, last_bdd_it, batch_, exp_approximation_degree_);
     return BDD_BRANCH_NODE::exp_sums(first_bdd_it, last_bdd_it);
 }
 
@@ -288,6 +323,31 @@ void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::up
     bdd_var.cost += diff;
 }
 
+// same as average_exp_sums and update_Lagrange_multiplier for all bdds of var, logarithms are evaluated together by log_approximation
+template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
+void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::batch_update_Lagrange_multipliers(const std::size_t var, const std::vector<bdd_branch_node_exp_sum_entry>& exp_sums)
+{
+    assert(exp_sums.size() == this->nr_bdds(var));
+    log_sums_.clear();
+    for (const auto& e : exp_sums)
+    {
+        log_sums_.push_back(e.sum[0]);
+        log_sums_.push_back(e.sum[1]);
+    }
+    log_approximation(log_sums_.data(), log_sums_.data() + log_sums_.size(), exp_approximation_degree_);
+
+    double average = 0.0;
+    for (std::size_t bdd_index = 0; bdd_index < exp_sums.size(); ++bdd_index)
+    {
+        log_sums_[2*bdd_index] = log_sums_[2*bdd_index+1] + exp_sums[bdd_index].max[1] - (log_sums_[2*bdd_index] + exp_sums[bdd_index].max[0]);
+        average -= log_sums_[2*bdd_index] / double(exp_sums.size());
+    }
+    assert(std::isfinite(average));
+
+    for (std::size_t bdd_index = 0; bdd_index < exp_sums.size(); ++bdd_index)
+        this->bdd_variables_(var, bdd_index).cost += log_sums_[2*bdd_index] + average;
+}
+
 template<typename BDD_VARIABLE, typename BDD_BRANCH_NODE>
 void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::smooth_averaging_pass_forward()
 {
@@ -304,6 +364,12 @@ void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::sm
                 exp_sums.push_back(this->exp_sums(var, bdd_index));
             }
 
+            if (exp_approximation_degree_ > 0)
+            {
+                batch_update_Lagrange_multipliers(var, exp_sums);
+                continue;
+            }
+
             const double average_exp_sums = this->average_exp_sums(exp_sums.begin(), exp_sums.end());
 
             // set marginals in each bdd so min marginals match each other
@@ -329,11 +395,17 @@ void bdd_min_marginal_averaging_smoothed_base<BDD_VARIABLE, BDD_BRANCH_NODE>::sm
             for (std::size_t bdd_index = 0; bdd_index < this->nr_bdds(var); ++bdd_index)
                 exp_sums.push_back(this->exp_sums(var, bdd_index));
 
-            const double average_exp_sums = this->average_exp_sums(exp_sums.begin(), exp_sums.end());
+            if (exp_approximation_degree_ > 0)
+                batch_update_Lagrange_multipliers(var, exp_sums);
+            else
+            {
+                const double average_exp_sums = this->average_exp_sums(exp_sums.begin(), exp_sums.end());
+                for (std::size_t bdd_index = 0; bdd_index < this->nr_bdds(var); ++bdd_index)
+                    update_Lagrange_multiplier(var, bdd_index, exp_sums[bdd_index], average_exp_sums);
+            }
 
             for (std::size_t bdd_index = 0; bdd_index < this->nr_bdds(var); ++bdd_index)
             {
-                update_Lagrange_multiplier(var, bdd_index, exp_sums[bdd_index], average_exp_sums);
                 smooth_backward_step(var, bdd_index);
                 lb += smooth_lower_bound_backward(var, bdd_index);
             }
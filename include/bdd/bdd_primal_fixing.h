@@ -10,6 +10,8 @@
 #include <cassert>
 #include <vector>
 #include <stack>
+#include <atomic>
+#include <memory>
 
 namespace LPMP {
 
@@ -18,23 +20,25 @@ namespace LPMP {
     // Variable Fixing
     ////////////////////////////////////////////////////
 
+    template<typename BDD_BRANCH_NODE>
     struct log_entry
     {
         log_entry(char * var_value)
         : var_value_(var_value) {}
-        log_entry(bdd_branch_node_fix * source, bdd_branch_node_fix * target, bool high)
+        log_entry(BDD_BRANCH_NODE * source, BDD_BRANCH_NODE * target, bool high)
         : source_(source), target_(target), high_(high) {}
 
         void restore();
 
         char * var_value_ = nullptr;
 
-        bdd_branch_node_fix * source_;
-        bdd_branch_node_fix * target_;
+        BDD_BRANCH_NODE * source_;
+        BDD_BRANCH_NODE * target_;
         bool high_;
     };
 
-    void log_entry::restore()
+    template<typename BDD_BRANCH_NODE>
+    void log_entry<BDD_BRANCH_NODE>::restore()
     {
         if (var_value_ != nullptr)
         {
@@ -42,15 +46,15 @@ namespace LPMP {
             return;    
         }
 
-        assert(target_ != bdd_branch_node_fix::terminal_0());
+        assert(target_ != BDD_BRANCH_NODE::terminal_0());
         if (high_)
         {
-            assert(source_->high_outgoing == bdd_branch_node_fix::terminal_0());
+            assert(source_->high_outgoing == BDD_BRANCH_NODE::terminal_0());
             assert(source_->prev_high_incoming == nullptr);
             assert(source_->next_high_incoming == nullptr);
             source_->high_outgoing = target_;
             source_->bdd_var->nr_feasible_high_arcs++;
-            if (bdd_branch_node_fix::is_terminal(target_))
+            if (BDD_BRANCH_NODE::is_terminal(target_))
                 return;
             if (target_->first_high_incoming != nullptr)
                 target_->first_high_incoming->prev_high_incoming = source_;
@@ -59,12 +63,12 @@ namespace LPMP {
         }
         else
         {
-            assert(source_->low_outgoing == bdd_branch_node_fix::terminal_0());
+            assert(source_->low_outgoing == BDD_BRANCH_NODE::terminal_0());
             assert(source_->prev_low_incoming == nullptr);
             assert(source_->next_low_incoming == nullptr);
             source_->low_outgoing = target_;
             source_->bdd_var->nr_feasible_low_arcs++;
-            if (bdd_branch_node_fix::is_terminal(target_))
+            if (BDD_BRANCH_NODE::is_terminal(target_))
                 return;
             if (target_->first_low_incoming != nullptr)
                 target_->first_low_incoming->prev_low_incoming = source_;
@@ -73,108 +77,102 @@ namespace LPMP {
         }
     }
 
-    class bdd_mma_fixing : public bdd_min_marginal_averaging_smoothed_base<bdd_variable_fix, bdd_branch_node_fix> {
+    // Fixing state of bdd_mma_fixing: arcs of the branch nodes, feasible arc counts of the bdd variables, the partial primal solution and the undo log.
+    // Operates in place on the given arrays, see bdd_fixing_state_copy for an independent state.
+    template<typename BDD_BRANCH_NODE>
+    class bdd_fixing_state {
         public:
-            using bdd_min_marginal_averaging_smoothed_base<bdd_variable_fix, bdd_branch_node_fix>::bdd_min_marginal_averaging_smoothed_base;
-            virtual ~bdd_mma_fixing() {};
-
-            bool fix_variables();
-
-            bool fix_variables(const std::vector<size_t> & indices, const std::vector<char> & values);
+            bdd_fixing_state(std::vector<BDD_BRANCH_NODE>& bdd_branch_nodes, two_dim_variable_array<bdd_variable_fix>& bdd_variables)
+                : bdd_branch_nodes_(bdd_branch_nodes), bdd_variables_(bdd_variables)
+            {}
+            bdd_fixing_state(const bdd_fixing_state&) = delete;
+
+            // depth first search fixing variables in the given order to the preferred values, backtracks on infeasibility.
+            // Gives up when stop is set.
+            bool fix_variables(const std::vector<size_t> & indices, const std::vector<char> & values, const std::atomic<bool> * stop = nullptr);
             bool fix_variable(const size_t var, const char value);
             bool is_fixed(const size_t var) const;
 
-            std::vector<double> total_min_marginals();
-            std::vector<double> search_space_reduction_coeffs();
-
-            void count_forward_run(size_t last_var);
-            void count_backward_run(ptrdiff_t first_var);
-
-            void min_marginal_averaging_forward();
-            void min_marginal_averaging_backward();
-            void min_marginal_averaging_iteration();
-
-            void init(const ILP_input& input);
-            void init();
-
             void revert_changes(const size_t target_log_size);
 
+            std::size_t nr_variables() const { return bdd_variables_.size(); }
+            std::size_t nr_bdds(const std::size_t var) const { assert(var < nr_variables()); return bdd_variables_[var].size(); }
+
             void init_primal_solution() { primal_solution_.resize(nr_variables(), 2); }
             const std::vector<char> & primal_solution() const { return primal_solution_; }
-            double compute_upper_bound();
+            void set_primal_solution(const std::vector<char> & sol) { assert(sol.size() == nr_variables()); primal_solution_ = sol; }
             const size_t log_size() const { return log_.size(); }
 
         private:
-            void init_pointers();
+            bool remove_all_incoming_arcs(BDD_BRANCH_NODE & bdd_node);
+            void remove_all_outgoing_arcs(BDD_BRANCH_NODE & bdd_node);
+            void remove_outgoing_low_arc(BDD_BRANCH_NODE & bdd_node);
+            void remove_outgoing_high_arc(BDD_BRANCH_NODE & bdd_node);
 
-            bool remove_all_incoming_arcs(bdd_branch_node_fix & bdd_node);
-            void remove_all_outgoing_arcs(bdd_branch_node_fix & bdd_node);
-            void remove_outgoing_low_arc(bdd_branch_node_fix & bdd_node);
-            void remove_outgoing_high_arc(bdd_branch_node_fix & bdd_node);
+            std::vector<BDD_BRANCH_NODE>& bdd_branch_nodes_;
+            two_dim_variable_array<bdd_variable_fix>& bdd_variables_;
 
             std::vector<char> primal_solution_;
-            std::stack<log_entry, std::deque<log_entry>> log_;
+            std::stack<log_entry<BDD_BRANCH_NODE>, std::deque<log_entry<BDD_BRANCH_NODE>>> log_;
     };
 
-    double bdd_mma_fixing::compute_upper_bound()
-    {
-        return bdd_mma_base<bdd_variable_fix, bdd_branch_node_fix>::compute_upper_bound(primal_solution());
-    }
+    // Independent copy of the arrays needed for fixing, such that several searches can run concurrently.
+    // Links between nodes are relocated into the copy, costs and messages are not copied.
+    template<typename BDD_BRANCH_NODE>
+    struct bdd_fixing_state_copy {
+        bdd_fixing_state_copy(const std::vector<BDD_BRANCH_NODE>& bdd_branch_nodes, const two_dim_variable_array<bdd_variable_fix>& bdd_variables);
+        bdd_fixing_state_copy(const bdd_fixing_state_copy&) = delete;
 
-    void bdd_mma_fixing::init_pointers()
-    {
-        for (size_t var = 0; var < nr_variables(); var++)
-        {
-            for (size_t bdd_index = 0; bdd_index < nr_bdds(var); bdd_index++)
-            {
-                auto & bdd_var = bdd_variables_(var, bdd_index);
-                bdd_var.nr_feasible_low_arcs = 0;
-                bdd_var.nr_feasible_high_arcs = 0;
-                bdd_var.variable_index = var;
-                for (size_t node_index = bdd_var.first_node_index; node_index < bdd_var.last_node_index; node_index++)
-                {
-                    auto & bdd_node = bdd_branch_nodes_[node_index];
-                    if (bdd_node.low_outgoing != bdd_branch_node_fix::terminal_0())
-                        bdd_var.nr_feasible_low_arcs++;
-                    if (bdd_node.high_outgoing != bdd_branch_node_fix::terminal_0())
-                        bdd_var.nr_feasible_high_arcs++;
+        std::vector<BDD_BRANCH_NODE> bdd_branch_nodes;
+        two_dim_variable_array<bdd_variable_fix> bdd_variables;
+        bdd_fixing_state<BDD_BRANCH_NODE> state;
+    };
 
-                    bdd_node.bdd_var = & bdd_var;
+    template<typename BDD_BRANCH_NODE>
+    bdd_fixing_state_copy<BDD_BRANCH_NODE>::bdd_fixing_state_copy(const std::vector<BDD_BRANCH_NODE>& o_bdd_branch_nodes, const two_dim_variable_array<bdd_variable_fix>& o_bdd_variables)
+        : bdd_branch_nodes(o_bdd_branch_nodes.size()),
+        bdd_variables(o_bdd_variables),
+        state(bdd_branch_nodes, bdd_variables)
+    {
+        // nodes are not copied as a whole, since compact links must not be copied between allocations
+        auto relocate = [&](BDD_BRANCH_NODE* p) -> BDD_BRANCH_NODE* {
+            if (p == nullptr || BDD_BRANCH_NODE::is_terminal(p))
+                return p;
+            return &bdd_branch_nodes[p - &o_bdd_branch_nodes[0]];
+        };
+        auto relocate_variable = [&](const bdd_variable_fix* p) -> bdd_variable_fix* {
+            if (p == nullptr)
+                return nullptr;
+            return &bdd_variables.data()[p - &o_bdd_variables.data()[0]];
+        };
 
-                    auto * low_incoming = bdd_node.first_low_incoming;
-                    while (low_incoming != nullptr && low_incoming->next_low_incoming != nullptr)
-                    {
-                        low_incoming->next_low_incoming->prev_low_incoming = low_incoming;
-                        low_incoming = low_incoming->next_low_incoming;
-                    }
-                    auto * high_incoming = bdd_node.first_high_incoming;
-                    while (high_incoming != nullptr && high_incoming->next_high_incoming != nullptr)
-                    {
-                        high_incoming->next_high_incoming->prev_high_incoming = high_incoming;
-                        high_incoming = high_incoming->next_high_incoming;
-                    }
-                }
-            }
+        for (auto & bdd_var : bdd_variables.data())
+        {
+            bdd_var.prev = relocate_variable(bdd_var.prev);
+            bdd_var.next = relocate_variable(bdd_var.next);
         }
-        init_primal_solution(); 
-    }
 
-    /*
-    void bdd_mma_fixing::init(const ILP_input& input)
-    {
-        bdd_mma_base<bdd_variable_fix, bdd_branch_node_fix>::init(input);
-        init_pointers();
-        input_ = input;
-    }
-    */
+        for (size_t i = 0; i < bdd_branch_nodes.size(); i++)
+        {
+            const auto & o = o_bdd_branch_nodes[i];
+            auto & bdd_node = bdd_branch_nodes[i];
+            bdd_node.low_outgoing = relocate(o.low_outgoing);
+            bdd_node.high_outgoing = relocate(o.high_outgoing);
+            bdd_node.first_low_incoming = relocate(o.first_low_incoming);
+            bdd_node.first_high_incoming = relocate(o.first_high_incoming);
+            bdd_node.next_low_incoming = relocate(o.next_low_incoming);
+            bdd_node.next_high_incoming = relocate(o.next_high_incoming);
+            bdd_node.prev_low_incoming = relocate(o.prev_low_incoming);
+            bdd_node.prev_high_incoming = relocate(o.prev_high_incoming);
+            bdd_node.bdd_var = relocate_variable(o.bdd_var);
+            bdd_node.variable_cost = &bdd_node.bdd_var->cost;
+        }
 
-    void bdd_mma_fixing::init()
-    {
-        bdd_mma_base<bdd_variable_fix, bdd_branch_node_fix>::init();
-        init_pointers();
+        state.init_primal_solution();
     }
 
-    bool bdd_mma_fixing::fix_variable(const std::size_t var, const char value)
+    template<typename BDD_BRANCH_NODE>
+    bool bdd_fixing_state<BDD_BRANCH_NODE>::fix_variable(const std::size_t var, const char value)
     {
         assert(0 <= value && value <= 1);
         assert(primal_solution_.size() == nr_variables());
@@ -188,7 +186,7 @@ namespace LPMP {
 
         // mark variable as fixed
         primal_solution_[var] = value;
-        const log_entry entry(&primal_solution_[var]);
+        const log_entry<BDD_BRANCH_NODE> entry(&primal_solution_[var]);
         log_.push(entry);
         std::vector<std::pair<size_t, char>> restrictions;
 
@@ -257,22 +255,23 @@ namespace LPMP {
         return true;
     }
 
-    bool bdd_mma_fixing::remove_all_incoming_arcs(bdd_branch_node_fix & bdd_node)
+    template<typename BDD_BRANCH_NODE>
+    bool bdd_fixing_state<BDD_BRANCH_NODE>::remove_all_incoming_arcs(BDD_BRANCH_NODE & bdd_node)
     {
         if (bdd_node.is_first())
             return false;
         // low arcs
         {
-            auto * cur = bdd_node.first_low_incoming;
+            BDD_BRANCH_NODE* cur = bdd_node.first_low_incoming;
             while (cur != nullptr)
             {
                 // log change
                 assert(cur->low_outgoing == &bdd_node);
                 auto * temp = cur;
-                const log_entry entry(cur, &bdd_node, false);
+                const log_entry<BDD_BRANCH_NODE> entry(cur, &bdd_node, false);
                 log_.push(entry);
                 // remove arc
-                cur->low_outgoing = bdd_branch_node_fix::terminal_0();
+                cur->low_outgoing = BDD_BRANCH_NODE::terminal_0();
                 assert(cur->bdd_var != nullptr);
                 cur->bdd_var->nr_feasible_low_arcs--;
                 bdd_node.first_low_incoming = cur->next_low_incoming;
@@ -294,21 +293,21 @@ namespace LPMP {
         }
         // high arcs
         {
-            auto * cur = bdd_node.first_high_incoming;
+            BDD_BRANCH_NODE* cur = bdd_node.first_high_incoming;
             while (cur != nullptr)
             {
                 assert(cur->high_outgoing == &bdd_node);
                 auto * temp = cur;
-                const log_entry entry(cur, &bdd_node, true);
+                const log_entry<BDD_BRANCH_NODE> entry(cur, &bdd_node, true);
                 log_.push(entry);
-                cur->high_outgoing = bdd_branch_node_fix::terminal_0();
+                cur->high_outgoing = BDD_BRANCH_NODE::terminal_0();
                 assert(cur->bdd_var != nullptr);
                 cur->bdd_var->nr_feasible_high_arcs--;
                 bdd_node.first_high_incoming = cur->next_high_incoming; 
                 cur = cur->next_high_incoming; 
                 if (cur != nullptr)
                 {
-                    assert(cur->prev_low_incoming != nullptr);
+                    assert(cur->prev_high_incoming != nullptr);
                     cur->prev_high_incoming->next_high_incoming = nullptr;
                     cur->prev_high_incoming = nullptr;    
                 }
@@ -322,15 +321,17 @@ namespace LPMP {
         return true;
     }
 
-    void bdd_mma_fixing::remove_all_outgoing_arcs(bdd_branch_node_fix & bdd_node)
+    template<typename BDD_BRANCH_NODE>
+    void bdd_fixing_state<BDD_BRANCH_NODE>::remove_all_outgoing_arcs(BDD_BRANCH_NODE & bdd_node)
     {
         remove_outgoing_low_arc(bdd_node);
         remove_outgoing_high_arc(bdd_node);
     }
 
-    void bdd_mma_fixing::remove_outgoing_low_arc(bdd_branch_node_fix & bdd_node)
+    template<typename BDD_BRANCH_NODE>
+    void bdd_fixing_state<BDD_BRANCH_NODE>::remove_outgoing_low_arc(BDD_BRANCH_NODE & bdd_node)
     {
-        if (!bdd_branch_node_fix::is_terminal(bdd_node.low_outgoing))
+        if (!BDD_BRANCH_NODE::is_terminal(bdd_node.low_outgoing))
         {
             // change pointers
             if (bdd_node.prev_low_incoming == nullptr)
@@ -345,20 +346,21 @@ namespace LPMP {
             if (bdd_node.low_outgoing->is_first())
                 remove_all_outgoing_arcs(*bdd_node.low_outgoing);
         }
-        if (bdd_node.low_outgoing != bdd_branch_node_fix::terminal_0())
+        if (bdd_node.low_outgoing != BDD_BRANCH_NODE::terminal_0())
         {
             // log change
-            const log_entry entry(&bdd_node, bdd_node.low_outgoing, false);
+            const log_entry<BDD_BRANCH_NODE> entry(&bdd_node, bdd_node.low_outgoing, false);
             log_.push(entry);
             // remove arc
-            bdd_node.low_outgoing = bdd_branch_node_fix::terminal_0();
+            bdd_node.low_outgoing = BDD_BRANCH_NODE::terminal_0();
             bdd_node.bdd_var->nr_feasible_low_arcs--;
         } 
     }
 
-    void bdd_mma_fixing::remove_outgoing_high_arc(bdd_branch_node_fix & bdd_node)
+    template<typename BDD_BRANCH_NODE>
+    void bdd_fixing_state<BDD_BRANCH_NODE>::remove_outgoing_high_arc(BDD_BRANCH_NODE & bdd_node)
     {
-        if (!bdd_branch_node_fix::is_terminal(bdd_node.high_outgoing))
+        if (!BDD_BRANCH_NODE::is_terminal(bdd_node.high_outgoing))
         {
             if (bdd_node.prev_high_incoming == nullptr)
                 bdd_node.high_outgoing->first_high_incoming = bdd_node.next_high_incoming;
@@ -371,16 +373,17 @@ namespace LPMP {
             if (bdd_node.high_outgoing->is_first())
                 remove_all_outgoing_arcs(*bdd_node.high_outgoing);
         }
-        if (bdd_node.high_outgoing != bdd_branch_node_fix::terminal_0())
+        if (bdd_node.high_outgoing != BDD_BRANCH_NODE::terminal_0())
         {
-            const log_entry entry(&bdd_node, bdd_node.high_outgoing, true);
+            const log_entry<BDD_BRANCH_NODE> entry(&bdd_node, bdd_node.high_outgoing, true);
             log_.push(entry);
-            bdd_node.high_outgoing = bdd_branch_node_fix::terminal_0();
+            bdd_node.high_outgoing = BDD_BRANCH_NODE::terminal_0();
             bdd_node.bdd_var->nr_feasible_high_arcs--;
         }
     }
 
-    bool bdd_mma_fixing::fix_variables(const std::vector<size_t> & variables, const std::vector<char> & values)
+    template<typename BDD_BRANCH_NODE>
+    bool bdd_fixing_state<BDD_BRANCH_NODE>::fix_variables(const std::vector<size_t> & variables, const std::vector<char> & values, const std::atomic<bool> * stop)
     {
         assert(variables.size() == values.size());
 
@@ -403,13 +406,20 @@ namespace LPMP {
         size_t nfixes = 0;
         size_t max_fixes = nr_variables();
         // size_t max_fixes = std::numeric_limits<size_t>::max();
-        std::cout << "Search tree node budget: " << max_fixes << std::endl;
-        std::cout << "Expanded: " << std::endl;
+        // progress is only printed for a single search, not for concurrent ones of a portfolio
+        if (stop == nullptr)
+        {
+            std::cout << "Search tree node budget: " << max_fixes << std::endl;
+            std::cout << "Expanded: " << std::endl;
+        }
 
         while (!variable_fixes.empty())
         {
             nfixes++;
-            std::cout << "\r" << nfixes << std::flush;
+            if (stop == nullptr)
+                std::cout << "\r" << nfixes << std::flush;
+            else if (stop->load(std::memory_order_relaxed))
+                return false;
             if (nfixes > max_fixes)
                 return false;
 
@@ -437,14 +447,16 @@ namespace LPMP {
         return false;
     }
 
-    bool bdd_mma_fixing::is_fixed(const size_t var) const
+    template<typename BDD_BRANCH_NODE>
+    bool bdd_fixing_state<BDD_BRANCH_NODE>::is_fixed(const size_t var) const
     {
         assert(primal_solution_.size() == nr_variables());
         assert(var < primal_solution_.size());
         return primal_solution_[var] < 2;
     }
 
-    void bdd_mma_fixing::revert_changes(const size_t target_log_size)
+    template<typename BDD_BRANCH_NODE>
+    void bdd_fixing_state<BDD_BRANCH_NODE>::revert_changes(const size_t target_log_size)
     {
         while (log_.size() > target_log_size)
         {
@@ -453,61 +465,158 @@ namespace LPMP {
         }
     }
 
-    std::vector<double> bdd_mma_fixing::total_min_marginals()
+    template<typename BDD_BRANCH_NODE>
+    class bdd_mma_fixing_base : public bdd_min_marginal_averaging_smoothed_base<bdd_variable_fix, BDD_BRANCH_NODE> {
+        public:
+            using bdd_min_marginal_averaging_smoothed_base<bdd_variable_fix, BDD_BRANCH_NODE>::bdd_min_marginal_averaging_smoothed_base;
+            virtual ~bdd_mma_fixing_base() {};
+
+            bool fix_variables();
+
+            bool fix_variables(const std::vector<size_t> & indices, const std::vector<char> & values) { return fixing_state_.fix_variables(indices, values); }
+            bool fix_variable(const size_t var, const char value) { return fixing_state_.fix_variable(var, value); }
+            bool is_fixed(const size_t var) const { return fixing_state_.is_fixed(var); }
+
+            std::vector<double> total_min_marginals();
+            std::vector<double> search_space_reduction_coeffs();
+
+            void count_forward_run(size_t last_var);
+            void count_backward_run(ptrdiff_t first_var);
+
+            void min_marginal_averaging_forward();
+            void min_marginal_averaging_backward();
+            void min_marginal_averaging_iteration();
+
+            void init(const ILP_input& input);
+            void init();
+
+            void revert_changes(const size_t target_log_size) { fixing_state_.revert_changes(target_log_size); }
+
+            void init_primal_solution() { fixing_state_.init_primal_solution(); }
+            const std::vector<char> & primal_solution() const { return fixing_state_.primal_solution(); }
+            double compute_upper_bound();
+            const size_t log_size() const { return fixing_state_.log_size(); }
+
+        private:
+            void init_pointers();
+
+            // variable order and preferred values of a fixing strategy
+            std::pair<std::vector<size_t>, std::vector<char>> fixing_strategy(
+                    const enum bdd_min_marginal_averaging_options::fixing_order order, const enum bdd_min_marginal_averaging_options::fixing_value value,
+                    const std::vector<double> & total_min_marginals, const std::vector<double> & reduction_coeffs) const;
+            // runs all combinations of fixing orders and marginal based values concurrently on copies of the fixing state
+            bool fix_variables_portfolio(const std::vector<double> & total_min_marginals, const std::vector<double> & reduction_coeffs);
+
+            bdd_fixing_state<BDD_BRANCH_NODE> fixing_state_{this->bdd_branch_nodes_, this->bdd_variables_};
+    };
+
+    using bdd_mma_fixing = bdd_mma_fixing_base<bdd_branch_node_fix>;
+    using bdd_mma_fixing_compact = bdd_mma_fixing_base<bdd_branch_node_fix_compact>;
+
+    template<typename BDD_BRANCH_NODE>
+    double bdd_mma_fixing_base<BDD_BRANCH_NODE>::compute_upper_bound()
+    {
+        return bdd_mma_base<bdd_variable_fix, BDD_BRANCH_NODE>::compute_upper_bound(primal_solution());
+    }
+
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::init_pointers()
     {
-        std::vector<double> total_min_marginals;
-        for(std::size_t var=0; var<this->nr_variables(); ++var)
+        for (size_t var = 0; var < this->nr_variables(); var++)
         {
-            double total_min_marg = 0;
-            for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index)
+            for (size_t bdd_index = 0; bdd_index < this->nr_bdds(var); bdd_index++)
             {
-                this->forward_step(var,bdd_index);
-                if (is_fixed(var))
-                    continue;
-                std::array<double,2> min_marg = min_marginal(var,bdd_index);
-                total_min_marg += (min_marg[1] - min_marg[0]);
+                auto & bdd_var = this->bdd_variables_(var, bdd_index);
+                bdd_var.nr_feasible_low_arcs = 0;
+                bdd_var.nr_feasible_high_arcs = 0;
+                bdd_var.variable_index = var;
+                for (size_t node_index = bdd_var.first_node_index; node_index < bdd_var.last_node_index; node_index++)
+                {
+                    auto & bdd_node = this->bdd_branch_nodes_[node_index];
+                    if (bdd_node.low_outgoing != BDD_BRANCH_NODE::terminal_0())
+                        bdd_var.nr_feasible_low_arcs++;
+                    if (bdd_node.high_outgoing != BDD_BRANCH_NODE::terminal_0())
+                        bdd_var.nr_feasible_high_arcs++;
+
+                    bdd_node.bdd_var = & bdd_var;
+
+                    BDD_BRANCH_NODE* low_incoming = bdd_node.first_low_incoming;
+                    while (low_incoming != nullptr && low_incoming->next_low_incoming != nullptr)
+                    {
+                        low_incoming->next_low_incoming->prev_low_incoming = low_incoming;
+                        low_incoming = low_incoming->next_low_incoming;
+                    }
+                    BDD_BRANCH_NODE* high_incoming = bdd_node.first_high_incoming;
+                    while (high_incoming != nullptr && high_incoming->next_high_incoming != nullptr)
+                    {
+                        high_incoming->next_high_incoming->prev_high_incoming = high_incoming;
+                        high_incoming = high_incoming->next_high_incoming;
+                    }
+                }
             }
-            total_min_marginals.push_back(total_min_marg);
-            // std::cout << input_.get_var_name(var) << " : " << total_min_marginals[var] << std::endl;
         }
-        return total_min_marginals;
+        init_primal_solution(); 
     }
 
-    void bdd_mma_fixing::count_backward_run(ptrdiff_t first_var)
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::init(const ILP_input& input)
+    {
+        bdd_mma_base<bdd_variable_fix, BDD_BRANCH_NODE>::init(input);
+        init_pointers();
+    }
+
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::init()
+    {
+        bdd_mma_base<bdd_variable_fix, BDD_BRANCH_NODE>::init();
+        init_pointers();
+    }
+
+    template<typename BDD_BRANCH_NODE>
+    std::vector<double> bdd_mma_fixing_base<BDD_BRANCH_NODE>::total_min_marginals()
+    {
+        // fixed variables have infinite min-marginals
+        return bdd_mma_base<bdd_variable_fix, BDD_BRANCH_NODE>::total_min_marginals([this](const std::size_t var) { return is_fixed(var); });
+    }
+
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::count_backward_run(ptrdiff_t first_var)
     {
         assert(first_var >= 0 && first_var < this->nr_variables());
         for (ptrdiff_t var = this->nr_variables()-1; var >= first_var; --var)
         {
             for (size_t bdd_index=0; bdd_index<this->nr_bdds(var); bdd_index++)
             {
-                auto & bdd_var = bdd_variables_(var, bdd_index);
+                auto & bdd_var = this->bdd_variables_(var, bdd_index);
                 for (size_t node_index = bdd_var.first_node_index; node_index < bdd_var.last_node_index; node_index++)
                 {
-                    auto & bdd_node = bdd_branch_nodes_[node_index];
+                    auto & bdd_node = this->bdd_branch_nodes_[node_index];
                     bdd_node.count_backward_step();
                 }
             }
         } 
     }
 
-    void bdd_mma_fixing::count_forward_run(size_t last_var)
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::count_forward_run(size_t last_var)
     {
         assert(last_var >= 0 && last_var < this->nr_variables());
         for (size_t var = 0; var <= last_var; var++)
         {
             for (size_t bdd_index=0; bdd_index<this->nr_bdds(var); bdd_index++)
             {
-                auto & bdd_var = bdd_variables_(var, bdd_index);
+                auto & bdd_var = this->bdd_variables_(var, bdd_index);
                 for (size_t node_index = bdd_var.first_node_index; node_index < bdd_var.last_node_index; node_index++)
                 {
-                    auto & bdd_node = bdd_branch_nodes_[node_index];
+                    auto & bdd_node = this->bdd_branch_nodes_[node_index];
                     bdd_node.count_forward_step();
                 }
             }
         }
     }
 
-    std::vector<double> bdd_mma_fixing::search_space_reduction_coeffs()
+    template<typename BDD_BRANCH_NODE>
+    std::vector<double> bdd_mma_fixing_base<BDD_BRANCH_NODE>::search_space_reduction_coeffs()
     {
         std::vector<double> r_coeffs;
         // solution count backward run
@@ -518,10 +627,10 @@ namespace LPMP {
             double coeff = 0;
             for (size_t bdd_index=0; bdd_index<this->nr_bdds(var); bdd_index++)
             {
-                auto & bdd_var = bdd_variables_(var, bdd_index);
+                auto & bdd_var = this->bdd_variables_(var, bdd_index);
                 for (size_t node_index = bdd_var.first_node_index; node_index < bdd_var.last_node_index; node_index++)
                 {
-                    auto & bdd_node = bdd_branch_nodes_[node_index];
+                    auto & bdd_node = this->bdd_branch_nodes_[node_index];
                     bdd_node.count_forward_step();
                     coeff += bdd_node.count_high() - bdd_node.count_low();
                 }
@@ -532,15 +641,13 @@ namespace LPMP {
         return r_coeffs;
     }
 
-    bool bdd_mma_fixing::fix_variables()
+    template<typename BDD_BRANCH_NODE>
+    std::pair<std::vector<size_t>, std::vector<char>> bdd_mma_fixing_base<BDD_BRANCH_NODE>::fixing_strategy(
+            const enum bdd_min_marginal_averaging_options::fixing_order order, const enum bdd_min_marginal_averaging_options::fixing_value value,
+            const std::vector<double> & total_min_marginals, const std::vector<double> & reduction_coeffs) const
     {
-        std::vector<double> reduction_coeffs = search_space_reduction_coeffs();
-        this->backward_run();
-        // additional MMA iteration increases chance of finding a feasible solution
-        min_marginal_averaging_iteration();
-        std::vector<double> total_min_marginals = this->total_min_marginals();
         std::vector<size_t> variables;
-        for (size_t i = 0; i < nr_variables(); i++)
+        for (size_t i = 0; i < this->nr_variables(); i++)
             variables.push_back(i);
 
         const double eps = std::numeric_limits<double>::epsilon();
@@ -589,13 +696,13 @@ namespace LPMP {
             return total_min_marginals[a] > total_min_marginals[b];
         };
 
-        if (options.fixing_order == bdd_min_marginal_averaging_options::fixing_order::marginals_absolute)
+        if (order == bdd_min_marginal_averaging_options::fixing_order::marginals_absolute)
             std::sort(variables.begin(), variables.end(), order_abs);
-        else if (options.fixing_order == bdd_min_marginal_averaging_options::fixing_order::marginals_up)
+        else if (order == bdd_min_marginal_averaging_options::fixing_order::marginals_up)
             std::sort(variables.begin(), variables.end(), order_up);
-        else if (options.fixing_order == bdd_min_marginal_averaging_options::fixing_order::marginals_down)
+        else if (order == bdd_min_marginal_averaging_options::fixing_order::marginals_down)
             std::sort(variables.begin(), variables.end(), order_down);
-        else if (options.fixing_order == bdd_min_marginal_averaging_options::fixing_order::marginals_reduction)
+        else if (order == bdd_min_marginal_averaging_options::fixing_order::marginals_reduction)
             std::sort(variables.begin(), variables.end(), order_reduction);
         else
             std::sort(variables.begin(), variables.end(), order_up);
@@ -604,22 +711,85 @@ namespace LPMP {
         for (size_t i = 0; i < variables.size(); i++)
         {
             char val;
-            if (options.fixing_value == bdd_min_marginal_averaging_options::fixing_value::marginal)
+            if (value == bdd_min_marginal_averaging_options::fixing_value::marginal)
                 val = (total_min_marginals[variables[i]] < eps) ? 1 : 0;
-            else if (options.fixing_value == bdd_min_marginal_averaging_options::fixing_value::reduction)
-                val = (sign(reduction_coeffs[i]) < 0) ? 1 : 0;
-            else if (options.fixing_value == bdd_min_marginal_averaging_options::fixing_value::one)
+            else if (value == bdd_min_marginal_averaging_options::fixing_value::reduction)
+                val = (sign(reduction_coeffs[variables[i]]) < 0) ? 1 : 0;
+            else if (value == bdd_min_marginal_averaging_options::fixing_value::one)
                 val = 1;
-            else if (options.fixing_value == bdd_min_marginal_averaging_options::fixing_value::zero)
+            else if (value == bdd_min_marginal_averaging_options::fixing_value::zero)
                 val = 0;
             else
                 val = (total_min_marginals[variables[i]] < eps) ? 1 : 0;
             values.push_back(val);
         }
 
+        return {variables, values};
+    }
+
+    template<typename BDD_BRANCH_NODE>
+    bool bdd_mma_fixing_base<BDD_BRANCH_NODE>::fix_variables()
+    {
+        std::vector<double> reduction_coeffs = search_space_reduction_coeffs();
+        this->backward_run();
+        // additional MMA iteration increases chance of finding a feasible solution
+        min_marginal_averaging_iteration();
+        std::vector<double> total_min_marginals = this->total_min_marginals();
+
+        if (this->options.fixing_order == bdd_min_marginal_averaging_options::fixing_order::portfolio)
+            return fix_variables_portfolio(total_min_marginals, reduction_coeffs);
+
+        const auto [variables, values] = fixing_strategy(this->options.fixing_order, this->options.fixing_value, total_min_marginals, reduction_coeffs);
         return fix_variables(variables, values);
     }
 
+    // The first strategy finding a feasible solution stops the others. Strategies finishing concurrently compete on the objective.
+    template<typename BDD_BRANCH_NODE>
+    bool bdd_mma_fixing_base<BDD_BRANCH_NODE>::fix_variables_portfolio(const std::vector<double> & total_min_marginals, const std::vector<double> & reduction_coeffs)
+    {
+        using fixing_order = enum bdd_min_marginal_averaging_options::fixing_order;
+        using fixing_value = enum bdd_min_marginal_averaging_options::fixing_value;
+        std::vector<std::pair<fixing_order, fixing_value>> strategies;
+        for (const auto order : {fixing_order::marginals_up, fixing_order::marginals_down, fixing_order::marginals_absolute, fixing_order::marginals_reduction})
+            for (const auto value : {fixing_value::marginal, fixing_value::reduction})
+                strategies.emplace_back(order, value);
+
+        std::atomic<bool> stop = false;
+        std::vector<double> upper_bounds(strategies.size(), std::numeric_limits<double>::infinity());
+        std::vector<std::vector<char>> solutions(strategies.size());
+
+#pragma omp parallel
+        {
+            std::unique_ptr<bdd_fixing_state_copy<BDD_BRANCH_NODE>> state_copy;
+#pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < strategies.size(); i++)
+            {
+                if (stop.load())
+                    continue;
+                if (state_copy == nullptr)
+                    state_copy = std::make_unique<bdd_fixing_state_copy<BDD_BRANCH_NODE>>(this->bdd_branch_nodes_, this->bdd_variables_);
+                auto & state = state_copy->state;
+                state.revert_changes(0);
+
+                const auto [variables, values] = fixing_strategy(strategies[i].first, strategies[i].second, total_min_marginals, reduction_coeffs);
+                if (state.fix_variables(variables, values, &stop))
+                {
+                    stop = true;
+                    solutions[i] = state.primal_solution();
+                    upper_bounds[i] = bdd_mma_base<bdd_variable_fix, BDD_BRANCH_NODE>::compute_upper_bound(solutions[i]);
+                }
+            }
+        }
+
+        const size_t best = std::min_element(upper_bounds.begin(), upper_bounds.end()) - upper_bounds.begin();
+        if (solutions[best].empty())
+            return false;
+        if (diagnostics())
+            std::cout << "portfolio: strategy " << best << " of " << strategies.size() << " found best solution with cost " << upper_bounds[best] << std::endl;
+        fixing_state_.set_primal_solution(solutions[best]);
+        return true;
+    }
+
     // bool bdd_mma_fixing::fix_variables()
     // {
     //     init_primal_solution();
@@ -752,7 +922,8 @@ namespace LPMP {
     //     }
     // }
 
-    void bdd_mma_fixing::min_marginal_averaging_forward()
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::min_marginal_averaging_forward()
     {
         std::vector<std::array<double,2>> min_marginals;
         for(std::size_t var=0; var<this->nr_variables(); ++var) {
@@ -761,21 +932,22 @@ namespace LPMP {
             for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index) {
                 this->forward_step(var,bdd_index);
                 if (!is_fixed(var))
-                    min_marginals.push_back(min_marginal(var,bdd_index)); 
+                    min_marginals.push_back(this->min_marginal(var,bdd_index)); 
             }
 
             if (is_fixed(var))
                 continue;
 
-            const std::array<double,2> average_marginal = average_marginals(min_marginals.begin(), min_marginals.end());
+            const std::array<double,2> average_marginal = this->average_marginals(min_marginals.begin(), min_marginals.end());
 
             for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index) {
-                set_marginal(var,bdd_index,average_marginal,min_marginals[bdd_index]);
+                this->set_marginal(var,bdd_index,average_marginal,min_marginals[bdd_index]);
             } 
         }
     }
 
-    void bdd_mma_fixing::min_marginal_averaging_backward()
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::min_marginal_averaging_backward()
     {
         double lb = 0.0;
         std::vector<std::array<double,2>> min_marginals;
@@ -786,22 +958,23 @@ namespace LPMP {
             if (!is_fixed(var))
             {
                 for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index) {
-                    min_marginals.push_back(min_marginal(var,bdd_index)); 
+                    min_marginals.push_back(this->min_marginal(var,bdd_index)); 
                 }
             }
-            const std::array<double,2> average_marginal = average_marginals(min_marginals.begin(), min_marginals.end());
+            const std::array<double,2> average_marginal = this->average_marginals(min_marginals.begin(), min_marginals.end());
             
             for(std::size_t bdd_index=0; bdd_index<this->nr_bdds(var); ++bdd_index) {
                 if (!is_fixed(var))
-                    set_marginal(var,bdd_index,average_marginal,min_marginals[bdd_index]);
+                    this->set_marginal(var,bdd_index,average_marginal,min_marginals[bdd_index]);
                 this->backward_step(var, bdd_index);
-                lb += lower_bound_backward(var,bdd_index);
+                lb += this->lower_bound_backward(var,bdd_index);
             }
         }
-        lower_bound_ = lb; 
+        this->lower_bound_ = lb; 
     }
 
-    void bdd_mma_fixing::min_marginal_averaging_iteration()
+    template<typename BDD_BRANCH_NODE>
+    void bdd_mma_fixing_base<BDD_BRANCH_NODE>::min_marginal_averaging_iteration()
     {
         this->min_marginal_averaging_forward();
         this->min_marginal_averaging_backward();
@@ -2,16 +2,25 @@
 
 #include "bdd.h"
 #include "ILP_input.h"
+#include "ILP_parser.h"
 #include "convert_pb_to_bdd.h"
 #include "hash_helper.hxx"
 #include "bdd_preprocessor.h"
 #include "bdd_collection.h"
+#include "two_dimensional_variable_array.hxx"
+#include "mapped_file.hxx"
 #include "tclap/CmdLine.h"
+#include <tsl/robin_map.h>
+#include <omp.h>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
 #include <stack>
 #include <numeric>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
 
 namespace LPMP {
 
@@ -23,7 +32,7 @@ namespace LPMP {
             constexpr static std::size_t terminal_0 = std::numeric_limits<std::size_t>::max()-1;
             constexpr static std::size_t terminal_1 = std::numeric_limits<std::size_t>::max();
             bool low_is_terminal() const { return low == terminal_0 || low == terminal_1; }
-            bool high_is_terminal() const { return low == terminal_0 || low == terminal_1; }
+            bool high_is_terminal() const { return high == terminal_0 || high == terminal_1; }
 
             std::size_t low;
             std::size_t high;
@@ -31,6 +40,9 @@ namespace LPMP {
         };
 
         bdd_storage(TCLAP::CmdLine& cmd);
+        // no command line options, no preprocessing
+        bdd_storage();
+        // constraints are converted to BDDs in parallel. The result does not depend on the number of threads.
         void init(const ILP_input& input);
 
         template <typename BDD_VARIABLES_ITERATOR>
@@ -38,6 +50,9 @@ namespace LPMP {
 
         void add_bdd(BDD::bdd_collection_entry bdd);
 
+        // append all BDDs of other
+        void append(const bdd_storage& other);
+
         template <typename STREAM>
         void export_dot(STREAM &s) const;
 
@@ -52,9 +67,26 @@ namespace LPMP {
         std::size_t first_bdd_node(const std::size_t bdd_nr) const;
         std::size_t last_bdd_node(const std::size_t bdd_nr) const;
 
+        // Binary snapshot of the BDDs together with the names of the variables in the order they are indexed by and the fingerprint of the constraints they were compiled from.
+        // Layout: header, bdd nodes, delimiters, name lengths, name characters, all in native byte order.
+        void write_snapshot(const std::string& filename, const std::vector<std::string>& variable_names, const ILP_parser::constraint_fingerprint& constraints) const;
+        // returns the variable names, throws if the snapshot was compiled from other constraints
+        std::vector<std::string> read_snapshot(const std::string& filename, const ILP_parser::constraint_fingerprint& constraints);
+
         // return all edges with endpoints being variables that are consecutive in some BDD
         std::vector<std::array<size_t,2>> dependency_graph() const;
 
+        // for BDD decomposition //
+        struct interval_decomposition {
+            std::vector<std::size_t> variable_index; // original variable -> variable after splitting
+            std::vector<std::array<std::size_t,2>> interval_variables; // range of original variables of each interval after splitting
+            two_dim_variable_array<std::size_t> left_split_variables; // per interval: split variables shared with a piece in a preceding interval
+            two_dim_variable_array<std::size_t> right_split_variables; // per interval: split variables shared with a piece in a succeeding interval
+        };
+        // Split BDDs at boundaries of variable intervals with balanced node counts. Afterwards each BDD lies in one interval.
+        // Each split variable is covered by exactly two BDDs, the first one in the preceding, the second one in the succeeding interval.
+        interval_decomposition split_bdds(const std::size_t nr_intervals);
+
     private:
         void check_node_valid(const bdd_node bdd) const;
 
@@ -81,7 +113,6 @@ namespace LPMP {
         void compute_intervals(const size_t nr_intervals);
         size_t interval(const size_t variable) const;
         size_t nr_intervals() const;
-        std::tuple<two_dim_variable_array<bdd_storage::bdd_node>, two_dim_variable_array<size_t>> split_bdd_nodes(const size_t nr_intervals);
 
         TCLAP::MultiArg<std::string> preprocessing_arg;
     };
@@ -91,6 +122,10 @@ namespace LPMP {
         : preprocessing_arg("","bdd_preprocessing","preprocess BDDs",false,"{none|bridge|subsumption|subsumption_except_one|contiguous_overlap|partial_contiguous_overlap|cliques}", cmd)
     {}
 
+    bdd_storage::bdd_storage()
+        : preprocessing_arg("","bdd_preprocessing","preprocess BDDs",false,"{none|bridge|subsumption|subsumption_except_one|contiguous_overlap|partial_contiguous_overlap|cliques}")
+    {}
+
     template<typename BDD_VARIABLES_ITERATOR>
         void bdd_storage::add_bdd(BDD::bdd_mgr& bdd_mgr, BDD::node_ref bdd, BDD_VARIABLES_ITERATOR bdd_vars_begin, BDD_VARIABLES_ITERATOR bdd_vars_end)
         {
@@ -240,37 +275,76 @@ namespace LPMP {
         }
 
 
-    void bdd_storage::init(const ILP_input& input)
+    void bdd_storage::append(const bdd_storage& other)
     {
-        BDD::bdd_mgr bdd_mgr;
+        const std::size_t offset = bdd_nodes_.size();
+        auto shift = [&](const std::size_t i) {
+            return i == bdd_node::terminal_0 || i == bdd_node::terminal_1 ? i : i + offset;
+        };
+        bdd_nodes_.reserve(bdd_nodes_.size() + other.bdd_nodes_.size());
+        for(const bdd_node& node : other.bdd_nodes_)
+            bdd_nodes_.push_back({shift(node.low), shift(node.high), node.variable});
+        for(std::size_t i=1; i<other.bdd_delimiters_.size(); ++i)
+            bdd_delimiters_.push_back(offset + other.bdd_delimiters_[i]);
+        nr_variables_ = std::max(nr_variables_, other.nr_variables_);
+    }
 
+    void bdd_storage::init(const ILP_input& input)
+    {
         bdd_preprocessor bdd_pre;
         const bool preprocess = preprocessing_arg.getValue().size() > 0;
 
-        // first transform linear inequalities into BDDs
-        std::vector<int> coefficients;
-        std::vector<std::size_t> variables;
-        std::vector<BDD::node_ref> bdds;
-        bdd_converter converter(bdd_mgr);
-
-        for(const auto& constraint : input.constraints()) {
-            coefficients.clear();
-            variables.clear();
-            for(const auto e : constraint.variables) {
-                coefficients.push_back(e.coefficient);
-                variables.push_back(e.var);
+        // first transform linear inequalities into BDDs.
+        // Each thread converts a contiguous chunk of constraints with its own BDD manager and constraint caches.
+        // Chunks are merged in constraint order.
+        const std::size_t nr_constraints = input.constraints().size();
+        const std::size_t nr_threads = std::max(std::size_t(1), std::min(std::size_t(omp_get_max_threads()), nr_constraints));
+        std::vector<BDD::bdd_mgr> bdd_mgrs(nr_threads);
+        std::vector<BDD::node_ref> bdds(preprocess ? nr_constraints : 0); // for preprocessing, which is sequential
+        std::vector<bdd_storage> thread_storages(preprocess ? 0 : nr_threads);
+
+#pragma omp parallel for schedule(static) num_threads(nr_threads)
+        for(std::size_t t=0; t<nr_threads; ++t) {
+            bdd_converter converter(bdd_mgrs[t]);
+            std::vector<int> coefficients;
+            std::vector<std::size_t> variables;
+            for(std::size_t c=t*nr_constraints/nr_threads; c<(t+1)*nr_constraints/nr_threads; ++c) {
+                const auto& constraint = input.constraints()[c];
+                coefficients.clear();
+                variables.clear();
+                for(const auto e : constraint.variables) {
+                    coefficients.push_back(e.coefficient);
+                    variables.push_back(e.var);
+                }
+                assert(std::is_sorted(variables.begin(), variables.end()));
+
+                BDD::node_ref bdd = converter.convert_to_bdd(coefficients, constraint.ineq, constraint.right_hand_side);
+                if(preprocess)
+                    bdds[c] = bdd;
+                else
+                    thread_storages[t].add_bdd(bdd_mgrs[t], bdd, variables.begin(), variables.end());
+            }
+        }
+
+        if(!preprocess) {
+            std::size_t nr_nodes = bdd_nodes_.size();
+            for(const auto& s : thread_storages)
+                nr_nodes += s.bdd_nodes_.size();
+            bdd_nodes_.reserve(nr_nodes);
+            for(const auto& s : thread_storages)
+                append(s);
+        } else {
+            std::vector<std::size_t> variables;
+            for(std::size_t c=0; c<nr_constraints; ++c) {
+                variables.clear();
+                for(const auto e : input.constraints()[c].variables)
+                    variables.push_back(e.var);
+                bdd_pre.add_bdd(bdds[c], variables.begin(), variables.end());
             }
-            assert(std::is_sorted(variables.begin(), variables.end()));
-            
-            BDD::node_ref bdd = converter.convert_to_bdd(coefficients, constraint.ineq, constraint.right_hand_side);
-            if(preprocess)
-                bdd_pre.add_bdd(bdd, variables.begin(), variables.end());
-            else
-                add_bdd(bdd_mgr, bdd, variables.begin(), variables.end());
         }
 
         // second, preprocess BDDs
-        if(preprocessing_arg.getValue().size() > 0)
+        if(preprocess)
         {
             for(const std::string& preprocessing : preprocessing_arg.getValue())
             {
@@ -296,6 +370,107 @@ namespace LPMP {
         }
     }
 
+    namespace detail {
+        struct bdd_storage_snapshot_header {
+            constexpr static char magic_value[8] = {'L','P','M','P','B','D','D','S'};
+            constexpr static std::uint32_t current_version = 2;
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t node_size;
+            std::uint64_t nr_variables;
+            std::uint64_t nr_bdd_nodes;
+            std::uint64_t nr_delimiters;
+            std::uint64_t nr_names;
+            std::uint64_t names_size;
+            std::uint64_t nr_constraints;
+            std::uint64_t constraint_hash;
+        };
+    }
+
+    inline void bdd_storage::write_snapshot(const std::string& filename, const std::vector<std::string>& variable_names, const ILP_parser::constraint_fingerprint& constraints) const
+    {
+        assert(variable_names.size() >= nr_variables());
+        detail::bdd_storage_snapshot_header h;
+        std::memcpy(h.magic, h.magic_value, sizeof(h.magic));
+        h.version = h.current_version;
+        h.node_size = sizeof(bdd_node);
+        h.nr_variables = nr_variables_;
+        h.nr_bdd_nodes = bdd_nodes_.size();
+        h.nr_delimiters = bdd_delimiters_.size();
+        h.nr_names = variable_names.size();
+        std::vector<std::uint64_t> name_lengths;
+        name_lengths.reserve(variable_names.size());
+        for(const auto& name : variable_names)
+            name_lengths.push_back(name.size());
+        h.names_size = std::accumulate(name_lengths.begin(), name_lengths.end(), std::uint64_t(0));
+        h.nr_constraints = constraints.nr_constraints;
+        h.constraint_hash = constraints.hash;
+
+        std::ofstream f(filename, std::ios::binary);
+        if(!f)
+            throw std::runtime_error("could not open " + filename + " for writing");
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        f.write(reinterpret_cast<const char*>(bdd_nodes_.data()), bdd_nodes_.size() * sizeof(bdd_node));
+        f.write(reinterpret_cast<const char*>(bdd_delimiters_.data()), bdd_delimiters_.size() * sizeof(std::size_t));
+        f.write(reinterpret_cast<const char*>(name_lengths.data()), name_lengths.size() * sizeof(std::uint64_t));
+        for(const auto& name : variable_names)
+            f.write(name.data(), name.size());
+        if(!f)
+            throw std::runtime_error("could not write " + filename);
+    }
+
+    inline std::vector<std::string> bdd_storage::read_snapshot(const std::string& filename, const ILP_parser::constraint_fingerprint& constraints)
+    {
+        static_assert(sizeof(bdd_node) == 3*sizeof(std::size_t));
+        const mapped_file f(filename);
+        auto invalid = [&]() { return std::runtime_error(filename + " is not a valid bdd snapshot"); };
+
+        detail::bdd_storage_snapshot_header h;
+        if(f.size() < sizeof(h))
+            throw invalid();
+        std::memcpy(&h, f.data(), sizeof(h));
+        if(std::memcmp(h.magic, h.magic_value, sizeof(h.magic)) != 0 || h.node_size != sizeof(bdd_node))
+            throw invalid();
+        if(h.version != h.current_version)
+            throw std::runtime_error(filename + " has bdd snapshot version " + std::to_string(h.version) + ", expected " + std::to_string(h.current_version));
+        if(h.nr_constraints != constraints.nr_constraints || h.constraint_hash != constraints.hash)
+            throw std::runtime_error(filename + " was compiled from other constraints (" + std::to_string(h.nr_constraints) + " constraints in snapshot, " + std::to_string(constraints.nr_constraints) + " in input)");
+        const std::size_t expected_size = sizeof(h) + h.nr_bdd_nodes * sizeof(bdd_node) + h.nr_delimiters * sizeof(std::size_t) + h.nr_names * sizeof(std::uint64_t) + h.names_size;
+        if(f.size() != expected_size || h.nr_delimiters == 0 || h.nr_names < h.nr_variables)
+            throw invalid();
+
+        const char* p = f.data() + sizeof(h);
+        bdd_nodes_.resize(h.nr_bdd_nodes);
+        std::memcpy(bdd_nodes_.data(), p, h.nr_bdd_nodes * sizeof(bdd_node));
+        p += h.nr_bdd_nodes * sizeof(bdd_node);
+        bdd_delimiters_.resize(h.nr_delimiters);
+        std::memcpy(bdd_delimiters_.data(), p, h.nr_delimiters * sizeof(std::size_t));
+        p += h.nr_delimiters * sizeof(std::size_t);
+        nr_variables_ = h.nr_variables;
+
+        std::vector<std::uint64_t> name_lengths(h.nr_names);
+        std::memcpy(name_lengths.data(), p, h.nr_names * sizeof(std::uint64_t));
+        p += h.nr_names * sizeof(std::uint64_t);
+        std::vector<std::string> variable_names;
+        variable_names.reserve(h.nr_names);
+        for(const std::uint64_t l : name_lengths) {
+            if(l > std::size_t(f.end() - p))
+                throw invalid();
+            variable_names.emplace_back(p, l);
+            p += l;
+        }
+
+        if(bdd_delimiters_.front() != 0 || bdd_delimiters_.back() != bdd_nodes_.size() || !std::is_sorted(bdd_delimiters_.begin(), bdd_delimiters_.end()))
+            throw invalid();
+        for(const bdd_node& node : bdd_nodes_)
+            if(node.variable >= nr_variables_
+                    || (!node.low_is_terminal() && node.low >= bdd_nodes_.size())
+                    || (!node.high_is_terminal() && node.high >= bdd_nodes_.size()))
+                throw invalid();
+
+        return variable_names;
+    }
+
     std::size_t bdd_storage::first_bdd_node(const std::size_t bdd_nr) const
     {
         assert(bdd_nr < nr_bdds());
@@ -370,19 +545,27 @@ namespace LPMP {
     // for BDD decomposition //
     ///////////////////////////
 
+    // partition variables into contiguous intervals holding roughly the same number of bdd nodes
     void bdd_storage::compute_intervals(const size_t nr_intervals)
     {
-        // first approach: Just partition variables equidistantly.
-        // TODO: Take into account number of BDD nodes in each interval
-        
-        assert(nr_intervals > 1);
+        assert(nr_intervals > 0);
+        std::vector<size_t> nr_nodes_per_variable(this->nr_variables(), 0);
+        for(const auto& bdd : bdd_nodes_)
+            ++nr_nodes_per_variable[bdd.variable];
+
         interval_boundaries.clear();
         interval_boundaries.reserve(nr_intervals+1);
-        for(size_t interval=0; interval<nr_intervals; ++interval)
-            interval_boundaries.push_back(std::round(double(interval*this->nr_variables())/double(nr_intervals)));
-
+        interval_boundaries.push_back(0);
+        size_t cumulative_nodes = 0;
+        for(size_t var=0; var<this->nr_variables(); ++var)
+        {
+            const size_t interval = interval_boundaries.size()-1;
+            if(interval+1 < nr_intervals && cumulative_nodes >= (interval+1)*bdd_nodes_.size()/nr_intervals && var > interval_boundaries.back())
+                interval_boundaries.push_back(var);
+            cumulative_nodes += nr_nodes_per_variable[var];
+        }
         interval_boundaries.push_back(this->nr_variables()); 
-        assert(interval_boundaries.size() == nr_intervals+1);
+        assert(interval_boundaries.size() <= nr_intervals+1);
 
         intervals.clear();
         intervals.reserve(this->nr_variables());
@@ -394,7 +577,6 @@ namespace LPMP {
     size_t bdd_storage::interval(const size_t variable) const
     {
         assert(variable < this->nr_variables());
-        assert(interval_boundaries.size() > 2 || interval_boundaries.size() == 0);
         if(interval_boundaries.size() == 0)
             return 0;
         assert(intervals.size() == this->nr_variables());
@@ -403,249 +585,214 @@ namespace LPMP {
 
     size_t bdd_storage::nr_intervals() const
     {
-        assert(interval_boundaries.size() > 2 || interval_boundaries.size() == 0);
         if(interval_boundaries.size() == 0)
             return 1;
         return interval_boundaries.size()-1;
     }
 
-    // take bdd_nodes_ and return two_dim_variable_array<bdd_node> bdd_nodes_split_, two_dim_variable_array<size_t> bdd_delimiters_split_
-    std::tuple<two_dim_variable_array<bdd_storage::bdd_node>, two_dim_variable_array<size_t>> bdd_storage::split_bdd_nodes(const size_t nr_intervals)
+    // A bdd reaching from interval i into interval j>i is cut at the nodes of its first variable in interval j, called cut nodes.
+    // The piece in interval i gets encoder nodes that write the index of the reached cut node into split variables.
+    // The piece in interval j starts with a decoder tree that reads the split variables and branches to the corresponding cut node.
+    // Hence every solution of the original bdd extends uniquely to a solution of the pieces and vice versa.
+    // Split variables are placed directly before the variables of interval j. If there is only one cut node, no split variables are needed.
+    bdd_storage::interval_decomposition bdd_storage::split_bdds(const size_t nr_intervals)
     {
         compute_intervals(nr_intervals);
 
-        std::vector<size_t> nr_bdd_nodes_per_interval(nr_intervals(), 0);
-        std::vector<size_t> nr_bdds_per_inteval(nr_intervals(), 1);
-        std::unordered_set<size_t> active_intervals;
-
-        for(size_t bdd_counter=0; bdd_counter<bdd_delimiters_.size()-1; ++bdd_counter)
+        struct cut {
+            size_t next_interval;
+            std::vector<size_t> nodes;
+            size_t nr_bits;
+            size_t slot_offset; // position of first split variable among those placed before next_interval
+        };
+        auto nr_bits = [](const size_t k) { size_t b = 0; while((size_t(1) << b) < k) ++b; return b; };
+
+        // first pass: compute cuts
+        std::vector<cut> cuts;
+        std::vector<size_t> cut_delimiters = {0};
+        std::vector<size_t> first_interval(nr_bdds());
+        std::vector<size_t> nr_split_variables(this->nr_intervals(), 0);
+        std::vector<size_t> first_variable_in_interval(this->nr_intervals());
+        for(size_t bdd_nr=0; bdd_nr<nr_bdds(); ++bdd_nr)
         {
-            const size_t last_bdd_interval = [&]() {
-                size_t last_bdd_interval = 0;
-                for(auto bdd_node_counter=bdd_delimiters_[bdd_counter]; bdd_node_counter<bdd_delimiters_[bdd_counter+1]; ++bdd_node_counter)
-                {
-                    const auto& bdd = bdd_nodes_[bdd_node_counter];
-                    last_bdd_interval = std::max(interval(bdd.variable), last_bdd_interval);
-                }
-                return last_bdd_interval;
-            }();
-            
-            // there are the following cases:
-            // (i) All bdd nodes are non-terminal and in the same interval
-            // (ii) all bdd nodes are non-terminal but in different intervals
-            // (iii) one arc is bottom and the other one is in the same interval
-            // (iv) one arc is bottom and the other one is in the next interval
-            // (v) At least one arc is top -> bdd node is in last interval
-            
-            // count in which intervals bdd has nodes
-            active_intervals.clear();
-            for(auto bdd_node_counter=bdd_delimiters_[bdd_counter]; bdd_node_counter<bdd_delimiters_[bdd_counter+1]; ++bdd_node_counter)
+            constexpr size_t not_set = std::numeric_limits<size_t>::max();
+            std::fill(first_variable_in_interval.begin(), first_variable_in_interval.end(), not_set);
+            for(size_t i=bdd_delimiters_[bdd_nr]; i<bdd_delimiters_[bdd_nr+1]; ++i)
             {
-                const auto& bdd = bdd_nodes_[bdd_node_counter];
-                active_intervals.insert(interval(bdd.variable));
+                const size_t var = bdd_nodes_[i].variable;
+                first_variable_in_interval[interval(var)] = std::min(var, first_variable_in_interval[interval(var)]);
             }
-            for(const size_t i : active_intervals)
-                ++nr_bdds_per_inteval[i];
+            first_interval[bdd_nr] = std::find_if(first_variable_in_interval.begin(), first_variable_in_interval.end(), [](const size_t v) { return v != not_set; }) - first_variable_in_interval.begin();
+            for(size_t interval=first_interval[bdd_nr]+1; interval<this->nr_intervals(); ++interval)
+            {
+                if(first_variable_in_interval[interval] == not_set)
+                    continue;
+                cut c;
+                c.next_interval = interval;
+                for(size_t i=bdd_delimiters_[bdd_nr]; i<bdd_delimiters_[bdd_nr+1]; ++i)
+                    if(bdd_nodes_[i].variable == first_variable_in_interval[interval])
+                        c.nodes.push_back(i);
+                c.nr_bits = nr_bits(c.nodes.size());
+                c.slot_offset = nr_split_variables[interval];
+                nr_split_variables[interval] += c.nr_bits;
+                cuts.push_back(std::move(c));
+            }
+            cut_delimiters.push_back(cuts.size());
+        }
 
-            // count number of bdd nodes per interval
-            for(auto bdd_node_counter=bdd_delimiters_[bdd_counter]; bdd_node_counter<bdd_delimiters_[bdd_counter+1]; ++bdd_node_counter)
+        // new variable order: split variables placed before interval, variables of interval
+        interval_decomposition d;
+        d.variable_index.resize(this->nr_variables());
+        d.interval_variables.reserve(this->nr_intervals());
+        std::vector<size_t> slot_begin;
+        slot_begin.reserve(this->nr_intervals());
+        size_t nr_split_variables_total = 0;
+        {
+            size_t offset = 0;
+            for(size_t interval=0; interval<this->nr_intervals(); ++interval)
             {
-                const auto& bdd = bdd_nodes_[bdd_node_counter];
-                // first check if node is split node. If not, increase node count in correct interval. If split node, increment node count in both intervals straddled.
-                // case (i)
-                if(!bdd.low_is_terminal() && !bdd.high_is_terminal())
-                {
-                    const bdd_node& low = bdd_nodes_[bdd.low];
-                    const bdd_node& high = bdd_nodes_[bdd.high];
-                    assert(low.variable == high.variable);
-                    if(interval(bdd.variable) == interval(low.variable)) // case (i)
-                    {
-                        ++nr_bdd_nodes_per_interval[interval(bdd.variable)]; 
-                    }
-                    else // case (ii)
-                    {
-                        ++nr_bdd_nodes_per_interval[interval(bdd.variable)];
-                        ++nr_bdd_nodes_per_interval[interval(bdd_nodes_[bdd.low].variable)]; // bdd nodes pointed  to by low and high will be counted in next interval again when visiting those 
-                    }
-                }
-                else if(bdd.low_is_terminal() && bdd.high_is_terminal()) // case (v)
-                {
-                    assert(bdd.low == bdd_node::terminal_1 || bdd.high == bdd_node::terminal_1);
-                    ++nr_bdd_nodes_per_interval[interval(bdd.variable)]; 
-                }
-                else if(bdd.low == bdd_node::terminal_0 || bdd.high == bdd_node::terminal_0)
-                {
-                    if(bdd.low == bdd_node::terminal_0)
-                    {
-                        const size_t high_var = bdd_nodes_[bdd.high].variable;
-                        if(interval(bdd.variable) == interval(high_var)) // case (iii)
-                        {
-                            ++nr_bdd_nodes_per_interval[interval(bdd.variable)];
-                        }
-                        else // case (iv)
-                        {
-                            // TODO: not necessarily += 2, possibly += 1 if node is shared!
-                            ++nr_bdd_nodes_per_interval[interval(bdd.variable)];
-                            ++nr_bdd_nodes_per_interval[interval(high_var)];
-                        }
-                    }
-                    else
-                    {
-                        assert(bdd.high == bdd_node::terminal_0);
-                        const size_t low_var = bdd_nodes_[bdd.low].variable;
-                        if(interval(bdd.variable) == interval(low_var)) // case (iii)
-                        {
-                            ++nr_bdd_nodes_per_interval[interval(bdd.variable)];
-                        }
-                        else // case (iv)
-                        {
-                            // TODO: not necessarily += 2, possibly += 1 if node is shared!
-                            ++nr_bdd_nodes_per_interval[interval(bdd.variable)];
-                            ++nr_bdd_nodes_per_interval[interval(low_var)];
-                        }
-                    } 
-                }
-                else
-                {
-                    assert(false); // We should have covered all cases
-                }
+                slot_begin.push_back(offset);
+                offset += nr_split_variables[interval];
+                nr_split_variables_total += nr_split_variables[interval];
+                const size_t begin = offset;
+                for(size_t var=interval_boundaries[interval]; var<interval_boundaries[interval+1]; ++var)
+                    d.variable_index[var] = offset++;
+                d.interval_variables.push_back({begin, offset});
             }
+            assert(offset == this->nr_variables() + nr_split_variables_total);
         }
+        auto split_variable = [&](const cut& c, const size_t bit) { assert(bit < c.nr_bits); return slot_begin[c.next_interval] + c.slot_offset + bit; };
 
-        two_dim_variable_array<bdd_node> split_bdd_nodes(nr_bdd_nodes_per_interval.begin(), nr_bdd_nodes_per_interval.end());
-        std::fill(nr_bdd_nodes_per_interval.begin(), nr_bdd_nodes_per_interval.end(), 0);
+        std::vector<std::vector<size_t>> left_split_variables(this->nr_intervals());
+        std::vector<std::vector<size_t>> right_split_variables(this->nr_intervals());
 
-        two_dim_variable_array<size_t> split_bdd_delimiters(nr_bdds_per_inteval.begin(), nr_bdds_per_inteval.end());
-        std::fill(nr_bdds_per_inteval.begin(), nr_bdds_per_inteval.end(), 1);
-        for(size_t i=0; i<split_bdd_delimiters.size(); ++i)
-            split_bdd_delimiters(i,0) = 0;
+        // second pass: emit pieces
+        std::vector<bdd_node> split_nodes;
+        split_nodes.reserve(bdd_nodes_.size());
+        std::vector<size_t> split_delimiters = {0};
+        std::unordered_map<size_t,size_t> node_index; // original node -> node in split_nodes
+        std::unordered_map<size_t,size_t> cut_node_code; // cut node -> position in its cut
+        tsl::robin_map<size_t,size_t> level, next_level; // encoder: code suffix -> node, decoder: code prefix -> node
+        std::vector<size_t> suffixes;
+        std::vector<size_t> encoder_entry;
 
-        // fill split bdd nodes, record duplicated arcs
-        struct split_node { size_t interval; size_t offset; };
-        std::vector<std::array<split_node,2>> duplicated_nodes;
-        std::unordered_map<std::array<size_t,2>,size_t> split_bdd_node_indices; // bdd index in bdd_nodes_, interval
-        for(size_t bdd_counter=0; bdd_counter<bdd_delimiters_.size()-1; ++bdd_counter)
+        for(size_t bdd_nr=0; bdd_nr<nr_bdds(); ++bdd_nr)
         {
-            split_bdd_node_indices.clear();
-            for(auto bdd_node_counter=bdd_delimiters_[bdd_counter]; bdd_node_counter<bdd_delimiters_[bdd_counter+1]; ++bdd_node_counter)
-            { 
-                const bdd_node& bdd = bdd_nodes_[bdd_node_counter];
-                // case (i) & (ii)
-                if(!bdd.low_is_terminal() && !bdd.high_is_terminal())
-                {
-                    const size_t i = interval(bdd.variable);
-                    const bdd_node& low = bdd_nodes_[bdd.low];
-                    const bdd_node& high = bdd_nodes_[bdd.high];
-                    assert(low.variable == high.variable);
+            node_index.clear();
+            cut_node_code.clear();
+            for(size_t c=cut_delimiters[bdd_nr]; c<cut_delimiters[bdd_nr+1]; ++c)
+                for(size_t j=0; j<cuts[c].nodes.size(); ++j)
+                    cut_node_code.insert({cuts[c].nodes[j], j});
+
+            const size_t nr_cuts = cut_delimiters[bdd_nr+1] - cut_delimiters[bdd_nr];
+            for(size_t piece=0; piece<=nr_cuts; ++piece)
+            {
+                const cut* in = piece > 0 ? &cuts[cut_delimiters[bdd_nr] + piece-1] : nullptr;
+                const cut* out = piece < nr_cuts ? &cuts[cut_delimiters[bdd_nr] + piece] : nullptr;
+                const size_t piece_interval = in == nullptr ? first_interval[bdd_nr] : in->next_interval;
 
-                    if(interval(bdd.variable) == interval(low.variable)) // case (i)
+                // encoder: node (bit t, suffix s) checks bit t of s and continues with the suffix of bits t+1,...
+                encoder_entry.clear();
+                if(out != nullptr && out->nr_bits > 0)
+                {
+                    const size_t b = out->nr_bits;
+                    next_level.clear();
+                    for(std::ptrdiff_t t=b-1; t>=0; --t)
                     {
-                        assert(split_bdd_node_indices.count({bdd.low, i}) > 0);
-                        const size_t low_idx = split_bdd_node_indices.find({bdd.low, i})->second;
-                        assert(split_bdd_node_indices.count({bdd.high, i}) > 0);
-                        const size_t high_idx = split_bdd_node_indices.find({bdd.high, i})->second;
-
-                        split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, low_idx, high_idx};
-                        split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i]));
-                        ++nr_bdd_nodes_per_interval[i];
+                        const size_t mask = (size_t(1) << (b-t)) - 1;
+                        suffixes.clear();
+                        for(size_t j=0; j<out->nodes.size(); ++j)
+                            suffixes.push_back(j & mask);
+                        std::sort(suffixes.begin(), suffixes.end());
+                        suffixes.erase(std::unique(suffixes.begin(), suffixes.end()), suffixes.end());
+
+                        level.clear();
+                        for(const size_t s : suffixes)
+                        {
+                            const bool bit = (s >> (b-1-t)) & 1;
+                            const size_t next = size_t(t+1) == b ? bdd_node::terminal_1 : next_level.find(s & (mask >> 1))->second;
+                            split_nodes.push_back({bit ? bdd_node::terminal_0 : next, bit ? next : bdd_node::terminal_0, split_variable(*out, t)});
+                            level.insert({s, split_nodes.size()-1});
+                        }
+                        std::swap(level, next_level);
                     }
-                    else // case (ii)
+                    for(size_t j=0; j<out->nodes.size(); ++j)
+                        encoder_entry.push_back(next_level.find(j)->second);
+                    for(size_t t=0; t<b; ++t)
+                        right_split_variables[piece_interval].push_back(split_variable(*out, t));
+                }
+
+                // original nodes
+                auto remap = [&](const size_t i) -> size_t {
+                    if(i == bdd_node::terminal_0 || i == bdd_node::terminal_1)
+                        return i;
+                    if(interval(bdd_nodes_[i].variable) == piece_interval)
                     {
-                        // in interval i, low and high arcs should point to topsink
-                        split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, bdd_node::terminal_1, bdd_node::terminal_1};
-                        split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i]));
-                        ++nr_bdd_nodes_per_interval[i];
-
-                        // in next interval
-                        const size_t next_i = interval(bdd_nodes_[bdd.low].variable);
-                        assert(i < next_i);
-                        const size_t next_lo_idx = split_bdd_node_indices.find({bdd.low, next_i})->second;
-                        const size_t next_hi_idx = split_bdd_node_indices.find({bdd.high, next_i})->second;
-                        split_bdd_nodes(next_i, nr_bdd_nodes_per_interval[next_i]) = {bdd.variable, next_lo_idx, next_hi_idx};
-                        split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, next_i}, nr_bdd_nodes_per_interval[next_i]));
-                        ++nr_bdd_nodes_per_interval[next_i]; 
-
-                        duplicated_nodes.push_back({split_node{i, nr_bdd_nodes_per_interval[i]-1}, split_node{next_i, nr_bdd_nodes_per_interval[next_i]-1}});
+                        assert(node_index.count(i) > 0);
+                        return node_index.find(i)->second;
                     }
-                }
-                else if(bdd.low_is_terminal() && bdd.high_is_terminal()) // case (v)
+                    assert(out != nullptr && cut_node_code.count(i) > 0);
+                    if(out->nr_bits == 0)
+                        return bdd_node::terminal_1;
+                    return encoder_entry[cut_node_code.find(i)->second];
+                };
+                for(size_t i=bdd_delimiters_[bdd_nr]; i<bdd_delimiters_[bdd_nr+1]; ++i)
                 {
-                    assert(bdd.low == bdd_node::terminal_1 || bdd.high == bdd_node::terminal_1);
-                    const size_t i = interval(bdd.variable);
-                    split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, bdd.low, bdd.high};
-                    split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i])); 
-                    ++nr_bdd_nodes_per_interval[i]; 
+                    const bdd_node& bdd = bdd_nodes_[i];
+                    if(interval(bdd.variable) != piece_interval)
+                        continue;
+                    split_nodes.push_back({remap(bdd.low), remap(bdd.high), d.variable_index[bdd.variable]});
+                    node_index.insert({i, split_nodes.size()-1});
                 }
-                else if(bdd.low == bdd_node::terminal_0 || bdd.high == bdd_node::terminal_0)
+
+                // decoder: node (bit t, prefix p) branches on bit t. Prefixes not extendable to a code of a cut node lead to terminal_0.
+                if(in != nullptr && in->nr_bits > 0)
                 {
-                    const size_t i = interval(bdd.variable);
-                    if(bdd.low == bdd_node::terminal_0)
+                    const size_t b = in->nr_bits;
+                    const size_t k = in->nodes.size();
+                    next_level.clear();
+                    for(std::ptrdiff_t t=b-1; t>=0; --t)
                     {
-                        const size_t high_var = bdd_nodes_[bdd.high].variable;
-                        if(i == interval(high_var)) // case (iii)
-                        {
-                            assert(split_bdd_node_indices.count({bdd.high,i}) > 0);
-                            const size_t high_idx = split_bdd_node_indices.find({bdd.high,i})->second;
-                            split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, bdd_node::terminal_0, high_idx};
-                            split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i])); 
-                            ++nr_bdd_nodes_per_interval[i]; 
-                        }
-                        else // case (iv)
+                        auto child = [&](const size_t q) -> size_t {
+                            if(size_t(t+1) == b)
+                                return q < k ? node_index.find(in->nodes[q])->second : bdd_node::terminal_0;
+                            auto it = next_level.find(q);
+                            return it != next_level.end() ? it->second : bdd_node::terminal_0;
+                        };
+                        level.clear();
+                        for(size_t p=0; (p << (b-t)) < k; ++p)
                         {
-                            split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, bdd_node::terminal_0, bdd_node::terminal_1};
-                            split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i])); 
-                            ++nr_bdd_nodes_per_interval[i]; 
-
-                            const size_t next_i = interval(high_var);
-                            assert(split_bdd_node_indices.count({bdd.high, next_i}) > 0);
-                            const size_t next_high_idx = split_bdd_node_indices.find({bdd.high, next_i})->second;
-                            split_bdd_nodes(next_i, nr_bdd_nodes_per_interval[next_i]) = {bdd.variable, bdd_node::terminal_0, next_high_idx};
-                            ++nr_bdd_nodes_per_interval[next_i]; 
-
-                            duplicated_nodes.push_back({split_node{i, nr_bdd_nodes_per_interval[i]-1}, split_node{next_i, nr_bdd_nodes_per_interval[next_i]-1}});
+                            split_nodes.push_back({child(2*p), child(2*p+1), split_variable(*in, t)});
+                            level.insert({p, split_nodes.size()-1});
                         }
+                        std::swap(level, next_level);
                     }
-                    else
-                    {
-                        assert(bdd.high == bdd_node::terminal_0);
-                        const size_t low_var = bdd_nodes_[bdd.low].variable;
-                        if(interval(bdd.variable) == interval(low_var)) // case (iii)
-                        {
-                            assert(split_bdd_node_indices.count({bdd.low,i}) > 0);
-                            const size_t low_idx = split_bdd_node_indices.find({bdd.high,i})->second;
-                            split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, low_idx, bdd_node::terminal_0};
-                            split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i])); 
-                            ++nr_bdd_nodes_per_interval[i]; 
-                        }
-                        else // case (iv)
-                        {
-                            split_bdd_nodes(i, nr_bdd_nodes_per_interval[i]) = {bdd.variable, bdd_node::terminal_1, bdd_node::terminal_0};
-                            split_bdd_node_indices.insert(std::make_pair(std::array<size_t,2>{bdd_node_counter, i}, nr_bdd_nodes_per_interval[i])); 
-                            ++nr_bdd_nodes_per_interval[i]; 
-
-                            const size_t next_i = interval(low_var);
-                            assert(split_bdd_node_indices.count({bdd.low, next_i}) > 0);
-                            const size_t next_low_idx = split_bdd_node_indices.find({bdd.low, next_i})->second;
-                            split_bdd_nodes(next_i, nr_bdd_nodes_per_interval[next_i]) = {bdd.variable, next_low_idx, bdd_node::terminal_0};
-                            ++nr_bdd_nodes_per_interval[next_i]; 
-
-                            duplicated_nodes.push_back({split_node{i, nr_bdd_nodes_per_interval[i]-1}, split_node{next_i, nr_bdd_nodes_per_interval[next_i]-1}});
-                        }
-                    } 
+                    assert(next_level.size() == 1);
+                    for(size_t t=0; t<b; ++t)
+                        left_split_variables[piece_interval].push_back(split_variable(*in, t));
                 }
+
+                split_delimiters.push_back(split_nodes.size());
             }
-            // go over each affected interval and set new bdd delimiter values
-            active_intervals.clear();
-            for(auto bdd_node_counter=bdd_delimiters_[bdd_counter]; bdd_node_counter<bdd_delimiters_[bdd_counter+1]; ++bdd_node_counter)
-            {
-                const auto& bdd = bdd_nodes_[bdd_node_counter];
-                active_intervals.insert(interval(bdd.variable));
-            }
-            for(const size_t i : active_intervals)
-                split_bdd_delimiters(i, nr_bdds_per_inteval[i]++) = nr_bdd_nodes_per_interval[i];
         }
 
-        return {split_bdd_nodes, split_bdd_delimiters};
+        bdd_nodes_ = std::move(split_nodes);
+        bdd_delimiters_ = std::move(split_delimiters);
+        nr_variables_ += nr_split_variables_total;
+        for(const auto& bdd : bdd_nodes_)
+            check_node_valid(bdd);
+
+        for(auto& vars : left_split_variables)
+            std::sort(vars.begin(), vars.end());
+        for(auto& vars : right_split_variables)
+            std::sort(vars.begin(), vars.end());
+        d.left_split_variables = two_dim_variable_array<size_t>(left_split_variables);
+        d.right_split_variables = two_dim_variable_array<size_t>(right_split_variables);
+
+        interval_boundaries.clear();
+        intervals.clear();
+
+        return d;
     }
 
 } // namespace LPMP
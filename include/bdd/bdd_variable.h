@@ -16,7 +16,6 @@ namespace LPMP {
             bool is_first_bdd_variable() const { return prev == nullptr; }
             bool is_last_bdd_variable() const { return next == nullptr; }
             // bool is_initial_state() const { return *this == bdd_variable<DERIVED>{}; }
-            friend bool operator==(const bdd_variable_base<DERIVED>&, const bdd_variable_base<DERIVED>&);
     };
 
     template<typename DERIVED>
@@ -4,13 +4,14 @@
 #include "bdd.h"
 //#include "cuddObj.hh"
 #include "hash_helper.hxx"
+#include <tsl/robin_map.h>
 #include <iostream>
-#include <unordered_map>
 #include <numeric>
 #include <tuple>
 
 namespace LPMP {
 
+    // Not thread safe, use one converter and bdd_mgr per thread.
     class bdd_converter {
         public:
             bdd_converter(BDD::bdd_mgr& bdd_mgr) : bdd_mgr_(bdd_mgr) 
@@ -19,58 +20,69 @@ namespace LPMP {
             template<typename LEFT_HAND_SIDE_ITERATOR>
                 BDD::node_ref convert_to_bdd(LEFT_HAND_SIDE_ITERATOR begin, LEFT_HAND_SIDE_ITERATOR end, const inequality_type ineq, const int right_hand_side);
 
-            BDD::node_ref convert_to_bdd(const std::vector<int> coefficients, const inequality_type ineq, const int right_hand_side); 
+            BDD::node_ref convert_to_bdd(const std::vector<int>& coefficients, const inequality_type ineq, const int right_hand_side); 
 
         private:
-            // returned vector has as its first element the right hand side, then follow the coefficients
+            // writes into nf_ the right hand side, then the coefficients
             template<typename COEFF_ITERATOR>
-                static std::tuple< std::vector<int>, inequality_type >
-                normal_form(COEFF_ITERATOR begin, COEFF_ITERATOR end, const inequality_type ineq, const int right_hand_side);
+                inequality_type normal_form(COEFF_ITERATOR begin, COEFF_ITERATOR end, const inequality_type ineq, const int right_hand_side);
 
             BDD::node_ref convert_to_bdd_impl(std::vector<int>& nf, const inequality_type ineq);
 
+            // hashes the normal form in place, lookups do not copy it
+            struct normal_form_hash {
+                std::size_t operator()(const std::vector<int>& nf) const
+                {
+                    assert(nf.size() > 0);
+                    std::size_t h = std::hash<int>()(nf[0]);
+                    for(std::size_t i=1; i<nf.size(); ++i)
+                        h = hash::hash_combine(h, std::hash<int>()(nf[i]));
+                    return h;
+                }
+            };
+
             BDD::bdd_mgr& bdd_mgr_;
-            using constraint_cache_type = std::unordered_map<std::vector<int>,BDD::node_ref>;
+            // normal form, reused across constraints and modified in place during recursion
+            std::vector<int> nf_;
+            using constraint_cache_type = tsl::robin_map<std::vector<int>, BDD::node_ref, normal_form_hash, std::equal_to<std::vector<int>>, std::allocator<std::pair<std::vector<int>, BDD::node_ref>>, true>;
             constraint_cache_type equality_cache;
             constraint_cache_type lower_equal_cache;
     };
 
     template<typename COEFF_ITERATOR>
-        std::tuple< std::vector<int>, inequality_type >
-        bdd_converter::normal_form(COEFF_ITERATOR begin, COEFF_ITERATOR end, const inequality_type ineq, const int right_hand_side)
+        inequality_type bdd_converter::normal_form(COEFF_ITERATOR begin, COEFF_ITERATOR end, const inequality_type ineq, const int right_hand_side)
         {
             assert(std::distance(begin,end) >= 1);
             int d = std::gcd(right_hand_side, *begin);
             for(auto it = begin+1; it != end; ++it)
                 d = std::gcd(d, *it);
 
-            std::vector<int> c;
-            c.reserve(std::distance(begin, end) + 1);
-            c.push_back(right_hand_side/d);
+            nf_.clear();
+            nf_.push_back(right_hand_side/d);
             for(auto it = begin; it != end; ++it)
-                c.push_back(*it/d);
+                nf_.push_back(*it/d);
 
             if(ineq == inequality_type::greater_equal)
-                for(auto& x : c)
-                    x *= -1.0;
+                for(auto& x : nf_)
+                    x *= -1;
 
-            return {c, ineq != inequality_type::greater_equal ? ineq : inequality_type::smaller_equal};
+            return ineq != inequality_type::greater_equal ? ineq : inequality_type::smaller_equal;
         }
 
     template<typename LEFT_HAND_SIDE_ITERATOR>
         BDD::node_ref bdd_converter::convert_to_bdd(LEFT_HAND_SIDE_ITERATOR begin, LEFT_HAND_SIDE_ITERATOR end, const inequality_type ineq, const int right_hand_side)
         {
-            auto [nf, ineq_nf] = normal_form(begin, end, ineq, right_hand_side);
-            return convert_to_bdd_impl(nf, ineq_nf); 
+            const inequality_type ineq_nf = normal_form(begin, end, ineq, right_hand_side);
+            return convert_to_bdd_impl(nf_, ineq_nf); 
         }
 
-    BDD::node_ref bdd_converter::convert_to_bdd(const std::vector<int> coefficients, const inequality_type ineq, const int right_hand_side)
+    inline BDD::node_ref bdd_converter::convert_to_bdd(const std::vector<int>& coefficients, const inequality_type ineq, const int right_hand_side)
         {
             return convert_to_bdd(coefficients.begin(), coefficients.end(), ineq, right_hand_side);
         }
 
 
-    BDD::node_ref bdd_converter::convert_to_bdd_impl(std::vector<int>& nf, const inequality_type ineq)
+    inline BDD::node_ref bdd_converter::convert_to_bdd_impl(std::vector<int>& nf, const inequality_type ineq)
         {
             assert(nf.size() > 0);
             const int right_hand_side = nf[0];
@@ -134,10 +146,10 @@ namespace LPMP {
             // record bdd in cache
             switch(ineq) {
                 case inequality_type::equal: 
-                    equality_cache.insert(std::make_pair(nf,bdd));
+                    equality_cache.insert({nf,bdd});
                     break;
                 case inequality_type::smaller_equal:
-                    lower_equal_cache.insert(std::make_pair(nf,bdd));
+                    lower_equal_cache.insert({nf,bdd});
                     break;
                 case inequality_type::greater_equal:
                     throw std::runtime_error("greater equal constraint not in normal form");
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "config.hxx"
+#include <array>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+namespace LPMP {
+
+    // Vectorized approximations of exp and log for arrays of doubles, used in the smoothed (log-sum-exp) passes over bdds.
+    // The degree of the polynomials trades speed against accuracy:
+    // exp: x = k*ln2 + r with |r| <= ln2/2. exp(r) is evaluated by its Taylor polynomial of degree d and 2^k by writing k into the exponent bits.
+    //      Relative error is at most e^{ln2/2} (ln2/2)^{d+1}/(d+1)! plus rounding: 3.4e-6 for d=5, 7.3e-9 for d=7, 9.7e-12 for d=9, 8.9e-15 for d=11.
+    //      Arguments are clamped to [-708,709], in particular exp(-inf) is a tiny positive number instead of 0.
+    // log: x = 2^e m with m in [sqrt(1/2),sqrt(2)). log(m) = 2 atanh(s) with s = (m-1)/(m+1) is evaluated by the series of atanh up to s^{2d+1}.
+    //      Absolute error is at most 2|s|^{2d+3}/(2d+3)/(1-s^2) with |s| <= 0.1716 plus rounding: 2.9e-8 for d=3, 1.8e-11 for d=5, 4.5e-13 for d=6.
+    //      Only valid for positive normalized arguments.
+    constexpr std::size_t max_exp_log_approximation_degree = 16;
+
+    namespace detail {
+
+        using exp_log_vector = simdpp::float64<4>;
+        using exp_log_bits = simdpp::uint64<4>;
+        constexpr std::size_t exp_log_vector_size = 4;
+
+        // 1/i!
+        constexpr std::array<double, max_exp_log_approximation_degree+1> exp_coefficients = {
+            1.0, 1.0, 1.0/2.0, 1.0/6.0, 1.0/24.0, 1.0/120.0, 1.0/720.0, 1.0/5040.0, 1.0/40320.0, 1.0/362880.0, 1.0/3628800.0,
+            1.0/39916800.0, 1.0/479001600.0, 1.0/6227020800.0, 1.0/87178291200.0, 1.0/1307674368000.0, 1.0/20922789888000.0
+        };
+
+        // 2/(2i+1)
+        constexpr std::array<double, max_exp_log_approximation_degree+1> log_coefficients = {
+            2.0, 2.0/3.0, 2.0/5.0, 2.0/7.0, 2.0/9.0, 2.0/11.0, 2.0/13.0, 2.0/15.0, 2.0/17.0,
+            2.0/19.0, 2.0/21.0, 2.0/23.0, 2.0/25.0, 2.0/27.0, 2.0/29.0, 2.0/31.0, 2.0/33.0
+        };
+
+        // ln2 split into a part with zero trailing bits such that k*ln2_hi is exact
+        constexpr double ln2_hi = 6.93147180369123816490e-01;
+        constexpr double ln2_lo = 1.90821492927058770002e-10;
+        constexpr double log2e = 1.44269504088896338700e+00;
+
+        inline exp_log_vector exp_approximation(const exp_log_vector x_in, const std::size_t degree)
+        {
+            const exp_log_vector lower = simdpp::splat(-708.0);
+            const exp_log_vector upper = simdpp::splat(709.0);
+            const exp_log_vector x = simdpp::min(simdpp::max(x_in, lower), upper);
+
+            // adding 1.5*2^52 rounds to the nearest integer k, which then sits in the low mantissa bits
+            const exp_log_vector shift = simdpp::splat(6755399441055744.0);
+            const exp_log_vector t = x * exp_log_vector(simdpp::splat(log2e)) + shift;
+            const exp_log_vector k = t - shift;
+            const exp_log_vector r = (x - k * exp_log_vector(simdpp::splat(ln2_hi))) - k * exp_log_vector(simdpp::splat(ln2_lo));
+
+            exp_log_vector p = simdpp::splat(exp_coefficients[degree]);
+            for(std::ptrdiff_t i=std::ptrdiff_t(degree)-1; i>=0; --i)
+                p = p * r + exp_log_vector(simdpp::splat(exp_coefficients[i]));
+
+            // 2^k: biased exponent k+1023 shifted into the exponent field, higher bits of t drop out
+            const exp_log_bits bias = simdpp::splat(std::uint64_t(1023));
+            const exp_log_bits scale = simdpp::shift_l<52>(exp_log_bits(simdpp::bit_cast<exp_log_bits>(t) + bias));
+            return p * simdpp::bit_cast<exp_log_vector>(scale);
+        }
+
+        inline exp_log_vector log_approximation(const exp_log_vector x, const std::size_t degree)
+        {
+            const exp_log_bits bits = simdpp::bit_cast<exp_log_bits>(x);
+            const exp_log_bits mantissa_mask = simdpp::splat(std::uint64_t(0x000FFFFFFFFFFFFF));
+            const exp_log_bits one_bits = simdpp::splat(std::uint64_t(0x3FF0000000000000)); // 1.0
+            const exp_log_bits two52_bits = simdpp::splat(std::uint64_t(0x4330000000000000)); // 2^52
+
+            // x = 2^e m with m in [1,2). e+1023 is read as a double by placing it into the mantissa of 2^52
+            exp_log_vector m = simdpp::bit_cast<exp_log_vector>(exp_log_bits((bits & mantissa_mask) | one_bits));
+            exp_log_vector e = simdpp::bit_cast<exp_log_vector>(exp_log_bits(simdpp::shift_r<52>(bits) | two52_bits));
+            e = e - exp_log_vector(simdpp::splat(4503599627371519.0)); // 2^52 + 1023
+
+            // move m into [sqrt(1/2), sqrt(2))
+            const exp_log_vector one = simdpp::splat(1.0);
+            const auto large = simdpp::cmp_gt(m, exp_log_vector(simdpp::splat(1.41421356237309504880)));
+            m = simdpp::blend(exp_log_vector(m * exp_log_vector(simdpp::splat(0.5))), m, large);
+            e = simdpp::blend(exp_log_vector(e + one), e, large);
+
+            const exp_log_vector s = simdpp::div(exp_log_vector(m - one), exp_log_vector(m + one));
+            const exp_log_vector s2 = s * s;
+            exp_log_vector p = simdpp::splat(log_coefficients[degree]);
+            for(std::ptrdiff_t i=std::ptrdiff_t(degree)-1; i>=0; --i)
+                p = p * s2 + exp_log_vector(simdpp::splat(log_coefficients[i]));
+
+            return e * exp_log_vector(simdpp::splat(ln2_hi)) + (s * p + e * exp_log_vector(simdpp::splat(ln2_lo)));
+        }
+
+        // apply f to [begin,end) in place, the remainder of the last vector is padded with pad
+        template<typename F>
+        void apply_vectorized(double* begin, double* end, const double pad, F f)
+        {
+            assert(begin <= end);
+            const std::size_t n = std::distance(begin, end);
+            std::size_t i = 0;
+            for(; i+exp_log_vector_size <= n; i+=exp_log_vector_size) {
+                const exp_log_vector x = simdpp::load_u(begin + i);
+                simdpp::store_u(begin + i, f(x));
+            }
+            if(i < n) {
+                std::array<double, exp_log_vector_size> tail;
+                tail.fill(pad);
+                std::copy(begin + i, end, tail.begin());
+                const exp_log_vector x = simdpp::load_u(tail.data());
+                simdpp::store_u(tail.data(), f(x));
+                std::copy(tail.begin(), tail.begin() + (n-i), begin + i);
+            }
+        }
+
+    }
+
+    // replace each entry of [begin,end) by its exponential
+    inline void exp_approximation(double* begin, double* end, const std::size_t degree)
+    {
+        assert(degree <= max_exp_log_approximation_degree);
+        detail::apply_vectorized(begin, end, 0.0, [degree](const detail::exp_log_vector x) { return detail::exp_approximation(x, degree); });
+    }
+
+    // replace each entry of [begin,end) by its natural logarithm
+    inline void log_approximation(double* begin, double* end, const std::size_t degree)
+    {
+        assert(degree <= max_exp_log_approximation_degree);
+        detail::apply_vectorized(begin, end, 1.0, [degree](const detail::exp_log_vector x) { return detail::log_approximation(x, degree); });
+    }
+
+}
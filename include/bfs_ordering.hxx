@@ -3,6 +3,7 @@
 #include "two_dimensional_variable_array.hxx"
 #include "pseudo_peripheral_node.hxx"
 #include "permutation.hxx"
+#include "clique_graph.hxx"
 #include <limits>
 #include <vector>
 #include <queue>
@@ -113,4 +114,133 @@ namespace LPMP {
         assert(is_permutation(ordering.begin(), ordering.end()));
         return ordering; 
     }
+
+    // Same on the cliques of the graph, each clique is expanded once per search.
+    // Terminals are decided in forward search order from per clique maximum distances and whether a clique already contains a terminal.
+    // The average distance of neighbors is taken over clique members, i.e. neighbors sharing several cliques count repeatedly.
+    inline permutation bfs_ordering(const clique_graph& g)
+    {
+        struct node
+        {
+            node(std::size_t index, std::size_t dist, double avg_adj_dist) : 
+                index_(index), dist_(dist), avg_adj_dist_(avg_adj_dist)
+            {}
+
+            bool operator <(node const & other) const
+            {
+                if (dist_ != other.dist_)
+                    return dist_ < other.dist_;
+                else
+                    return avg_adj_dist_ < other.avg_adj_dist_;
+            }
+
+            std::size_t index_;
+            std::size_t dist_;
+            double avg_adj_dist_;
+        };
+
+        permutation ordering(g.size());
+
+        std::queue<std::size_t> Q;
+        std::vector<std::size_t> dist(g.size(), std::numeric_limits<std::size_t>::max());
+        std::vector<char> seen(g.size(), 0);
+        std::vector<char> placed(g.size(), 0);
+        std::vector<char> clique_expanded(g.nr_cliques(), 0);
+        std::vector<char> clique_placed(g.nr_cliques(), 0);
+        std::vector<char> clique_has_terminal(g.nr_cliques(), 0);
+        std::vector<std::size_t> clique_max_dist(g.nr_cliques(), 0);
+        std::vector<double> clique_dist_sum(g.nr_cliques(), 0.0);
+        std::size_t pos = g.size()-1;
+
+        auto avg_adj_dist = [&](const std::size_t i) {
+            double sum = 0.0;
+            std::size_t nr = 0;
+            for(const std::size_t c : g.cliques(i)) {
+                sum += clique_dist_sum[c] - dist[i];
+                nr += g.clique(c).size() - 1;
+            }
+            return nr > 0 ? sum / double(nr) : 0.0;
+        };
+
+        std::vector<std::size_t> pseudo_peripheral_nodes = find_pseudo_peripheral_nodes(g);
+
+        // loop over connected components
+        for (size_t s : pseudo_peripheral_nodes)
+        {
+            // forward run of BFS from source to determine distances
+            std::vector<std::size_t> bfs_order;
+            Q.push(s);
+            seen[s] = 1;
+            dist[s] = 0;
+            while (!Q.empty())
+            {
+                const std::size_t i = Q.front();
+                Q.pop();
+                bfs_order.push_back(i);
+                for(const std::size_t c : g.cliques(i)) {
+                    if(clique_expanded[c])
+                        continue;
+                    clique_expanded[c] = 1;
+                    for(const std::size_t j : g.clique(c)) {
+                        if (seen[j])
+                            continue;
+                        seen[j] = 1;
+                        dist[j] = dist[i] + 1;
+                        Q.push(j);
+                    }
+                }
+            }
+
+            for(const std::size_t i : bfs_order) {
+                for(const std::size_t c : g.cliques(i)) {
+                    clique_max_dist[c] = std::max(clique_max_dist[c], dist[i]);
+                    clique_dist_sum[c] += dist[i];
+                }
+            }
+
+            // terminals of search tree: no neighbor is farther from source and no neighbor visited before is a terminal
+            std::vector<std::size_t> terminals;
+            for(const std::size_t i : bfs_order) {
+                bool terminal = true;
+                for(const std::size_t c : g.cliques(i))
+                    if(clique_max_dist[c] > dist[i] || clique_has_terminal[c])
+                        terminal = false;
+                if(terminal) {
+                    terminals.push_back(i);
+                    for(const std::size_t c : g.cliques(i))
+                        clique_has_terminal[c] = 1;
+                }
+            }
+
+            std::priority_queue<node> dist_queue;
+            for(const std::size_t t : terminals) {
+                dist_queue.emplace(t, dist[t], avg_adj_dist(t));
+                placed[t] = 1;
+            }
+
+            // backward run of BFS from all terminals, ordering vertices in decreasing distance from source
+            while(!dist_queue.empty()) {
+
+                const auto next = dist_queue.top();
+                dist_queue.pop();
+                const auto i = next.index_;
+                ordering[pos--] = i;
+
+                for(const std::size_t c : g.cliques(i)) {
+                    if(clique_placed[c])
+                        continue;
+                    clique_placed[c] = 1;
+                    for(const std::size_t j : g.clique(c)) {
+                        if (placed[j])
+                            continue;
+                        dist_queue.emplace(j, dist[j], avg_adj_dist(j));
+                        placed[j] = 1;
+                    }
+                }
+            }
+        }
+
+        assert(is_permutation(ordering.begin(), ordering.end()));
+        return ordering; 
+    }
 }
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "two_dimensional_variable_array.hxx"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cassert>
+#include <omp.h>
+
+namespace LPMP {
+
+// Graph given implicitly as union of cliques, e.g. variables that are adjacent when they share a constraint.
+// Adjacency lists of dense cliques grow quadratically, hence orderings (bfs_ordering, Cuthill_McKee, minimum_degree_ordering) work directly on the cliques:
+// a breadth first search expands each clique once, after which all its nodes are reached.
+class clique_graph {
+public:
+    clique_graph() {}
+    // each clique is a list of nodes < nr_nodes, nodes may occur repeatedly in a clique
+    clique_graph(const std::size_t nr_nodes, two_dim_variable_array<std::size_t>&& cliques);
+
+    std::size_t size() const { return node_cliques_.size(); }
+    std::size_t nr_cliques() const { return cliques_.size(); }
+    auto clique(const std::size_t c) const { assert(c < nr_cliques()); return cliques_[c]; }
+    // cliques containing node
+    auto cliques(const std::size_t node) const { assert(node < size()); return node_cliques_[node]; }
+
+    // sum of clique sizes minus one over the cliques of node, upper bound on the degree
+    std::size_t degree_bound(const std::size_t node) const;
+
+    // explicit adjacency lists with sorted neighbors and without self loops, computed in parallel
+    two_dim_variable_array<std::size_t> adjacency() const;
+
+private:
+    two_dim_variable_array<std::size_t> cliques_;
+    two_dim_variable_array<std::size_t> node_cliques_;
+};
+
+inline clique_graph::clique_graph(const std::size_t nr_nodes, two_dim_variable_array<std::size_t>&& cliques)
+    : cliques_(std::move(cliques))
+{
+    std::vector<std::size_t> nr_node_cliques(nr_nodes, 0);
+    for(std::size_t c=0; c<cliques_.size(); ++c) {
+        for(const std::size_t i : cliques_[c]) {
+            assert(i < nr_nodes);
+            ++nr_node_cliques[i];
+        }
+    }
+
+    node_cliques_ = two_dim_variable_array<std::size_t>(nr_node_cliques.begin(), nr_node_cliques.end());
+    std::fill(nr_node_cliques.begin(), nr_node_cliques.end(), 0);
+    for(std::size_t c=0; c<cliques_.size(); ++c) {
+        for(const std::size_t i : cliques_[c]) {
+            // repeated nodes in a clique are recorded once
+            if(nr_node_cliques[i] > 0 && node_cliques_(i, nr_node_cliques[i]-1) == c)
+                continue;
+            node_cliques_(i, nr_node_cliques[i]++) = c;
+        }
+    }
+
+    // drop slots of repeated nodes
+    bool repeated = false;
+    for(std::size_t i=0; i<nr_nodes; ++i)
+        repeated |= nr_node_cliques[i] != node_cliques_[i].size();
+    if(repeated) {
+        two_dim_variable_array<std::size_t> node_cliques(nr_node_cliques.begin(), nr_node_cliques.end());
+        for(std::size_t i=0; i<nr_nodes; ++i)
+            std::copy(node_cliques_[i].begin(), node_cliques_[i].begin() + nr_node_cliques[i], node_cliques[i].begin());
+        std::swap(node_cliques_, node_cliques);
+    }
+}
+
+inline std::size_t clique_graph::degree_bound(const std::size_t node) const
+{
+    std::size_t d = 0;
+    for(const std::size_t c : cliques(node))
+        d += clique(c).size() - 1;
+    return d;
+}
+
+// Two passes over the cliques of each node, the first one counts distinct neighbors, the second one writes them.
+// Each thread marks neighbors already seen for the current node in its own array.
+inline two_dim_variable_array<std::size_t> clique_graph::adjacency() const
+{
+    const std::size_t n = size();
+    std::vector<std::size_t> degree(n);
+
+    auto for_each_neighbor = [&](const std::size_t i, std::vector<std::size_t>& mark, auto f) {
+        mark[i] = i;
+        for(const std::size_t c : cliques(i)) {
+            for(const std::size_t j : clique(c)) {
+                if(mark[j] != i) {
+                    mark[j] = i;
+                    f(j);
+                }
+            }
+        }
+    };
+
+#pragma omp parallel
+    {
+        std::vector<std::size_t> mark(n, std::numeric_limits<std::size_t>::max());
+#pragma omp for schedule(dynamic, 64)
+        for(std::size_t i=0; i<n; ++i) {
+            std::size_t d = 0;
+            for_each_neighbor(i, mark, [&](const std::size_t) { ++d; });
+            degree[i] = d;
+        }
+    }
+
+    two_dim_variable_array<std::size_t> adj(degree.begin(), degree.end());
+
+#pragma omp parallel
+    {
+        std::vector<std::size_t> mark(n, std::numeric_limits<std::size_t>::max());
+#pragma omp for schedule(dynamic, 64)
+        for(std::size_t i=0; i<n; ++i) {
+            std::size_t k = 0;
+            for_each_neighbor(i, mark, [&](const std::size_t j) { adj(i, k++) = j; });
+            assert(k == adj[i].size());
+            std::sort(adj[i].begin(), adj[i].end());
+        }
+    }
+
+    return adj;
+}
+
+}
@@ -18,14 +18,19 @@
 namespace LPMP {
 
    // data types for all floating point/integer operations 
-   // float is inaccurate for large problems and I observed oscillation. Possibly, some sort of numerical stabilization needs to be employed
-   //using REAL = float;
-   //constexpr std::size_t REAL_ALIGNMENT = 8;
-   //using REAL_VECTOR = simdpp::float32<REAL_ALIGNMENT>;
-
+   // With LPMP_SINGLE_PRECISION defined (link against LPMP_single_precision), potentials, messages and weights are stored as float.
+   // Lower bounds, primal costs and the LP constant are accumulated in double.
+   // Plain float is inaccurate for large problems and oscillates, since potentials grow during optimization and small message updates are lost.
+   // Therefore factors' potentials are normalized after each pass, see LP::normalize_potentials.
+#ifdef LPMP_SINGLE_PRECISION
+   using REAL = float;
+   constexpr std::size_t REAL_ALIGNMENT = 8;
+   using REAL_VECTOR = simdpp::float32<REAL_ALIGNMENT>;
+#else
    using REAL = double;
    constexpr std::size_t REAL_ALIGNMENT = 4;
    using REAL_VECTOR = simdpp::float64<REAL_ALIGNMENT>;
+#endif
 
    using INDEX = std::size_t;
    using UNSIGNED_INDEX = INDEX;
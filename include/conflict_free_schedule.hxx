@@ -0,0 +1,64 @@
+#ifndef LPMP_CONFLICT_FREE_SCHEDULE_HXX
+#define LPMP_CONFLICT_FREE_SCHEDULE_HXX
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <tsl/robin_map.h>
+#include "two_dimensional_variable_array.hxx"
+#include "factor_container_interface.h"
+
+namespace LPMP {
+
+// Partition a sequence of factor updates into levels such that factors in the same level can be updated concurrently.
+// Updating a factor reads the potentials of its adjacent factors and changes the messages between itself and them.
+// Hence two updates conflict iff the factors are adjacent or share an adjacent factor. Each factor is put into the level one after the last level of an earlier conflicting factor.
+// Conflicting factors therefore keep their relative order and updates in the same level commute, so processing the levels in order gives exactly the result of the serial pass.
+// Returned levels hold positions into [update_begin, update_end), ascending within each level.
+template<typename FACTOR_ITERATOR>
+two_dim_variable_array<std::size_t> compute_conflict_free_schedule(FACTOR_ITERATOR update_begin, FACTOR_ITERATOR update_end)
+{
+   const std::size_t n = std::distance(update_begin, update_end);
+
+   // last level of an update that touched the given factor, i.e. updated it or one of its neighbors
+   tsl::robin_map<const FactorTypeAdapter*, std::size_t> last_level;
+   last_level.reserve(2*n);
+
+   std::vector<std::size_t> level(n);
+   std::size_t no_levels = 0;
+   for(std::size_t i=0; i<n; ++i) {
+      const FactorTypeAdapter* f = *(update_begin + i);
+      const auto msgs = f->get_messages();
+
+      std::size_t l = 0;
+      auto update_level = [&](const FactorTypeAdapter* g) {
+         auto it = last_level.find(g);
+         if(it != last_level.end()) {
+            l = std::max(l, it->second + 1);
+         }
+      };
+      update_level(f);
+      for(const auto& m : msgs) { update_level(m.adjacent_factor); }
+
+      last_level[f] = l;
+      for(const auto& m : msgs) { last_level[m.adjacent_factor] = l; }
+
+      level[i] = l;
+      no_levels = std::max(no_levels, l+1);
+   }
+
+   std::vector<std::size_t> level_size(no_levels, 0);
+   for(const auto l : level) { ++level_size[l]; }
+
+   two_dim_variable_array<std::size_t> schedule(level_size.begin(), level_size.end());
+   std::fill(level_size.begin(), level_size.end(), 0);
+   for(std::size_t i=0; i<n; ++i) {
+      schedule(level[i], level_size[level[i]]++) = i;
+   }
+
+   return schedule;
+}
+
+} // namespace LPMP
+
+#endif // LPMP_CONFLICT_FREE_SCHEDULE_HXX
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "cut_base_instance.hxx"
+#include "parse_cursor.hxx"
+#include "mapped_file.hxx"
+#include <vector>
+#include <cstring>
+#include <omp.h>
+
+// Reader for edge lists as in cut_base_text_input.hxx, multicut_text_input.cpp and asymmetric_multiway_cut_parser.cpp without going through PEGTL.
+// Files are memory mapped, the edge section is cut at line breaks into chunks, which are parsed in parallel and appended to the instance in input order.
+
+namespace LPMP {
+
+    namespace cut_base_edge_list_reader {
+
+        // ignore_line: comment or empty line
+        inline const char* ignore_line(const parsing::cursor& c, const char* p)
+        {
+            const char* q = c.blanks(p);
+            if(q < c.end && (*q == 'c' || *q == '#'))
+                return c.until_eolf(q+1);
+            return c.eolf(q);
+        }
+
+        // star<ignore_line>
+        inline const char* ignore_lines(const parsing::cursor& c, const char* p)
+        {
+            while(p < c.end) {
+                const char* q = ignore_line(c, p);
+                if(!q)
+                    break;
+                p = q;
+            }
+            return p;
+        }
+
+        // edge_line: $vertex_1 $vertex_2 $cost
+        inline const char* edge_line(const parsing::cursor& c, const char* p, std::size_t& i, std::size_t& j, double& cost)
+        {
+            const char* i_begin = c.blanks(p);
+            const char* i_end = c.positive_integer(i_begin);
+            if(!i_end)
+                return nullptr;
+            const char* j_begin = c.mand_blanks(i_end);
+            if(!j_begin)
+                return nullptr;
+            const char* j_end = c.positive_integer(j_begin);
+            if(!j_end)
+                return nullptr;
+            const char* cost_begin = c.mand_blanks(j_end);
+            if(!cost_begin)
+                return nullptr;
+            const char* cost_end = c.real_number(cost_begin);
+            if(!cost_end)
+                return nullptr;
+            const char* q = c.eolf(c.blanks(cost_end));
+            if(!q)
+                return nullptr;
+
+            i = parsing::to_size_t(i_begin, i_end);
+            j = parsing::to_size_t(j_begin, j_end);
+            cost = parsing::to_double(cost_begin, cost_end);
+            return q;
+        }
+
+        // first line start at or after p
+        inline const char* next_line(const char* begin, const char* end, const char* p)
+        {
+            if(p == begin)
+                return p;
+            const char* nl = static_cast<const char*>(std::memchr(p-1, '\n', end - (p-1)));
+            return nl ? nl+1 : end;
+        }
+
+        // star<sor<ignore_line, edge_line>> starting at begin, edge costs are multiplied with sign.
+        // Returns the start of the first line matching neither or end.
+        // nr_chunks = 0 chooses it from the input size and the number of threads.
+        template<typename CUT_INSTANCE>
+            const char* read_edges(const char* begin, const char* end, CUT_INSTANCE& instance, const double sign = 1.0, std::size_t nr_chunks = 0)
+            {
+                const parsing::cursor c{end};
+                if(nr_chunks == 0) {
+                    constexpr std::size_t min_chunk_size = 1 << 20;
+                    nr_chunks = std::min(std::size_t(4*omp_get_max_threads()), std::size_t(end - begin) / min_chunk_size + 1);
+                }
+
+                struct chunk {
+                    std::vector<cut_base_instance::weighted_edge> edges;
+                    const char* stop = nullptr; // first line not matching
+                };
+                std::vector<chunk> chunks(nr_chunks);
+                const std::size_t size = end - begin;
+
+#pragma omp parallel for schedule(dynamic)
+                for(std::size_t k=0; k<nr_chunks; ++k) {
+                    const char* p = next_line(begin, end, begin + k*size/nr_chunks);
+                    const char* chunk_end = next_line(begin, end, begin + (k+1)*size/nr_chunks);
+                    auto& ch = chunks[k];
+                    ch.edges.reserve((chunk_end - p) / 16);
+                    std::size_t i, j;
+                    double cost;
+                    while(p < chunk_end) {
+                        if(const char* q = edge_line(c, p, i, j, cost)) {
+                            ch.edges.push_back(cut_base_instance::weighted_edge(std::min(i,j), std::max(i,j), sign*cost));
+                            p = q;
+                        } else if(const char* q = ignore_line(c, p)) {
+                            p = q;
+                        } else {
+                            ch.stop = p;
+                            break;
+                        }
+                    }
+                }
+
+                // edges after the first non-matching line are not part of the edge section
+                const char* stop = end;
+                for(std::size_t k=0; k<nr_chunks; ++k) {
+                    if(chunks[k].stop) {
+                        stop = chunks[k].stop;
+                        chunks.resize(k+1);
+                        break;
+                    }
+                }
+
+                std::vector<std::vector<cut_base_instance::weighted_edge>> edge_batches;
+                edge_batches.reserve(chunks.size());
+                for(auto& ch : chunks)
+                    edge_batches.push_back(std::move(ch.edges));
+                instance.add_edges(std::move(edge_batches));
+
+                return stop;
+            }
+
+    }
+
+}
@@ -5,6 +5,8 @@
 #include <cassert>
 #include <algorithm>
 #include <stack>
+#include <tuple>
+#include <omp.h>
 #include "vector.hxx"
 #include "graph.hxx"
 #include "union_find.hxx"
@@ -31,12 +33,15 @@ namespace LPMP {
         };
 
         void add_edge(const std::size_t i, const std::size_t j, const double cost);
+        // edges with smaller node first, appended batch after batch and copied in parallel
+        void add_edges(std::vector<std::vector<weighted_edge>>&& edge_batches);
+        void reserve(const std::size_t nr_edges) { edges_.reserve(nr_edges); }
         const std::vector<weighted_edge>& edges() const { return edges_; }
         std::vector<weighted_edge>& edges() { return edges_; }
         std::size_t no_nodes() const { return no_nodes_; }
         std::size_t no_edges() const { return edges_.size(); }
 
-        void normalize(); // merge parallel edges
+        void normalize(); // merge parallel edges, in parallel
         bool normalized() const; // check if there are parallel edges
 
         auto begin() { return edges_.begin(); }
@@ -73,7 +78,9 @@ namespace LPMP {
             using std::vector<char>::vector;
 
             cut_base_edge_labeling(const cut_base_instance& instance, const cut_base_node_labeling& labeling);
-            cut_base_edge_labeling(const cut_base_instance& instance, union_find& uf);
+            // INSTANCE is cut_base_instance or a view with the same edges() interface
+            template<typename INSTANCE>
+                cut_base_edge_labeling(const INSTANCE& instance, union_find& uf);
     };
 
 
@@ -127,23 +134,84 @@ namespace LPMP {
         edges_.push_back(weighted_edge(std::min(i,j), std::max(i,j), cost));
     }
 
+    inline void cut_base_instance::add_edges(std::vector<std::vector<weighted_edge>>&& edge_batches)
+    {
+        std::vector<std::size_t> offsets = {edges_.size()};
+        for(const auto& batch : edge_batches)
+            offsets.push_back(offsets.back() + batch.size());
+        const bool move_batch = edges_.empty() && edge_batches.size() == 1;
+        if(move_batch)
+            std::swap(edges_, edge_batches[0]);
+        else
+            edges_.resize(offsets.back());
+
+        std::size_t max_node = no_nodes_;
+        std::size_t min_node = min_node_;
+#pragma omp parallel for schedule(dynamic) reduction(max:max_node) reduction(min:min_node)
+        for(std::size_t b=0; b<edge_batches.size(); ++b) {
+            if(!move_batch)
+                std::copy(edge_batches[b].begin(), edge_batches[b].end(), edges_.begin() + offsets[b]);
+            for(auto e_it=edges_.begin()+offsets[b]; e_it!=edges_.begin()+offsets[b+1]; ++e_it) {
+                const auto& e = *e_it;
+                assert(e[0] < e[1]);
+                max_node = std::max(max_node, e[1]+1);
+                min_node = std::min(min_node, e[0]);
+            }
+        }
+        no_nodes_ = max_node;
+        min_node_ = min_node;
+    }
+
+    // Blocks of edges are sorted in parallel and merged pairwise.
+    // Costs are part of the order, so that parallel edges are summed up in the same order independently of the number of threads.
     inline void cut_base_instance::normalize()
     {
-        // merge parallel edges
-        std::sort(edges_.begin(), edges_.end(), [](const auto& e1, const auto& e2) { 
-                return std::lexicographical_compare(e1.begin(), e1.end(), e2.begin(), e2.end());
-                });
-
-        std::vector<weighted_edge> normalized_edges; 
-
-        // merge matching edge copies and add them to edges
-        for(std::size_t k=0; k<edges_.size();) {
-            normalized_edges.push_back(edges_[k]);
-            ++k; 
-            while(k<edges_.size() && normalized_edges.back()[0] == edges_[k][0] && normalized_edges.back()[1] == edges_[k][1]) {
-                normalized_edges.back().cost[0] += edges_[k].cost[0];
-                ++k; 
+        auto edge_order = [](const weighted_edge& e1, const weighted_edge& e2) {
+            return std::make_tuple(e1[0], e1[1], e1.cost[0]) < std::make_tuple(e2[0], e2[1], e2.cost[0]);
+        };
+
+        const std::size_t nr_blocks = std::max(std::min(std::size_t(omp_get_max_threads()), edges_.size() / 4096), std::size_t(1));
+        auto block_begin = [&](const std::size_t b) { return edges_.begin() + std::min(b, nr_blocks) * edges_.size() / nr_blocks; };
+#pragma omp parallel for schedule(static)
+        for(std::size_t b=0; b<nr_blocks; ++b)
+            std::sort(block_begin(b), block_begin(b+1), edge_order);
+        for(std::size_t width=1; width<nr_blocks; width*=2) {
+#pragma omp parallel for schedule(dynamic)
+            for(std::size_t b=0; b<nr_blocks; b+=2*width)
+                if(b + width < nr_blocks)
+                    std::inplace_merge(block_begin(b), block_begin(b+width), block_begin(b+2*width), edge_order);
+        }
+
+        // merge matching edge copies, each block writes the runs starting in it
+        auto run_start = [&](const std::size_t k) {
+            return k == 0 || edges_[k-1][0] != edges_[k][0] || edges_[k-1][1] != edges_[k][1];
+        };
+        std::vector<std::size_t> nr_runs(nr_blocks+1, 0);
+#pragma omp parallel for schedule(static)
+        for(std::size_t b=0; b<nr_blocks; ++b)
+            for(std::size_t k=block_begin(b)-edges_.begin(); k<std::size_t(block_begin(b+1)-edges_.begin()); ++k)
+                nr_runs[b+1] += run_start(k);
+        for(std::size_t b=0; b<nr_blocks; ++b)
+            nr_runs[b+1] += nr_runs[b];
+
+        std::vector<weighted_edge> normalized_edges(nr_runs.back());
+#pragma omp parallel for schedule(static)
+        for(std::size_t b=0; b<nr_blocks; ++b) {
+            std::size_t r = nr_runs[b];
+            std::size_t k = block_begin(b)-edges_.begin();
+            const std::size_t block_end = block_begin(b+1)-edges_.begin();
+            while(k < block_end && !run_start(k))
+                ++k;
+            while(k < block_end) {
+                normalized_edges[r] = edges_[k];
+                ++k;
+                while(k < edges_.size() && !run_start(k)) {
+                    normalized_edges[r].cost[0] += edges_[k].cost[0];
+                    ++k;
+                }
+                ++r;
             }
+            assert(r == nr_runs[b+1]);
         }
 
         std::swap(normalized_edges, edges_); 
@@ -168,17 +236,18 @@ namespace LPMP {
                 s << e[0] << " " << e[1] << " " << e.cost << "\n";
         }
 
-    inline cut_base_edge_labeling::cut_base_edge_labeling(const cut_base_instance& instance, union_find& uf)
-    {
-        assert(instance.no_nodes() == uf.size());
-        this->reserve(instance.no_edges());
-        for(const auto& e : instance.edges()) {
-            if(uf.connected(e[0], e[1]))
-                this->push_back(0);
-            else
-                this->push_back(1);
+    template<typename INSTANCE>
+        cut_base_edge_labeling::cut_base_edge_labeling(const INSTANCE& instance, union_find& uf)
+        {
+            assert(instance.no_nodes() == uf.size());
+            this->reserve(instance.no_edges());
+            for(const auto& e : instance.edges()) {
+                if(uf.connected(e[0], e[1]))
+                    this->push_back(0);
+                else
+                    this->push_back(1);
+            }
         }
-    }
 
     inline cut_base_edge_labeling::cut_base_edge_labeling(const cut_base_instance& instance, const cut_base_node_labeling& labeling)
     {
@@ -0,0 +1,315 @@
+#pragma once
+
+#include "cut_base_instance.hxx"
+#include "mapped_file.hxx"
+#include <string>
+#include <memory>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+// Binary snapshot of a cut_base_instance: 32 bit node ids, edge costs as float or double and the adjacency in CSR format.
+// Loading maps the file and does no parsing, cut_base_snapshot is a read only view that solvers templated on the instance type can work on directly.
+// Edges are stored in the order of the instance written, so edge labelings computed on the snapshot refer to the same edges.
+
+namespace LPMP {
+
+    namespace detail {
+        struct cut_base_snapshot_header {
+            constexpr static char magic_value[8] = {'L','P','M','P','C','U','T','S'};
+            constexpr static std::uint32_t current_version = 1;
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t cost_size; // 4 for float, 8 for double
+            std::uint64_t nr_nodes;
+            std::uint64_t nr_edges;
+            double constant;
+        };
+
+        // sections start at multiples of 8 bytes
+        inline std::size_t cut_base_snapshot_padded(const std::size_t size) { return (size + 7) / 8 * 8; }
+    }
+
+    class cut_base_snapshot {
+        public:
+            // check = false only validates the header and the file size, the arrays are then trusted.
+            cut_base_snapshot(const std::string& filename, const bool check = true);
+
+            static void write(const cut_base_instance& instance, const std::string& filename, const bool single_precision = false);
+            // whether the file starts like a snapshot
+            static bool is_snapshot(const std::string& filename);
+
+            std::size_t no_nodes() const { return header_.nr_nodes; }
+            std::size_t no_edges() const { return header_.nr_edges; }
+            double constant() const { return header_.constant; }
+            bool single_precision() const { return header_.cost_size == sizeof(float); }
+
+            std::array<std::size_t,2> endpoints(const std::size_t e) const { assert(e < no_edges()); return {endpoints_[2*e], endpoints_[2*e+1]}; }
+            double cost(const std::size_t e) const
+            {
+                assert(e < no_edges());
+                if(single_precision())
+                    return reinterpret_cast<const float*>(costs_)[e];
+                return reinterpret_cast<const double*>(costs_)[e];
+            }
+
+            // edges are produced on the fly as cut_base_instance::weighted_edge, so code written against cut_base_instance::edges() can be reused
+            class edge_iterator {
+                public:
+                    using iterator_category = std::random_access_iterator_tag;
+                    using value_type = cut_base_instance::weighted_edge;
+                    using difference_type = std::ptrdiff_t;
+                    using pointer = void;
+                    using reference = value_type;
+
+                    edge_iterator(const cut_base_snapshot& s, const std::size_t e) : s_(&s), e_(e) {}
+                    value_type operator*() const { const auto ij = s_->endpoints(e_); return value_type(ij[0], ij[1], s_->cost(e_)); }
+                    value_type operator[](const difference_type d) const { return *(*this + d); }
+                    edge_iterator& operator++() { ++e_; return *this; }
+                    edge_iterator operator++(int) { edge_iterator it = *this; ++e_; return it; }
+                    edge_iterator& operator--() { --e_; return *this; }
+                    edge_iterator& operator+=(const difference_type d) { e_ += d; return *this; }
+                    edge_iterator operator+(const difference_type d) const { return edge_iterator(*s_, e_ + d); }
+                    edge_iterator operator-(const difference_type d) const { return edge_iterator(*s_, e_ - d); }
+                    difference_type operator-(const edge_iterator& o) const { return difference_type(e_) - difference_type(o.e_); }
+                    bool operator==(const edge_iterator& o) const { return e_ == o.e_; }
+                    bool operator!=(const edge_iterator& o) const { return e_ != o.e_; }
+                    bool operator<(const edge_iterator& o) const { return e_ < o.e_; }
+                private:
+                    const cut_base_snapshot* s_;
+                    std::size_t e_;
+            };
+
+            struct edge_range {
+                const cut_base_snapshot& s;
+                edge_iterator begin() const { return edge_iterator(s, 0); }
+                edge_iterator end() const { return edge_iterator(s, s.no_edges()); }
+                std::size_t size() const { return s.no_edges(); }
+                cut_base_instance::weighted_edge operator[](const std::size_t e) const { return *edge_iterator(s, e); }
+            };
+            edge_range edges() const { return edge_range{*this}; }
+
+            // CSR adjacency, neighbors of each node are sorted
+            template<typename T>
+                struct array_range {
+                    const T* b;
+                    const T* e;
+                    const T* begin() const { return b; }
+                    const T* end() const { return e; }
+                    std::size_t size() const { return e - b; }
+                    T operator[](const std::size_t k) const { assert(k < size()); return b[k]; }
+                };
+            std::size_t no_edges(const std::size_t i) const { assert(i < no_nodes()); return offsets_[i+1] - offsets_[i]; }
+            array_range<std::uint32_t> neighbors(const std::size_t i) const { assert(i < no_nodes()); return {adjacent_nodes_ + offsets_[i], adjacent_nodes_ + offsets_[i+1]}; }
+            // edge ids in the same order as neighbors(i)
+            array_range<std::uint32_t> incident_edges(const std::size_t i) const { assert(i < no_nodes()); return {adjacent_edges_ + offsets_[i], adjacent_edges_ + offsets_[i+1]}; }
+
+            double evaluate(const cut_base_edge_labeling& l) const;
+            double lower_bound() const;
+            bool graph_connected() const;
+
+            // copy into an owning instance, e.g. multicut_instance or max_cut_instance
+            template<typename INSTANCE>
+                INSTANCE instance() const;
+
+        private:
+            std::unique_ptr<mapped_file> file_;
+            detail::cut_base_snapshot_header header_;
+            const std::uint32_t* endpoints_;
+            const char* costs_;
+            const std::uint64_t* offsets_;
+            const std::uint32_t* adjacent_nodes_;
+            const std::uint32_t* adjacent_edges_;
+    };
+
+    // implementation
+
+    inline void cut_base_snapshot::write(const cut_base_instance& instance, const std::string& filename, const bool single_precision)
+    {
+        if(instance.no_nodes() > std::numeric_limits<std::uint32_t>::max() || instance.no_edges() > std::numeric_limits<std::uint32_t>::max())
+            throw std::runtime_error("instance too large for cut snapshot with 32 bit ids");
+
+        detail::cut_base_snapshot_header h;
+        std::memcpy(h.magic, h.magic_value, sizeof(h.magic));
+        h.version = h.current_version;
+        h.cost_size = single_precision ? sizeof(float) : sizeof(double);
+        h.nr_nodes = instance.no_nodes();
+        h.nr_edges = instance.no_edges();
+        h.constant = instance.constant();
+
+        const auto& edges = instance.edges();
+        std::vector<std::uint32_t> endpoints(2*edges.size());
+        std::vector<float> float_costs(single_precision ? edges.size() : 0);
+        std::vector<double> double_costs(single_precision ? 0 : edges.size());
+        std::vector<std::uint64_t> offsets(h.nr_nodes+1, 0);
+        for(std::size_t e=0; e<edges.size(); ++e) {
+            assert(edges[e][0] < h.nr_nodes && edges[e][1] < h.nr_nodes);
+            endpoints[2*e] = edges[e][0];
+            endpoints[2*e+1] = edges[e][1];
+            if(single_precision)
+                float_costs[e] = edges[e].cost[0];
+            else
+                double_costs[e] = edges[e].cost[0];
+            offsets[edges[e][0]+1]++;
+            offsets[edges[e][1]+1]++;
+        }
+        for(std::size_t i=0; i<h.nr_nodes; ++i)
+            offsets[i+1] += offsets[i];
+
+        std::vector<std::uint32_t> adjacent_nodes(offsets.back());
+        std::vector<std::uint32_t> adjacent_edges(offsets.back());
+        {
+            std::vector<std::uint64_t> fill(offsets.begin(), offsets.end()-1);
+            for(std::size_t e=0; e<edges.size(); ++e) {
+                const std::size_t i = edges[e][0];
+                const std::size_t j = edges[e][1];
+                adjacent_nodes[fill[i]] = j;
+                adjacent_edges[fill[i]++] = e;
+                adjacent_nodes[fill[j]] = i;
+                adjacent_edges[fill[j]++] = e;
+            }
+        }
+#pragma omp parallel for schedule(dynamic, 1024)
+        for(std::size_t i=0; i<h.nr_nodes; ++i) {
+            std::vector<std::array<std::uint32_t,2>> adjacency;
+            adjacency.reserve(offsets[i+1] - offsets[i]);
+            for(std::size_t k=offsets[i]; k<offsets[i+1]; ++k)
+                adjacency.push_back({adjacent_nodes[k], adjacent_edges[k]});
+            std::sort(adjacency.begin(), adjacency.end());
+            for(std::size_t k=offsets[i]; k<offsets[i+1]; ++k) {
+                adjacent_nodes[k] = adjacency[k - offsets[i]][0];
+                adjacent_edges[k] = adjacency[k - offsets[i]][1];
+            }
+        }
+
+        std::ofstream f(filename, std::ios::binary);
+        if(!f)
+            throw std::runtime_error("could not open " + filename + " for writing");
+        auto write_section = [&](const void* data, const std::size_t size) {
+            f.write(static_cast<const char*>(data), size);
+            const char padding[8] = {0};
+            f.write(padding, detail::cut_base_snapshot_padded(size) - size);
+        };
+        write_section(&h, sizeof(h));
+        write_section(endpoints.data(), endpoints.size() * sizeof(std::uint32_t));
+        if(single_precision)
+            write_section(float_costs.data(), float_costs.size() * sizeof(float));
+        else
+            write_section(double_costs.data(), double_costs.size() * sizeof(double));
+        write_section(offsets.data(), offsets.size() * sizeof(std::uint64_t));
+        write_section(adjacent_nodes.data(), adjacent_nodes.size() * sizeof(std::uint32_t));
+        write_section(adjacent_edges.data(), adjacent_edges.size() * sizeof(std::uint32_t));
+        if(!f)
+            throw std::runtime_error("could not write " + filename);
+    }
+
+    inline bool cut_base_snapshot::is_snapshot(const std::string& filename)
+    {
+        std::ifstream f(filename, std::ios::binary);
+        char magic[sizeof(detail::cut_base_snapshot_header::magic_value)];
+        return f.read(magic, sizeof(magic)) && std::memcmp(magic, detail::cut_base_snapshot_header::magic_value, sizeof(magic)) == 0;
+    }
+
+    inline cut_base_snapshot::cut_base_snapshot(const std::string& filename, const bool check)
+        : file_(std::make_unique<mapped_file>(filename))
+    {
+        const mapped_file& f = *file_;
+        auto invalid = [&]() { return std::runtime_error(filename + " is not a valid cut snapshot"); };
+
+        detail::cut_base_snapshot_header& h = header_;
+        if(f.size() < sizeof(h))
+            throw invalid();
+        std::memcpy(&h, f.data(), sizeof(h));
+        if(std::memcmp(h.magic, h.magic_value, sizeof(h.magic)) != 0 || (h.cost_size != sizeof(float) && h.cost_size != sizeof(double)))
+            throw invalid();
+        if(h.version != h.current_version)
+            throw std::runtime_error(filename + " has cut snapshot version " + std::to_string(h.version) + ", expected " + std::to_string(h.current_version));
+        if(h.nr_nodes > std::numeric_limits<std::uint32_t>::max() || h.nr_edges > std::numeric_limits<std::uint32_t>::max())
+            throw invalid();
+
+        using detail::cut_base_snapshot_padded;
+        const std::size_t endpoints_size = cut_base_snapshot_padded(2 * h.nr_edges * sizeof(std::uint32_t));
+        const std::size_t costs_size = cut_base_snapshot_padded(h.nr_edges * h.cost_size);
+        const std::size_t offsets_size = (h.nr_nodes + 1) * sizeof(std::uint64_t);
+        const std::size_t adjacency_size = cut_base_snapshot_padded(2 * h.nr_edges * sizeof(std::uint32_t));
+        if(f.size() != cut_base_snapshot_padded(sizeof(h)) + endpoints_size + costs_size + offsets_size + 2*adjacency_size)
+            throw invalid();
+
+        const char* p = f.data() + cut_base_snapshot_padded(sizeof(h));
+        endpoints_ = reinterpret_cast<const std::uint32_t*>(p);
+        p += endpoints_size;
+        costs_ = p;
+        p += costs_size;
+        offsets_ = reinterpret_cast<const std::uint64_t*>(p);
+        p += offsets_size;
+        adjacent_nodes_ = reinterpret_cast<const std::uint32_t*>(p);
+        p += adjacency_size;
+        adjacent_edges_ = reinterpret_cast<const std::uint32_t*>(p);
+
+        if(offsets_[0] != 0 || offsets_[h.nr_nodes] != 2*h.nr_edges)
+            throw invalid();
+        if(!check)
+            return;
+
+        bool consistent = true;
+#pragma omp parallel for reduction(&&:consistent)
+        for(std::size_t e=0; e<h.nr_edges; ++e)
+            consistent = consistent && endpoints_[2*e] < h.nr_nodes && endpoints_[2*e+1] < h.nr_nodes;
+#pragma omp parallel for reduction(&&:consistent)
+        for(std::size_t i=0; i<h.nr_nodes; ++i) {
+            consistent = consistent && offsets_[i] <= offsets_[i+1] && offsets_[i+1] <= 2*h.nr_edges;
+            for(std::size_t k=offsets_[i]; consistent && k<offsets_[i+1]; ++k) {
+                const std::size_t e = adjacent_edges_[k];
+                const std::size_t j = adjacent_nodes_[k];
+                consistent = e < h.nr_edges && ((endpoints_[2*e] == i && endpoints_[2*e+1] == j) || (endpoints_[2*e] == j && endpoints_[2*e+1] == i));
+            }
+        }
+        if(!consistent)
+            throw invalid();
+    }
+
+    inline double cut_base_snapshot::evaluate(const cut_base_edge_labeling& l) const
+    {
+        assert(l.size() == no_edges());
+        double cost = constant();
+        for(std::size_t e=0; e<no_edges(); ++e) {
+            assert(l[e] == 0 || l[e] == 1);
+            cost += this->cost(e) * l[e];
+        }
+        return cost;
+    }
+
+    inline double cut_base_snapshot::lower_bound() const
+    {
+        double lb = constant();
+        for(std::size_t e=0; e<no_edges(); ++e)
+            lb += std::min(cost(e), 0.0);
+        return lb;
+    }
+
+    inline bool cut_base_snapshot::graph_connected() const
+    {
+        union_find uf(no_nodes());
+        for(std::size_t e=0; e<no_edges(); ++e)
+            uf.merge(endpoints_[2*e], endpoints_[2*e+1]);
+        return uf.count() == 1;
+    }
+
+    template<typename INSTANCE>
+        INSTANCE cut_base_snapshot::instance() const
+        {
+            std::vector<std::vector<cut_base_instance::weighted_edge>> edges(1);
+            edges[0].resize(no_edges());
+#pragma omp parallel for schedule(static)
+            for(std::size_t e=0; e<no_edges(); ++e)
+                edges[0][e] = this->edges()[e];
+
+            INSTANCE instance;
+            instance.add_edges(std::move(edges));
+            instance.add_to_constant(constant());
+            return instance;
+        }
+
+}
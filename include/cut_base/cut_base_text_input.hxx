@@ -2,6 +2,7 @@
 
 #include "pegtl.hh"
 #include "pegtl_parse_rules.h"
+#include "cut_base_edge_list_reader.hxx"
 #include <cassert>
 #include <string>
 
@@ -83,6 +84,46 @@ namespace LPMP {
                 return input;
             }
 
+        // Same as above for IDENTIFIER = pegtl::opt<identifier>. Files are memory mapped and edges are read in parallel.
+        template<typename CUT_INSTANCE, char SIGN = 1>
+            CUT_INSTANCE parse_streaming(const char* begin, const char* end, const char* identifier)
+            {
+                const parsing::cursor c{end};
+                const char* p = cut_base_edge_list_reader::ignore_lines(c, begin);
+                p = c.blanks(p);
+                if(const char* q = c.keyword(p, identifier))
+                    p = c.blanks(q);
+                if(const char* q = c.eol(p))
+                    p = q;
+                p = cut_base_edge_list_reader::ignore_lines(c, p);
+
+                // init_line
+                if(const char* q = c.positive_integer(c.blanks(p)))
+                    if((q = c.mand_blanks(q)))
+                        if((q = c.positive_integer(q)))
+                            if((q = c.eolf(c.blanks(q))))
+                                p = q;
+
+                CUT_INSTANCE input;
+                cut_base_edge_list_reader::read_edges(p, end, input, SIGN);
+                input.shift_to_zero_offset();
+
+                return input;
+            }
+
+        template<typename CUT_INSTANCE, char SIGN = 1>
+            CUT_INSTANCE parse_file_streaming(const std::string& filename, const char* identifier)
+            {
+                mapped_file f(filename);
+                return parse_streaming<CUT_INSTANCE, SIGN>(f.begin(), f.end(), identifier);
+            }
+
+        template<typename CUT_INSTANCE, char SIGN = 1>
+            CUT_INSTANCE parse_string_streaming(const std::string& string, const char* identifier)
+            {
+                return parse_streaming<CUT_INSTANCE, SIGN>(string.data(), string.data() + string.size(), identifier);
+            }
+
     }
 
 }
@@ -7,6 +7,7 @@
 #include <queue>
 #include <tuple>
 #include <algorithm>
+#include <stdexcept>
 
 namespace LPMP {
 
@@ -71,4 +72,61 @@ namespace LPMP {
         return result;
     }
 
+    // Same on the cliques of the graph without explicit adjacency.
+    // Nodes reached from a node are sorted by their degree bound, since the remaining degree would need the explicit adjacency.
+    inline permutation Cuthill_McKee(const clique_graph& g)
+    {
+        std::queue<std::size_t> Q;
+        permutation result;
+        result.reserve(g.size());
+        std::vector<char> visited(g.size(), 0);
+        std::vector<char> clique_visited(g.nr_cliques(), 0);
+        std::vector<std::size_t> degree(g.size());
+        for(std::size_t i=0; i<g.size(); ++i)
+            degree[i] = g.degree_bound(i);
+
+        const auto pseudo_peripheral_nodes = find_pseudo_peripheral_nodes(g);
+
+        for (const std::size_t i : pseudo_peripheral_nodes)
+        {
+            result.push_back(i);
+            Q.push(i);
+            visited[i] = 1;
+
+            std::vector<std::size_t> a;
+            while (!Q.empty())
+            {
+                const std::size_t i = Q.front();
+                Q.pop();
+                a.clear();
+                for (const std::size_t c : g.cliques(i))
+                {
+                    if (clique_visited[c])
+                        continue;
+                    clique_visited[c] = 1;
+                    for (const std::size_t x : g.clique(c))
+                    {
+                        if (!visited[x])
+                        {
+                            visited[x] = 1;
+                            a.push_back(x);
+                        }
+                    }
+                }
+                std::stable_sort(a.begin(), a.end(), [&](const std::size_t x, const std::size_t y) { return degree[x] < degree[y]; });
+                for (const auto x : a)
+                {
+                    Q.push(x);
+                    result.push_back(x);
+                }
+            }
+        }
+
+        if(result.size() != g.size())
+            throw std::runtime_error("Graph not connected.");
+
+        assert(is_permutation(result.begin(), result.end()));
+        return result;
+    }
+
 }
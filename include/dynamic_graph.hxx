@@ -27,6 +27,11 @@ namespace LPMP {
 		template<typename EDGE_ITERATOR, typename EDGE_INFORMATION_LAMBDA>
             void construct(EDGE_ITERATOR edge_begin, EDGE_ITERATOR edge_end, EDGE_INFORMATION_LAMBDA edge_information_func);
 
+        // take over an existing adjacency structure with neighbors(i) and edge ids incident_edges(i) in the same order, e.g. cut_base_snapshot.
+        // Edge with id e gets information edge_information_func(e).
+		template<typename ADJACENCY, typename EDGE_INFORMATION_LAMBDA>
+            void construct_from_adjacency(const ADJACENCY& adj, EDGE_INFORMATION_LAMBDA edge_information_func);
+
         dynamic_graph(const std::size_t no_nodes);
 
         constexpr static auto return_edge_op = [](const auto& edge) { return EDGE_INFORMATION{}; };
@@ -154,6 +159,32 @@ namespace LPMP {
                     assert_edge_valid(e,i);
         }
 
+    template<typename EDGE_INFORMATION>
+        template<typename ADJACENCY, typename EDGE_INFORMATION_LAMBDA>
+        void dynamic_graph<EDGE_INFORMATION>::construct_from_adjacency(const ADJACENCY& adj, EDGE_INFORMATION_LAMBDA edge_information_func)
+        {
+            nodes_.clear();
+            edges_.clear();
+            edge_map_.clear();
+            free_edge_list_ = no_next_edge;
+
+            std::size_t no_edges = 0;
+            for(std::size_t i=0; i<adj.no_nodes(); ++i)
+                no_edges += adj.no_edges(i);
+
+            nodes_.resize(adj.no_nodes());
+            edges_.reserve(no_edges);
+            edge_map_.reserve(no_edges);
+
+            for(std::size_t i=0; i<adj.no_nodes(); ++i) {
+                const auto neighbors = adj.neighbors(i);
+                const auto incident_edges = adj.incident_edges(i);
+                for(std::size_t k=0; k<neighbors.size(); ++k)
+                    if(i < neighbors[k])
+                        insert_edge(i, neighbors[k], edge_information_func(incident_edges[k]));
+            }
+        }
+
     template<typename EDGE_INFORMATION>
         dynamic_graph<EDGE_INFORMATION>::dynamic_graph(const std::size_t no_nodes)
         {
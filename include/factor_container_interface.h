@@ -31,7 +31,7 @@ public:
    virtual std::size_t no_messages() const = 0;
    virtual std::size_t no_send_messages() const = 0;
    virtual std::size_t no_receive_messages() const = 0;
-   virtual REAL LowerBound() const = 0;
+   virtual double LowerBound() const = 0;
    virtual void init_primal() = 0;
    virtual void MaximizePotentialAndComputePrimal() = 0;
    virtual void propagate_primal_through_messages() = 0;
@@ -58,13 +58,15 @@ public:
    virtual void divide(const REAL val) = 0; // divide potential by value
    virtual void set_to_value(const REAL val) = 0; // set potential to given value
    virtual void add(FactorTypeAdapter*) = 0; // add potential values of other factor
+   // subtract a constant from the potential such that the lower bound and the cost of every labeling decrease by it. Returns the constant, 0 if the factor does not support this.
+   virtual double normalize_potential() = 0;
 
    virtual INDEX dual_size() = 0;
    virtual INDEX dual_size_in_bytes() = 0;
    virtual INDEX primal_size_in_bytes() = 0;
 
    // do zrobienia: this function is not needed. Evaluation can be performed automatically
-   virtual REAL EvaluatePrimal() const = 0;
+   virtual double EvaluatePrimal() const = 0;
 
    // external ILP-interface
    virtual void construct_constraints(DD_ILP::external_solver_interface<DD_ILP::problem_export>& solver) = 0;
@@ -77,6 +77,7 @@ LPMP_FUNCTION_EXISTENCE_CLASS(HasMaximizePotential, MaximizePotential)
 LPMP_FUNCTION_EXISTENCE_CLASS(HasMaximizePotentialAndComputePrimal, MaximizePotentialAndComputePrimal)
 
 LPMP_FUNCTION_EXISTENCE_CLASS(has_apply, apply)
+LPMP_FUNCTION_EXISTENCE_CLASS(has_normalize_potential, normalize_potential)
 
 LPMP_FUNCTION_EXISTENCE_CLASS(has_construct_constraints, construct_constraints)
 LPMP_FUNCTION_EXISTENCE_CLASS(has_convert_primal, convert_primal)
@@ -1260,11 +1261,11 @@ public:
        if constexpr(can_construct_constraints()) {
            auto current_variable_counters = s.get_variable_counters();
 
-           auto left_vars = leftFactor_->get_factor()->export_variables();
+           auto left_vars = leftFactor_->export_variables_read_only();
            s.set_variable_counters(left_variable_counters);
            auto left_external_vars = std::apply([this,&s](auto... x){ return std::make_tuple(this->leftFactor_->load_external_variables(s, x)...); }, left_vars);
 
-           auto right_vars = rightFactor_->get_factor()->export_variables();
+           auto right_vars = rightFactor_->export_variables_read_only();
            s.set_variable_counters(right_variable_counters);
            auto right_external_vars = std::apply([this,&s](auto... x){ return std::make_tuple(this->rightFactor_->load_external_variables(s, x)...); }, right_vars);
 
@@ -2658,7 +2659,7 @@ public:
       apply_subgradient(double* _w, REAL _sign) : w(_w), sign(_sign) { assert(sign == 1.0 || sign == -1.0); }
       void operator[](const INDEX i) { w[i] = sign; }
       private:
-      REAL* const w;
+      double* const w;
       const REAL sign;
    };
    constexpr static bool can_apply()
@@ -2685,8 +2686,8 @@ public:
          void operator[](const INDEX i) { dp += w[i]; }
          REAL dot_product() const { return dp; }
       private:
-         REAL* const w;
-         REAL dp = 0;
+         double* const w;
+         double dp = 0;
       };
 
       apply_dot_product d(w);
@@ -2778,12 +2779,24 @@ public:
    }
 
    
+   template<typename T>
+   using has_const_export_variables_t = decltype(std::declval<const T&>().export_variables());
+
+   // exported variables for reading only. Factors may provide a const export_variables() that avoids copying data shared between factors.
+   auto export_variables_read_only()
+   {
+       if constexpr(is_detected<has_const_export_variables_t, FactorType>::value)
+           return std::as_const(factor_).export_variables();
+       else
+           return factor_.export_variables();
+   }
+
    virtual void add(FactorTypeAdapter* other) final
    {
        assert(dynamic_cast<FactorContainer*>(other) != nullptr);
        auto* o = static_cast<FactorContainer*>(other);
        auto vars = factor_.export_variables();
-       auto other_vars = o->get_factor()->export_variables();
+       auto other_vars = o->export_variables_read_only();
        for_each_tuple_pair(vars, other_vars, [&](auto& var_1, auto& var_2) { operator_equal_plus(var_1, var_2); });
    }
 
@@ -2794,12 +2807,20 @@ public:
       return ar.size(); 
    }
 
-   REAL LowerBound() const final {
+   double LowerBound() const final {
       //return factor_.LowerBound(*this); 
       return factor_.LowerBound(); 
    } 
 
-   REAL EvaluatePrimal() const final
+   double normalize_potential() final
+   {
+      if constexpr(FunctionExistence::has_normalize_potential<FactorType, double>())
+         return factor_.normalize_potential();
+      else
+         return 0.0;
+   }
+
+   double EvaluatePrimal() const final
    {
       return factor_.EvaluatePrimal();
    }
@@ -3073,7 +3094,7 @@ public:
    template<typename EXTERNAL_SOLVER>
    auto get_external_vars(EXTERNAL_SOLVER& s)
    {
-       auto vars = factor_.export_variables();
+       auto vars = export_variables_read_only();
        auto external_vars = std::apply([this,&s](auto... x){ return std::make_tuple(this->convert_variables_to_external(s, x)...); }, vars);
        return external_vars; 
    }
@@ -3098,7 +3119,7 @@ public:
    void load_costs_impl(EXTERNAL_SOLVER& s)
    {
       // load external solver variables corresponding to reparametrization ones and add reparametrization as cost
-      auto vars = factor_.export_variables();
+      auto vars = export_variables_read_only();
       std::apply([this,&s](auto... x){ ((this->add_objective(s,x)), ...); },  vars);
       //auto external_vars = std::apply([this,&s](auto... x){ return std::make_tuple(this->leftFactor_->load_external_variables(s, x)...); }, vars);
       // for all variables,
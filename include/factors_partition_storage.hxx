@@ -3,401 +3,282 @@
 
 #include <vector>
 #include <array>
+#include <algorithm>
+#include <iostream>
+#include <tsl/robin_map.h>
 #include "two_dimensional_variable_array.hxx"
 #include "factor_container_interface.h"
-#include "union_find.hxx"
+#include "message_passing_weight_computation.hxx"
+#include "lp_reparametrization.hxx"
 
 namespace LPMP {
 
+// Staged optimization: the forward factor ordering is cut into contiguous partitions fitting into cache.
+// Several inner passes are run on each partition, with partitions processed concurrently, followed by a pass that pushes messages across partition boundaries.
+// During inner passes only messages with both endpoints in the same partition are sent and received, hence distinct partitions touch disjoint messages and can be processed in parallel.
 class factors_partition_storage {
 public:
-   // methods for staged optimization
-   void put_in_same_partition(FactorTypeAdapter* f1, FactorTypeAdapter* f2) { factor_partition_valid_ = false; partition_graph.push_back({f1,f2}); }
-   void
+   void set_partition_size(const std::size_t bytes) { if(bytes != partition_size_in_bytes_) { partition_size_in_bytes_ = bytes; invalidate_partition(); } }
+   void invalidate_partition() { partition_valid_ = false; overlapping_partition_valid_ = false; }
+   // weights of partition passes are computed as for forward and backward passes with the given reparametrization
+   void set_partition_reparametrization(const lp_reparametrization r) { if(!(r == partition_repam_)) { partition_repam_ = r; invalidate_partition(); } }
 
-   void construct_factor_partition();
-   void construct_overlapping_factor_partition();
+   template<typename FACTOR_ITERATOR>
+   void compute_partition_pass(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, const std::size_t no_passes);
+   template<typename FACTOR_ITERATOR>
+   void compute_overlapping_partition_pass(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, const std::size_t no_passes);
 
-   template<typename PARTITION_ITERATOR, typename INTRA_PARTITION_FACTOR_ITERATOR>
-   void construct_forward_pushing_weights(PARTITION_ITERATOR partition_begin, PARTITION_ITERATOR partition_end, std::vector<weight_array>& omega_partition, std::vector<receive_array>& receive_mask_partition, INTRA_PARTITION_FACTOR_ITERATOR factor_iterator_getter);
-
-   void compute_partition_pass(const std::size_t no_passes);
-   void compute_overlapping_partition_pass(const std::size_t no_passes);
+   std::size_t no_partitions() const { return factor_partition_.size(); }
 
 private:
-   template<typename ITERATOR_1, typename ITERATOR_2>
-   std::vector<FactorTypeAdapter*> concatenate_factors(ITERATOR_1 f1_begin, ITERATOR_1 f1_end, ITERATOR_2 f2_begin, ITERATOR_2 f2_end);
-
-   // for staged optimization: partition factors that are updated and run multiple rounds of optimization on each component of the partition followed by pushing messages to the next component.
-   std::vector<std::array<FactorTypeAdapter*,2>> partition_graph;
-   bool factor_partition_valid_ = false;
-   two_dim_variable_array<FactorTypeAdapter*> factor_partition_; // already sorted
-   std::vector<weight_array> omega_partition_forward_, omega_partition_backward_;
-   std::vector<receive_array> receive_mask_partition_forward_, receive_mask_partition_backward_;
-
-   std::vector<weight_array> omega_partition_forward_pass_push_forward_, omega_partition_backward_pass_push_forward_;
-   std::vector<weight_array> omega_partition_forward_pass_push_backward_, omega_partition_backward_pass_push_backward_;
-   std::vector<receive_array> receive_mask_partition_forward_pass_push_forward_, receive_mask_partition_backward_pass_push_forward_;
-   std::vector<receive_array> receive_mask_partition_forward_pass_push_backward_, receive_mask_partition_backward_pass_push_backward_;
-
-   std::vector<weight_array> omega_partition_forward_pass_push_;
-   std::vector<weight_array> omega_partition_backward_pass_push_;
-   std::vector<receive_array> receive_mask_partition_forward_pass_push_;
-   std::vector<receive_array> receive_mask_partition_backward_pass_push_;
-
-   bool overlapping_factor_partition_valid_ = false;
-   std::vector<weight_array> omega_overlapping_partition_forward_;
-   std::vector<weight_array> omega_overlapping_partition_backward_;
-   std::vector<receive_array> receive_mask_overlapping_partition_forward_;
-   std::vector<receive_array> receive_mask_overlapping_partition_backward_;
+   // forward and backward pass over a subset of factors in which no message to factors outside the subset is sent or received
+   struct restricted_pass {
+      std::vector<FactorTypeAdapter*> forward_update, backward_update;
+      weight_array omega_forward, omega_backward;
+      receive_array receive_mask_forward, receive_mask_backward;
+
+      void compute(const std::size_t no_passes);
+   };
+
+   template<typename FACTOR_ITERATOR>
+   void construct_factor_partition(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end);
+   template<typename FACTOR_ITERATOR>
+   void construct_overlapping_factor_partition(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end);
+
+   // factors must be given in forward order. inside(f, adjacent_factor) tells whether the message between f and an adjacent factor belongs to the pass.
+   template<typename PREDICATE>
+   restricted_pass construct_restricted_pass(const std::vector<FactorTypeAdapter*>& factors, PREDICATE inside) const;
+
+   template<typename FACTOR_ITERATOR>
+   std::tuple<weight_array, receive_array> compute_weights(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end) const;
+
+   template<typename FACTOR_ITERATOR, typename PREDICATE>
+   static void restrict_weights(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, weight_array& omega, receive_array& receive_mask, PREDICATE inside);
+
+   std::size_t partition_size_in_bytes_ = 1024*1024;
+   lp_reparametrization partition_repam_ = lp_reparametrization(lp_reparametrization_mode::Anisotropic, 0.0);
+
+   bool partition_valid_ = false;
+   two_dim_variable_array<FactorTypeAdapter*> factor_partition_; // all factors of each partition in forward order
+   std::vector<restricted_pass> partition_passes_;
+   restricted_pass boundary_pass_; // factors incident to messages across partitions
+
+   bool overlapping_partition_valid_ = false;
+   std::vector<restricted_pass> overlapping_partition_passes_; // union of partitions i and i+1
+   restricted_pass far_boundary_pass_; // messages between partitions i and j with |i-j| >= 2, covered by no window
 };
 
-template<typename FMC>
-inline void LP<FMC>::construct_factor_partition()
+inline void factors_partition_storage::restricted_pass::compute(const std::size_t no_passes)
+{
+   for(std::size_t iter=0; iter<no_passes; ++iter) {
+      for(std::size_t i=0; i<forward_update.size(); ++i) {
+         forward_update[i]->UpdateFactor(omega_forward[i], receive_mask_forward[i]);
+      }
+      for(std::size_t i=0; i<backward_update.size(); ++i) {
+         backward_update[i]->UpdateFactor(omega_backward[i], receive_mask_backward[i]);
+      }
+   }
+}
+
+template<typename FACTOR_ITERATOR, typename PREDICATE>
+void factors_partition_storage::restrict_weights(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, weight_array& omega, receive_array& receive_mask, PREDICATE inside)
 {
-    if(factor_partition_valid_) { return; }
-    factor_partition_valid_ = true;
-
-    SortFactors();
-
-    union_find uf(f_.size());
-    for(auto p : partition_graph) {
-        const auto i = factor_address_to_index_[p[0]];
-        const auto j = factor_address_to_index_[p[1]];
-        uf.merge(i,j);
-    }
-    auto contiguous_ids = uf.get_contiguous_ids();
-    std::vector<INDEX> partition_size(uf.count(),0);
-    for(std::size_t i=0; i<contiguous_ids.size(); ++i) {
-        const std::size_t id = contiguous_ids[ uf.find(i) ];
-        if(f_[i]->FactorUpdated()) {
-            partition_size[id]++;
-        } 
-    }
-
-    // filter out partitions with size zero
-    std::vector<INDEX> partition_size_filtered;
-    std::vector<INDEX> contiguous_id_to_partition_id(contiguous_ids.size(),std::numeric_limits<INDEX>::max());
-    for(INDEX i=0; i<partition_size.size(); ++i) {
-        if(partition_size[i]>0) {
-            contiguous_id_to_partition_id[i] = partition_size_filtered.size();
-            partition_size_filtered.push_back( partition_size[i] );
-        }
-    }
-    //partition_size.erase(std::remove(partition_size.begin(), partition_size.end(), 0), partition_size.end()); 
-
-    factor_partition_ = two_dim_variable_array<FactorTypeAdapter*>(partition_size_filtered);
-
-    // populate factor_partition
-    std::fill(partition_size_filtered.begin(), partition_size_filtered.end(), 0);
-    for(std::size_t i=0; i<f_.size(); ++i) {
-        const std::size_t id = contiguous_id_to_partition_id[ contiguous_ids[ uf.find(i) ] ];
-        if(f_[i]->FactorUpdated()) {
-            factor_partition_[id][ partition_size_filtered[id]++ ] = f_[i];
-        } 
-    }
-
-    // sort factor_partition.
-    std::unordered_map<FactorTypeAdapter*, std::size_t> factor_address_to_sorted_position;
-    for(std::size_t i=0; i<forwardOrdering_.size(); ++i) {
-        factor_address_to_sorted_position.insert( {forwardOrdering_[i], i} );
-    }
-    for(std::size_t i=0; i<factor_partition_.size(); ++i) {
-        std::vector<std::pair<std::size_t,FactorTypeAdapter*>> sorted_indices; // sorted index, number in partition
-        sorted_indices.reserve(factor_partition_[i].size());
-        for(std::size_t j=0; j<factor_partition_[i].size(); ++j) {
-            auto* f = factor_partition_[i][j];
-            assert(factor_address_to_sorted_position.find(f) != factor_address_to_sorted_position.end());
-            const std::size_t idx = factor_address_to_sorted_position[f];
-            sorted_indices.push_back( {idx, f} );
-        }
-        std::sort(sorted_indices.begin(), sorted_indices.end(), [](const auto a, const auto b) { return std::get<0>(a) < std::get<0>(a); });
-        for(std::size_t j=0; j<factor_partition_[i].size(); ++j) {
-            factor_partition_[i][j] = std::get<1>(sorted_indices[j]);
-        } 
-    }
-
-    // compute weights and receive masks
-    omega_partition_forward_.resize(factor_partition_.size());
-    omega_partition_backward_.resize(factor_partition_.size());
-    receive_mask_partition_forward_.resize(factor_partition_.size());
-    receive_mask_partition_backward_.resize(factor_partition_.size());
-    for(std::size_t i=0; i<factor_partition_.size(); ++i) {
-        std::tie(omega_partition_forward_[i], receive_mask_partition_forward_[i]) = compute_anisotropic_weights( factor_partition_[i].begin(), factor_partition_[i].end(), 0.0);
-        std::tie(omega_partition_backward_[i], receive_mask_partition_backward_[i]) = compute_anisotropic_weights( factor_partition_[i].rbegin(), factor_partition_[i].rend(), 0.0);
-    } 
-
-    construct_forward_pushing_weights(factor_partition_.begin(), factor_partition_.end(), omega_partition_forward_pass_push_forward_, receive_mask_partition_forward_pass_push_forward_, 
-            [](const auto& partition) { return std::make_tuple(partition.begin(), partition.end()); }
-            );
-
-    construct_forward_pushing_weights(factor_partition_.begin(), factor_partition_.end(), omega_partition_backward_pass_push_forward_, receive_mask_partition_backward_pass_push_forward_,
-            [](const auto& partition) { return std::make_tuple(partition.rbegin(), partition.rend()); }
-            );
-
-    construct_forward_pushing_weights(factor_partition_.rbegin(), factor_partition_.rend(), omega_partition_forward_pass_push_backward_, receive_mask_partition_forward_pass_push_backward_, 
-            [](const auto& partition) { return std::make_tuple(partition.begin(), partition.end()); }
-            );
-
-    construct_forward_pushing_weights(factor_partition_.rbegin(), factor_partition_.rend(), omega_partition_backward_pass_push_backward_, receive_mask_partition_backward_pass_push_backward_, 
-            [](const auto& partition) { return std::make_tuple(partition.rbegin(), partition.rend()); }
-            );
-
-
-    omega_partition_forward_pass_push_.resize(factor_partition_.size()-1);
-    receive_mask_partition_forward_pass_push_.resize(factor_partition_.size()-1);
-    for(std::size_t i=0; i<factor_partition_.size()-1; ++i) {
-        auto f = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-        ComputeAnisotropicWeights( f.begin(), f.end(), omega_partition_forward_pass_push_[i], receive_mask_partition_forward_pass_push_[i], 0.0); 
-    }
-
-    omega_partition_backward_pass_push_.resize(factor_partition_.size()-1);
-    receive_mask_partition_backward_pass_push_.resize(factor_partition_.size()-1);
-    for(std::size_t ri=0; ri<factor_partition_.size()-1; ++ri) {
-        const std::size_t i = factor_partition_.size() - ri - 1;
-        auto f = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i-1].rbegin(), factor_partition_[i-1].rend());
-        ComputeAnisotropicWeights( f.begin(), f.end(), omega_partition_backward_pass_push_[ri], receive_mask_partition_backward_pass_push_[ri], 0.0); 
-    }
+   std::size_t c = 0;
+   for(auto f_it=factor_begin; f_it!=factor_end; ++f_it) {
+      if(!(*f_it)->FactorUpdated()) { continue; }
+      std::size_t k_send = 0;
+      std::size_t k_receive = 0;
+      for(const auto m : (*f_it)->get_messages()) {
+         if(message_passing_schedule_factor_view::sends_message_to_adjacent_factor(m.mps)) {
+            if(!inside(*f_it, m.adjacent_factor)) { omega[c][k_send] = 0.0; }
+            ++k_send;
+         }
+         if(message_passing_schedule_factor_view::receives_message_from_adjacent_factor(m.mps)) {
+            if(!inside(*f_it, m.adjacent_factor)) { receive_mask[c][k_receive] = 0; }
+            ++k_receive;
+         }
+      }
+      assert(k_send == omega[c].size() && k_receive == receive_mask[c].size());
+      ++c;
+   }
+   assert(c == omega.size());
 }
 
-template<typename FMC>
-inline void LP<FMC>::construct_overlapping_factor_partition()
+template<typename FACTOR_ITERATOR>
+std::tuple<weight_array, receive_array> factors_partition_storage::compute_weights(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end) const
 {
-    construct_factor_partition();
-    if(overlapping_factor_partition_valid_) { return; }
-    overlapping_factor_partition_valid_ = true;
-
-    omega_overlapping_partition_forward_.resize(factor_partition_.size()-1);
-    omega_overlapping_partition_backward_.resize(factor_partition_.size()-1);
-    receive_mask_overlapping_partition_forward_.resize(factor_partition_.size()-1);
-    receive_mask_overlapping_partition_backward_.resize(factor_partition_.size()-1);
-    for(std::size_t i=0; i<factor_partition_.size()-1; ++i) {
-        auto f_forward = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-        ComputeAnisotropicWeights( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i], receive_mask_overlapping_partition_forward_[i], 0.0);
-
-        auto f_backward = concatenate_factors(factor_partition_[i+1].begin(), factor_partition_[i+1].end(), factor_partition_[i].rbegin(), factor_partition_[i].rend());
-        ComputeAnisotropicWeights( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i], receive_mask_overlapping_partition_backward_[i], 0.0);
-    } 
+   const double leave_percentage = partition_repam_.leave_percentage;
+   switch(partition_repam_.mode) {
+      case lp_reparametrization_mode::Anisotropic:
+         return compute_anisotropic_weights(factor_begin, factor_end, leave_percentage);
+      case lp_reparametrization_mode::Anisotropic2:
+         return compute_anisotropic_weights_2(factor_begin, factor_end, leave_percentage);
+      case lp_reparametrization_mode::Uniform:
+         return {compute_isotropic_weights(factor_begin, factor_end, leave_percentage), compute_full_receive_mask(factor_begin, factor_end)};
+      default:
+         throw std::runtime_error("no reparametrization mode set");
+   }
 }
 
-template<typename FMC>
-template<typename PARTITION_ITERATOR, typename INTRA_PARTITION_FACTOR_ITERATOR>
-inline void LP<FMC>::construct_forward_pushing_weights(PARTITION_ITERATOR partition_begin, PARTITION_ITERATOR partition_end, std::vector<weight_array>& omega_partition, std::vector<receive_array>& receive_mask_partition, INTRA_PARTITION_FACTOR_ITERATOR factor_iterator_getter)
+template<typename PREDICATE>
+factors_partition_storage::restricted_pass factors_partition_storage::construct_restricted_pass(const std::vector<FactorTypeAdapter*>& factors, PREDICATE inside) const
 {
-    std::unordered_map<FactorTypeAdapter*, std::size_t> factor_address_to_partition;
-    factor_address_to_partition.reserve(f_.size());
-
-    for(auto partition_it=partition_begin; partition_it!=partition_end; ++partition_it) {
-
-        auto [factor_begin, factor_end] = factor_iterator_getter(*partition_it);
-
-        const auto partition_number = std::distance(partition_begin, partition_it);
-        for(auto factor_it=factor_begin; factor_it!=factor_end; ++factor_it) {
-            assert(factor_address_to_partition.count(*factor_it) == 0);
-            factor_address_to_partition.insert( {*factor_it, partition_number} );
-        }
-    }
-
-    const auto no_partitions = std::distance(partition_begin, partition_end);
-    omega_partition.reserve(no_partitions);
-    receive_mask_partition.reserve(no_partitions);
-
-    for(auto partition_it=partition_begin; partition_it!=partition_end; ++partition_it) {
-
-        auto [factor_begin, factor_end] = factor_iterator_getter(*partition_it);
-
-        std::unordered_map<FactorTypeAdapter*, std::size_t> factor_address_to_partition_position;
-        for(auto factor_it=factor_begin; factor_it!=factor_end; ++factor_it) {
-            factor_address_to_partition_position.insert( {*factor_it, factor_address_to_partition_position.size()} );
-        }
-
-        const auto partition_number = std::distance(partition_begin, partition_it);
-        omega_partition.push_back(allocate_omega(factor_begin, factor_end));
-        auto& omega = omega_partition.back();
-        receive_mask_partition.push_back(allocate_receive_mask(factor_begin, factor_end));
-        auto& receive_mask = receive_mask_partition.back();
-
-        std::size_t c = 0;
-        for(auto factor_it=factor_begin; factor_it!=factor_end; ++factor_it) {
-            if((*factor_it)->FactorUpdated()) {
-                std::size_t k_send = 0;
-                std::size_t k_receive = 0;
-                for(auto m : (*factor_it)->get_messages()) {
-                    if(m.sends_to_adjacent_factor) {
-                        if(factor_address_to_partition.count(m.adjacent_factor)) {
-                            const auto adjacent_factor_partition = factor_address_to_partition[m.adjacent_factor];
-                            if(adjacent_factor_partition >= partition_number) {
-                                omega[c][k_send] = 1.0;
-                            } else {
-                                omega[c][k_send] = 0.0;
-                            }
-                        } else {
-                        //    if(factor_address_to_partition_position.count(m.adjacent_factor) && factor_address_to_partition_position[m.adjacent_factor] > std::distance(factor_begin, factor_it) ) {
-                        //        omega[c][k_send] = 1.0;
-                        //    } else {
-                                omega[c][k_send] = 0.0; 
-                        //    }
-                        }
-                        ++k_send;
-                    }
-                    if(m.receives_from_adjacent_factor) {
-                        const auto adjacent_factor_partition = factor_address_to_partition[m.adjacent_factor];
-                        if(adjacent_factor_partition <= partition_number) {
-                            receive_mask[c][k_receive] = 1.0;
-                        } else {
-                            receive_mask[c][k_receive] = 0.0;
-                        }
-                        ++k_receive;
-                    }
-                } 
-                assert(k_receive == (*factor_it)->no_receive_messages());
-                assert(k_send == (*factor_it)->no_send_messages());
-
-                // reweight omega
-                const auto omega_sum = std::accumulate(omega[c].begin(), omega[c].end(), 0.0);
-                if(omega_sum > 0) {
-                    for(auto& x : omega[c]) {
-                        x *= 1.0/omega_sum;
-                    }
-                }
-                assert(std::accumulate(omega[c].begin(), omega[c].end(), 0.0) <= 1.0 + eps);
-                ++c;
-            }
-        }
-    } 
+   restricted_pass p;
+
+   std::tie(p.omega_forward, p.receive_mask_forward) = compute_weights(factors.begin(), factors.end());
+   restrict_weights(factors.begin(), factors.end(), p.omega_forward, p.receive_mask_forward, inside);
+   std::tie(p.omega_backward, p.receive_mask_backward) = compute_weights(factors.rbegin(), factors.rend());
+   restrict_weights(factors.rbegin(), factors.rend(), p.omega_backward, p.receive_mask_backward, inside);
+
+   std::copy_if(factors.begin(), factors.end(), std::back_inserter(p.forward_update), [](auto* f) { return f->FactorUpdated(); });
+   std::copy_if(factors.rbegin(), factors.rend(), std::back_inserter(p.backward_update), [](auto* f) { return f->FactorUpdated(); });
+   assert(p.forward_update.size() == p.omega_forward.size() && p.backward_update.size() == p.omega_backward.size());
+
+   return p;
 }
 
-template<typename FMC> 
-void LP<FMC>::compute_partition_pass(const std::size_t no_passes)
+template<typename FACTOR_ITERATOR>
+void factors_partition_storage::construct_factor_partition(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end)
 {
-    construct_factor_partition();
-    for(std::size_t i=0; i<factor_partition_.size(); ++i) {
-        for(std::size_t iter=0; iter<no_passes; ++iter) {
-            ComputePass(factor_partition_[i].begin(), factor_partition_[i].end(), omega_partition_forward_[i].begin(), receive_mask_partition_forward_[i].begin());
-            ComputePass(factor_partition_[i].rbegin(), factor_partition_[i].rend(), omega_partition_backward_[i].begin(), receive_mask_partition_backward_[i].begin());
-        } 
-        // push all messages forward
-        if(i < factor_partition_.size()-1) {
-            auto f = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-            ComputePass(f.begin(), f.end(), omega_partition_forward_pass_push_[i].begin(), receive_mask_partition_forward_pass_push_[i].begin());
-        }
-        //ComputePass(factor_partition_[i].begin(), factor_partition_[i].end(), omega_partition_forward_pass_push_forward_[i].begin(), receive_mask_partition_forward_pass_push_forward_[i].begin());
-        //ComputePass(factor_partition_[i].rbegin(), factor_partition_[i].rend(), omega_partition_backward_pass_push_forward_[i].begin(), receive_mask_partition_backward_pass_push_forward_[i].begin());
-    } 
-
-    for(std::size_t ri=0; ri<factor_partition_.size(); ++ri) {
-        const std::size_t i = factor_partition_.size() - ri - 1;
-        for(std::size_t iter=0; iter<no_passes; ++iter) {
-            ComputePass(factor_partition_[i].begin(), factor_partition_[i].end(), omega_partition_forward_[i].begin(), receive_mask_partition_forward_[i].begin());
-            ComputePass(factor_partition_[i].rbegin(), factor_partition_[i].rend(), omega_partition_backward_[i].begin(), receive_mask_partition_backward_[i].begin());
-        } 
-        // push all messages backward
-        if(i != 0) {
-            auto f = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i-1].rbegin(), factor_partition_[i-1].rend());
-            ComputePass(f.begin(), f.end(), omega_partition_backward_pass_push_[ri].begin(), receive_mask_partition_backward_pass_push_[ri].begin());
-        }
-        //ComputePass(factor_partition_[i].begin(), factor_partition_[i].end(), omega_partition_forward_pass_push_backward_[ri].begin(), receive_mask_partition_forward_pass_push_backward_[ri].begin());
-        //ComputePass(factor_partition_[i].rbegin(), factor_partition_[i].rend(), omega_partition_backward_pass_push_backward_[ri].begin(), receive_mask_partition_backward_pass_push_backward_[ri].begin());
-    } 
+   if(partition_valid_) { return; }
+   partition_valid_ = true;
+   overlapping_partition_valid_ = false;
+
+   // cut forward ordering into contiguous chunks whose duals fit into partition_size_in_bytes_
+   std::vector<std::size_t> partition_size;
+   std::size_t cur_bytes = 0;
+   for(auto f_it=factor_begin; f_it!=factor_end; ++f_it) {
+      const std::size_t bytes = (*f_it)->dual_size_in_bytes();
+      if(partition_size.empty() || (cur_bytes + bytes > partition_size_in_bytes_ && cur_bytes > 0)) {
+         partition_size.push_back(0);
+         cur_bytes = 0;
+      }
+      partition_size.back()++;
+      cur_bytes += bytes;
+   }
+
+   factor_partition_ = two_dim_variable_array<FactorTypeAdapter*>(partition_size);
+   tsl::robin_map<const FactorTypeAdapter*, std::size_t> factor_to_partition;
+   factor_to_partition.reserve(std::distance(factor_begin, factor_end));
+   {
+      auto f_it = factor_begin;
+      for(std::size_t p=0; p<factor_partition_.size(); ++p) {
+         for(std::size_t j=0; j<factor_partition_[p].size(); ++j, ++f_it) {
+            factor_partition_(p,j) = *f_it;
+            factor_to_partition.insert({*f_it, p});
+         }
+      }
+      assert(f_it == factor_end);
+   }
+
+   partition_passes_.clear();
+   partition_passes_.resize(factor_partition_.size());
+#pragma omp parallel for schedule(dynamic)
+   for(std::size_t p=0; p<factor_partition_.size(); ++p) {
+      std::vector<FactorTypeAdapter*> factors(factor_partition_[p].begin(), factor_partition_[p].end());
+      partition_passes_[p] = construct_restricted_pass(factors, [&](const FactorTypeAdapter*, const FactorTypeAdapter* f) {
+            auto it = factor_to_partition.find(f);
+            return it != factor_to_partition.end() && it->second == p;
+      });
+   }
+
+   // factors incident to messages across partitions
+   std::vector<FactorTypeAdapter*> boundary_factors;
+   tsl::robin_map<const FactorTypeAdapter*, std::size_t> boundary_factor_set;
+   for(auto f_it=factor_begin; f_it!=factor_end; ++f_it) {
+      const auto p = factor_to_partition.find(*f_it)->second;
+      for(const auto m : (*f_it)->get_messages()) {
+         auto it = factor_to_partition.find(m.adjacent_factor);
+         if(it == factor_to_partition.end() || it->second != p) {
+            boundary_factors.push_back(*f_it);
+            boundary_factor_set.insert({*f_it, boundary_factors.size()-1});
+            break;
+         }
+      }
+   }
+   boundary_pass_ = construct_restricted_pass(boundary_factors, [&](const FactorTypeAdapter*, const FactorTypeAdapter* f) { return boundary_factor_set.count(f) > 0; });
+
+   if(debug()) {
+      std::cout << "factor partition: " << factor_partition_.size() << " partitions, " << boundary_factors.size() << " factors on partition boundaries\n";
+   }
 }
 
-template<typename FMC> 
-void LP<FMC>::compute_overlapping_partition_pass(const std::size_t no_passes)
+template<typename FACTOR_ITERATOR>
+void factors_partition_storage::construct_overlapping_factor_partition(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end)
 {
-    construct_overlapping_factor_partition();
-
-/*
-    auto forward_pass = [&](const std::size_t begin, const std::size_t end) 
-    {
-        for(std::size_t i=begin; i<end; ++i) {
-            auto f_forward = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-            auto f_backward = concatenate_factors(factor_partition_[i+1].begin(), factor_partition_[i+1].end(), factor_partition_[i].rbegin(), factor_partition_[i].rend());
-            for(std::size_t iter=0; iter<no_passes; ++iter) {
-                ComputePass( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i].begin(), receive_mask_overlapping_partition_forward_[i].begin());
-                ComputePass( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i].begin(), receive_mask_overlapping_partition_backward_[i].begin());
-            }
-            ComputePass( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i].begin(), receive_mask_overlapping_partition_forward_[i].begin());
-        }
-    };
-
-    auto backward_pass = [&](const std::size_t begin, const std::size_t end)
-    {
-        for(std::size_t ri=begin+1; ri<end+1; ++ri) {
-            const std::size_t i = factor_partition_.size() - ri - 1;
-            auto f_forward = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-            auto f_backward = concatenate_factors(factor_partition_[i+1].begin(), factor_partition_[i+1].end(), factor_partition_[i].rbegin(), factor_partition_[i].rend());
-
-            for(std::size_t iter=0; iter<no_passes; ++iter) {
-                ComputePass( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i].begin(), receive_mask_overlapping_partition_backward_[i].begin());
-                ComputePass( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i].begin(), receive_mask_overlapping_partition_forward_[i].begin());
-            }
-            ComputePass( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i].begin(), receive_mask_overlapping_partition_backward_[i].begin());
-        } 
-    };
-
-    const auto no_threads = 1;
-    const auto loop_size = factor_partition_.size()-1;
-    std::vector<std::thread> threads(no_threads);
-    const int grainsize = loop_size / no_threads;
-
-    auto work_iter = 0;
-    for(auto it = std::begin(threads); it != std::end(threads) - 1; ++it) {
-        *it = std::thread(forward_pass, work_iter, work_iter + grainsize);
-        work_iter += grainsize;
-    }
-    threads.back() = std::thread(forward_pass, work_iter, factor_partition_.size()-1);
-
-    for(auto&& i : threads) {
-        i.join();
-    }
-
-    work_iter = 0;
-    for(auto it = std::begin(threads); it != std::end(threads) - 1; ++it) {
-        *it = std::thread(backward_pass, work_iter, work_iter + grainsize);
-        work_iter += grainsize;
-    }
-    threads.back() = std::thread(backward_pass, work_iter, factor_partition_.size()-1);
-
-    for(auto&& i : threads) {
-        i.join();
-    }
-
-
-    return;
-*/
-
-    for(std::size_t i=0; i<factor_partition_.size()-1; ++i) {
-        auto f_forward = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-        auto f_backward = concatenate_factors(factor_partition_[i+1].begin(), factor_partition_[i+1].end(), factor_partition_[i].rbegin(), factor_partition_[i].rend());
-        for(std::size_t iter=0; iter<no_passes; ++iter) {
-            ComputePass( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i].begin(), receive_mask_overlapping_partition_forward_[i].begin());
-            ComputePass( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i].begin(), receive_mask_overlapping_partition_backward_[i].begin());
-        }
-        ComputePass( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i].begin(), receive_mask_overlapping_partition_forward_[i].begin());
-    } 
-
-    for(std::size_t ri=1; ri<factor_partition_.size(); ++ri) {
-        const std::size_t i = factor_partition_.size() - ri - 1;
-        auto f_forward = concatenate_factors(factor_partition_[i].begin(), factor_partition_[i].end(), factor_partition_[i+1].rbegin(), factor_partition_[i+1].rend());
-        auto f_backward = concatenate_factors(factor_partition_[i+1].begin(), factor_partition_[i+1].end(), factor_partition_[i].rbegin(), factor_partition_[i].rend());
-
-        for(std::size_t iter=0; iter<no_passes; ++iter) {
-            ComputePass( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i].begin(), receive_mask_overlapping_partition_backward_[i].begin());
-            ComputePass( f_forward.begin(), f_forward.end(), omega_overlapping_partition_forward_[i].begin(), receive_mask_overlapping_partition_forward_[i].begin());
-        }
-        ComputePass( f_backward.begin(), f_backward.end(), omega_overlapping_partition_backward_[i].begin(), receive_mask_overlapping_partition_backward_[i].begin());
-    }
+   construct_factor_partition(factor_begin, factor_end);
+   if(overlapping_partition_valid_) { return; }
+   overlapping_partition_valid_ = true;
+
+   const std::size_t no_windows = factor_partition_.size() > 1 ? factor_partition_.size()-1 : factor_partition_.size();
+   overlapping_partition_passes_.clear();
+   overlapping_partition_passes_.resize(no_windows);
+#pragma omp parallel for schedule(dynamic)
+   for(std::size_t i=0; i<no_windows; ++i) {
+      std::vector<FactorTypeAdapter*> factors(factor_partition_[i].begin(), factor_partition_[i].end());
+      if(i+1 < factor_partition_.size()) {
+         factors.insert(factors.end(), factor_partition_[i+1].begin(), factor_partition_[i+1].end());
+      }
+      tsl::robin_map<const FactorTypeAdapter*, char> factor_set;
+      factor_set.reserve(factors.size());
+      for(auto* f : factors) { factor_set.insert({f, 1}); }
+      overlapping_partition_passes_[i] = construct_restricted_pass(factors, [&](const FactorTypeAdapter*, const FactorTypeAdapter* f) { return factor_set.count(f) > 0; });
+   }
+
+   // messages between partitions that are not adjacent
+   tsl::robin_map<const FactorTypeAdapter*, std::size_t> factor_to_partition;
+   factor_to_partition.reserve(std::distance(factor_begin, factor_end));
+   for(std::size_t p=0; p<factor_partition_.size(); ++p) {
+      for(auto* f : factor_partition_[p]) { factor_to_partition.insert({f, p}); }
+   }
+   auto far_apart = [&](const FactorTypeAdapter* f1, const FactorTypeAdapter* f2) {
+      const auto it1 = factor_to_partition.find(f1);
+      const auto it2 = factor_to_partition.find(f2);
+      if(it1 == factor_to_partition.end() || it2 == factor_to_partition.end()) { return false; }
+      return std::max(it1->second, it2->second) - std::min(it1->second, it2->second) >= 2;
+   };
+   std::vector<FactorTypeAdapter*> far_boundary_factors;
+   for(auto f_it=factor_begin; f_it!=factor_end; ++f_it) {
+      const auto messages = (*f_it)->get_messages();
+      if(std::any_of(messages.begin(), messages.end(), [&](const auto m) { return far_apart(*f_it, m.adjacent_factor); })) {
+         far_boundary_factors.push_back(*f_it);
+      }
+   }
+   far_boundary_pass_ = construct_restricted_pass(far_boundary_factors, far_apart);
+
+   if(debug()) {
+      std::cout << "overlapping factor partition: " << overlapping_partition_passes_.size() << " windows, " << far_boundary_factors.size() << " factors on messages spanning more than two partitions\n";
+   }
 }
 
-template<typename FMC>
-template<typename ITERATOR_1, typename ITERATOR_2>
-std::vector<FactorTypeAdapter*> LP<FMC>::concatenate_factors(ITERATOR_1 f1_begin, ITERATOR_1 f1_end, ITERATOR_2 f2_begin, ITERATOR_2 f2_end)
+template<typename FACTOR_ITERATOR>
+void factors_partition_storage::compute_partition_pass(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, const std::size_t no_passes)
 {
-    std::vector<FactorTypeAdapter*> f;
-    f.reserve(std::distance(f1_begin, f1_end) + std::distance(f2_begin, f2_end));
-    std::copy(f1_begin, f1_end, std::back_inserter(f));
-    std::copy(f2_begin, f2_end, std::back_inserter(f)); 
-    return f; 
+   construct_factor_partition(factor_begin, factor_end);
+
+#pragma omp parallel for schedule(dynamic)
+   for(std::size_t p=0; p<partition_passes_.size(); ++p) {
+      partition_passes_[p].compute(no_passes);
+   }
+
+   boundary_pass_.compute(1);
+}
+
+// windows i and i+2 are disjoint. Process all even windows concurrently, then all odd ones.
+// Messages between partitions further apart than one are covered by no window and are passed afterwards.
+template<typename FACTOR_ITERATOR>
+void factors_partition_storage::compute_overlapping_partition_pass(FACTOR_ITERATOR factor_begin, FACTOR_ITERATOR factor_end, const std::size_t no_passes)
+{
+   construct_overlapping_factor_partition(factor_begin, factor_end);
+
+   for(std::size_t parity=0; parity<2; ++parity) {
+#pragma omp parallel for schedule(dynamic)
+      for(std::size_t i=parity; i<overlapping_partition_passes_.size(); i+=2) {
+         overlapping_partition_passes_[i].compute(no_passes);
+      }
+   }
+
+   far_boundary_pass_.compute(1);
 }
 
 } // namespace LPMP
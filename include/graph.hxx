@@ -5,6 +5,8 @@
 #include <algorithm>
 #include <queue>
 #include <list>
+#include <cstdint>
+#include <omp.h>
 // TODO: decide on hash map
 #include "tsl/robin_set.h"
 #include <unordered_set>
@@ -52,6 +54,11 @@ namespace LPMP {
                 template<typename EDGE_ITERATOR, typename EDGE_INFORMATION_LAMBDA>
                     void construct(EDGE_ITERATOR edge_begin, EDGE_ITERATOR edge_end, EDGE_INFORMATION_LAMBDA f);
 
+                // take over an existing adjacency structure with sorted neighbors(i) and edge ids incident_edges(i) in the same order, e.g. cut_base_snapshot.
+                // Edge with id e is added iff mask(e), with information f(e). No sorting is needed.
+                template<typename ADJACENCY, typename EDGE_MASK_LAMBDA, typename EDGE_INFORMATION_LAMBDA>
+                    void construct_from_adjacency(const ADJACENCY& adj, EDGE_MASK_LAMBDA mask, EDGE_INFORMATION_LAMBDA f);
+
                 graph() {}
 
                 template<typename EDGE_ITERATOR, typename EDGE_ENDPOINTS_LAMBDA, typename EDGE_INFORMATION_LAMBDA>
@@ -101,6 +108,10 @@ namespace LPMP {
                 // enumerate all triangles and call f on each. f expects the three node indices (i<j<k) of triangles (sorted) and references to edges in lexicographical order (ij,ik,jk)
                 template<typename LAMBDA>
                     void for_each_triangle(LAMBDA f) const;
+                // same as above, but f is called concurrently from several threads, triangles come in no particular order and edge references are to copies of the edge information.
+                // Edges are oriented along the degeneracy ordering, so that each node only intersects with at most degeneracy many neighbors.
+                template<typename LAMBDA>
+                    void for_each_triangle_parallel(LAMBDA f) const;
 
                 // we enumerate quadrangles with the method C4 from "Arboricity and subgraph listin algorithms" by Norishige Chiba and Takao Nishizeki
                 template<typename LAMBDA>
@@ -166,6 +177,11 @@ namespace LPMP {
             template<typename MASK_OP, typename EDGE_OP>
                 std::vector<std::size_t> find_path(const std::size_t start_node, const std::size_t end_node, MASK_OP mask_op, EDGE_OP edge_op);
 
+            // shortest paths from start_node to all targets with one search, which stops as soon as all targets are reached.
+            // For each reached target, edge_op is called on the edges of the path and then path_op(path) with path going from start_node to the target.
+            template<typename TARGET_ITERATOR, typename MASK_OP, typename EDGE_OP, typename PATH_OP>
+                void find_paths(const std::size_t start_node, TARGET_ITERATOR targets_begin, TARGET_ITERATOR targets_end, MASK_OP mask_op, EDGE_OP edge_op, PATH_OP path_op);
+
             // traverse all edges that have at least one endpoint in current component
             template<typename CUT_EDGE_OP>
                 void traverse_component(const std::size_t start_node, CUT_EDGE_OP cut_edge_op);
@@ -227,6 +243,37 @@ namespace LPMP {
             return construct(edge_begin, edge_end, return_endpoints_op, f);
         }
 
+    template<typename EDGE_INFORMATION, bool SUPPORT_SISTER, bool SUPPORT_MASKING>
+        template<typename ADJACENCY, typename EDGE_MASK_LAMBDA, typename EDGE_INFORMATION_LAMBDA>
+        void graph<EDGE_INFORMATION, SUPPORT_SISTER, SUPPORT_MASKING>::construct_from_adjacency(const ADJACENCY& adj, EDGE_MASK_LAMBDA mask, EDGE_INFORMATION_LAMBDA f)
+        {
+            std::vector<std::size_t> adjacency_list_count(adj.no_nodes(), 0);
+            for(std::size_t i=0; i<adj.no_nodes(); ++i)
+                for(const auto e : adj.incident_edges(i))
+                    if(mask(e))
+                        adjacency_list_count[i]++;
+
+            edges_.resize(adjacency_list_count.begin(), adjacency_list_count.end());
+
+            for(std::size_t i=0; i<adj.no_nodes(); ++i) {
+                const auto neighbors = adj.neighbors(i);
+                const auto incident_edges = adj.incident_edges(i);
+                assert(std::is_sorted(neighbors.begin(), neighbors.end()));
+                std::size_t c = 0;
+                for(std::size_t k=0; k<neighbors.size(); ++k) {
+                    if(!mask(incident_edges[k]))
+                        continue;
+                    edges_[i][c].head_ = neighbors[k];
+                    edges_[i][c].edge() = f(incident_edges[k]);
+                    c++;
+                }
+                assert(c == adjacency_list_count[i]);
+            }
+
+            set_sister_pointers();
+            check_graph();
+        }
+
     template<typename EDGE_INFORMATION, bool SUPPORT_SISTER, bool SUPPORT_MASKING>
         template<typename EDGE_ITERATOR, typename EDGE_ENDPOINTS_LAMBDA, typename EDGE_INFORMATION_LAMBDA>
         graph<EDGE_INFORMATION, SUPPORT_SISTER, SUPPORT_MASKING>::graph(EDGE_ITERATOR edge_begin, EDGE_ITERATOR edge_end, EDGE_ENDPOINTS_LAMBDA e, EDGE_INFORMATION_LAMBDA f)
@@ -318,45 +365,104 @@ namespace LPMP {
         }
 
     // enumerate all triangles and call f on each. f expects the three node indices (i<j<k) of triangles (sorted) and references to edges in lexicographical order (ij,ik,jk)
+    // Neighbors j>i of i are marked with their position in i's adjacency list, so that for each edge ij the common neighbors k>j are found by one pass over j's adjacency list.
     template<typename EDGE_INFORMATION, bool SUPPORT_SISTER, bool SUPPORT_MASKING>
         template<typename LAMBDA>
         void graph<EDGE_INFORMATION, SUPPORT_SISTER, SUPPORT_MASKING>::for_each_triangle(LAMBDA f) const
         {
-            struct triangle_intersection_type {
-                triangle_intersection_type(std::size_t _k, const edge_type* _ik, const edge_type* _jk) : k(_k), ik(_ik), jk(_jk) {}
-                std::size_t k;
-                const edge_type* ik;
-                const edge_type* jk;
-            };
-            auto edge_intersection_merge = [](const edge_type& e1, const edge_type& e2) -> triangle_intersection_type {
-                assert(e1.head() == e2.head());
-                const auto k = e1.head();
-                return triangle_intersection_type(k, &e1, &e2);
-            };
-            auto edge_intersection_sort = [](const edge_type& e1, const edge_type& e2) { return e1.head() < e2.head(); };
-
-            std::vector<triangle_intersection_type> common_nodes;
+            std::vector<std::uint32_t> marker(no_nodes(), 0); // 1 + position in adjacency list of i
             for(std::size_t i=0; i<no_nodes(); ++i) {
-                for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it) {
+                const auto upper_begin = std::upper_bound(begin(i), end(i), i, edge_comparator{});
+                for(auto edge_it=upper_begin; edge_it!=end(i); ++edge_it)
+                    marker[edge_it->head()] = 1 + std::distance(begin(i), edge_it);
+
+                for(auto edge_it=upper_begin; edge_it!=end(i); ++edge_it) {
                     const auto j = edge_it->head();
-                    if(i<j) {
-                        // Now find all neighbors of both i and j to see where the triangles are
-                        common_nodes.clear();
-                        auto intersects_iter_end = set_intersection_merge(
-                                edges_[i].begin(), edges_[i].end(), edges_[j].begin(), edges_[j].end(),
-                                std::back_inserter(common_nodes), edge_intersection_sort, edge_intersection_merge);
+                    for(auto jk_it=std::upper_bound(begin(j), end(j), j, edge_comparator{}); jk_it!=end(j); ++jk_it) {
+                        const auto k = jk_it->head();
+                        if(marker[k] == 0)
+                            continue;
+                        const auto& ik = *(begin(i) + marker[k] - 1);
+                        assert(ik.head() == k);
+                        f(i,j,k, edge_it->edge(), ik.edge(), jk_it->edge()); // edge costs: 01, 02, 12
+                    }
+                }
 
-                        for(const triangle_intersection_type t : common_nodes) {
-                            const auto k = t.k;
+                for(auto edge_it=upper_begin; edge_it!=end(i); ++edge_it)
+                    marker[edge_it->head()] = 0;
+            }
+        }
 
-                            // Since a triplet shows up three times as an edge plus a node, we only consider it for the case when i<j<k
-                            if(!(j<k)) { continue; }
+    template<typename EDGE_INFORMATION, bool SUPPORT_SISTER, bool SUPPORT_MASKING>
+        template<typename LAMBDA>
+        void graph<EDGE_INFORMATION, SUPPORT_SISTER, SUPPORT_MASKING>::for_each_triangle_parallel(LAMBDA f) const
+        {
+            if(no_nodes() == 0)
+                return;
+
+            // orient edges from nodes removed earlier in the degeneracy ordering to nodes removed later
+            const std::vector<std::size_t> ordering = degeneracy_ordering();
+            std::vector<std::uint32_t> rank(no_nodes());
+            for(std::size_t c=0; c<ordering.size(); ++c)
+                rank[ordering[c]] = ordering.size() - 1 - c;
+
+            std::vector<std::size_t> out_degree(no_nodes(), 0);
+#pragma omp parallel for schedule(static)
+            for(std::size_t i=0; i<no_nodes(); ++i)
+                for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it)
+                    out_degree[i] += rank[edge_it->head()] > rank[i];
+
+            // oriented edges hold a copy of the edge information, f gets references to these copies
+            struct out_edge {
+                std::uint32_t head;
+                EDGE_INFORMATION edge;
+            };
+            two_dim_variable_array<out_edge> out_edges(out_degree.begin(), out_degree.end());
+#pragma omp parallel for schedule(static)
+            for(std::size_t i=0; i<no_nodes(); ++i) {
+                std::size_t c = 0;
+                for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it)
+                    if(rank[edge_it->head()] > rank[i])
+                        out_edges(i, c++) = {std::uint32_t(edge_it->head()), edge_it->edge()};
+            }
 
-                            assert(t.ik->tail() == i && t.jk->tail() == j);
-                            //f(i,j,k, *edge_it, *(t.ik), *(t.jk));
-                            f(i,j,k, edge_it->edge(), t.ik->edge(), t.jk->edge()); // edge costs: 01, 02, 12
+#pragma omp parallel
+            {
+                std::vector<std::uint32_t> marker(no_nodes(), 0); // 1 + position in out_edges[u]
+#pragma omp for schedule(dynamic, 64)
+                for(std::size_t u=0; u<no_nodes(); ++u) {
+                    for(std::size_t c=0; c<out_edges[u].size(); ++c)
+                        marker[out_edges(u,c).head] = c+1;
+
+                    for(const out_edge& uv : out_edges[u]) {
+                        const std::size_t v = uv.head;
+                        for(const out_edge& vw : out_edges[v]) {
+                            const std::size_t w = vw.head;
+                            if(marker[w] == 0)
+                                continue;
+                            const out_edge& uw = out_edges(u, marker[w]-1);
+
+                            // sort nodes and edges lexicographically
+                            if(u < v) {
+                                if(v < w)
+                                    f(u,v,w, uv.edge, uw.edge, vw.edge);
+                                else if(u < w)
+                                    f(u,w,v, uw.edge, uv.edge, vw.edge);
+                                else
+                                    f(w,u,v, uw.edge, vw.edge, uv.edge);
+                            } else {
+                                if(u < w)
+                                    f(v,u,w, uv.edge, vw.edge, uw.edge);
+                                else if(v < w)
+                                    f(v,w,u, vw.edge, uv.edge, uw.edge);
+                                else
+                                    f(w,v,u, vw.edge, uw.edge, uv.edge);
+                            }
                         }
                     }
+
+                    for(const out_edge& uv : out_edges[u])
+                        marker[uv.head] = 0;
                 }
             }
         }
@@ -424,49 +530,43 @@ namespace LPMP {
     template<typename EDGE_INFORMATION, bool SUPPORT_SISTER, bool SUPPORT_MASKING>
     std::vector<size_t> graph<EDGE_INFORMATION, SUPPORT_SISTER, SUPPORT_MASKING>::degeneracy_ordering() const
     {
-        std::vector<size_t> degeneracy_ordering;
-        degeneracy_ordering.reserve(no_nodes());
-
-        std::vector<size_t> degree;
-        degree.reserve(no_nodes());
+        // bucket sort of nodes by remaining degree as in "An O(m) Algorithm for Cores Decomposition of Networks" by Batagelj and Zaversnik.
+        // degeneracy_ordering holds the nodes sorted by degree, nodes before position iter are removed.
+        std::vector<size_t> degree(no_nodes());
         for(size_t v=0; v<no_nodes(); ++v)
-            degree.push_back(no_edges(v));
-        const size_t max_degree = *std::max_element(degree.begin(), degree.end());
+            degree[v] = no_edges(v);
+        const size_t max_degree = no_nodes() > 0 ? *std::max_element(degree.begin(), degree.end()) : 0;
 
-        std::vector<std::list<size_t>::iterator> D_ptr;
-        D_ptr.reserve(no_nodes());
-        std::vector<std::list<size_t>> D(max_degree+1);
+        std::vector<size_t> bucket_begin(max_degree+2, 0);
         for(size_t v=0; v<no_nodes(); ++v)
+            bucket_begin[degree[v]+1]++;
+        for(size_t d=0; d<=max_degree; ++d)
+            bucket_begin[d+1] += bucket_begin[d];
+        std::vector<size_t> degeneracy_ordering(no_nodes());
+        std::vector<size_t> position(no_nodes());
         {
-            D[no_edges(v)].push_front(v);
-            D_ptr.push_back(D[no_edges(v)].begin());
+            std::vector<size_t> fill(bucket_begin.begin(), bucket_begin.end()-1);
+            for(size_t v=0; v<no_nodes(); ++v) {
+                position[v] = fill[degree[v]]++;
+                degeneracy_ordering[position[v]] = v;
+            }
         }
 
         for(size_t iter=0; iter<no_nodes(); ++iter)
         {
-            // find smallest remaining degree element
-            const size_t min_d = [&]() {
-                for(size_t d=0; d<D.size(); ++d)
-                    if(!D[d].empty())
-                        return d;
-                throw std::runtime_error("in degeneracy_ordering(): degree list empty.");
-            }();
-
-            const size_t i = D[min_d].front();
-            D[min_d].pop_front();
-            degree[i] = 0;
-            degeneracy_ordering.push_back(i);
-
+            const size_t i = degeneracy_ordering[iter];
             for(auto edge_it=begin(i); edge_it!=end(i); ++edge_it)
             {
+                // move j to the front of its bucket and decrease its degree
                 const size_t j = edge_it->head();
-                if(degree[j] == 0)
+                if(degree[j] <= degree[i])
                     continue;
-
-                D[degree[j]].erase(D_ptr[j]);
+                const size_t front = std::max(bucket_begin[degree[j]], iter+1);
+                const size_t k = degeneracy_ordering[front];
+                std::swap(degeneracy_ordering[position[j]], degeneracy_ordering[front]);
+                std::swap(position[j], position[k]);
+                bucket_begin[degree[j]] = front+1;
                 degree[j]--;
-                D[degree[j]].push_front(j);
-                D_ptr[j] = D[degree[j]].begin();
             } 
         } 
 
@@ -785,6 +885,57 @@ namespace LPMP {
             return std::vector<std::size_t>({});
         }
 
+    // targets are labelled2 until reached, then they are expanded like all other nodes
+    template<typename GRAPH>
+        template<typename TARGET_ITERATOR, typename MASK_OP, typename EDGE_OP, typename PATH_OP>
+        void bfs_data<GRAPH>::find_paths(const std::size_t start_node, TARGET_ITERATOR targets_begin, TARGET_ITERATOR targets_end, MASK_OP mask_op, EDGE_OP edge_op, PATH_OP path_op)
+        {
+            assert(start_node < g.no_nodes());
+            reset();
+            std::size_t nr_targets = 0;
+            for(auto it=targets_begin; it!=targets_end; ++it) {
+                assert(*it < g.no_nodes() && *it != start_node);
+                if(!labelled2(*it)) {
+                    label2(*it);
+                    ++nr_targets;
+                }
+            }
+            visit.push_back({start_node, 0});
+            label1(start_node);
+            parent(start_node) = start_node;
+
+            std::vector<std::size_t> path;
+            while(!visit.empty() && nr_targets > 0) {
+                const std::size_t i = visit.front()[0];
+                const std::size_t distance = visit.front()[1];
+                visit.pop_front();
+
+                for(auto a_it=g.begin(i); a_it!=g.end(i) && nr_targets > 0; ++a_it) {
+                    const std::size_t j = a_it->head();
+                    if(labelled1(j) || !mask_op(i,j,a_it->edge(), distance))
+                        continue;
+
+                    const bool target = labelled2(j);
+                    visit.push_back({j, distance+1});
+                    d[j].e = a_it->edge();
+                    parent(j) = i;
+                    label1(j);
+
+                    if(target) {
+                        path.clear();
+                        for(std::size_t k=j; parent(k) != k; k = parent(k)) {
+                            edge_op(k, parent(k), d[k].e);
+                            path.push_back(k);
+                        }
+                        path.push_back(start_node);
+                        std::reverse(path.begin(), path.end());
+                        path_op(path);
+                        --nr_targets;
+                    }
+                }
+            }
+        }
+
     // traverse all edges that have at least one endpoint in current component
     template<typename GRAPH>
         template<typename CUT_EDGE_OP>
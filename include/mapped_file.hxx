@@ -0,0 +1,59 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace LPMP {
+
+// read only memory mapping of a whole file
+class mapped_file {
+public:
+   mapped_file(const std::string& filename)
+   {
+      fd_ = open(filename.c_str(), O_RDONLY);
+      if(fd_ < 0) {
+         throw std::runtime_error("could not open file " + filename);
+      }
+      struct stat st;
+      if(fstat(fd_, &st) != 0) {
+         close(fd_);
+         throw std::runtime_error("could not read file " + filename);
+      }
+      size_ = st.st_size;
+      if(size_ > 0) {
+         data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+         if(data_ == MAP_FAILED) {
+            close(fd_);
+            throw std::runtime_error("could not map file " + filename);
+         }
+         madvise(data_, size_, MADV_SEQUENTIAL);
+      }
+   }
+
+   ~mapped_file()
+   {
+      if(size_ > 0) {
+         munmap(data_, size_);
+      }
+      close(fd_);
+   }
+
+   mapped_file(const mapped_file&) = delete;
+   mapped_file& operator=(const mapped_file&) = delete;
+
+   const char* data() const { return static_cast<const char*>(data_); }
+   const char* begin() const { return data(); }
+   const char* end() const { return data() + size_; }
+   std::size_t size() const { return size_; }
+
+private:
+   int fd_;
+   void* data_ = nullptr;
+   std::size_t size_ = 0;
+};
+
+} // namespace LPMP
@@ -5,6 +5,7 @@
 namespace LPMP {
 
     max_cut_edge_labeling greedy_additive_edge_contraction(const max_cut_instance& instance);
+    max_cut_edge_labeling greedy_additive_edge_contraction(const max_cut_snapshot& instance);
 
 }
 
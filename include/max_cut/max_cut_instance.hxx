@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cut_base/cut_base_instance.hxx"
+#include "cut_base/cut_base_snapshot.hxx"
 #include "max_cut_factors_messages.h"
 #include <cassert>
 #include "union_find.hxx"
@@ -14,6 +15,11 @@ struct max_cut_instance : public cut_base_instance {
     void write_problem(STREAM& s) const;
 };
 
+// memory mapped max-cut instance, see cut_base_snapshot.hxx
+struct max_cut_snapshot : public cut_base_snapshot {
+    using cut_base_snapshot::cut_base_snapshot;
+};
+
 struct max_cut_node_labeling : public cut_base_node_labeling {
     using cut_base_node_labeling::cut_base_node_labeling;
 };
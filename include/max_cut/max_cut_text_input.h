@@ -6,5 +6,9 @@ namespace LPMP {
     namespace max_cut_text_input {
         max_cut_instance parse_string(const std::string& input);
         max_cut_instance parse_file(const std::string& filename); 
+
+        // same as above with the PEGTL grammar instead of the memory mapped parallel reader
+        max_cut_instance parse_string_pegtl(const std::string& input);
+        max_cut_instance parse_file_pegtl(const std::string& filename); 
     }
 }
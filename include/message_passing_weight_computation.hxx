@@ -11,11 +11,6 @@
 
 namespace LPMP {
 
-using weight_array = two_dim_variable_array<double>;
-using weight_slice = two_dim_variable_array<double>::ArrayAccessObject;
-using receive_array = two_dim_variable_array<unsigned char>;
-using receive_slice = two_dim_variable_array<unsigned char>::ArrayAccessObject;
-
 template<typename ITERATOR>
 weight_array allocate_omega(ITERATOR factor_begin, ITERATOR factor_end)
 {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "permutation.hxx"
+#include "clique_graph.hxx"
 #include <Eigen/OrderingMethods>
 #include <vector>
 #include <limits>
@@ -30,5 +31,31 @@ namespace LPMP {
         return o; 
     }
 
+    // Approximate minimum degree ordering of the graph formed by the cliques, computed by COLAMD on the clique/node incidence matrix M without forming M^T M.
+    // COLAMD ignores very dense cliques, such that long constraints do not dominate the ordering.
+    inline permutation minimum_degree_ordering(const clique_graph& g)
+    {
+        Eigen::SparseMatrix<double> M(g.nr_cliques(), g.size());
+        std::vector< Eigen::Triplet<double> > incidence;
+        for(std::size_t c=0; c<g.nr_cliques(); ++c) {
+            for(const std::size_t i : g.clique(c)) {
+                assert(i <= std::numeric_limits<int>::max());
+                incidence.push_back({int(c), int(i), 1.0});
+            }
+        }
+        M.setFromTriplets(incidence.begin(), incidence.end());
+        M.makeCompressed();
+
+        Eigen::COLAMDOrdering<int> ordering;
+        Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> perm(g.size());
+        ordering(M, perm);
+        // perm maps nodes to their position
+        permutation o(g.size());
+        for(std::size_t i=0; i<g.size(); ++i) {
+            o[perm.indices()[i]] = i;
+        }
+        return o;
+    }
+
 
 } 
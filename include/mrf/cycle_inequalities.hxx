@@ -9,6 +9,8 @@
 #include <vector>
 #include <algorithm>
 #include <set>
+#include <array>
+#include <omp.h>
 //#include <list>
 //#include <map>
 //#include <queue>
@@ -52,75 +54,39 @@ public:
 
    std::vector<triplet_candidate> search()
    {
-      // Initialize adjacency list (filled in later) TODO: only do this when needed
-      std::vector<std::vector<std::size_t> > adjacency_list(gm_.get_number_of_variables());
-
-      // Construct adjacency list for the graph
-      // Iterate over all of the edges (we do this by looking at the edge intersection sets)
+      // graph with pairwise factor ids as edge information
+      struct factor_edge : public std::array<std::size_t,2> { std::size_t factor_id; };
+      std::vector<factor_edge> edges;
+      edges.reserve(gm_.get_number_of_pairwise_factors());
       for(size_t factorId=0; factorId<gm_.get_number_of_pairwise_factors(); factorId++) {
          auto vars = gm_.get_pairwise_variables(factorId);
-         // Get the two nodes i & j
-         const size_t i=std::get<0>(vars);
-         const size_t j=std::get<1>(vars);
-         assert(i<j);
-         adjacency_list[i].push_back(j);
-         adjacency_list[j].push_back(i);
-      }
-
-      // Sort the adjacency list, for fast intersections later
-#pragma omp parallel for schedule(guided)
-      for(std::size_t i=0; i < adjacency_list.size(); i++) {
-         std::sort(adjacency_list[i].begin(), adjacency_list[i].end());
+         assert(std::get<0>(vars) < std::get<1>(vars));
+         edges.push_back({std::get<0>(vars), std::get<1>(vars), factorId});
       }
+      const graph<std::size_t> g(edges.begin(), edges.end(), [](const factor_edge& e) { return e.factor_id; });
+
+      // triangles are enumerated in parallel along the degeneracy ordering, candidates are collected per thread
+      std::vector<std::vector<triplet_candidate>> triplet_candidates_local(omp_get_max_threads());
+      g.for_each_triangle_parallel([&](const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t ij, const std::size_t ik, const std::size_t jk) {
+         const auto& factor_ij = *gm_.get_pairwise_factor(ij)->get_factor();
+         const auto& factor_ik = *gm_.get_pairwise_factor(ik)->get_factor();
+         const auto& factor_jk = *gm_.get_pairwise_factor(jk)->get_factor();
+         const double boundIndep = factor_ij.LowerBound() + factor_ik.LowerBound() + factor_jk.LowerBound();
+         const double boundCycle = minimizeTriangle(factor_ij, factor_ik, factor_jk);
+
+         const double bound = boundCycle - boundIndep; 
+         assert(bound >=  - eps);
+         if(bound > eps_)
+            triplet_candidates_local[omp_get_thread_num()].push_back(triplet_candidate(i,j,k, bound));
+      });
 
       std::vector<triplet_candidate> triplet_candidates;
-
-      // Iterate over all of the edge intersection sets
-#pragma omp parallel 
-      {
-         std::vector<std::size_t> commonNodes(gm_.get_number_of_variables()-1);
-         std::vector<triplet_candidate> triplet_candidates_local;
-#pragma omp for schedule(guided)
-         for(size_t factorId=0; factorId<gm_.get_number_of_pairwise_factors(); factorId++) {
-            auto vars = gm_.get_pairwise_variables(factorId);
-            const std::size_t i=std::get<0>(vars);
-            const std::size_t j=std::get<1>(vars);
-            const auto& factor_ij = *gm_.get_pairwise_factor(i,j)->get_factor();
-            const double lb_ij = factor_ij.LowerBound();
-
-            // Now find all neighbors of both i and j to see where the triangles are
-            auto intersects_iter_end = set_intersection(adjacency_list[i].begin(), adjacency_list[i].end(), adjacency_list[j].begin(), adjacency_list[j].end(), commonNodes.begin());
-            assert(adjacency_list[i].size() <= commonNodes.size() && adjacency_list[j].size() <= commonNodes.size());
-
-            for(auto n=commonNodes.begin(); n != intersects_iter_end; ++n) {
-               std::size_t k = *n;
-
-               // Since a triplet shows up multiple times, we only consider it for the case when i<j<k 
-               if(!(j<k))
-                  continue;
-
-               const auto& factor_ik = *gm_.get_pairwise_factor(i,k)->get_factor();
-               const auto& factor_jk = *gm_.get_pairwise_factor(j,k)->get_factor();
-               const double boundIndep = lb_ij + factor_ik.LowerBound() + factor_jk.LowerBound();
-               const double boundCycle = minimizeTriangle(factor_ij, factor_ik, factor_jk);
-
-               const double bound = boundCycle - boundIndep; 
-               assert(bound >=  - eps);
-               if(bound > eps_) {
-                  triplet_candidate t(i,j,k, bound);
-                  triplet_candidates_local.push_back(t);
-               }
-            }
-         }
-#pragma omp critical
-         {
-            triplet_candidates.insert(triplet_candidates.end(), triplet_candidates_local.begin(), triplet_candidates_local.end());
-         }
-      }
+      for(const auto& c : triplet_candidates_local)
+         triplet_candidates.insert(triplet_candidates.end(), c.begin(), c.end());
 
       std::sort(triplet_candidates.begin(), triplet_candidates.end());
 
-      return std::move(triplet_candidates);
+      return triplet_candidates;
    }
 
 protected:
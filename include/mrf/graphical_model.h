@@ -53,6 +53,26 @@ struct FMC_SRMP_T { // equivalent to SRMP or TRWS
 
 
 
+// as FMC_SRMP, truncated linear and quadratic pairwise potentials are represented compactly and their min-marginals are computed by distance transforms
+struct FMC_SRMP_TRUNCATED {
+   constexpr static const char* name = "SRMP for pairwise case with truncated pairwise potentials";
+
+   using UnaryFactor = FactorContainer<UnarySimplexFactor, FMC_SRMP_TRUNCATED, 0, true >;
+   using PairwiseFactor = FactorContainer<PairwiseSimplexFactor, FMC_SRMP_TRUNCATED, 1, false >;
+   using TruncatedPairwiseFactor = FactorContainer<pairwise_truncated_factor, FMC_SRMP_TRUNCATED, 2, false >;
+
+   using UnaryPairwiseMessageLeftContainer = MessageContainer<UnaryPairwiseMessage<Chirality::left,false>, 0, 1, message_passing_schedule::left, variableMessageNumber, 1, FMC_SRMP_TRUNCATED, 0 >;
+   using UnaryPairwiseMessageRightContainer = MessageContainer<UnaryPairwiseMessage<Chirality::right,false>, 0, 1, message_passing_schedule::left, variableMessageNumber, 1, FMC_SRMP_TRUNCATED, 1 >;
+   using UnaryTruncatedMessageLeftContainer = MessageContainer<UnaryPairwiseMessage<Chirality::left,false>, 0, 2, message_passing_schedule::left, variableMessageNumber, 1, FMC_SRMP_TRUNCATED, 2 >;
+   using UnaryTruncatedMessageRightContainer = MessageContainer<UnaryPairwiseMessage<Chirality::right,false>, 0, 2, message_passing_schedule::left, variableMessageNumber, 1, FMC_SRMP_TRUNCATED, 3 >;
+
+   using FactorList = meta::list< UnaryFactor, PairwiseFactor, TruncatedPairwiseFactor >;
+   using MessageList = meta::list< UnaryPairwiseMessageLeftContainer, UnaryPairwiseMessageRightContainer, UnaryTruncatedMessageLeftContainer, UnaryTruncatedMessageRightContainer >;
+
+   using mrf = mrf_constructor<FMC_SRMP_TRUNCATED,0,1,0,1>;
+   using problem_constructor = truncated_mrf_constructor<mrf,2,2,3>;
+};
+
 struct FMC_MPLP {
    constexpr static const char* name = "MPLP for pairwise case";
 
@@ -69,4 +89,23 @@ struct FMC_MPLP {
    using problem_constructor = mrf;
 };
 
+struct FMC_MPLP_TRUNCATED {
+   constexpr static const char* name = "MPLP for pairwise case with truncated pairwise potentials";
+
+   using UnaryFactor = FactorContainer<UnarySimplexFactor, FMC_MPLP_TRUNCATED, 0, true>;
+   using PairwiseFactor = FactorContainer<PairwiseSimplexFactor, FMC_MPLP_TRUNCATED, 1, false>;
+   using TruncatedPairwiseFactor = FactorContainer<pairwise_truncated_factor, FMC_MPLP_TRUNCATED, 2, false>;
+
+   using UnaryPairwiseMessageLeftContainer = MessageContainer<UnaryPairwiseMessage<Chirality::left,false>, 0, 1, message_passing_schedule::right, variableMessageNumber, 1, FMC_MPLP_TRUNCATED, 0 >;
+   using UnaryPairwiseMessageRightContainer = MessageContainer<UnaryPairwiseMessage<Chirality::right,false>, 0, 1, message_passing_schedule::right, variableMessageNumber, 1, FMC_MPLP_TRUNCATED, 1 >;
+   using UnaryTruncatedMessageLeftContainer = MessageContainer<UnaryPairwiseMessage<Chirality::left,false>, 0, 2, message_passing_schedule::right, variableMessageNumber, 1, FMC_MPLP_TRUNCATED, 2 >;
+   using UnaryTruncatedMessageRightContainer = MessageContainer<UnaryPairwiseMessage<Chirality::right,false>, 0, 2, message_passing_schedule::right, variableMessageNumber, 1, FMC_MPLP_TRUNCATED, 3 >;
+
+   using FactorList = meta::list< UnaryFactor, PairwiseFactor, TruncatedPairwiseFactor >;
+   using MessageList = meta::list< UnaryPairwiseMessageLeftContainer, UnaryPairwiseMessageRightContainer, UnaryTruncatedMessageLeftContainer, UnaryTruncatedMessageRightContainer >;
+
+   using mrf = mrf_constructor<FMC_MPLP_TRUNCATED,0,1,0,1>;
+   using problem_constructor = truncated_mrf_constructor<mrf,2,2,3>;
+};
+
 } // namespace LPMP
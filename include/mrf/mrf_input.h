@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
 #include "two_dimensional_variable_array.hxx"
 #include "three_dimensional_variable_array.hxx"
 
@@ -10,6 +12,8 @@ namespace LPMP {
        two_dim_variable_array<double> unaries;
        three_dimensional_variable_array<double> pairwise_values;
        std::vector<std::array<std::size_t,2>> pairwise_indices;
+       // optional: pairwise potentials with equal id have identical cost tables. Ids are contiguous, starting at zero.
+       std::vector<std::size_t> pairwise_table_ids;
        // higher order potentials not supported currently
 
        std::size_t no_variables() const { return unaries.size(); }
@@ -44,6 +48,10 @@ namespace LPMP {
 
        void propagate();
 
+       // detect identical pairwise cost tables by hashing
+       void compute_pairwise_table_ids();
+       std::size_t no_pairwise_tables() const;
+
        bool is_Potts(const std::size_t pairwise_idx) const;
        double Potts_strength(const std::size_t pairwise_index) const;
    };
@@ -121,6 +129,7 @@ namespace LPMP {
    inline void mrf_input::propagate()
    {
        // if exactly one unary variable is active, incorporate pairwise costs into unary ones
+       pairwise_table_ids.clear(); // pairwise potentials change
        for(std::size_t pairwise_idx = 0; pairwise_idx < no_pairwise_factors(); ++pairwise_idx)
        {
            const auto [i, j] = get_pairwise_variables(pairwise_idx);
@@ -150,6 +159,53 @@ namespace LPMP {
        }
    }
 
+   inline void mrf_input::compute_pairwise_table_ids()
+   {
+       auto table_hash = [&](const std::size_t i) {
+           const auto pot = get_pairwise_potential(i);
+           std::size_t h = std::hash<std::size_t>()(pot.dim1()) ^ (std::hash<std::size_t>()(pot.dim2()) << 1);
+           for(std::size_t l1=0; l1<pot.dim1(); ++l1)
+               for(std::size_t l2=0; l2<pot.dim2(); ++l2)
+                   h ^= std::hash<double>()(pot(l1,l2)) + 0x9e3779b9 + (h << 6) + (h >> 2);
+           return h;
+       };
+       auto tables_equal = [&](const std::size_t i, const std::size_t j) {
+           const auto pot_i = get_pairwise_potential(i);
+           const auto pot_j = get_pairwise_potential(j);
+           if(pot_i.dim1() != pot_j.dim1() || pot_i.dim2() != pot_j.dim2())
+               return false;
+           for(std::size_t l1=0; l1<pot_i.dim1(); ++l1)
+               for(std::size_t l2=0; l2<pot_i.dim2(); ++l2)
+                   if(pot_i(l1,l2) != pot_j(l1,l2))
+                       return false;
+           return true;
+       };
+
+       pairwise_table_ids.clear();
+       pairwise_table_ids.reserve(no_pairwise_factors());
+       std::vector<std::size_t> representative; // pairwise factor holding table with given id
+       std::unordered_map<std::size_t, std::vector<std::size_t>> hash_to_ids;
+       for(std::size_t i=0; i<no_pairwise_factors(); ++i)
+       {
+           auto& ids = hash_to_ids[table_hash(i)];
+           auto it = std::find_if(ids.begin(), ids.end(), [&](const std::size_t id) { return tables_equal(representative[id], i); });
+           if(it != ids.end()) {
+               pairwise_table_ids.push_back(*it);
+           } else {
+               ids.push_back(representative.size());
+               pairwise_table_ids.push_back(representative.size());
+               representative.push_back(i);
+           }
+       }
+   }
+
+   inline std::size_t mrf_input::no_pairwise_tables() const
+   {
+       if(pairwise_table_ids.size() != no_pairwise_factors())
+           return no_pairwise_factors();
+       return pairwise_table_ids.empty() ? 0 : *std::max_element(pairwise_table_ids.begin(), pairwise_table_ids.end()) + 1;
+   }
+
    inline bool mrf_input::is_Potts(const std::size_t pairwise_idx) const
    {
        assert(pairwise_idx < no_pairwise_factors());
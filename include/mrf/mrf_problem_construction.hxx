@@ -6,10 +6,12 @@
 #include "tree_decomposition.hxx"
 #include "arboricity.h"
 #include "mrf_input.h"
+#include "pairwise_truncated_factor.h"
 
 #include <string>
 #include <vector>
 #include <functional>
+#include <memory>
 
 namespace LPMP {
 
@@ -91,9 +93,47 @@ public:
 
    PairwiseFactorContainer* add_pairwise_factor(const std::size_t var1, const std::size_t var2)
    { 
+      return add_pairwise_factor_impl(var1, var2, get_number_of_labels(var1), get_number_of_labels(var2));
+   }
+
+   // pairwise factor referring to a cost table that may be shared with other factors
+   PairwiseFactorContainer* add_shared_pairwise_factor(const std::size_t var1, const std::size_t var2, std::shared_ptr<const matrix<REAL>> cost)
+   {
+      assert(cost->dim1() == get_number_of_labels(var1) && cost->dim2() == get_number_of_labels(var2));
+      return add_pairwise_factor_impl(var1, var2, std::move(cost));
+   }
+
+   // add i-th pairwise potential of input. Factors whose potentials have the same table id share one cost table if the pairwise factor supports it.
+   PairwiseFactorContainer* add_input_pairwise_factor(const mrf_input& input, const std::size_t i, std::vector<std::shared_ptr<const matrix<REAL>>>& tables)
+   {
+      const auto [var1, var2] = input.get_pairwise_variables(i);
+      const auto cost = input.get_pairwise_potential(i);
+      if constexpr(std::is_constructible_v<PairwiseFactorType, std::shared_ptr<const matrix<REAL>>>) {
+         if(input.pairwise_table_ids.size() == input.no_pairwise_factors()) {
+            const std::size_t id = input.pairwise_table_ids[i];
+            if(id >= tables.size()) { tables.resize(id+1); }
+            if(!tables[id]) {
+               auto t = std::make_shared<matrix<REAL>>(cost.dim1(), cost.dim2());
+               for(std::size_t l1=0; l1<cost.dim1(); ++l1) {
+                  for(std::size_t l2=0; l2<cost.dim2(); ++l2) {
+                     (*t)(l1,l2) = cost(l1,l2);
+                  }
+               }
+               tables[id] = std::move(t);
+            }
+            return add_shared_pairwise_factor(var1, var2, tables[id]);
+         }
+      }
+      return add_pairwise_factor(var1, var2, cost);
+   }
+
+private:
+   template<typename... ARGS>
+   PairwiseFactorContainer* add_pairwise_factor_impl(const std::size_t var1, const std::size_t var2, ARGS&&... args)
+   {
       assert(var1<var2);
       assert(!has_pairwise_factor(var1,var2));
-      auto* p = lp_->template add_factor<PairwiseFactorContainer>(get_number_of_labels(var1), get_number_of_labels(var2));
+      auto* p = lp_->template add_factor<PairwiseFactorContainer>(std::forward<ARGS>(args)...);
       pairwiseFactor_.push_back(p);
       pairwiseIndices_.push_back(std::array<std::size_t,2>({var1,var2}));
       const std::size_t factorId = pairwiseFactor_.size()-1;
@@ -105,6 +145,7 @@ public:
       return p;
    }
 
+public:
    // TODO: remove this function
    PairwiseFactorContainer* add_empty_pairwise_factor(const std::size_t var1, const std::size_t var2)
    {
@@ -413,11 +454,12 @@ public:
       }
 
       assert(input.pairwise_indices.size() == input.pairwise_values.dim1());
+      std::vector<std::shared_ptr<const matrix<REAL>>> tables;
       for(std::size_t i=0; i<input.pairwise_indices.size(); ++i) {
-          const auto var1 = input.pairwise_indices[i][0];
-          const auto var2 = input.pairwise_indices[i][1];
-          auto pairwise_cost = input.pairwise_values[i];
-          this->add_pairwise_factor(var1,var2, pairwise_cost);
+          this->add_input_pairwise_factor(input, i, tables);
+      }
+      if(diagnostics() && input.pairwise_table_ids.size() == input.no_pairwise_factors()) {
+          std::cout << input.no_pairwise_factors() << " pairwise factors share " << input.no_pairwise_tables() << " distinct cost tables\n";
       }
   }
 
@@ -436,6 +478,107 @@ protected:
    LP<FMC>* lp_;
 };
 
+// derives from a given mrf problem constructor and represents pairwise potentials min(w*|x1-x2|, t) and min(w*(x1-x2)^2, t) by pairwise_truncated_factor instead of dense tables.
+// Such potentials are recognized automatically when constructing from mrf_input. Tree decompositions only cover the dense pairwise factors.
+template<class MRF_PROBLEM_CONSTRUCTOR, std::size_t TRUNCATED_FACTOR_NO, std::size_t TRUNCATED_LEFT_MESSAGE_NO, std::size_t TRUNCATED_RIGHT_MESSAGE_NO>
+class truncated_mrf_constructor : public MRF_PROBLEM_CONSTRUCTOR
+{
+public:
+   using MRFPC = MRF_PROBLEM_CONSTRUCTOR;
+   using FMC = typename MRFPC::FMC;
+
+   using TruncatedFactorContainer = meta::at_c<typename FMC::FactorList, TRUNCATED_FACTOR_NO>;
+   using TruncatedLeftMessageContainer = typename meta::at_c<typename FMC::MessageList, TRUNCATED_LEFT_MESSAGE_NO>::MessageContainerType;
+   using TruncatedRightMessageContainer = typename meta::at_c<typename FMC::MessageList, TRUNCATED_RIGHT_MESSAGE_NO>::MessageContainerType;
+
+   template<typename SOLVER>
+   truncated_mrf_constructor(SOLVER& pd)
+      : MRF_PROBLEM_CONSTRUCTOR(pd)
+   {}
+
+   TruncatedFactorContainer* add_truncated_pairwise_factor(const std::size_t var1, const std::size_t var2, const pairwise_truncated_factor::parameters& p)
+   {
+      assert(var1<var2);
+      auto* f = this->lp_->template add_factor<TruncatedFactorContainer>(this->get_number_of_labels(var1), this->get_number_of_labels(var2), p);
+      truncated_factor_.push_back(f);
+      truncated_indices_.push_back({var1,var2});
+
+      this->lp_->template add_message<TruncatedLeftMessageContainer>(this->get_unary_factor(var1), f);
+      this->lp_->template add_message<TruncatedRightMessageContainer>(this->get_unary_factor(var2), f);
+
+      return f;
+   }
+
+   std::size_t get_number_of_truncated_pairwise_factors() const { return truncated_factor_.size(); }
+   TruncatedFactorContainer* get_truncated_pairwise_factor(const std::size_t i) const { assert(i<truncated_factor_.size()); return truncated_factor_[i]; }
+   std::array<std::size_t,2> get_truncated_pairwise_variables(const std::size_t i) const { assert(i<truncated_indices_.size()); return truncated_indices_[i]; }
+
+   std::vector<FactorTypeAdapter*> get_factors()
+   {
+      auto factors = MRFPC::get_factors();
+      for(auto* f : truncated_factor_) { factors.push_back(f); }
+      return factors;
+   }
+
+   void order_factors()
+   {
+      MRFPC::order_factors();
+      for(std::size_t p=0; p<truncated_factor_.size(); ++p) {
+         const auto [i,j] = truncated_indices_[p];
+         this->lp_->add_factor_relation(this->get_unary_factor(i), truncated_factor_[p]);
+         this->lp_->add_factor_relation(truncated_factor_[p], this->get_unary_factor(j));
+      }
+   }
+
+   template<typename SOLVER>
+   void Construct(SOLVER& pd)
+   {
+      if(debug()) { std::cout << "Construct MRF problem with " << this->unaryFactor_.size() << " unary factors, " << this->pairwiseFactor_.size() << " dense and " << truncated_factor_.size() << " truncated pairwise factors\n"; }
+      order_factors();
+   }
+
+   void send_messages_to_unaries()
+   {
+      MRFPC::send_messages_to_unaries();
+      for(auto* f : truncated_factor_) {
+         auto left_msgs = f->template get_messages<TruncatedLeftMessageContainer>();
+         auto right_msgs = f->template get_messages<TruncatedRightMessageContainer>();
+         assert(left_msgs.size() == 1 && right_msgs.size() == 1);
+         left_msgs[0]->send_message_to_right(1.0);
+         right_msgs[0]->send_message_to_right(1.0);
+
+         left_msgs[0]->send_message_to_left(0.5);
+         right_msgs[0]->send_message_to_left(1.0);
+         left_msgs[0]->send_message_to_left(1.0);
+      }
+   }
+
+   void construct(const mrf_input& input)
+   {
+      for(std::size_t i=0; i<input.no_variables(); ++i) {
+         this->add_unary_factor(input.unaries[i]);
+      }
+
+      assert(input.pairwise_indices.size() == input.pairwise_values.dim1());
+      std::vector<std::shared_ptr<const matrix<REAL>>> tables;
+      for(std::size_t i=0; i<input.pairwise_indices.size(); ++i) {
+         const auto var1 = input.pairwise_indices[i][0];
+         const auto var2 = input.pairwise_indices[i][1];
+         if(const auto p = pairwise_truncated_factor::detect(input.pairwise_values[i])) {
+            add_truncated_pairwise_factor(var1, var2, *p);
+         } else {
+            this->add_input_pairwise_factor(input, i, tables);
+         }
+      }
+
+      if(diagnostics()) { std::cout << "recognized " << truncated_factor_.size() << " of " << input.pairwise_indices.size() << " pairwise potentials as truncated linear or quadratic\n"; }
+   }
+
+protected:
+   std::vector<TruncatedFactorContainer*> truncated_factor_;
+   std::vector<std::array<std::size_t,2>> truncated_indices_;
+};
+
 // derives from a given mrf problem constructor and adds tightening capabilities on top of it, as implemented in cycle_inequalities and proposed by David Sontag
 template<class MRF_PROBLEM_CONSTRUCTOR,
    std::size_t TERNARY_FACTOR_NO, std::size_t PAIRWISE_TRIPLET_MESSAGE12_NO, std::size_t PAIRWISE_TRIPLET_MESSAGE13_NO, std::size_t PAIRWISE_TRIPLET_MESSAGE23_NO> // the last indices indicate triplet factor and possible messages
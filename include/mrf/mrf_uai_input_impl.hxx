@@ -279,6 +279,9 @@ namespace mrf_uai_input {
 
        const bool read_success = problem.parse<typename grammar<PEGTL_STRING>::type, action>( input, input_helper );
        assert(read_success);
+       if constexpr(std::is_same_v<RETURN_TYPE, mrf_input>) {
+           input.compute_pairwise_table_ids();
+       }
        return input; 
    }
 
@@ -290,6 +293,9 @@ namespace mrf_uai_input {
 
        const bool read_success = pegtl::parse<typename grammar<PEGTL_STRING>::type, action>(uai_string, "", input, input_helper);
        assert(read_success);
+       if constexpr(std::is_same_v<RETURN_TYPE, mrf_input>) {
+           input.compute_pairwise_table_ids();
+       }
        return input;
    }
 
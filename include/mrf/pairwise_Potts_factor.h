@@ -27,6 +27,8 @@ public:
 
    vector<double> min_marginal_1() const;
    vector<double> min_marginal_2() const;
+   void min_marginal_1(vector<double>& m) const;
+   void min_marginal_2(vector<double>& m) const;
    double min_marginal_cut() const;
 
    std::size_t dim() const { return this->size()/2; }
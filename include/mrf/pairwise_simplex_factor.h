@@ -1,6 +1,8 @@
 #ifndef LPMP_PAIRWISE_SIMPLEX_FACTOR_H
 #define LPMP_PAIRWISE_SIMPLEX_FACTOR_H
 
+#include <memory>
+#include <algorithm>
 #include "vector.hxx"
 
 namespace LPMP {
@@ -8,18 +10,22 @@ namespace LPMP {
 // do zrobienia: if pairwise was supplied to us (e.g. external factor, then reflect this in constructor and only allocate space for messages.
 // When tightening, we can simply replace pairwise pointer to external factor with an explicit copy. Reallocate left_msg_ and right_msg_ to make memory contiguous? Not sure, depends whether we use block_allocator, which will not acually release the memory
 // when factor is copied, then pairwise_ must only be copied if it is actually modified. This depends on whether we execute SMRP or MPLP style message passing. Templatize for this possibility
-class PairwiseSimplexFactor : public matrix_expression<double, PairwiseSimplexFactor> {
+// The pairwise cost table may be shared between factors with identical costs. It is copied on first write access (copy on write), message passing only changes left_msg_ and right_msg_.
+class PairwiseSimplexFactor : public matrix_expression<REAL, PairwiseSimplexFactor> {
 public:
+   using cost_table = std::shared_ptr<const matrix<REAL>>;
+
    PairwiseSimplexFactor(const std::size_t _dim1, const std::size_t _dim2);
+   PairwiseSimplexFactor(cost_table pairwise);
    template<typename MATRIX>
    PairwiseSimplexFactor(const std::size_t dim1, const std::size_t dim2, const MATRIX& m);
    PairwiseSimplexFactor(const PairwiseSimplexFactor& o);
 
    void operator=(const PairwiseSimplexFactor& o);
-   double operator[](const std::size_t x) const;
-   double operator()(const std::size_t x1, const std::size_t x2) const;
-   double& cost(const std::size_t x1, const std::size_t x2);
-   double& cost(const std::size_t idx);
+   REAL operator[](const std::size_t x) const;
+   REAL operator()(const std::size_t x1, const std::size_t x2) const;
+   REAL& cost(const std::size_t x1, const std::size_t x2);
+   REAL& cost(const std::size_t idx);
    double LowerBound() const;
    template<std::size_t N>
    double lower_bound_except(const std::array<std::size_t,N> indices) const;
@@ -28,21 +34,30 @@ public:
    std::size_t dim1() const { return left_msg_.size(); }
    std::size_t dim2() const { return right_msg_.size(); }
    std::size_t dim(const std::size_t d) const;
-   double& pairwise(const std::size_t x1, const std::size_t x2) { assert(x1<dim1() && x2<dim2()); return pairwise_(x1,x2); }
-   double& msg1(const std::size_t x1) { assert(x1<dim1()); return left_msg_[x1]; }
-   double& msg2(const std::size_t x2) { assert(x2<dim2()); return right_msg_[x2]; }
+   REAL& pairwise(const std::size_t x1, const std::size_t x2) { assert(x1<dim1() && x2<dim2()); return mutable_pairwise()(x1,x2); }
+   bool shares_pairwise() const { return shared_pairwise_; }
+   REAL& msg1(const std::size_t x1) { assert(x1<dim1()); return left_msg_[x1]; }
+   REAL& msg2(const std::size_t x2) { assert(x2<dim2()); return right_msg_[x2]; }
    void init_primal();
    double EvaluatePrimal() const;
    void MaximizePotentialAndComputePrimal();
+   // subtract minimum from potential and return it
+   double normalize_potential();
 
    template<class ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar( primal_[0], primal_[1] ); }
    //template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( cereal::binary_data( pairwise_, sizeof(double)*(size()+dim1()+dim2()) ) ); }
-   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( left_msg_, right_msg_, pairwise_ ); }
+   // archives may write (e.g. divide, set_to_value), hence a shared cost table is unshared first. The layout does not depend on sharing.
+   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( left_msg_, right_msg_, mutable_pairwise() ); }
 
-   auto export_variables() { return std::tie(left_msg_, right_msg_, pairwise_); }
+   auto export_variables() { return std::tie(left_msg_, right_msg_, mutable_pairwise()); }
+   // read-only view, keeps a shared cost table shared
+   auto export_variables() const { return std::tie(left_msg_, right_msg_, static_cast<const matrix<REAL>&>(*pairwise_)); }
 
-   vector<double> min_marginal_1() const;
-   vector<double> min_marginal_2() const;
+   vector<REAL> min_marginal_1() const;
+   vector<REAL> min_marginal_2() const;
+   // write min-marginals into preallocated buffer of size dim1() resp. dim2()
+   void min_marginal_1(vector<REAL>& min) const;
+   void min_marginal_2(vector<REAL>& min) const;
 
    template<typename ARRAY>
    void apply(ARRAY& a) const;
@@ -55,11 +70,15 @@ public:
    std::array<std::size_t,2>& primal() { return primal_; }
 
 private:
-   mutable matrix<double> pairwise_;
+   // unshare cost table before writing to it
+   matrix<REAL>& mutable_pairwise();
+
+   std::shared_ptr<matrix<REAL>> pairwise_; // not written to while shared_pairwise_ is set
+   bool shared_pairwise_ = false;
    std::array<std::size_t,2> get_indices(const std::size_t idx) const;
    std::size_t get_index(const std::size_t x, const std::size_t y) const;
-   vector<double> left_msg_;
-   vector<double> right_msg_;
+   vector<REAL> left_msg_;
+   vector<REAL> right_msg_;
    std::array<std::size_t,2> primal_;
 };
 
@@ -110,19 +129,25 @@ void PairwiseSimplexFactor::convert_primal(SOLVER& s, typename SOLVER::vector le
    assert(pairwise_sol[1] == primal_[1]);
 }
 
+// the cost table may be shared, hence excluded entries are skipped instead of temporarily set to infinity
 template<std::size_t N>
 double PairwiseSimplexFactor::lower_bound_except(const std::array<std::size_t,N> indices) const
 {
-   std::array<double,N> vars;
-   for(std::size_t i=0; i<N;++i) {
-      const auto [x,y] = get_indices(indices[i]);
-      vars[i] = pairwise_(x,y);
-      pairwise_(x,y) = std::numeric_limits<double>::infinity();
-   }
-   const double lb = LowerBound();
-   for(std::size_t i=0; i<N;++i) {
-      const auto [x,y] = get_indices(indices[i]);
-      pairwise_(x,y) = vars[i];
+   auto excluded = [&](const std::size_t x1, const std::size_t x2) {
+      return std::find(indices.begin(), indices.end(), get_index(x1,x2)) != indices.end();
+   };
+   double lb = std::numeric_limits<double>::infinity();
+   for(std::size_t x1=0; x1<dim1(); ++x1) {
+      const bool row_excluded = std::any_of(indices.begin(), indices.end(), [&](const std::size_t idx) { return get_indices(idx)[0] == x1; });
+      if(!row_excluded) {
+         lb = std::min(lb, double(left_msg_[x1] + pairwise_->col_min(x1, right_msg_)));
+      } else {
+         for(std::size_t x2=0; x2<dim2(); ++x2) {
+            if(!excluded(x1,x2)) {
+               lb = std::min(lb, double((*this)(x1,x2)));
+            }
+         }
+      }
    }
    return lb;
 }
@@ -0,0 +1,121 @@
+#ifndef LPMP_PAIRWISE_TRUNCATED_FACTOR_H
+#define LPMP_PAIRWISE_TRUNCATED_FACTOR_H
+
+#include <array>
+#include <optional>
+#include <limits>
+#include <cmath>
+#include <cassert>
+#include "vector.hxx"
+
+namespace LPMP {
+
+// pairwise potential min(weight*d(x1-x2), truncation) with d(x) = |x| (truncated linear) or d(x) = x^2 (truncated quadratic).
+// Only the parameters and messages are stored. Min-marginals are computed in time linear in the number of labels with the lower envelope distance transforms of Felzenszwalb and Huttenlocher.
+class pairwise_truncated_factor {
+public:
+   enum class distance { linear, quadratic };
+   struct parameters {
+      distance type;
+      double weight;
+      double truncation;
+   };
+
+   // recognize whether the cost table has truncated linear or truncated quadratic structure
+   template<typename MATRIX>
+   static std::optional<parameters> detect(const MATRIX& c);
+   static double cost(const parameters& p, const std::size_t x1, const std::size_t x2);
+
+   pairwise_truncated_factor(const std::size_t dim1, const std::size_t dim2, const parameters& p);
+
+   double cost(const std::size_t x1, const std::size_t x2) const { return cost(params_, x1, x2); }
+   REAL operator()(const std::size_t x1, const std::size_t x2) const;
+
+   double LowerBound() const;
+   double EvaluatePrimal() const;
+   void MaximizePotentialAndComputePrimal();
+   // subtract minimum from left message and return it
+   double normalize_potential();
+
+   vector<REAL> min_marginal_1() const;
+   vector<REAL> min_marginal_2() const;
+   void min_marginal_1(vector<REAL>& m) const;
+   void min_marginal_2(vector<REAL>& m) const;
+
+   std::size_t dim1() const { return msg1_.size(); }
+   std::size_t dim2() const { return msg2_.size(); }
+   std::size_t dim(const std::size_t d) const { assert(d < 2); return d == 0 ? dim1() : dim2(); }
+   std::size_t size() const { return dim1()*dim2(); }
+
+   REAL msg1(const std::size_t x1) const { assert(x1 < dim1()); return msg1_[x1]; }
+   REAL& msg1(const std::size_t x1) { assert(x1 < dim1()); return msg1_[x1]; }
+   REAL msg2(const std::size_t x2) const { assert(x2 < dim2()); return msg2_[x2]; }
+   REAL& msg2(const std::size_t x2) { assert(x2 < dim2()); return msg2_[x2]; }
+
+   const parameters& get_parameters() const { return params_; }
+
+   void init_primal() { primal_[0] = std::numeric_limits<std::size_t>::max(); primal_[1] = std::numeric_limits<std::size_t>::max(); }
+   auto& primal() { return primal_; }
+   const auto& primal() const { return primal_; }
+
+   template<typename ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( msg1_, msg2_ ); }
+   template<typename ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar( primal_ ); }
+
+   auto export_variables() { return std::tie( msg1_, msg2_ ); }
+
+private:
+   // m[x] = msg_out[x] + min_y msg_in[y] + cost, written for all x < msg_out.size()
+   void min_marginal(const vector<REAL>& msg_in, const vector<REAL>& msg_out, REAL* m) const;
+   std::size_t argmin_1(const std::size_t x2) const;
+   std::size_t argmin_2(const std::size_t x1) const;
+
+   parameters params_;
+   vector<REAL> msg1_;
+   vector<REAL> msg2_;
+   std::array<std::size_t,2> primal_;
+};
+
+inline double pairwise_truncated_factor::cost(const parameters& p, const std::size_t x1, const std::size_t x2)
+{
+   const double d = x1 > x2 ? double(x1 - x2) : double(x2 - x1);
+   const double c = p.type == distance::linear ? p.weight*d : p.weight*d*d;
+   return std::min(c, p.truncation);
+}
+
+template<typename MATRIX>
+std::optional<pairwise_truncated_factor::parameters> pairwise_truncated_factor::detect(const MATRIX& c)
+{
+   if(c.dim1() < 2 || c.dim2() < 2) { return std::nullopt; }
+   if(c(0,0) != 0.0) { return std::nullopt; }
+
+   // weight is the cost of label distance one, truncation the largest cost
+   const double weight = c(0,1);
+   if(!(weight > 0.0) || !std::isfinite(weight)) { return std::nullopt; }
+   double truncation = 0.0;
+   for(std::size_t x1=0; x1<c.dim1(); ++x1) {
+      for(std::size_t x2=0; x2<c.dim2(); ++x2) {
+         if(!std::isfinite(c(x1,x2))) { return std::nullopt; }
+         truncation = std::max(truncation, double(c(x1,x2)));
+      }
+   }
+
+   for(const distance type : {distance::linear, distance::quadratic}) {
+      const parameters p = {type, weight, truncation};
+      bool matches = true;
+      for(std::size_t x1=0; x1<c.dim1() && matches; ++x1) {
+         for(std::size_t x2=0; x2<c.dim2(); ++x2) {
+            const double val = cost(p, x1, x2);
+            if(std::abs(val - c(x1,x2)) > 1e-8*std::max(1.0, std::abs(val))) {
+               matches = false;
+               break;
+            }
+         }
+      }
+      if(matches) { return p; }
+   }
+   return std::nullopt;
+}
+
+} // namespace LPMP
+
+#endif // LPMP_PAIRWISE_TRUNCATED_FACTOR_H
@@ -3,6 +3,7 @@
 #include "unary_simplex_factor.h"
 #include "pairwise_simplex_factor.h"
 #include "pairwise_Potts_factor.h"
+#include "pairwise_truncated_factor.h"
 #include "ternary_simplex_factor.h"
 #include "at_most_one_factor.h"
 
@@ -28,7 +28,8 @@ public:
                   l[i] += r(i, r.primal()[1]);
                }
             } else {
-               auto msg = r.min_marginal_1();
+               auto& msg = min_marginal_buffer(r);
+               r.min_marginal_1(msg);
                RepamLeft(l,msg);
             }
          }
@@ -40,7 +41,8 @@ public:
                   l[i] += r(r.primal()[0], i);
                }
             } else {
-               auto msg = r.min_marginal_2();
+               auto& msg = min_marginal_buffer(r);
+               r.min_marginal_2(msg);
                RepamLeft(l,msg); 
             }
          } 
@@ -173,12 +175,11 @@ public:
     template<typename RIGHT_FACTOR, typename G2>
     void send_message_to_left(const RIGHT_FACTOR& r, G2& msg, const REAL omega = 1.0)
     {
-       auto msgs = [&]() {
-          if(CHIRALITY == Chirality::left) 
-             return r.min_marginal_1();
-          else
-             return r.min_marginal_2(); 
-       }();
+       auto& msgs = min_marginal_buffer(r);
+       if(CHIRALITY == Chirality::left) 
+          r.min_marginal_1(msgs);
+       else
+          r.min_marginal_2(msgs); 
 
        if(!SUPPORT_INFINITY)
          for(INDEX x=0; x<msgs.size(); ++x)
@@ -194,6 +195,19 @@ public:
    {
       return l.primal() == r.primal()[pairwise_index_];
    } 
+
+private:
+   // per-thread buffer for min-marginals, reallocated only when the label space size changes
+   template<typename RIGHT_FACTOR>
+   static auto& min_marginal_buffer(const RIGHT_FACTOR& r)
+   {
+      const std::size_t dim = CHIRALITY == Chirality::left ? r.dim1() : r.dim2();
+      thread_local decltype(r.min_marginal_1()) buffer;
+      if(buffer.size() != dim) {
+         buffer = decltype(r.min_marginal_1())(dim);
+      }
+      return buffer;
+   }
 };
 
 template<INDEX I1, INDEX I2, bool SUPPORT_INFINITY = false>
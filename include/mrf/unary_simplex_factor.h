@@ -4,9 +4,9 @@
 
 namespace LPMP {
 
-class UnarySimplexFactor : public vector<double> {
+class UnarySimplexFactor : public vector<REAL> {
 public:
-    using vector<double>::vector;
+    using vector<REAL>::vector;
 
     UnarySimplexFactor(std::size_t dim) : vector(dim, 0.0) {}
 
@@ -17,12 +17,14 @@ public:
    double LowerBound() const;
    double EvaluatePrimal() const;
    void MaximizePotentialAndComputePrimal();
+   // subtract minimum from all entries and return it
+   double normalize_potential();
 
    // load/store function for the primal value
    template<class ARCHIVE> void serialize_primal(ARCHIVE& ar) { ar(primal_); }
-   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( *static_cast<vector<double>*>(this) ); }
+   template<class ARCHIVE> void serialize_dual(ARCHIVE& ar) { ar( *static_cast<vector<REAL>*>(this) ); }
 
-   auto export_variables() { return std::tie(*static_cast<vector<double>*>(this)); }
+   auto export_variables() { return std::tie(*static_cast<vector<REAL>*>(this)); }
 
    void init_primal() { primal_ = std::numeric_limits<std::size_t>::max(); }
    std::size_t primal() const { return primal_; }
@@ -77,6 +79,14 @@ inline void UnarySimplexFactor::MaximizePotentialAndComputePrimal()
    }
 }
 
+inline double UnarySimplexFactor::normalize_potential()
+{
+   const REAL min = this->min();
+   if(!std::isfinite(min)) { return 0.0; }
+   for(auto it=this->begin(); it!=this->end(); ++it) { *it -= min; }
+   return min;
+}
+
 template<typename ARRAY>
 void UnarySimplexFactor::apply(ARRAY& a) const 
 { 
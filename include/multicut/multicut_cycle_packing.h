@@ -9,6 +9,9 @@ namespace LPMP {
 // implementation of the ICP algorithm from Lange et al's ICML18 algorithm.
 void multicut_cycle_packing(const multicut_instance& input);
 cycle_packing compute_multicut_cycle_packing(const multicut_instance& input);
+// same as above directly on a memory mapped snapshot
+void multicut_cycle_packing(const multicut_snapshot& input);
+cycle_packing compute_multicut_cycle_packing(const multicut_snapshot& input);
 
 triplet_multicut_instance pack_multicut_instance(const multicut_instance& input, const cycle_packing& cp); 
 
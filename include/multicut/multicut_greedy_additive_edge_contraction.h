@@ -5,5 +5,6 @@
 namespace LPMP {
 
     multicut_edge_labeling greedy_additive_edge_contraction(const multicut_instance& instance);
+    multicut_edge_labeling greedy_additive_edge_contraction(const multicut_snapshot& instance);
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "cut_base/cut_base_instance.hxx"
+#include "cut_base/cut_base_snapshot.hxx"
 #include "correlation_clustering_instance.h"
 #include "multicut_factors.h"
 #include "union_find.hxx"
@@ -23,6 +24,11 @@ namespace LPMP {
         correlation_clustering_instance transform_to_correlation_clustering() const;
     };
 
+    // memory mapped multicut instance, see cut_base_snapshot.hxx
+    struct multicut_snapshot : public cut_base_snapshot {
+        using cut_base_snapshot::cut_base_snapshot;
+    };
+
     class multicut_node_labeling : public cut_base_node_labeling {
         public:
             using cut_base_node_labeling::cut_base_node_labeling;
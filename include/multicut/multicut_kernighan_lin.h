@@ -11,6 +11,11 @@ namespace LPMP {
    multicut_edge_labeling compute_gaec(const multicut_instance& instance);
    multicut_edge_labeling compute_multicut_kernighan_lin(const multicut_instance& instance, multicut_edge_labeling labeling = multicut_edge_labeling());
    multicut_edge_labeling compute_multicut_gaec_kernighan_lin(const multicut_instance& instance);
+   // same as above directly on a memory mapped snapshot
+   multicut_edge_labeling compute_multicut_kernighan_lin(const multicut_snapshot& instance, multicut_edge_labeling labeling = multicut_edge_labeling());
+   multicut_edge_labeling compute_multicut_gaec_kernighan_lin(const multicut_snapshot& instance);
+   // serial implementation from andres graph, for comparison
+   multicut_edge_labeling compute_multicut_kernighan_lin_andres(const multicut_instance& instance, multicut_edge_labeling labeling = multicut_edge_labeling());
    multicut_edge_labeling compute_multicut_greedy_edge_fixation(const multicut_instance& instance);
 
 }
@@ -10,6 +10,10 @@ namespace LPMP {
       multicut_instance parse_string(const std::string& input);
       multicut_instance parse_file(const std::string& input);
 
+      // same as above with the PEGTL grammar instead of the memory mapped parallel reader
+      multicut_instance parse_string_pegtl(const std::string& input);
+      multicut_instance parse_file_pegtl(const std::string& input);
+
    }
 
 }
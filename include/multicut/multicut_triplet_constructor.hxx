@@ -3,6 +3,7 @@
 #include <vector>
 #include <cassert>
 #include <future>
+#include <omp.h>
 #include "cut_base/cut_base_triplet_constructor.hxx"
 #include "multicut_instance.h"
 #include "multicut_cycle_packing.h"
@@ -57,6 +58,7 @@ protected:
     TCLAP::ValueArg<std::string> rounding_method_arg_;
     TCLAP::SwitchArg no_informative_factors_arg_;
     TCLAP::SwitchArg no_tightening_packing_arg_;
+    TCLAP::SwitchArg path_separation_arg_;
 };
 
 template<class FACTOR_MESSAGE_CONNECTION, typename UNARY_FACTOR, typename TRIPLET_FACTOR, typename UNARY_TRIPLET_MESSAGE_0, typename UNARY_TRIPLET_MESSAGE_1, typename UNARY_TRIPLET_MESSAGE_2>
@@ -66,6 +68,7 @@ multicut_triplet_constructor<FACTOR_MESSAGE_CONNECTION, UNARY_FACTOR, TRIPLET_FA
         rounding_method_arg_("", "multicutRounding", "method for rounding primal solution", false, "gaec", "{gaec|gef}", s.get_cmd()),
         no_informative_factors_arg_("", "noInformativeFactorReparametrization", "do not make factors informative when rounding and tightening", s.get_cmd(), false),
         no_tightening_packing_arg_("", "noTighteningPacking", "do not pack inequalities after tightening", s.get_cmd(), false),
+        path_separation_arg_("", "tighteningPathSeparation", "separate violated cycles by shortest paths over positive edges instead of cycle packing", s.get_cmd(), false),
         base_constructor(s)
 {}
 
@@ -95,130 +98,141 @@ double multicut_triplet_constructor<FACTOR_MESSAGE_CONNECTION, UNARY_FACTOR, TRI
 template<class FACTOR_MESSAGE_CONNECTION, typename UNARY_FACTOR, typename TRIPLET_FACTOR, typename UNARY_TRIPLET_MESSAGE_0, typename UNARY_TRIPLET_MESSAGE_1, typename UNARY_TRIPLET_MESSAGE_2>
    std::size_t multicut_triplet_constructor<FACTOR_MESSAGE_CONNECTION, UNARY_FACTOR, TRIPLET_FACTOR, UNARY_TRIPLET_MESSAGE_0, UNARY_TRIPLET_MESSAGE_1, UNARY_TRIPLET_MESSAGE_2>::find_violated_cycles(const std::size_t max_triplets_to_add)
    {
-      std::vector<std::tuple<std::size_t, std::size_t, double, bool> > negative_edges; // endpoints, edge cost, searched positive path with given endpoints?
-
-      struct weighted_edge : public std::array<std::size_t,2> { double cost; double& operator()() { return cost; } };
+      // Every negative edge together with a path of positive edges between its endpoints forms a violated cycle.
+      // The guaranteed increase in the dual objective is the minimum of the negated negative cost and the smallest cost on the path.
+      // For decreasing thresholds th, only edges with |cost| >= th are considered. Negative edges are grouped by connected component and by a common endpoint,
+      // such that one search from this endpoint finds shortest paths to all other endpoints of the group.
+      // Union find and search data are kept across rounds.
+      // Found cycles are packed: their weight is subtracted from the positive edges of the graph and from the negative edge, so that cycles found in the same round do not claim the same capacity twice
+      // and later rounds only find paths over edges that still have capacity >= th. Negative edges are searched again as long as they have capacity left.
+      struct weighted_edge : public std::array<std::size_t,2> { double cost; };
       std::vector<weighted_edge> positive_edges;
-
-      // we can speed up compution by skipping path searches for node pairs which lie in different connected components. Connectedness is stored in a union find structure
-      double pos_th = 0.0;
-      for(auto& it : this->unary_factors_vector_) {
-         const double v = (*it.second->get_factor())[0];
-         const std::size_t i = std::get<0>(it.first);
-         const std::size_t j = std::get<1>(it.first);
-         if(v >= 0.0) {
-            pos_th = std::max(pos_th, v);
-            positive_edges.push_back({i,j,v});
-         } else {
-            negative_edges.push_back(std::make_tuple(i,j,v,false));
-         }
+      std::vector<weighted_edge> negative_edges;
+
+      for(std::size_t e=0; e<this->unary_factors_vector_.size(); ++e) {
+         const auto nodes = this->get_edge(e);
+         const double v = this->get_edge_cost(e);
+         if(v >= 0.0)
+            positive_edges.push_back({nodes, v});
+         else
+            negative_edges.push_back({nodes, v});
       }
 
-      if(negative_edges.size() == 0 || negative_edges.size() == this->unary_factors_vector_.size()) { return 0; }
+      if(negative_edges.size() == 0 || positive_edges.size() == 0)
+         return 0;
 
-      weighted_graph posEdgesGraph(positive_edges.begin(), positive_edges.end()); // graph consisting of positive edges
+      weighted_graph pos_edges_graph(positive_edges.begin(), positive_edges.end(), [](const weighted_edge& e) { return e.cost; });
 
-      // do zrobienia: possibly add reparametrization of triplet factors additionally. Do it analogously as in graph matching via send_messages_to_unaries()?
+      std::sort(positive_edges.begin(), positive_edges.end(), [](const auto& e1, const auto& e2) { return e1.cost > e2.cost; });
+      std::sort(negative_edges.begin(), negative_edges.end(), [](const auto& e1, const auto& e2) { return e1.cost < e2.cost; });
 
-      std::sort(negative_edges.begin(), negative_edges.end(), [](const auto& e1, const auto& e2)->bool { return std::get<2>(e1) < std::get<2>(e2); });
+      union_find uf(this->no_nodes());
+      std::size_t next_positive_edge = 0;
 
+      std::vector<bfs_data<weighted_graph>> search_data;
+      search_data.reserve(omp_get_max_threads());
+      for(int t=0; t<omp_get_max_threads(); ++t)
+         search_data.emplace_back(pos_edges_graph);
 
-         // now search for every negative edge for most negative path from end point to starting point. Do zrobienia: do this in parallel
-         // here, longest path is sought after only the edges with positive taken into account
-         // the cost of the path is the minimum of the costs of its edges. The guaranteed increase in the dual objective is v_min > -v ? -v : v_min
+      struct path_search { std::size_t component, source, target, negative_edge; };
+      std::vector<path_search> searches;
+      std::vector<std::size_t> search_groups;
+      std::vector<std::size_t> no_eligible_edges(this->no_nodes(), 0);
 
-         //MostViolatedPathData mp(posEdgesGraph);
-         //BfsData mp(posEdgesGraph);
+      struct violated_cycle { std::vector<std::size_t> nodes; double weight; std::size_t negative_edge; };
+      std::vector<violated_cycle> cycles;
 
-         union_find uf(this->no_nodes());
-         std::size_t triplets_added = 0;
-         const double initial_th = 0.6*std::min(-std::get<2>(negative_edges[0]), pos_th);
-         bool zero_th_iteration = true;
+      const std::size_t no_triplets_before = this->number_of_triplets();
+      const double initial_th = 0.6*std::min(-negative_edges[0].cost, positive_edges[0].cost);
 
-         for(double th=initial_th; th>=eps || zero_th_iteration; th*=0.1) {
-            if(th < eps) {
-               if(triplets_added <= 0.01*max_triplets_to_add) {
-                  // we would first like to go on with odd wheels and odd bicycle wheels before actually adding triplets with no guaranteed dual increase.
-                  //std::cout << "additional separation with no guaranteed dual increase, i.e. th = 0\n";
-                  //th = 0.0;
-                  //zero_th_iteration = false;
-               } else {
-                  break;
-               }
-            }
-            // first update union find datastructure
-            for(auto& it : this->unary_factors_vector_) {
-               const double v = (*it.second->get_factor())[0];
-               if(v >= th) {
-                  const std::size_t i = std::get<0>(it.first);
-                  const std::size_t j = std::get<1>(it.first);
-                  uf.merge(i,j);   
-               }
-            }
+      for(double th=initial_th; th>=eps && this->number_of_triplets() - no_triplets_before < max_triplets_to_add; th*=0.1) {
+         for(; next_positive_edge<positive_edges.size() && positive_edges[next_positive_edge].cost >= th; ++next_positive_edge)
+            uf.merge(positive_edges[next_positive_edge][0], positive_edges[next_positive_edge][1]);
 
-            std::vector<typename base_constructor::triplet_candidate> triplet_candidates;
-
-#pragma omp parallel 
-            {
-               std::vector<typename base_constructor::triplet_candidate> triplet_candidates_local;
-               bfs_data<weighted_graph> mp2(posEdgesGraph);
-#pragma omp for schedule(guided) nowait
-               for(std::size_t c=0; c<negative_edges.size(); ++c) {
-                  const std::size_t i = std::get<0>(negative_edges[c]);
-                  const std::size_t j = std::get<1>(negative_edges[c]);
-                  const double v = std::get<2>(negative_edges[c]);
-                  const bool already_used_for_path_search = std::get<3>(negative_edges[c]);
-                  //if(-v <= th) break;
-                  //if(already_used_for_path_search) continue;
-                  if(-v > th && !already_used_for_path_search && uf.thread_safe_connected(i,j)) {
-                     //auto cycle = mp.FindPath(i,j,posEdgesGraph);
-                     auto mask_small_edges = [th](const std::size_t i, const std::size_t j, const double cost, const std::size_t distance) { return cost >= th; };
-                     double cycle_cap = std::numeric_limits<double>::infinity();
-                     auto cycle_capacity = [&cycle_cap](const std::size_t i, const std::size_t j, const double cost) { cycle_cap = std::min(cycle_cap, cost); };
-                     auto cycle = mp2.find_path(i, j, mask_small_edges, cycle_capacity);
-                     const double dualIncrease = std::min(-v, cycle_cap);
-                     assert(cycle.size() > 0);
-                     if(cycle.size() > 0) {
-                        this->triangulate_cycle(dualIncrease, cycle.begin(), cycle.end(), triplet_candidates_local);
-                        //triplets_added += AddCycle(std::get<1>(cycle));
-                        //if(triplets_added > max_triplets_to_add) {
-                        //   return triplets_added;
-                        //}
-                     } else {
-                        throw std::runtime_error("No path found although there should be one"); 
-                     }
-                  }
-               }
-#pragma omp critical
-               {
-                  triplet_candidates.insert(triplet_candidates.end(), triplet_candidates_local.begin(), triplet_candidates_local.end()); 
+         searches.clear();
+         for(std::size_t c=0; c<negative_edges.size(); ++c) {
+            const auto& e = negative_edges[c];
+            if(-e.cost > th && uf.connected(e[0], e[1])) {
+               searches.push_back({uf.find(e[0]), e[0], e[1], c});
+               no_eligible_edges[e[0]]++;
+               no_eligible_edges[e[1]]++;
             }
          }
 
-         // sort by guaranteed increase in decreasing order
-         std::sort(triplet_candidates.begin(), triplet_candidates.end());
-
-         if(triplet_candidates.size() > 0 && diagnostics()) {
-            std::cout << "best triplet candidate in triplet search has guaranteed dual improvement " << triplet_candidates[0].cost << "\n";
+         // search from the endpoint shared with more negative edges
+         for(auto& s : searches)
+            if(no_eligible_edges[s.target] > no_eligible_edges[s.source])
+               std::swap(s.source, s.target);
+         for(const auto& s : searches)
+            no_eligible_edges[s.source] = no_eligible_edges[s.target] = 0;
+
+         std::sort(searches.begin(), searches.end(), [](const auto& s1, const auto& s2) {
+               return std::make_tuple(s1.component, s1.source, s1.target) < std::make_tuple(s2.component, s2.source, s2.target); });
+         search_groups.clear();
+         for(std::size_t c=0; c<searches.size(); ++c)
+            if(c == 0 || searches[c].source != searches[c-1].source)
+               search_groups.push_back(c);
+         search_groups.push_back(searches.size());
+
+         cycles.clear();
+#pragma omp parallel
+         {
+            auto& mp = search_data[omp_get_thread_num()];
+            std::vector<violated_cycle> cycles_local;
+            std::vector<std::size_t> targets;
+            auto mask_small_edges = [th](const std::size_t i, const std::size_t j, const double cost, const std::size_t distance) { return cost >= th; };
+            double cycle_cap = std::numeric_limits<double>::infinity();
+            auto cycle_capacity = [&cycle_cap](const std::size_t i, const std::size_t j, const double cost) { cycle_cap = std::min(cycle_cap, cost); };
+
+#pragma omp for schedule(dynamic) nowait
+            for(std::size_t g=0; g<search_groups.size()-1; ++g) {
+               const auto group_begin = searches.begin() + search_groups[g];
+               const auto group_end = searches.begin() + search_groups[g+1];
+               targets.clear();
+               for(auto it=group_begin; it!=group_end; ++it)
+                  targets.push_back(it->target);
+
+               auto add_cycle = [&](const std::vector<std::size_t>& path) {
+                  assert(path.size() >= 3);
+                  const auto it = std::lower_bound(group_begin, group_end, path.back(), [](const auto& s, const std::size_t target) { return s.target < target; });
+                  assert(it != group_end && it->target == path.back());
+                  const auto& e = negative_edges[it->negative_edge];
+                  cycles_local.push_back({path, std::min(-e.cost, cycle_cap), it->negative_edge});
+                  cycle_cap = std::numeric_limits<double>::infinity();
+               };
+               mp.find_paths(group_begin->source, targets.begin(), targets.end(), mask_small_edges, cycle_capacity, add_cycle);
+            }
+#pragma omp critical
+            std::move(cycles_local.begin(), cycles_local.end(), std::back_inserter(cycles));
          }
 
-         for(const auto& triplet_candidate : triplet_candidates) {
-            const std::size_t i = triplet_candidate.nodes[0];
-            const std::size_t j = triplet_candidate.nodes[1];
-            const std::size_t k = triplet_candidate.nodes[2];
-            if(!this->HasTripletFactor(i,j,k)) {
-               this->add_triplet_factor(i,j,k);
-               triplets_added++;
-               if(triplets_added > max_triplets_to_add) {
-                  break;
-               } 
+         // sort by guaranteed increase in decreasing order
+         std::sort(cycles.begin(), cycles.end(), [](const auto& c1, const auto& c2) {
+               return c1.weight > c2.weight || (c1.weight == c2.weight && c1.nodes < c2.nodes); });
+
+         if(cycles.size() > 0 && debug())
+            std::cout << "threshold " << th << ": " << searches.size() << " negative edges, " << search_groups.size()-1 << " path searches, best cycle has guaranteed dual improvement " << cycles[0].weight << "\n";
+
+         for(auto& c : cycles) {
+            if(this->number_of_triplets() - no_triplets_before >= max_triplets_to_add)
+               break;
+            // capacity left after packing the cycles before
+            auto& e = negative_edges[c.negative_edge];
+            double weight = -e.cost;
+            for(std::size_t k=1; k<c.nodes.size(); ++k)
+               weight = std::min(weight, pos_edges_graph.edge(c.nodes[k-1], c.nodes[k]));
+            if(weight < th)
+               continue;
+            e.cost += weight;
+            for(std::size_t k=1; k<c.nodes.size(); ++k) {
+               pos_edges_graph.edge(c.nodes[k-1], c.nodes[k]) -= weight;
+               pos_edges_graph.edge(c.nodes[k], c.nodes[k-1]) -= weight;
             }
+            this->triangulate_cycle(c.nodes.begin(), c.nodes.end(), weight, !no_tightening_packing_arg_.isSet());
          }
-
-         triplet_candidates.clear();
       }
 
-      return triplets_added;
+      return this->number_of_triplets() - no_triplets_before;
    }
 
 template<class FACTOR_MESSAGE_CONNECTION, typename UNARY_FACTOR, typename TRIPLET_FACTOR, typename UNARY_TRIPLET_MESSAGE_0, typename UNARY_TRIPLET_MESSAGE_1, typename UNARY_TRIPLET_MESSAGE_2>
@@ -272,6 +286,12 @@ template<class FACTOR_MESSAGE_CONNECTION, typename UNARY_FACTOR, typename TRIPLE
 {
     if(!no_informative_factors_arg_.isSet())
         this->send_messages_to_edges(); // TODO: check if this is always helpful or only for triplet tightening
+    if(path_separation_arg_.isSet()) {
+        const std::size_t no_triplets = find_violated_cycles(no_constraints);
+        if(debug())
+            std::cout << "Added " << no_triplets << " triplets through path separation\n";
+        return no_triplets;
+    }
     const auto mc = this->template export_edges<multicut_instance>();
     cycle_packing cp = compute_multicut_cycle_packing(mc);
     if(debug())
@@ -315,18 +315,6 @@ public:
        } 
     }
 
-    void End()
-    {
-       // read out last mgm solution
-       if(primal_result_handle_.valid()) {
-          primal_result_handle_.wait();
-          if(debug()) 
-             std::cout << "read in primal mgm solution\n";
-          auto mgm_sol = primal_result_handle_.get();
-          read_in_labeling(mgm_sol); 
-       }
-    }
-
     void pre_iterate()
     {
 #pragma omp parallel for schedule(guided)
@@ -790,6 +778,13 @@ public:
     // start with possibly inconsistent primal labeling obtained by individual graph matching roundings.
     // remote cycles that are inconsistent through a multicut solver
     void ComputePrimal()
+    {
+       read_in_primal_rounding(export_primal_rounding()());
+    }
+
+    // reads off everything needed for rounding from the current reparametrization.
+    // The returned callable does not access the LP, hence it can be run concurrently to further dual optimization.
+    auto export_primal_rounding()
     {
        if (debug())
           std::cout << "construct mgm rounding problem\n";
@@ -823,11 +818,11 @@ public:
           for (auto &c : graph_matching_constructors)
              labeling_to_improve.push_back({c.first.p, c.first.q, c.second->compute_primal_fw_solution()});
 
-       const auto mgm = export_linear_multigraph_matching_input();
-       const auto allowed_matchings = compute_allowed_matching_matrix();
-       auto mgm_sol = [&]() {
-          auto mgm_ptr = std::make_shared<multigraph_matching_input>(mgm);
-          multigraph_matching_correlation_clustering_transform mgm_cc_trafo(mgm_ptr);
+       auto mgm = std::make_shared<multigraph_matching_input>(export_linear_multigraph_matching_input());
+       auto allowed_matchings = compute_allowed_matching_matrix();
+
+       return [rm, mgm = std::move(mgm), allowed_matchings = std::move(allowed_matchings), labeling_to_improve = std::move(labeling_to_improve)]() mutable {
+          multigraph_matching_correlation_clustering_transform mgm_cc_trafo(mgm);
           auto cc = mgm_cc_trafo.get_correlatino_clustering_instance();
           auto mc = cc.transform_to_multicut();
           if (rm == rounding_method::gaec_KL)
@@ -856,7 +851,7 @@ public:
           }
           else if (rm == rounding_method::mcf_ps || rm == rounding_method::fw_ps)
           {
-             multigraph_matching_input::graph_size gs(mgm);
+             multigraph_matching_input::graph_size gs(*mgm);
              synchronize_multigraph_matching(gs, labeling_to_improve, allowed_matchings); // for sparse assignment problems
              //synchronize_multigraph_matching(gs, labeling_to_improve); // when all edges are present in pairwise matching subproblems
              return labeling_to_improve;
@@ -865,9 +860,11 @@ public:
           {
              throw std::runtime_error("rounding method not supported");
           }
-       }();
+       };
+    }
 
-       // read in primal solution
+    void read_in_primal_rounding(const multigraph_matching_input::labeling& mgm_sol)
+    {
        read_in_labeling(mgm_sol);
        const double labeling_cost = lp_->EvaluatePrimal();
        if (labeling_cost < best_labeling_cost_)
@@ -877,113 +874,6 @@ public:
        }
     }
 
-    // TODO: Use concurrency only optionally
-    void ComputePrimal_concurrent()
-    {
-       if (!mcf_primal_rounding_arg_.getValue())
-          return;
-
-       if (primal_result_handle_.valid() && primal_result_handle_.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
-       {
-          if (debug())
-             std::cout << "read in primal mgm solution\n";
-          const auto mgm_sol = primal_result_handle_.get();
-          read_in_labeling(mgm_sol);
-          const double labeling_cost = lp_->EvaluatePrimal();
-          if (labeling_cost < best_labeling_cost_)
-          {
-             best_labeling_cost_ = labeling_cost;
-             best_labeling_ = mgm_sol;
-          }
-       }
-
-       if (!primal_result_handle_.valid() || primal_result_handle_.wait_for(std::chrono::seconds(0)) == std::future_status::deferred)
-       {
-          if (debug())
-             std::cout << "construct mgm rounding problem\n";
-
-          if (debug())
-             std::cout << "send messages to unaries\n";
-          send_messages_to_unaries();
-
-          enum class rounding_method
-          {
-             gaec_KL,
-             KL,
-             mcf_KL,
-             mcf_ps,
-             fw_ps
-          };
-          const rounding_method rm = [&]() {
-             if (primal_rounding_algorithms_arg_.getValue() == "gaec_KL")
-                return rounding_method::gaec_KL;
-             else if (primal_rounding_algorithms_arg_.getValue() == "KL")
-                return rounding_method::KL;
-             else if (primal_rounding_algorithms_arg_.getValue() == "MCF_KL") // K&L on infeasible partial minimum cost flow matchings
-                return rounding_method::mcf_KL;
-             else if (primal_rounding_algorithms_arg_.getValue() == "MCF_PS") // permutation synchronization
-                return rounding_method::mcf_ps;
-             else if (primal_rounding_algorithms_arg_.getValue() == "FW_PS") // permutation synchronization
-                return rounding_method::fw_ps;
-             else
-                throw std::runtime_error("could not recognize correlation clustering rounding method");
-          }();
-
-          multigraph_matching_input::labeling labeling_to_improve;
-          if (rm == rounding_method::mcf_KL || rm == rounding_method::mcf_ps)
-             for (auto &c : graph_matching_constructors)
-                labeling_to_improve.push_back({c.first.p, c.first.q, c.second->compute_primal_mcf_solution()});
-          else if (rm == rounding_method::fw_ps)
-             for (auto &c : graph_matching_constructors)
-                labeling_to_improve.push_back({c.first.p, c.first.q, c.second->compute_primal_fw_solution()});
-
-          // TODO: split round_primal_async based on rounding method into multiple lambdas
-          auto mgm = std::make_shared<multigraph_matching_input>(export_linear_multigraph_matching_input());
-          const auto allowed_matchings = compute_allowed_matching_matrix();
-          auto round_primal_async = ([=](std::shared_ptr<multigraph_matching_input> mgm, multigraph_matching_input::labeling labeling_to_improve) {
-             multigraph_matching_correlation_clustering_transform mgm_cc_trafo(mgm);
-             auto cc = mgm_cc_trafo.get_correlatino_clustering_instance();
-             auto mc = cc.transform_to_multicut();
-             if (rm == rounding_method::gaec_KL)
-             {
-                auto mc_sol = compute_multicut_gaec_kernighan_lin(mc); // seems better than just computing with Kernighan&Lin
-                auto cc_sol = mc_sol.transform_to_correlation_clustering();
-                auto mgm_sol = mgm_cc_trafo.transform(cc_sol);
-                return mgm_sol;
-             }
-             else if (rm == rounding_method::KL)
-             {
-                auto mc_sol = compute_multicut_kernighan_lin(mc);
-                auto cc_sol = mc_sol.transform_to_correlation_clustering();
-                auto mgm_sol = mgm_cc_trafo.transform(cc_sol);
-                return mgm_sol;
-             }
-             else if (rm == rounding_method::mcf_KL)
-             {
-                // try fixing infeasible matchings computed by individual graph matching solvers with Kernighan&Lin
-                auto cc_sol_to_improve = mgm_cc_trafo.transform(labeling_to_improve);
-                auto mc_sol_to_improve = cc_sol_to_improve.transform_to_multicut();
-                auto mc_sol = compute_multicut_kernighan_lin(mc, mc_sol_to_improve);
-                auto cc_sol = mc_sol.transform_to_correlation_clustering();
-                auto mgm_sol = mgm_cc_trafo.transform(cc_sol);
-                return mgm_sol;
-             }
-             else if (rm == rounding_method::mcf_ps || rm == rounding_method::fw_ps)
-             {
-                multigraph_matching_input::graph_size gs(*mgm);
-                synchronize_multigraph_matching(gs, labeling_to_improve, allowed_matchings); // for sparse assignment problems
-                //synchronize_multigraph_matching(gs, labeling_to_improve); // when all edges are present in pairwise matching subproblems
-                return labeling_to_improve;
-             }
-             else
-             {
-                throw std::runtime_error("rounding method not supported");
-             }
-          });
-          primal_result_handle_ = std::async(std::launch::deferred, round_primal_async, mgm, labeling_to_improve); // TODO: should be async for parallel evaluation
-       }
-    }
-
     void read_in_labeling(const multigraph_matching_input::labeling& l)
     {
        if(l.size() != graph_matching_constructors.size())
@@ -1142,8 +1032,6 @@ private:
     mutable TCLAP::ValueArg<std::string> output_format_arg_; // mutable should not be necessary, but TCLAP's getValue is not const.
     TCLAP::ValueArg<std::string> primal_rounding_algorithms_arg_; // which multicut algorithms to run on
 
-    std::future<multigraph_matching_input::labeling> primal_result_handle_;
-
     multigraph_matching_input::labeling best_labeling_;
     double best_labeling_cost_ = std::numeric_limits<double>::infinity();
 }; 
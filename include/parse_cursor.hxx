@@ -0,0 +1,146 @@
+#pragma once
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+// hand written matchers of the rules in pegtl_parse_rules.h for readers working directly on (memory mapped) character buffers
+
+namespace LPMP {
+
+namespace parsing {
+
+// Each rule returns the end of the match or nullptr.
+struct cursor {
+    const char* end;
+
+    static bool is_blank(const char c) { return c == ' ' || c == '\t'; }
+    static bool is_digit(const char c) { return c >= '0' && c <= '9'; }
+    static bool is_alpha(const char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+    static bool is_alnum(const char c) { return is_alpha(c) || is_digit(c); }
+
+    // opt_whitespace
+    const char* blanks(const char* p) const
+    {
+        while(p < end && is_blank(*p))
+            ++p;
+        return p;
+    }
+    // mand_whitespace
+    const char* mand_blanks(const char* p) const
+    {
+        const char* q = blanks(p);
+        return q != p ? q : nullptr;
+    }
+    const char* digits(const char* p) const
+    {
+        while(p < end && is_digit(*p))
+            ++p;
+        return p;
+    }
+    // positive_integer
+    const char* positive_integer(const char* p) const
+    {
+        const char* q = digits(p);
+        return q != p ? q : nullptr;
+    }
+    const char* eol(const char* p) const
+    {
+        if(p < end && *p == '\n')
+            return p+1;
+        if(p+1 < end && p[0] == '\r' && p[1] == '\n')
+            return p+2;
+        return nullptr;
+    }
+    const char* eolf(const char* p) const
+    {
+        return p == end ? p : eol(p);
+    }
+    // until<eolf>
+    const char* until_eolf(const char* p) const
+    {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        return nl ? nl+1 : end;
+    }
+    const char* keyword(const char* p, const char* word) const
+    {
+        const std::size_t n = std::strlen(word);
+        if(std::size_t(end - p) >= n && std::memcmp(p, word, n) == 0)
+            return p+n;
+        return nullptr;
+    }
+    const char* sign(const char* p) const
+    {
+        return p < end && (*p == '+' || *p == '-') ? p+1 : nullptr;
+    }
+    // real_number: first alternative matching wins
+    const char* real_number(const char* p) const
+    {
+        const char* q = p;
+        if(q < end && (*q == '+' || *q == '-'))
+            ++q;
+        // exponential
+        {
+            const char* r = digits(q);
+            if(r < end && *r == '.')
+                r = digits(r+1);
+            if(r < end && *r == 'e') {
+                ++r;
+                if(r < end && (*r == '+' || *r == '-'))
+                    ++r;
+                const char* e = digits(r);
+                if(e != r)
+                    return e;
+            }
+        }
+        // standard
+        {
+            const char* r = digits(q);
+            if(r != q) {
+                if(r < end && *r == '.')
+                    r = digits(r+1);
+                return r;
+            }
+            if(const char* r = keyword(p, "Inf"))
+                return r;
+            if(const char* r = keyword(p, "inf"))
+                return r;
+        }
+        // smaller than one
+        if(q < end && *q == '.') {
+            const char* r = digits(q+1);
+            if(r != q+1)
+                return r;
+        }
+        return nullptr;
+    }
+    // line consisting of a keyword, the last line need not end with a line break (eolf)
+    const char* keyword_line(const char* p, const char* word) const
+    {
+        const char* q = keyword(blanks(p), word);
+        return q ? eolf(blanks(q)) : nullptr;
+    }
+};
+
+inline double to_double(const char* begin, const char* end)
+{
+    char buf[64];
+    const std::size_t n = end - begin;
+    if(n >= sizeof(buf))
+        return std::stod(std::string(begin, end));
+    std::memcpy(buf, begin, n);
+    buf[n] = '\0';
+    return std::strtod(buf, nullptr);
+}
+
+inline std::size_t to_size_t(const char* begin, const char* end)
+{
+    std::size_t x = 0;
+    for(const char* p=begin; p!=end; ++p)
+        x = 10*x + (*p - '0');
+    return x;
+}
+
+} // namespace parsing
+
+} // namespace LPMP
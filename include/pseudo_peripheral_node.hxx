@@ -1,6 +1,7 @@
 #pragma once
 
 #include "union_find.hxx"
+#include "clique_graph.hxx"
 #include <queue>
 #include <vector>
 #include <tuple>
@@ -134,6 +135,104 @@ std::tuple<std::size_t, std::size_t> farthest_node(const ADJACENCY_GRAPH &adjace
         return pseudo_peripheral_nodes;
     }
 
+    // breadth first search expanding each clique once
+    inline std::tuple<std::size_t, std::size_t> farthest_node(const clique_graph& g, const std::size_t x, std::vector<std::size_t>& visited, std::vector<std::size_t>& clique_visited, const std::size_t timestamp)
+    {
+        assert(visited.size() == g.size() && clique_visited.size() == g.nr_cliques());
+
+        struct queue_elem
+        {
+            std::size_t v;
+            std::size_t d;
+        };
+        std::queue<queue_elem> Q;
+        Q.push({x, 0});
+        visited[x] = timestamp + 1;
+        std::size_t farthest_node = x;
+        std::size_t max_distance = 0;
+        while (!Q.empty())
+        {
+            const auto [i, d] = Q.front();
+            Q.pop();
+            if (d > max_distance)
+            {
+                max_distance = d;
+                farthest_node = i;
+            }
+            for (const std::size_t c : g.cliques(i))
+            {
+                if (clique_visited[c] > timestamp)
+                    continue;
+                clique_visited[c] = timestamp + 1;
+                for (const std::size_t j : g.clique(c))
+                {
+                    if (visited[j] <= timestamp)
+                    {
+                        Q.push({j, d + 1});
+                        visited[j] = timestamp + 1;
+                    }
+                }
+            }
+        }
+
+        return {farthest_node, max_distance};
+    }
+
+    // pseudo peripheral node of each connected component, starting from a node of minimum degree bound
+    inline std::vector<std::size_t> find_pseudo_peripheral_nodes(const clique_graph& g)
+    {
+        union_find uf(g.size());
+        for (std::size_t c = 0; c < g.nr_cliques(); ++c)
+        {
+            const auto clique = g.clique(c);
+            for (std::size_t k = 1; k < clique.size(); ++k)
+                uf.merge(clique[0], clique[k]);
+        }
+
+        struct min_degree_elem
+        {
+            std::size_t degree = std::numeric_limits<std::size_t>::max();
+            std::size_t node = std::numeric_limits<std::size_t>::max();
+        };
+        std::vector<min_degree_elem> min_degree(g.size());
+        for (std::size_t i = 0; i < g.size(); ++i)
+        {
+            const std::size_t cc_id = uf.find(i);
+            const std::size_t d = g.degree_bound(i);
+            if (d < min_degree[cc_id].degree)
+            {
+                min_degree[cc_id].degree = d;
+                min_degree[cc_id].node = i;
+            }
+        }
+
+        std::vector<std::size_t> pseudo_peripheral_nodes;
+        std::vector<std::size_t> visited(g.size(), 0);
+        std::vector<std::size_t> clique_visited(g.nr_cliques(), 0);
+        std::size_t iter = 0;
+
+        for (std::size_t i = 0; i < g.size(); ++i)
+        {
+            if (visited[i] != 0)
+                continue;
+
+            const std::size_t x = min_degree[uf.find(i)].node;
+            assert(x < g.size());
+
+            auto [y, d_y] = farthest_node(g, x, visited, clique_visited, iter++);
+            auto [z, d_z] = farthest_node(g, y, visited, clique_visited, iter++);
+            while (d_z > d_y)
+            {
+                std::swap(y, z);
+                std::swap(d_z, d_y);
+                std::tie(z, d_z) = farthest_node(g, y, visited, clique_visited, iter++);
+            }
+            pseudo_peripheral_nodes.push_back(y);
+        }
+
+        return pseudo_peripheral_nodes;
+    }
+
     template<typename ADJACENCY_GRAPH, typename NODE_ITERATOR>
     std::size_t find_pseudo_peripheral_node(const ADJACENCY_GRAPH& adjacency, NODE_ITERATOR node_begin, NODE_ITERATOR node_end)
     {
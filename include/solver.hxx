@@ -4,6 +4,8 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <future>
+#include <chrono>
 #include <fstream>
 #include <sstream>
 
@@ -168,17 +170,34 @@ namespace LPMP {
             virtual void Iterate(LpControl c);
     };
 
+    template<typename PROBLEM_CONSTRUCTOR, typename = void>
+        struct primal_rounding_handle { using type = std::nullptr_t; };
+
+    template<typename PROBLEM_CONSTRUCTOR>
+        struct primal_rounding_handle<PROBLEM_CONSTRUCTOR, std::void_t<decltype(std::declval<PROBLEM_CONSTRUCTOR&>().export_primal_rounding())>> {
+            using type = std::future<std::invoke_result_t<decltype(std::declval<PROBLEM_CONSTRUCTOR&>().export_primal_rounding())>>;
+        };
+
     // rounding based on primal heuristics provided by problem constructor
+    // If the problem constructor splits rounding into export_primal_rounding() and read_in_primal_rounding(result), rounding is run in a background thread while the dual is optimized further:
+    // export_primal_rounding() is called in the solver thread and returns a callable holding a snapshot of everything rounding needs, read_in_primal_rounding writes the rounding result back into the factors.
     template<typename SOLVER>
         class ProblemConstructorRoundingSolver : public SOLVER
     {
         public:
             using SOLVER::SOLVER;
+            using problem_constructor_type = typename SOLVER::problem_constructor_type;
+            // joins a rounding still in flight when End() was not reached
+            ~ProblemConstructorRoundingSolver();
 
             LPMP_FUNCTION_EXISTENCE_CLASS(HasComputePrimal,ComputePrimal)
 
                 constexpr static bool can_compute_primal();
 
+            template<typename T>
+                using has_export_primal_rounding_t = decltype(&T::export_primal_rounding);
+            constexpr static bool can_round_asynchronously();
+
             void ComputePrimal();
 
             virtual void Begin();
@@ -186,6 +205,14 @@ namespace LPMP {
             virtual void PostIterate(LpControl c);
 
             virtual void End();
+
+        private:
+            // start rounding on current reparametrization if no rounding is in flight
+            void launch_primal_rounding();
+            // read in and register finished rounding result. If wait is set, block until the outstanding rounding has finished
+            void collect_primal_rounding(const bool wait);
+
+            typename primal_rounding_handle<problem_constructor_type>::type primal_rounding_handle_;
     };
 
     // rounding based on (i) interleaved message passing followed by (ii) problem constructor rounding.
@@ -509,16 +536,57 @@ namespace LPMP {
             return HasComputePrimal<typename SOLVER::problem_constructor_type, void>();
         }
 
+    template<typename SOLVER>
+        constexpr bool ProblemConstructorRoundingSolver<SOLVER>::can_round_asynchronously()
+        {
+            return is_detected<has_export_primal_rounding_t, problem_constructor_type>::value;
+        }
+
+    template<typename SOLVER>
+        ProblemConstructorRoundingSolver<SOLVER>::~ProblemConstructorRoundingSolver()
+        {
+            if constexpr(can_round_asynchronously()) {
+                if(primal_rounding_handle_.valid())
+                    primal_rounding_handle_.wait();
+            }
+        }
+
     template<typename SOLVER>
         void ProblemConstructorRoundingSolver<SOLVER>::ComputePrimal()
         {
             SOLVER::lp_.init_primal();
-            // compute the primal in parallel.
-            // for this, first we have to wait until the rounding procedure has read off everything from the LP model before optimizing further
-            if constexpr(can_compute_primal())
+            if constexpr(can_round_asynchronously())
+                this->problem_constructor_.read_in_primal_rounding(this->problem_constructor_.export_primal_rounding()());
+            else if constexpr(can_compute_primal())
                 this->problem_constructor_.ComputePrimal();
         }
 
+    template<typename SOLVER>
+        void ProblemConstructorRoundingSolver<SOLVER>::launch_primal_rounding()
+        {
+            if constexpr(can_round_asynchronously()) {
+                if(primal_rounding_handle_.valid())
+                    return;
+                if(debug()) { std::cout << "launch asynchronous primal rounding\n"; }
+                primal_rounding_handle_ = std::async(std::launch::async, this->problem_constructor_.export_primal_rounding());
+            }
+        }
+
+    template<typename SOLVER>
+        void ProblemConstructorRoundingSolver<SOLVER>::collect_primal_rounding(const bool wait)
+        {
+            if constexpr(can_round_asynchronously()) {
+                if(!primal_rounding_handle_.valid())
+                    return;
+                if(!wait && primal_rounding_handle_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                    return;
+                if(debug()) { std::cout << "read in asynchronous primal rounding\n"; }
+                SOLVER::lp_.init_primal();
+                this->problem_constructor_.read_in_primal_rounding(primal_rounding_handle_.get());
+                this->RegisterPrimal();
+            }
+        }
+
     template<typename SOLVER>
         void ProblemConstructorRoundingSolver<SOLVER>::Begin()
         {
@@ -530,7 +598,12 @@ namespace LPMP {
     template<typename SOLVER>
         void ProblemConstructorRoundingSolver<SOLVER>::PostIterate(LpControl c)
         {
-            if(c.computePrimal) {
+            if constexpr(can_round_asynchronously()) {
+                // poll every iteration so that a finished rounding is registered without waiting for the next primal computation interval
+                collect_primal_rounding(false);
+                if(c.computePrimal)
+                    launch_primal_rounding();
+            } else if(c.computePrimal) {
                 ComputePrimal();
                 this->RegisterPrimal();
             }
@@ -540,6 +613,7 @@ namespace LPMP {
     template<typename SOLVER>
         void ProblemConstructorRoundingSolver<SOLVER>::End()
         {
+            collect_primal_rounding(true);
             SOLVER::End(); // first let problem constructors end (done in Solver)
             this->RegisterPrimal();
         }
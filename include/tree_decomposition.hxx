@@ -597,15 +597,15 @@ public:
    {
       //const REAL subgradient_value = compute_subgradient();
       //assert(false); // assert that subgradient has been computed!
-      std::vector<double> local_subgradient(mapping_.size(),0.0);
+      local_buffer_.assign(mapping_.size(), 0.0);
       // write primal solution into subgradient
       for(auto L : Lagrangean_factors_) {
-         L.copy_fn(&local_subgradient[0]);
+         L.copy_fn(local_buffer_.data());
       }
       assert(mapping_.size() >= dual_size());
       for(INDEX i=0; i<mapping_.size(); ++i) {
          assert(mapping_[i] < subgradient.size());
-         subgradient[ mapping_[i] ] += local_subgradient[i];
+         subgradient[ mapping_[i] ] += local_buffer_[i];
       } 
    }
 
@@ -648,6 +648,16 @@ public:
       }
    }
 
+   // w is indexed by global Lagrangean variables. Gather entries belonging to this tree via mapping_ and add them.
+   void add_mapped_weights(const double* w, const double scaling)
+   {
+      local_buffer_.resize(mapping_.size());
+      for(INDEX i=0; i<mapping_.size(); ++i) {
+         local_buffer_[i] = w[ mapping_[i] ];
+      }
+      add_weights(local_buffer_.data(), scaling);
+   }
+
   // dual size of Lagrangeans connected to current tree
   INDEX compute_dual_size_in_bytes()
   {
@@ -705,6 +715,7 @@ public:
 
    INDEX subgradient_size;
    std::vector<int> mapping_;
+   std::vector<double> local_buffer_; // tree local Lagrangean variables, reused across calls so that neither gathering weights nor scattering subgradients allocates
 
    std::vector<FactorTypeAdapter*> original_factors_;
 };
@@ -713,6 +724,7 @@ public:
 template<typename FMC, typename LAGRANGEAN_FACTOR, typename DECOMPOSITION_SOLVER>
 class LP_with_trees : public LP<FMC>
 {
+   static_assert(std::is_same_v<REAL,double>, "Lagrangean variables are exchanged as double, single precision is not supported");
 public:
    LP_with_trees(TCLAP::CmdLine& cmd)
    : LP<FMC>(cmd)
@@ -933,8 +945,9 @@ public:
    REAL decomposition_lower_bound() const
    {
      REAL lb = 0.0;
-     for(auto& t : trees_) {
-       lb += t.lower_bound();
+#pragma omp parallel for schedule(dynamic) reduction(+:lb)
+     for(INDEX i=0; i<trees_.size(); ++i) {
+       lb += trees_[i].lower_bound();
      }
      return lb; 
    }
@@ -944,18 +957,39 @@ public:
        return LP<FMC>::LowerBound(); 
    }
 
+   // trees hold distinct copies of shared factors, hence they can be modified concurrently
    void add_weights(const double* w, const REAL scaling) 
    {
+#pragma omp parallel for schedule(dynamic)
       for(INDEX i=0; i<trees_.size(); ++i) {
-         auto& tree = trees_[i];
-         const auto& m = tree.mapping();
-         std::vector<double> local_weights;
-         local_weights.reserve(m.size());
-         for(INDEX idx=0; idx<m.size(); ++idx) {
-            local_weights.push_back(w[m[idx]]);
+         trees_[i].add_mapped_weights(w, scaling);
+      }
+   }
+
+   // solve all trees concurrently and add their mapped subgradients to subgradient. Returns the sum of the trees' optimal values.
+   // Each thread accumulates into its own buffer, buffers are reduced at the end.
+   template<typename VECTOR>
+   REAL solve_trees(VECTOR& subgradient)
+   {
+      REAL value = 0.0;
+#pragma omp parallel
+      {
+         std::vector<double> local_subgradient(subgradient.size(), 0.0);
+         REAL local_value = 0.0;
+#pragma omp for schedule(dynamic) nowait
+         for(INDEX i=0; i<trees_.size(); ++i) {
+            local_value += trees_[i].solve();
+            trees_[i].compute_mapped_subgradient(local_subgradient); // note that mapping has one extra component!
+         }
+#pragma omp critical
+         {
+            value += local_value;
+            for(INDEX i=0; i<subgradient.size(); ++i) {
+               subgradient[i] += local_subgradient[i];
+            }
          }
-         tree.add_weights(&local_weights[0], scaling);
       }
+      return value;
    }
 
   // write back reparametrization of tree decomposition factor into original factors
@@ -1000,13 +1034,8 @@ public:
 
    void optimize_decomposition()
    {
-      REAL current_lower_bound = 0.0;
       std::vector<REAL> subgradient(this->no_Lagrangean_vars(), 0.0);
-      for(std::size_t i=0; i<this->trees_.size(); ++i) {
-         current_lower_bound += this->trees_[i].solve();
-         this->trees_[i].compute_mapped_subgradient(subgradient); // note that mapping has one extra component!
-         //trees_[i].primal_cost();
-      }
+      const REAL current_lower_bound = this->solve_trees(subgradient);
 
       best_lower_bound = std::max(current_lower_bound, best_lower_bound);
       assert(std::find_if(subgradient.begin(), subgradient.end(), [](auto x) { return x != 0.0 && x != 1.0 && x != -1.0; }) == subgradient.end());
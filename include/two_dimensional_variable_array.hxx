@@ -3,6 +3,9 @@
 #include <vector>
 #include <array>
 #include <cassert>
+#include <limits>
+#include <iterator>
+#include <cstddef>
 
 namespace LPMP {
 
@@ -200,7 +203,12 @@ public:
        return (*this)[i];
    }
 
-   struct iterator : public std::iterator< std::random_access_iterator_tag, T* > {
+   struct iterator {
+     using iterator_category = std::random_access_iterator_tag;
+     using value_type = T*;
+     using difference_type = std::ptrdiff_t;
+     using pointer = T**;
+     using reference = T*&;
      iterator(T* _data, std::size_t* _offset) : data(_data), offset(_offset) {}
      void operator++() { ++offset; }
      void operator--() { --offset; }
@@ -1070,13 +1070,19 @@ class matrix : public matrix_expression<T,matrix<T>> {
         //minimum along second dimension, such that to each row of matrix v is added.
         vector<T> min1(const vector<T>& v) const
         {
-            assert(v.size() == dim2());
-            static_assert(std::is_same<T,REAL>::value, "");
             vector<T> min(dim1());
+            min1(v, min);
+            return min; 
+        }
+
+        // as above, but write into caller provided buffer
+        void min1(const vector<T>& v, vector<T>& min) const
+        {
+            assert(v.size() == dim2() && min.size() == dim1());
+            static_assert(std::is_same<T,REAL>::value, "");
             for(std::size_t x1=0; x1<dim1(); ++x1) {
                 min[x1] = col_min(x1, v);
             }
-            return min; 
         }
 
         // minima along first dimension
@@ -1109,9 +1115,15 @@ class matrix : public matrix_expression<T,matrix<T>> {
         // possibly make free function!
         vector<T> min2(const vector<T>& v) const
         {
-            static_assert(std::is_same<T,REAL>::value, "");
-            assert(v.size() == dim1());
             vector<T> min(dim2());
+            min2(v, min);
+            return min;
+        }
+
+        void min2(const vector<T>& v, vector<T>& min) const
+        {
+            static_assert(std::is_same<T,REAL>::value, "");
+            assert(v.size() == dim1() && min.size() == dim2());
 
             for(std::size_t x2=0; x2<dim2(); x2+=REAL_ALIGNMENT) {
                 REAL_VECTOR tmp = simdpp::load( vec_.begin() + x2 );
@@ -1129,8 +1141,6 @@ class matrix : public matrix_expression<T,matrix<T>> {
                     simdpp::store(&min[x2], updated_min);
                 } 
             }
-
-            return min;
         }
 
         T min() const
@@ -1,5 +1,6 @@
 #include "asymmetric_multiway_cut/asymmetric_multiway_cut_parser.h"
 #include "pegtl_parse_rules.h"
+#include "cut_base/cut_base_edge_list_reader.hxx"
 
 namespace LPMP {
 
@@ -68,7 +69,7 @@ struct empty_line : pegtl::seq<opt_whitespace, pegtl::eolf> {};
                 }
         };
 
-        asymmetric_multiway_cut_instance parse_file(const std::string& filename)
+        asymmetric_multiway_cut_instance parse_file_pegtl(const std::string& filename)
         {
             asymmetric_multiway_cut_instance instance;
             pegtl::file_parser problem(filename);
@@ -80,7 +81,7 @@ struct empty_line : pegtl::seq<opt_whitespace, pegtl::eolf> {};
             return instance;
         }
 
-        asymmetric_multiway_cut_instance parse_string(const std::string& string)
+        asymmetric_multiway_cut_instance parse_string_pegtl(const std::string& string)
         {
             asymmetric_multiway_cut_instance instance;
             const bool read_success = pegtl::parse<grammar, action>(string,"",instance);
@@ -91,6 +92,73 @@ struct empty_line : pegtl::seq<opt_whitespace, pegtl::eolf> {};
             return instance;
         }
 
+        // grammar above, edges are read with cut_base_edge_list_reader, node costs sequentially
+        static bool parse_streaming(const char* begin, const char* end, asymmetric_multiway_cut_instance& instance)
+        {
+            const parsing::cursor c{end};
+            const char* p = c.keyword_line(begin, "ASYMMETRIC MULTIWAY CUT");
+            if(!p)
+                return false;
+            p = c.keyword_line(p, "MULTICUT");
+            if(!p)
+                return false;
+            p = cut_base_edge_list_reader::read_edges(p, end, instance.edge_costs);
+            p = c.keyword_line(p, "NODE COSTS");
+            if(!p)
+                return false;
+
+            std::vector<double> costs;
+            while(p < end) {
+                if(const char* q = cut_base_edge_list_reader::ignore_line(c, p)) {
+                    p = q;
+                    continue;
+                }
+                // node_cost_line
+                costs.clear();
+                const char* q = c.blanks(p);
+                while(true) {
+                    const char* r = c.real_number(q);
+                    if(!r)
+                        break;
+                    costs.push_back(parsing::to_double(q, r));
+                    q = c.mand_blanks(r);
+                    if(!q) {
+                        q = r;
+                        break;
+                    }
+                }
+                if(costs.empty())
+                    return false;
+                q = c.eolf(c.blanks(q));
+                if(!q)
+                    return false;
+                instance.node_costs.push_back(costs.begin(), costs.end());
+                p = q;
+            }
+            return true;
+        }
+
+        asymmetric_multiway_cut_instance parse_file(const std::string& filename)
+        {
+            asymmetric_multiway_cut_instance instance;
+            mapped_file f(filename);
+            if(!parse_streaming(f.begin(), f.end(), instance)) {
+                throw std::runtime_error("could not read file " + filename);
+            }
+
+            return instance;
+        }
+
+        asymmetric_multiway_cut_instance parse_string(const std::string& string)
+        {
+            asymmetric_multiway_cut_instance instance;
+            if(!parse_streaming(string.data(), string.data() + string.size(), instance)) {
+                throw std::runtime_error("could not read string");
+            }
+
+            return instance;
+        }
+
     }
 
 }
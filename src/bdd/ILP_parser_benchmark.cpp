@@ -0,0 +1,49 @@
+#include "bdd/ILP_parser.h"
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+using namespace LPMP;
+
+// compares throughput of the PEGTL based and the streaming reader on the same .lp file and checks that both give the same ILP_input
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+        throw std::runtime_error("input filename must be present as argument");
+    const std::string filename(argv[1]);
+    const std::size_t nr_repetitions = argc > 2 ? std::stoul(argv[2]) : 1;
+
+    std::ifstream f(filename, std::ios::binary | std::ios::ate);
+    if(!f)
+        throw std::runtime_error("could not open input file " + filename);
+    const double megabytes = double(f.tellg()) / (1024.0*1024.0);
+
+    auto measure = [&](auto parse) {
+        double best = std::numeric_limits<double>::infinity();
+        ILP_input input;
+        for(std::size_t i=0; i<nr_repetitions; ++i) {
+            const auto begin_time = std::chrono::steady_clock::now();
+            input = parse(filename);
+            const auto end_time = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end_time - begin_time).count());
+        }
+        return std::make_pair(std::move(input), best);
+    };
+
+    const auto [pegtl_input, pegtl_time] = measure([](const std::string& f) { return ILP_parser::parse_file(f); });
+    const auto [streaming_input, streaming_time] = measure([](const std::string& f) { return ILP_parser::parse_file_streaming(f); });
+
+    std::cout << "file size: " << megabytes << " MB, #variables: " << pegtl_input.nr_variables() << ", #constraints: " << pegtl_input.nr_constraints() << "\n";
+    std::cout << "PEGTL parser:     " << pegtl_time << " s, " << megabytes / pegtl_time << " MB/s\n";
+    std::cout << "streaming parser: " << streaming_time << " s, " << megabytes / streaming_time << " MB/s\n";
+
+    std::stringstream pegtl_out, streaming_out;
+    pegtl_input.write(pegtl_out);
+    streaming_input.write(streaming_out);
+    if(pegtl_out.str() != streaming_out.str()) {
+        std::cout << "results differ\n";
+        return 1;
+    }
+    std::cout << "results identical\n";
+}
@@ -0,0 +1,409 @@
+#include "bdd/ILP_parser.h"
+#include "bdd/ILP_input.h"
+#include "mapped_file.hxx"
+#include "parse_cursor.hxx"
+#include <tsl/robin_map.h>
+#include <string_view>
+#include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <climits>
+#include <stdexcept>
+#include <omp.h>
+
+// Hand written reader for the grammar in ILP_parser.cpp.
+// Objective and bounds are read sequentially. The constraint section is cut into chunks at lines containing '=', which end every constraint.
+// Each chunk is tokenized by its own thread, which interns variable names as views into the input.
+// Names are mapped to variable indices chunk by chunk in input order, hence indices agree with the sequential parser.
+
+namespace LPMP {
+
+    namespace ILP_parser {
+
+        namespace {
+
+            struct parse_error {};
+
+            // additional rules of ILP_parser.cpp
+            struct cursor : public parsing::cursor {
+                static bool is_name_char(const char c)
+                {
+                    return is_alnum(c) || c == '_' || c == '-' || c == '/' || c == '(' || c == ')' || c == '{' || c == '}' || c == ',';
+                }
+
+                const char* variable_name(const char* p) const
+                {
+                    if(p == end || !is_alpha(*p))
+                        return nullptr;
+                    ++p;
+                    while(p < end && is_name_char(*p))
+                        ++p;
+                    return p;
+                }
+            };
+
+            using parsing::to_double;
+
+            int to_int(const char* begin, const char* end)
+            {
+                long long x = 0;
+                for(const char* p=begin; p!=end; ++p) {
+                    x = 10*x + (*p - '0');
+                    if(x > INT_MAX)
+                        throw std::out_of_range("stoi");
+                }
+                return x;
+            }
+
+            struct chunk {
+                const char* begin;
+                const char* end;
+                // tokenization result
+                std::vector<std::string_view> names; // in order of first occurrence
+                std::vector<ILP_input::weighted_variable> terms; // var is index into names
+                struct constraint { inequality_type ineq; int right_hand_side; std::size_t terms_end; };
+                std::vector<constraint> constraints;
+                const char* section_end = nullptr; // start of line with Bounds or End, if in this chunk
+                bool error = false;
+            };
+
+            // inequality_line of the grammar. Returns nullptr at End or Bounds.
+            const char* parse_constraint(const cursor& c, const char* p, chunk& ch, tsl::robin_map<std::string_view, std::size_t>& name_index)
+            {
+                const char* q = c.blanks(p);
+                if(c.keyword(q, "End") || c.keyword(q, "Bounds"))
+                    return nullptr;
+                // inequality_identifier
+                if(q < c.end && cursor::is_alpha(*q)) {
+                    const char* i = q+1;
+                    while(i < c.end && cursor::is_alnum(*i))
+                        ++i;
+                    i = c.blanks(i);
+                    if(i < c.end && *i == ':')
+                        q = c.blanks(i+1);
+                }
+
+                // terms
+                while(true) {
+                    const char* r = c.blanks(q);
+                    int coeff = 1;
+                    if(const char* s = c.sign(r)) {
+                        if(*r == '-')
+                            coeff = -1;
+                        r = c.blanks(s);
+                    }
+                    if(cursor::is_digit(r < c.end ? *r : ' ')) {
+                        const char* s = c.digits(r);
+                        coeff *= to_int(r, s);
+                        r = c.blanks(s);
+                        if(r < c.end && *r == '*')
+                            r = c.blanks(r+1);
+                    }
+                    const char* name_end = c.variable_name(r);
+                    if(!name_end)
+                        break;
+                    const std::string_view name(r, name_end - r);
+                    auto it = name_index.find(name);
+                    std::size_t var;
+                    if(it != name_index.end()) {
+                        var = it->second;
+                    } else {
+                        var = ch.names.size();
+                        name_index.insert({name, var});
+                        ch.names.push_back(name);
+                    }
+                    ch.terms.push_back({coeff, var});
+                    q = c.blanks(name_end);
+                    if(const char* e = c.eol(q))
+                        q = e;
+                }
+
+                q = c.blanks(q);
+                inequality_type ineq;
+                if(const char* r = c.keyword(q, "<=")) {
+                    ineq = inequality_type::smaller_equal;
+                    q = r;
+                } else if(const char* r = c.keyword(q, ">=")) {
+                    ineq = inequality_type::greater_equal;
+                    q = r;
+                } else if(const char* r = c.keyword(q, "=")) {
+                    ineq = inequality_type::equal;
+                    q = r;
+                } else {
+                    throw parse_error();
+                }
+                q = c.blanks(q);
+                const char* rhs_begin = q;
+                if(const char* r = c.sign(q))
+                    q = r;
+                const char* rhs_end = c.digits(q);
+                if(rhs_end == q)
+                    throw parse_error();
+                const int rhs = to_double(rhs_begin, rhs_end);
+                q = c.eol(c.blanks(rhs_end));
+                if(!q)
+                    throw parse_error();
+                ch.constraints.push_back({ineq, rhs, ch.terms.size()});
+                return q;
+            }
+
+            void tokenize(const cursor& c, chunk& ch)
+            {
+                tsl::robin_map<std::string_view, std::size_t> name_index;
+                try {
+                    const char* p = ch.begin;
+                    while(p < ch.end) {
+                        const char* q = parse_constraint(c, p, ch, name_index);
+                        if(!q) {
+                            ch.section_end = p;
+                            return;
+                        }
+                        p = q;
+                    }
+                } catch(...) {
+                    ch.error = true;
+                }
+            }
+
+            // first position after a line containing '=' at or after the line of p
+            const char* next_constraint_boundary(const char* section_begin, const char* end, const char* p)
+            {
+                while(p > section_begin && *(p-1) != '\n')
+                    --p;
+                const char* eq = static_cast<const char*>(std::memchr(p, '=', end - p));
+                if(!eq)
+                    return end;
+                const char* nl = static_cast<const char*>(std::memchr(eq, '\n', end - eq));
+                return nl ? nl+1 : end;
+            }
+
+            // min_line, objective lines and subject_to_line. Returns the beginning of the constraint section.
+            const char* parse_objective(const cursor& c, const char* begin, ILP_input& input)
+            {
+                const char* p = c.keyword_line(begin, "Minimize");
+                if(!p)
+                    throw parse_error();
+                while(!c.keyword(p, "Subject To")) {
+                    const char* q = p;
+                    while(true) {
+                        const char* r = c.blanks(q);
+                        double coeff = 1.0;
+                        if(const char* s = c.sign(r)) {
+                            if(*r == '-')
+                                coeff *= -1.0;
+                            r = c.blanks(s);
+                        }
+                        if(const char* s = c.real_number(r)) {
+                            coeff *= to_double(r, s);
+                            r = c.blanks(s);
+                            if(r < c.end && *r == '*')
+                                r = c.blanks(r+1);
+                        }
+                        const char* name_end = c.variable_name(r);
+                        if(!name_end)
+                            break;
+                        input.add_to_objective(coeff, std::string(r, name_end));
+                        q = name_end;
+                    }
+                    q = c.eol(c.blanks(q));
+                    if(!q)
+                        break;
+                    p = q;
+                }
+                p = c.keyword_line(p, "Subject To");
+                if(!p)
+                    throw parse_error();
+                return p;
+            }
+
+            // Fingerprint of the constraint section beginning at p. Returns the beginning of the line with Bounds or End.
+            const char* fingerprint_constraint_section(const cursor& c, const char* p, constraint_fingerprint& fingerprint)
+            {
+                // FNV-1a
+                std::uint64_t hash = 14695981039346656037ull;
+                std::uint64_t nr_constraints = 0;
+                while(p < c.end) {
+                    const char* q = c.blanks(p);
+                    if(c.keyword(q, "End") || c.keyword(q, "Bounds")) {
+                        fingerprint = {nr_constraints, hash};
+                        return p;
+                    }
+                    const char* line_end = c.until_eolf(q);
+                    for(; q<line_end; ++q) {
+                        if(cursor::is_blank(*q) || *q == '\r' || *q == '\n')
+                            continue;
+                        // every constraint contains exactly one of =, <= and >=
+                        if(*q == '=')
+                            ++nr_constraints;
+                        hash = (hash ^ std::uint64_t(static_cast<unsigned char>(*q))) * 1099511628211ull;
+                    }
+                    p = line_end;
+                }
+                throw parse_error();
+            }
+
+            ILP_input parse(const char* begin, const char* end, std::size_t nr_chunks)
+            {
+                ILP_input input;
+                const cursor c{{end}};
+
+                const char* p = parse_objective(c, begin, input);
+
+                // constraints
+                const char* section_begin = p;
+                if(nr_chunks == 0) {
+                    constexpr std::size_t min_chunk_size = 1 << 20;
+                    nr_chunks = std::min(std::size_t(omp_get_max_threads()), std::size_t(end - section_begin) / min_chunk_size + 1);
+                }
+                std::vector<chunk> chunks(nr_chunks);
+                const std::size_t section_size = end - section_begin;
+#pragma omp parallel for schedule(dynamic)
+                for(std::size_t i=0; i<nr_chunks; ++i) {
+                    chunks[i].begin = i == 0 ? section_begin : next_constraint_boundary(section_begin, end, section_begin + i*section_size/nr_chunks);
+                    chunks[i].end = i+1 == nr_chunks ? end : next_constraint_boundary(section_begin, end, section_begin + (i+1)*section_size/nr_chunks);
+                    tokenize(c, chunks[i]);
+                }
+
+                // chunks up to the one containing the end of the constraint section
+                std::size_t nr_valid_chunks = 0;
+                for(; nr_valid_chunks<nr_chunks; ++nr_valid_chunks) {
+                    if(chunks[nr_valid_chunks].error)
+                        throw parse_error();
+                    if(chunks[nr_valid_chunks].section_end) {
+                        ++nr_valid_chunks;
+                        break;
+                    }
+                }
+                p = chunks[nr_valid_chunks-1].section_end;
+                if(!p)
+                    throw parse_error();
+
+                // map names to variable indices in order of occurrence
+                std::vector<std::vector<std::size_t>> chunk_var_index(nr_valid_chunks);
+                for(std::size_t i=0; i<nr_valid_chunks; ++i) {
+                    chunk_var_index[i].reserve(chunks[i].names.size());
+                    for(const std::string_view name : chunks[i].names)
+                        chunk_var_index[i].push_back(input.get_or_create_variable_index(std::string(name)));
+                }
+
+                std::vector<std::vector<ILP_input::linear_constraint>> chunk_constraints(nr_valid_chunks);
+#pragma omp parallel for schedule(dynamic)
+                for(std::size_t i=0; i<nr_valid_chunks; ++i) {
+                    const chunk& ch = chunks[i];
+                    chunk_constraints[i].resize(ch.constraints.size());
+                    std::size_t t = 0;
+                    for(std::size_t j=0; j<ch.constraints.size(); ++j) {
+                        auto& constraint = chunk_constraints[i][j];
+                        for(; t<ch.constraints[j].terms_end; ++t)
+                            constraint.add_variable(ch.terms[t].coefficient, chunk_var_index[i][ch.terms[t].var]);
+                        constraint.ineq = ch.constraints[j].ineq;
+                        constraint.right_hand_side = ch.constraints[j].right_hand_side;
+                    }
+                }
+                for(auto& constraints : chunk_constraints)
+                    for(auto& constraint : constraints)
+                        input.add_constraint(std::move(constraint));
+
+                // bounds, binary variables are not recorded
+                if(const char* q = c.keyword_line(p, "Bounds")) {
+                    q = c.keyword_line(q, "Binaries");
+                    if(q) {
+                        while(true) {
+                            const char* r = c.blanks(q);
+                            if(const char* e = c.eol(r))
+                                r = e;
+                            r = c.blanks(r);
+                            if(c.keyword(r, "End"))
+                                break;
+                            const char* name_end = c.variable_name(r);
+                            if(!name_end)
+                                break;
+                            q = name_end;
+                        }
+                        q = c.eol(c.blanks(q));
+                    }
+                    if(q)
+                        p = q;
+                }
+
+                const char* q = c.keyword(c.blanks(p), "End");
+                if(!q || !c.eolf(c.blanks(q)))
+                    throw parse_error();
+
+                return input;
+            }
+
+            ILP_input parse_objective(const char* begin, const char* end, constraint_fingerprint& fingerprint)
+            {
+                ILP_input input;
+                const cursor c{{end}};
+                const char* p = parse_objective(c, begin, input);
+                p = fingerprint_constraint_section(c, p, fingerprint);
+                return input;
+            }
+
+        } // end anonymous namespace
+
+        ILP_input parse_file_streaming(const std::string& filename, const std::size_t nr_chunks)
+        {
+            mapped_file f(filename);
+            try {
+                return parse(f.data(), f.data() + f.size(), nr_chunks);
+            } catch(const parse_error&) {
+                throw std::runtime_error("could not read input file " + filename);
+            }
+        }
+
+        ILP_input parse_string_streaming(const std::string& input, const std::size_t nr_chunks)
+        {
+            try {
+                return parse(input.data(), input.data() + input.size(), nr_chunks);
+            } catch(const parse_error&) {
+                throw std::runtime_error("could not read input");
+            }
+        }
+
+        ILP_input parse_objective_file(const std::string& filename, constraint_fingerprint& constraints)
+        {
+            mapped_file f(filename);
+            try {
+                return parse_objective(f.data(), f.data() + f.size(), constraints);
+            } catch(const parse_error&) {
+                throw std::runtime_error("could not read input file " + filename);
+            }
+        }
+
+        ILP_input parse_objective_string(const std::string& input, constraint_fingerprint& constraints)
+        {
+            try {
+                return parse_objective(input.data(), input.data() + input.size(), constraints);
+            } catch(const parse_error&) {
+                throw std::runtime_error("could not read input");
+            }
+        }
+
+        constraint_fingerprint fingerprint_constraints_file(const std::string& filename)
+        {
+            constraint_fingerprint constraints;
+            parse_objective_file(filename, constraints);
+            return constraints;
+        }
+
+        constraint_fingerprint fingerprint_constraints_string(const std::string& input)
+        {
+            constraint_fingerprint constraints;
+            parse_objective_string(input, constraints);
+            return constraints;
+        }
+
+        constraint_fingerprint fingerprint_constraints(const ILP_input& input)
+        {
+            std::stringstream s;
+            input.write(s);
+            return fingerprint_constraints_string(s.str());
+        }
+
+    }
+
+}
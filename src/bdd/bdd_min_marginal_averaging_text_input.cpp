@@ -5,6 +5,7 @@
 #include "tclap/CmdLine.h"
 
 #include <fstream>
+#include <iomanip>
 
 using namespace LPMP;
 
@@ -37,8 +38,8 @@ int main(int argc, char** argv)
     //solver.set_options(options);
     solver.init();
 
-    std::cout << "\#variables: " << solver.nr_variables() << std::endl;
-    std::cout << "\#constraints: " << solver.nr_bdds() << std::endl;
+    std::cout << "#variables: " << solver.nr_variables() << std::endl;
+    std::cout << "#constraints: " << solver.nr_bdds() << std::endl;
 
     std::cout << std::setprecision(10);
     const double initial_lb = solver.compute_lower_bound();
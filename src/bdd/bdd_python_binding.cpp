@@ -0,0 +1,164 @@
+#include "bdd/bdd_min_marginal_averaging.h"
+#include "bdd/bdd_primal_fixing.h"
+#include "bdd/ILP_input.h"
+#include "tclap/CmdLine.h"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+using int_array = py::array_t<long, py::array::c_style | py::array::forcecast>;
+using double_array = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+// constraints are rows of a CSR matrix (indptr, indices, coefficients). sense is -1 for <=, 0 for = and 1 for >=.
+LPMP::ILP_input construct_ILP_input(const double_array objective, const int_array indptr, const int_array indices, const int_array coefficients, const int_array sense, const int_array rhs)
+{
+    const std::size_t nr_variables = objective.size();
+    const std::size_t nr_constraints = sense.size();
+    if(objective.ndim() != 1 || indptr.ndim() != 1 || indices.ndim() != 1 || coefficients.ndim() != 1 || sense.ndim() != 1 || rhs.ndim() != 1)
+        throw std::runtime_error("arrays must be one dimensional");
+    if(indptr.size() != nr_constraints + 1 || rhs.size() != nr_constraints)
+        throw std::runtime_error("indptr must have one entry more than sense and rhs");
+    if(indices.size() != coefficients.size() || indptr.at(nr_constraints) != indices.size())
+        throw std::runtime_error("indices and coefficients must have length indptr[-1]");
+
+    LPMP::ILP_input input;
+    for(std::size_t i=0; i<nr_variables; ++i) {
+        input.add_new_variable("x" + std::to_string(i));
+        input.add_to_objective(objective.at(i), i);
+    }
+
+    const auto _indptr = indptr.unchecked<1>();
+    const auto _indices = indices.unchecked<1>();
+    const auto _coefficients = coefficients.unchecked<1>();
+    for(std::size_t c=0; c<nr_constraints; ++c) {
+        if(_indptr(c) > _indptr(c+1))
+            throw std::runtime_error("indptr must be non-decreasing");
+        LPMP::ILP_input::linear_constraint constraint;
+        for(long k=_indptr(c); k<_indptr(c+1); ++k) {
+            if(_indices(k) < 0 || _indices(k) >= nr_variables)
+                throw std::runtime_error("variable index out of range");
+            constraint.variables.push_back({int(_coefficients(k)), std::size_t(_indices(k))});
+        }
+        constraint.normalize();
+        if(sense.at(c) < 0)
+            constraint.ineq = LPMP::inequality_type::smaller_equal;
+        else if(sense.at(c) == 0)
+            constraint.ineq = LPMP::inequality_type::equal;
+        else
+            constraint.ineq = LPMP::inequality_type::greater_equal;
+        constraint.right_hand_side = rhs.at(c);
+        input.add_constraint(std::move(constraint));
+    }
+    return input;
+}
+
+// Holds the command line parser the solver registers its options with.
+// The solver may reorder variables, arrays exchanged with python are in the order of the input and mapped through variable names.
+template<typename SOLVER>
+struct python_bdd_solver {
+    python_bdd_solver(const LPMP::ILP_input& input, std::vector<std::string> args)
+        : cmd("BDD based 0/1 ILP solver", ' ', "0.1"),
+        solver(cmd)
+    {
+        args.insert(args.begin(), "bdd_solver_py");
+        cmd.setExceptionHandling(false);
+        cmd.parse(args);
+
+        {
+            py::gil_scoped_release release;
+            solver.init(input);
+        }
+
+        variable_index.reserve(input.nr_variables());
+        bool identity = true;
+        for(std::size_t i=0; i<input.nr_variables(); ++i) {
+            variable_index.push_back(solver.ilp_input().get_var_index(input.get_var_name(i)));
+            identity &= variable_index.back() == i;
+        }
+        if(identity)
+            variable_index.clear();
+    }
+
+    // no copy if costs are a contiguous float64 array and variables are not reordered
+    void set_costs(const double_array costs)
+    {
+        if(costs.ndim() != 1 || costs.size() > solver.nr_variables())
+            throw std::runtime_error("costs must be one dimensional with at most one entry per variable");
+        const double* begin = costs.data();
+        const double* end = begin + costs.size();
+        py::gil_scoped_release release;
+        if(variable_index.empty()) {
+            solver.set_costs(begin, end);
+        } else {
+            std::vector<double> permuted_costs(solver.nr_variables(), 0.0);
+            for(const double* it=begin; it!=end; ++it)
+                permuted_costs[variable_index[std::distance(begin, it)]] = *it;
+            solver.set_costs(permuted_costs.begin(), permuted_costs.end());
+        }
+    }
+
+    template<typename T>
+    py::array_t<T> to_input_order(const std::vector<T>& x) const
+    {
+        py::array_t<T> result(x.size());
+        auto r = result.template mutable_unchecked<1>();
+        for(std::size_t i=0; i<x.size(); ++i)
+            r(i) = variable_index.empty() ? x[i] : x[variable_index[i]];
+        return result;
+    }
+
+    py::array_t<double> min_marginals()
+    {
+        std::vector<double> m;
+        {
+            py::gil_scoped_release release;
+            m = solver.total_min_marginals();
+        }
+        return to_input_order(m);
+    }
+
+    TCLAP::CmdLine cmd;
+    SOLVER solver;
+    std::vector<std::size_t> variable_index; // input variable to solver variable, empty if identical
+};
+
+template<typename SOLVER>
+py::class_<python_bdd_solver<SOLVER>> bind_solver(py::module& m, const char* name)
+{
+    using solver_type = python_bdd_solver<SOLVER>;
+    return py::class_<solver_type>(m, name)
+        .def(py::init<const LPMP::ILP_input&, std::vector<std::string>>(), py::arg("input"), py::arg("args") = std::vector<std::string>{},
+                "args are command line options of the solver, e.g. [\"--averaging\", \"SRMP\"]")
+        .def("nr_variables", [](const solver_type& s) { return s.solver.nr_variables(); })
+        .def("set_costs", &solver_type::set_costs, py::arg("costs"))
+        .def("iteration", [](solver_type& s) { s.solver.iteration(); }, py::call_guard<py::gil_scoped_release>())
+        .def("iterations", [](solver_type& s, const std::size_t nr_iterations) {
+                for(std::size_t iter=0; iter<nr_iterations; ++iter)
+                    s.solver.iteration();
+                }, py::arg("nr_iterations"), py::call_guard<py::gil_scoped_release>())
+        .def("lower_bound", [](solver_type& s) { return s.solver.compute_lower_bound(); }, py::call_guard<py::gil_scoped_release>())
+        .def("min_marginals", &solver_type::min_marginals, "min-marginal differences m[1]-m[0] summed over the bdds of each variable");
+}
+
+PYBIND11_MODULE(bdd_solver_py, m) {
+    m.doc() = "python binding for LPMP BDD based 0/1 ILP solvers";
+
+    py::class_<LPMP::ILP_input>(m, "ILP_input")
+        .def(py::init(&construct_ILP_input), py::arg("objective"), py::arg("indptr"), py::arg("indices"), py::arg("coefficients"), py::arg("sense"), py::arg("rhs"),
+                "0/1 ILP with constraints given as CSR matrix, sense is -1 for <=, 0 for = and 1 for >=")
+        .def("nr_variables", &LPMP::ILP_input::nr_variables)
+        .def("nr_constraints", &LPMP::ILP_input::nr_constraints);
+
+    bind_solver<LPMP::bdd_min_marginal_averaging>(m, "bdd_min_marginal_averaging");
+
+    using fixing_solver = python_bdd_solver<LPMP::bdd_mma_fixing>;
+    bind_solver<LPMP::bdd_mma_fixing>(m, "bdd_mma_fixing")
+        .def("fix_variables", [](fixing_solver& s) { return s.solver.fix_variables(); }, py::call_guard<py::gil_scoped_release>(),
+                "primal heuristic, returns whether a feasible solution was found")
+        .def("primal_solution", [](const fixing_solver& s) { return s.to_input_order(s.solver.primal_solution()); })
+        .def("upper_bound", [](fixing_solver& s) { return s.solver.compute_upper_bound(); }, py::call_guard<py::gil_scoped_release>());
+}
@@ -0,0 +1,47 @@
+#include "bdd/bdd_min_marginal_averaging_smoothed.h"
+#include "tclap/CmdLine.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace LPMP;
+
+// compares time per smoothed iteration and the smoothed lower bound reached with exact scalar passes and batched passes with approximate exp/log of different degrees
+int main(int argc, char** argv)
+{
+    std::cout << std::setprecision(12);
+
+    struct result { double time; double lower_bound; };
+
+    auto run = [&](const std::size_t degree) -> result {
+        TCLAP::CmdLine cmd("benchmark of vectorized exp/log approximation in smoothed min-marginal averaging", ' ', "0.1");
+        bdd_min_marginal_averaging_smoothed solver(cmd);
+        TCLAP::ValueArg<std::size_t> nr_iterations_arg("","nr_iterations","number of smoothed iterations",false,20,"integer",cmd);
+        TCLAP::ValueArg<double> cost_scaling_arg("","cost_scaling","smoothing parameter",false,0.01,"real",cmd);
+        cmd.parse(argc, argv);
+
+        solver.init();
+        solver.set_cost_scaling(cost_scaling_arg.getValue());
+        solver.set_exp_approximation(degree);
+        solver.smooth_backward_run();
+
+        const auto begin_time = std::chrono::steady_clock::now();
+        for(std::size_t iter=0; iter<nr_iterations_arg.getValue(); ++iter)
+            solver.smooth_iteration();
+        const auto end_time = std::chrono::steady_clock::now();
+        const double time = std::chrono::duration<double>(end_time - begin_time).count() / double(std::max(nr_iterations_arg.getValue(), std::size_t(1)));
+
+        // bound is evaluated after an exact backward run such that only the effect on the Lagrange multipliers is measured
+        solver.set_exp_approximation(0);
+        solver.smooth_backward_run();
+        return {time, solver.compute_smooth_lower_bound()};
+    };
+
+    const result exact = run(0);
+    std::cout << "exact:     " << exact.time << " s/iteration, smoothed lower bound = " << exact.lower_bound << "\n";
+    for(const std::size_t degree : {3, 5, 7, 9, 11}) {
+        const result approx = run(degree);
+        std::cout << "degree " << std::setw(2) << degree << ": " << approx.time << " s/iteration (speedup " << exact.time / approx.time << "), smoothed lower bound = " << approx.lower_bound
+            << ", difference to exact = " << approx.lower_bound - exact.lower_bound << "\n";
+    }
+}
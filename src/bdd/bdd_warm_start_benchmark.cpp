@@ -0,0 +1,91 @@
+#include "bdd/bdd_min_marginal_averaging.h"
+#include "tclap/CmdLine.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace LPMP;
+
+// Re-solves the input with randomly perturbed objectives. For each perturbation compares the number of iterations needed to come close to the converged lower bound
+// when starting from scratch (set_costs) and when keeping the Lagrange multipliers of the previous solve (import_Lagrange_multipliers).
+int main(int argc, char** argv)
+{
+    std::cout << std::setprecision(10);
+
+    TCLAP::CmdLine cmd("benchmark of warm started reoptimization after cost changes", ' ', "0.1");
+    bdd_min_marginal_averaging solver(cmd);
+    TCLAP::ValueArg<std::size_t> nr_rounds_arg("","nr_rounds","number of cost perturbations",false,5,"integer",cmd);
+    TCLAP::ValueArg<double> perturbation_arg("","perturbation","relative magnitude of cost perturbations",false,0.01,"real",cmd);
+    TCLAP::ValueArg<double> gap_arg("","gap","relative gap to the converged lower bound at which a solve counts as finished",false,1e-4,"real",cmd);
+    TCLAP::ValueArg<std::size_t> max_iter_arg("","max_iter","maximum number of iterations per solve",false,1000,"integer",cmd);
+    cmd.parse(argc, argv);
+
+    solver.init();
+    const std::vector<double> objective = solver.ilp_input().objective();
+
+    // runs until progress stalls, returns lower bound after each iteration, the first entry is the initial one
+    auto solve = [&]() {
+        const double min_progress = 1e-07;
+        std::vector<double> lower_bounds = {solver.compute_lower_bound()};
+        for(std::size_t iter=0; iter<max_iter_arg.getValue(); ++iter) {
+            solver.iteration();
+            lower_bounds.push_back(solver.lower_bound());
+            const double prev_lb = lower_bounds[lower_bounds.size()-2];
+            if(std::abs(lower_bounds.back() - prev_lb) <= min_progress * std::max(std::abs(prev_lb), 1.0))
+                break;
+        }
+        return lower_bounds;
+    };
+
+    auto iterations_to_gap = [&](const std::vector<double>& lower_bounds, const double target) -> std::size_t {
+        for(std::size_t iter=0; iter<lower_bounds.size(); ++iter)
+            if(lower_bounds[iter] >= target)
+                return iter;
+        return std::numeric_limits<std::size_t>::max();
+    };
+
+    const auto initial_begin = std::chrono::steady_clock::now();
+    solve();
+    const auto initial_end = std::chrono::steady_clock::now();
+    std::cout << "initial solve: lower bound = " << solver.lower_bound() << ", time = " << std::chrono::duration<double>(initial_end - initial_begin).count() << " s\n";
+    std::vector<double> multipliers = solver.export_Lagrange_multipliers();
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    std::vector<double> costs(objective.size());
+    std::size_t total_cold = 0;
+    std::size_t total_warm = 0;
+
+    for(std::size_t round=0; round<nr_rounds_arg.getValue(); ++round) {
+        for(std::size_t i=0; i<objective.size(); ++i)
+            costs[i] = objective[i] * (1.0 + perturbation_arg.getValue() * dist(gen));
+
+        const auto cold_begin = std::chrono::steady_clock::now();
+        solver.set_costs(costs.begin(), costs.end());
+        const std::vector<double> cold = solve();
+        const auto cold_end = std::chrono::steady_clock::now();
+
+        const auto warm_begin = std::chrono::steady_clock::now();
+        solver.import_Lagrange_multipliers(multipliers, costs.begin(), costs.end());
+        const std::vector<double> warm = solve();
+        const auto warm_end = std::chrono::steady_clock::now();
+        multipliers = solver.export_Lagrange_multipliers();
+
+        const double converged_lb = std::max(cold.back(), warm.back());
+        const double target = converged_lb - gap_arg.getValue() * std::max(std::abs(converged_lb), 1.0);
+        const std::size_t cold_iter = iterations_to_gap(cold, target);
+        const std::size_t warm_iter = iterations_to_gap(warm, target);
+        total_cold += std::min(cold_iter, cold.size());
+        total_warm += std::min(warm_iter, warm.size());
+
+        auto print_iter = [](const std::size_t iter) { return iter == std::numeric_limits<std::size_t>::max() ? std::string("not reached") : std::to_string(iter); };
+        std::cout << "round " << round << ": converged lower bound = " << converged_lb
+            << ", iterations to gap cold = " << print_iter(cold_iter) << " (" << std::chrono::duration<double>(cold_end - cold_begin).count() << " s until convergence)"
+            << ", warm = " << print_iter(warm_iter) << " (" << std::chrono::duration<double>(warm_end - warm_begin).count() << " s until convergence)"
+            << ", initial lower bound cold = " << cold.front() << ", warm = " << warm.front() << "\n";
+    }
+
+    std::cout << "total iterations to gap: cold = " << total_cold << ", warm = " << total_warm << "\n";
+}
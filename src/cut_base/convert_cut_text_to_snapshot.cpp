@@ -0,0 +1,37 @@
+#include "multicut/multicut_text_input.h"
+#include "max_cut/max_cut_text_input.h"
+#include "cut_base/cut_base_snapshot.hxx"
+#include "mapped_file.hxx"
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+using namespace LPMP;
+
+// Writes a multicut or max-cut text file as binary snapshot, which can be loaded without parsing.
+// The file format is recognized by its first line, costs are stored as float if a third argument "float" is given.
+int main(int argc, char** argv)
+{
+    if(argc < 3)
+        throw std::runtime_error("input and output filename must be present as arguments");
+    const std::string input_filename(argv[1]);
+    const std::string output_filename(argv[2]);
+    const bool single_precision = argc > 3 && std::string(argv[3]) == "float";
+
+    std::string first_line;
+    {
+        mapped_file f(input_filename);
+        const char* line_end = std::find(f.begin(), f.end(), '\n');
+        first_line = std::string(f.begin(), line_end);
+    }
+
+    const cut_base_instance input = first_line.find("MULTICUT") != std::string::npos
+        ? cut_base_instance(multicut_text_input::parse_file(input_filename))
+        : cut_base_instance(max_cut_text_input::parse_file(input_filename));
+    cut_base_snapshot::write(input, output_filename, single_precision);
+
+    const auto begin_time = std::chrono::steady_clock::now();
+    const cut_base_snapshot snapshot(output_filename);
+    const auto end_time = std::chrono::steady_clock::now();
+    std::cout << "#nodes: " << snapshot.no_nodes() << ", #edges: " << snapshot.no_edges() << ", loading snapshot took " << std::chrono::duration<double>(end_time - begin_time).count()*1000.0 << " milliseconds\n";
+}
@@ -0,0 +1,75 @@
+#include "multicut/multicut_text_input.h"
+#include "max_cut/max_cut_text_input.h"
+#include "asymmetric_multiway_cut/asymmetric_multiway_cut_parser.h"
+#include "mapped_file.hxx"
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+using namespace LPMP;
+
+// Compares throughput of the PEGTL based and the memory mapped parallel reader on a multicut, max-cut or asymmetric multiway cut file, checks that both give the same edges and times normalize().
+// The file format is recognized by its first line.
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+        throw std::runtime_error("input filename must be present as argument");
+    const std::string filename(argv[1]);
+    const std::size_t nr_repetitions = argc > 2 ? std::stoul(argv[2]) : 1;
+
+    std::string first_line;
+    double megabytes;
+    {
+        mapped_file f(filename);
+        megabytes = double(f.size()) / (1024.0*1024.0);
+        const char* line_end = std::find(f.begin(), f.end(), '\n');
+        first_line = std::string(f.begin(), line_end);
+    }
+
+    auto measure = [&](auto parse) {
+        double best = std::numeric_limits<double>::infinity();
+        decltype(parse(filename)) input;
+        for(std::size_t i=0; i<nr_repetitions; ++i) {
+            const auto begin_time = std::chrono::steady_clock::now();
+            input = parse(filename);
+            const auto end_time = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end_time - begin_time).count());
+        }
+        return std::make_pair(std::move(input), best);
+    };
+
+    auto compare = [&](const cut_base_instance& pegtl_input, const double pegtl_time, cut_base_instance& streaming_input, const double streaming_time) {
+        std::cout << "file size: " << megabytes << " MB, #nodes: " << pegtl_input.no_nodes() << ", #edges: " << pegtl_input.no_edges() << "\n";
+        std::cout << "PEGTL parser:     " << pegtl_time << " s, " << megabytes / pegtl_time << " MB/s\n";
+        std::cout << "streaming parser: " << streaming_time << " s, " << megabytes / streaming_time << " MB/s\n";
+
+        bool identical = pegtl_input.no_nodes() == streaming_input.no_nodes() && pegtl_input.no_edges() == streaming_input.no_edges();
+        for(std::size_t e=0; identical && e<pegtl_input.no_edges(); ++e) {
+            const auto& e1 = pegtl_input.edges()[e];
+            const auto& e2 = streaming_input.edges()[e];
+            identical = e1[0] == e2[0] && e1[1] == e2[1] && e1.cost[0] == e2.cost[0];
+        }
+
+        const auto normalize_begin = std::chrono::steady_clock::now();
+        streaming_input.normalize();
+        const auto normalize_end = std::chrono::steady_clock::now();
+        std::cout << "normalize: " << std::chrono::duration<double>(normalize_end - normalize_begin).count() << " s, #edges after merging parallel ones: " << streaming_input.no_edges() << "\n";
+
+        std::cout << (identical ? "results identical\n" : "results differ\n");
+        return identical ? 0 : 1;
+    };
+
+    if(first_line.find("ASYMMETRIC MULTIWAY CUT") != std::string::npos) {
+        auto [pegtl_input, pegtl_time] = measure([](const std::string& f) { return asymmetric_multiway_cut_parser::parse_file_pegtl(f); });
+        auto [streaming_input, streaming_time] = measure([](const std::string& f) { return asymmetric_multiway_cut_parser::parse_file(f); });
+        return compare(pegtl_input.edge_costs, pegtl_time, streaming_input.edge_costs, streaming_time);
+    } else if(first_line.find("MULTICUT") != std::string::npos) {
+        auto [pegtl_input, pegtl_time] = measure([](const std::string& f) { return multicut_text_input::parse_file_pegtl(f); });
+        auto [streaming_input, streaming_time] = measure([](const std::string& f) { return multicut_text_input::parse_file(f); });
+        return compare(pegtl_input, pegtl_time, streaming_input, streaming_time);
+    } else {
+        auto [pegtl_input, pegtl_time] = measure([](const std::string& f) { return max_cut_text_input::parse_file_pegtl(f); });
+        auto [streaming_input, streaming_time] = measure([](const std::string& f) { return max_cut_text_input::parse_file(f); });
+        return compare(pegtl_input, pegtl_time, streaming_input, streaming_time);
+    }
+}
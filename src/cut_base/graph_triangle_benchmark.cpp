@@ -0,0 +1,136 @@
+#include "graph.hxx"
+#include <random>
+#include <chrono>
+#include <iostream>
+#include <cmath>
+#include <omp.h>
+
+using namespace LPMP;
+
+// Compares triangle enumeration by set intersection of adjacency lists for every edge, graph::for_each_triangle and graph::for_each_triangle_parallel on k-nearest-neighbor graphs of random points in the unit cube.
+// Arguments: #points (default 100000), k (default 30)
+
+std::vector<std::array<std::size_t,2>> knn_graph(const std::size_t n, const std::size_t k)
+{
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> coord(0.0, 1.0);
+    std::vector<std::array<double,3>> points(n);
+    for(auto& p : points)
+        p = {coord(gen), coord(gen), coord(gen)};
+
+    // uniform grid with about k points per cell, neighbors are searched in the surrounding 3x3x3 cells
+    const std::size_t cells = std::max(std::size_t(1), std::size_t(std::cbrt(double(n) / double(k))));
+    auto cell_coord = [&](const double x) { return std::min(cells-1, std::size_t(x * cells)); };
+    std::vector<std::vector<std::size_t>> grid(cells*cells*cells);
+    for(std::size_t i=0; i<n; ++i)
+        grid[(cell_coord(points[i][0])*cells + cell_coord(points[i][1]))*cells + cell_coord(points[i][2])].push_back(i);
+
+    std::vector<std::vector<std::array<std::size_t,2>>> thread_edges(omp_get_max_threads());
+#pragma omp parallel
+    {
+        std::vector<std::pair<double,std::size_t>> candidates;
+#pragma omp for schedule(dynamic, 1024)
+        for(std::size_t i=0; i<n; ++i) {
+            candidates.clear();
+            const std::array<std::size_t,3> c = {cell_coord(points[i][0]), cell_coord(points[i][1]), cell_coord(points[i][2])};
+            for(std::size_t x=c[0] > 0 ? c[0]-1 : 0; x<std::min(cells, c[0]+2); ++x)
+                for(std::size_t y=c[1] > 0 ? c[1]-1 : 0; y<std::min(cells, c[1]+2); ++y)
+                    for(std::size_t z=c[2] > 0 ? c[2]-1 : 0; z<std::min(cells, c[2]+2); ++z)
+                        for(const std::size_t j : grid[(x*cells + y)*cells + z]) {
+                            if(i == j)
+                                continue;
+                            double d = 0.0;
+                            for(std::size_t l=0; l<3; ++l)
+                                d += (points[i][l] - points[j][l]) * (points[i][l] - points[j][l]);
+                            candidates.push_back({d, j});
+                        }
+            const std::size_t nr_neighbors = std::min(k, candidates.size());
+            std::partial_sort(candidates.begin(), candidates.begin() + nr_neighbors, candidates.end());
+            for(std::size_t l=0; l<nr_neighbors; ++l)
+                thread_edges[omp_get_thread_num()].push_back({std::min(i, candidates[l].second), std::max(i, candidates[l].second)});
+        }
+    }
+
+    std::vector<std::array<std::size_t,2>> edges;
+    for(const auto& t : thread_edges)
+        edges.insert(edges.end(), t.begin(), t.end());
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    return edges;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t n = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const std::size_t k = argc > 2 ? std::stoul(argv[2]) : 30;
+
+    const auto edges = knn_graph(n, k);
+    const graph<double> g(edges.begin(), edges.end(), [](const auto& e) { return double(e[0] + e[1]); });
+    std::cout << "#nodes: " << g.no_nodes() << ", #edges: " << edges.size() << ", #threads: " << omp_get_max_threads() << "\n";
+
+    auto measure = [](const std::string& name, auto enumerate) {
+        const auto begin_time = std::chrono::steady_clock::now();
+        const auto [nr_triangles, checksum] = enumerate();
+        const auto end_time = std::chrono::steady_clock::now();
+        std::cout << name << ": " << std::chrono::duration<double>(end_time - begin_time).count() << " s, #triangles: " << nr_triangles << ", checksum: " << checksum << "\n";
+        return nr_triangles;
+    };
+
+    // per edge intersection of adjacency lists, as for_each_triangle did before
+    const std::size_t nr_merge = measure("adjacency list intersection", [&]() {
+        using edge_type = graph<double>::edge_type;
+        std::size_t nr_triangles = 0;
+        double checksum = 0.0;
+        std::vector<std::array<const edge_type*,2>> common_nodes;
+        for(std::size_t i=0; i<g.no_nodes(); ++i) {
+            for(auto edge_it=g.begin(i); edge_it!=g.end(i); ++edge_it) {
+                const std::size_t j = edge_it->head();
+                if(j < i)
+                    continue;
+                common_nodes.clear();
+                set_intersection_merge(g.begin(i), g.end(i), g.begin(j), g.end(j), std::back_inserter(common_nodes),
+                        [](const edge_type& e1, const edge_type& e2) { return e1.head() < e2.head(); },
+                        [](const edge_type& e1, const edge_type& e2) { return std::array<const edge_type*,2>{&e1, &e2}; });
+                for(const auto [ik, jk] : common_nodes) {
+                    if(ik->head() > j) {
+                        ++nr_triangles;
+                        checksum += edge_it->edge() + ik->edge() + jk->edge();
+                    }
+                }
+            }
+        }
+        return std::make_pair(nr_triangles, checksum);
+    });
+
+    const std::size_t nr_sequential = measure("for_each_triangle", [&]() {
+        std::size_t nr_triangles = 0;
+        double checksum = 0.0;
+        g.for_each_triangle([&](const std::size_t i, const std::size_t j, const std::size_t k, const double ij, const double ik, const double jk) {
+            ++nr_triangles;
+            checksum += ij + ik + jk;
+        });
+        return std::make_pair(nr_triangles, checksum);
+    });
+
+    const std::size_t nr_parallel = measure("for_each_triangle_parallel", [&]() {
+        struct alignas(64) thread_result { std::size_t nr_triangles = 0; double checksum = 0.0; };
+        std::vector<thread_result> results(omp_get_max_threads());
+        g.for_each_triangle_parallel([&](const std::size_t i, const std::size_t j, const std::size_t k, const double ij, const double ik, const double jk) {
+            auto& r = results[omp_get_thread_num()];
+            ++r.nr_triangles;
+            r.checksum += ij + ik + jk;
+        });
+        std::size_t nr_triangles = 0;
+        double checksum = 0.0;
+        for(const auto& r : results) {
+            nr_triangles += r.nr_triangles;
+            checksum += r.checksum;
+        }
+        return std::make_pair(nr_triangles, checksum);
+    });
+
+    if(nr_merge != nr_sequential || nr_merge != nr_parallel) {
+        std::cout << "triangle counts differ\n";
+        return 1;
+    }
+}
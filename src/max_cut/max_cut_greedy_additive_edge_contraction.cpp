@@ -9,7 +9,8 @@
 
 namespace LPMP {
 
-    max_cut_edge_labeling greedy_additive_edge_contraction(const max_cut_instance& instance)
+    template<typename INSTANCE>
+    max_cut_edge_labeling greedy_additive_edge_contraction_impl(const INSTANCE& instance)
     {
         std::cout << "graph connected: " << instance.graph_connected() << "\n";
         assert(instance.graph_connected());
@@ -94,5 +95,15 @@ namespace LPMP {
         return sol;
     }
 
+    max_cut_edge_labeling greedy_additive_edge_contraction(const max_cut_instance& instance)
+    {
+        return greedy_additive_edge_contraction_impl(instance);
+    }
+
+    max_cut_edge_labeling greedy_additive_edge_contraction(const max_cut_snapshot& instance)
+    {
+        return greedy_additive_edge_contraction_impl(instance);
+    }
+
 } // namespace LPMP 
 
@@ -9,9 +9,18 @@ namespace LPMP {
 
         max_cut_instance parse_string(const std::string& input)
         {
-            return cut_base_text_input::parse_string<max_cut_instance, max_cut_identifier, -1>(input);
+            return cut_base_text_input::parse_string_streaming<max_cut_instance, -1>(input, "MAX-CUT");
         }
         max_cut_instance parse_file(const std::string& filename)
+        {
+            return cut_base_text_input::parse_file_streaming<max_cut_instance, -1>(filename, "MAX-CUT");
+        }
+
+        max_cut_instance parse_string_pegtl(const std::string& input)
+        {
+            return cut_base_text_input::parse_string<max_cut_instance, max_cut_identifier, -1>(input);
+        }
+        max_cut_instance parse_file_pegtl(const std::string& filename)
         {
             return cut_base_text_input::parse_file<max_cut_instance, max_cut_identifier, -1>(filename);
         }
@@ -60,12 +60,12 @@ conic_bundle_preamble_opengm = """
 """
 
 solvers = [
-    solver(opengm_preamble, 'FMC_SRMP', 'LP<FMC_SRMP>', 'mrf_opengm_input::parse_file', 'srmp_opengm.cpp', 'StandardVisitor', False),
+    solver(opengm_preamble, 'FMC_SRMP_TRUNCATED', 'LP<FMC_SRMP_TRUNCATED>', 'mrf_opengm_input::parse_file', 'srmp_opengm.cpp', 'StandardVisitor', False),
     solver(opengm_preamble, 'FMC_SRMP_T', 'LP<FMC_SRMP_T>', 'mrf_opengm_input::parse_file', 'srmp_opengm_tightening.cpp', 'StandardTighteningVisitor', False),
-    solver(opengm_preamble, 'FMC_MPLP', 'LP<FMC_MPLP>', 'mrf_opengm_input::parse_file', 'mplp_opengm.cpp', 'StandardVisitor', False),
-    solver(preamble, 'FMC_SRMP', 'LP<FMC_SRMP>', 'mrf_uai_input::parse_file', 'srmp_uai.cpp', 'StandardVisitor', False),
+    solver(opengm_preamble, 'FMC_MPLP_TRUNCATED', 'LP<FMC_MPLP_TRUNCATED>', 'mrf_opengm_input::parse_file', 'mplp_opengm.cpp', 'StandardVisitor', False),
+    solver(preamble, 'FMC_SRMP_TRUNCATED', 'LP<FMC_SRMP_TRUNCATED>', 'mrf_uai_input::parse_file', 'srmp_uai.cpp', 'StandardVisitor', False),
     solver(preamble, 'FMC_SRMP_T', 'LP<FMC_SRMP_T>', 'mrf_uai_input::parse_file', 'srmp_uai_tightening.cpp', 'StandardTighteningVisitor', False),
-    solver(preamble, 'FMC_MPLP', 'LP<FMC_MPLP>', 'mrf_uai_input::parse_file', 'mplp_uai.cpp', 'StandardVisitor', False),
+    solver(preamble, 'FMC_MPLP_TRUNCATED', 'LP<FMC_MPLP_TRUNCATED>', 'mrf_uai_input::parse_file', 'mplp_uai.cpp', 'StandardVisitor', False),
     solver(combiLP_preamble, 'FMC_SRMP', 'combiLP<DD_ILP::gurobi_interface, LP<FMC_SRMP>>', 'mrf_uai_input::parse_file', 'srmp_uai_combiLP.cpp', 'StandardVisitor', False),
     solver(opengm_combiLP_preamble, 'FMC_SRMP', 'combiLP<DD_ILP::gurobi_interface, LP<FMC_SRMP>>', 'mrf_opengm_input::parse_file', 'srmp_opengm_combiLP.cpp', 'StandardVisitor', False),
     solver(dd_preamble, 'FMC_SRMP', 'LP_tree_FWMAP<FMC_SRMP>', 'mrf_uai_input::parse_file', 'FWMAP_uai.cpp', 'StandardVisitor', True),
@@ -5,7 +5,7 @@
 
 using namespace LPMP;
 int main(int argc, char** argv) {
-MpRoundingSolver<Solver<LP<FMC_MPLP>,StandardVisitor>> solver(argc,argv);
+MpRoundingSolver<Solver<LP<FMC_MPLP_TRUNCATED>,StandardVisitor>> solver(argc,argv);
 auto input = mrf_opengm_input::parse_file(solver.get_input_file());
 solver.GetProblemConstructor().construct(input);
 return solver.Solve();
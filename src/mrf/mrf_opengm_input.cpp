@@ -94,6 +94,7 @@ namespace mrf_opengm_input {
 
        }
 
+       input.compute_pairwise_table_ids();
        return input;
    }
 
@@ -95,7 +95,20 @@ void pairwise_potts_factor::MaximizePotentialAndComputePrimal()
 vector<double> pairwise_potts_factor::min_marginal_1() const
 {
    vector<double> m(dim());
+   min_marginal_1(m);
+   return m;
+}
+
+vector<double> pairwise_potts_factor::min_marginal_2() const
+{
+   vector<double> m(dim());
+   min_marginal_2(m);
+   return m;
+}
 
+void pairwise_potts_factor::min_marginal_1(vector<double>& m) const
+{
+   assert(m.size() == dim());
    const auto smallest2 = two_smallest_elements<double>(msg2_begin(), msg2_end());
 
    for(std::size_t i=0; i<dim(); ++i) {
@@ -103,14 +116,11 @@ vector<double> pairwise_potts_factor::min_marginal_1() const
       const double diff_label = diff_cost() + ((*this)[i+dim()] == smallest2[0] ? smallest2[1] : smallest2[0]);
       m[i] = (*this)[i] + std::min(same_label, diff_label); 
    } 
-
-   return m;
 }
 
-vector<double> pairwise_potts_factor::min_marginal_2() const
+void pairwise_potts_factor::min_marginal_2(vector<double>& m) const
 {
-   vector<double> m(dim());
-
+   assert(m.size() == dim());
    const auto smallest2 = two_smallest_elements<double>(msg1_begin(), msg1_end());
 
    for(std::size_t i=0; i<dim(); ++i) {
@@ -118,7 +128,6 @@ vector<double> pairwise_potts_factor::min_marginal_2() const
       const double diff_label = diff_cost() + ((*this)[i] == smallest2[0] ? smallest2[1] : smallest2[0]);
       m[i] = (*this)[i+dim()] + std::min(same_label, diff_label); 
    } 
-   return m;
 }
 
 double pairwise_potts_factor::min_marginal_cut() const
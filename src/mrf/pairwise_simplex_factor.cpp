@@ -5,85 +5,125 @@
 namespace LPMP {
 
 PairwiseSimplexFactor::PairwiseSimplexFactor(const std::size_t _dim1, const std::size_t _dim2) 
-   : pairwise_(_dim1, _dim2),
+   : pairwise_(std::make_shared<matrix<REAL>>(_dim1, _dim2)),
    left_msg_(_dim1),
    right_msg_(_dim2)
 {
-   std::fill(pairwise_.begin(), pairwise_.end(), 0.0);
+   std::fill(pairwise_->begin(), pairwise_->end(), 0.0);
    std::fill(left_msg_.begin(), left_msg_.end(), 0.0);
    std::fill(right_msg_.begin(), right_msg_.end(), 0.0);
 }
 
+PairwiseSimplexFactor::PairwiseSimplexFactor(cost_table pairwise)
+   : pairwise_(std::const_pointer_cast<matrix<REAL>>(pairwise)),
+   shared_pairwise_(true),
+   left_msg_(pairwise->dim1()),
+   right_msg_(pairwise->dim2())
+{
+   std::fill(left_msg_.begin(), left_msg_.end(), 0.0);
+   std::fill(right_msg_.begin(), right_msg_.end(), 0.0);
+}
+
+// shared tables stay shared, private ones are copied
 PairwiseSimplexFactor::PairwiseSimplexFactor(const PairwiseSimplexFactor& o) 
-   : pairwise_(o.dim1(), o.dim2()),
+   : pairwise_(o.shared_pairwise_ ? o.pairwise_ : std::make_shared<matrix<REAL>>(*o.pairwise_)),
+   shared_pairwise_(o.shared_pairwise_),
    left_msg_(o.dim1()),
    right_msg_(o.dim2())
 {
-   pairwise_ = o.pairwise_;
    left_msg_ = o.left_msg_;
    right_msg_ = o.right_msg_;
 }
 
 void PairwiseSimplexFactor::operator=(const PairwiseSimplexFactor& o) {
    assert(dim1() == o.dim1() && dim2() == o.dim2());
-   pairwise_ = o.pairwise_;
+   if(o.shared_pairwise_) {
+      pairwise_ = o.pairwise_;
+      shared_pairwise_ = true;
+   } else {
+      mutable_pairwise() = *o.pairwise_;
+   }
    left_msg_ = o.left_msg_;
    right_msg_ = o.right_msg_;
 }
 
-double PairwiseSimplexFactor::operator[](const std::size_t idx) const 
+matrix<REAL>& PairwiseSimplexFactor::mutable_pairwise()
+{
+   if(shared_pairwise_) {
+      pairwise_ = std::make_shared<matrix<REAL>>(*pairwise_);
+      shared_pairwise_ = false;
+   }
+   return *pairwise_;
+}
+
+REAL PairwiseSimplexFactor::operator[](const std::size_t idx) const 
 {
    const auto [x,y] = get_indices(idx);
-   return pairwise_(x,y) + left_msg_[x] + right_msg_[y];
+   return (*pairwise_)(x,y) + left_msg_[x] + right_msg_[y];
 }
 
 // below is not nice: two different values, only differ by const!
-double PairwiseSimplexFactor::operator()(const std::size_t x1, const std::size_t x2) const 
+REAL PairwiseSimplexFactor::operator()(const std::size_t x1, const std::size_t x2) const 
 {
    assert(x1 < dim1() && x2 < dim2());
-   return pairwise_(x1,x2) + left_msg_[x1] + right_msg_[x2];
+   return (*pairwise_)(x1,x2) + left_msg_[x1] + right_msg_[x2];
 }
 
-double& PairwiseSimplexFactor::cost(const std::size_t x1, const std::size_t x2) 
+REAL& PairwiseSimplexFactor::cost(const std::size_t x1, const std::size_t x2) 
 {
    assert(x1 < dim1() && x2 < dim2());
-   return pairwise_(x1,x2);
+   return mutable_pairwise()(x1,x2);
 }
 
-double& PairwiseSimplexFactor::cost(const std::size_t idx) 
+REAL& PairwiseSimplexFactor::cost(const std::size_t idx) 
 {
    const auto [x,y] = get_indices(idx);
-   return pairwise_(x,y);
+   return mutable_pairwise()(x,y);
 }
 
-// TODO: make more efficient based on SIMD instructions
 double PairwiseSimplexFactor::LowerBound() const
 {
-   double lb = std::numeric_limits<double>::infinity();
+   REAL lb = std::numeric_limits<REAL>::infinity();
    for(std::size_t x1=0; x1<dim1(); ++x1) {
-      for(std::size_t x2=0; x2<dim2(); ++x2) {
-         lb = std::min(lb, (*this)(x1,x2));
-      }
+      lb = std::min(lb, left_msg_[x1] + pairwise_->col_min(x1, right_msg_));
    }
    assert(std::isfinite(lb));
    return lb;
 }
 
+// keep smallest and second smallest value per simd lane and merge lanes at the end. Padding holds infinity and does not interfere.
 double PairwiseSimplexFactor::sensitivity() const
 {
-   double smallest = std::numeric_limits<double>::infinity();
-   double second_smallest = std::numeric_limits<double>::infinity();
+   const REAL inf = std::numeric_limits<REAL>::infinity();
+   REAL_VECTOR smallest = simdpp::load_splat(&inf);
+   REAL_VECTOR second_smallest = smallest;
    for(std::size_t x1=0; x1<dim1(); ++x1) {
-      for(std::size_t x2=0; x2<dim2(); ++x2) {
-         const double val = (*this)(x1,x2);
-         const double min = std::min(smallest, val);
-         const double max = std::max(smallest, val);
-         smallest = min;
-         second_smallest = std::min(max, second_smallest);
+      const REAL* row = &(*pairwise_)(x1,0);
+      const REAL_VECTOR l = simdpp::load_splat(left_msg_.begin() + x1);
+      for(std::size_t x2=0; x2<dim2(); x2+=REAL_ALIGNMENT) {
+         REAL_VECTOR val = simdpp::load(row + x2);
+         REAL_VECTOR r = simdpp::load(right_msg_.begin() + x2);
+         val = val + r;
+         val = val + l;
+         second_smallest = simdpp::min(second_smallest, simdpp::max(smallest, val));
+         smallest = simdpp::min(smallest, val);
+      }
+   }
+
+   alignas(32) std::array<REAL, REAL_ALIGNMENT> lane_smallest;
+   alignas(32) std::array<REAL, REAL_ALIGNMENT> lane_second_smallest;
+   simdpp::store(lane_smallest.data(), smallest);
+   simdpp::store(lane_second_smallest.data(), second_smallest);
+   double s = std::numeric_limits<double>::infinity();
+   double t = std::numeric_limits<double>::infinity();
+   for(const auto& lane : {lane_smallest, lane_second_smallest}) {
+      for(const REAL val : lane) {
+         t = std::min(t, std::max(s, double(val)));
+         s = std::min(s, double(val));
       }
    }
-   assert(std::isfinite(second_smallest));
-   return second_smallest - smallest;
+   assert(std::isfinite(t));
+   return t - s;
 } 
 
 std::size_t PairwiseSimplexFactor::dim(const std::size_t d) const 
@@ -109,71 +149,111 @@ PairwiseSimplexFactor::EvaluatePrimal() const {
    return (*this)(primal_[0], primal_[1]); 
 }
 
+double PairwiseSimplexFactor::normalize_potential()
+{
+   const double lb = LowerBound();
+   if(!std::isfinite(lb)) { return 0.0; }
+   // shift messages instead of pairwise costs to keep a shared cost table intact
+   const REAL min = lb;
+   for(std::size_t x1=0; x1<dim1(); ++x1) { left_msg_[x1] -= min; }
+   return min;
+}
+
 void 
 PairwiseSimplexFactor::MaximizePotentialAndComputePrimal() 
 {
+   // last minimizer of pairwise_(x1,.) + right_msg_
+   auto row_argmin = [&](const std::size_t x1) {
+      const REAL* row = &(*pairwise_)(x1,0);
+      REAL min_val = std::numeric_limits<REAL>::infinity();
+      std::size_t x2_min = 0;
+      for(std::size_t x2=0; x2<dim2(); ++x2) {
+         const REAL val = row[x2] + right_msg_[x2];
+         if(min_val >= val) {
+            min_val = val;
+            x2_min = x2;
+         }
+      }
+      return x2_min;
+   };
+
    if(primal_[0] >= dim1() && primal_[1] >= dim2()) {
-      double min_val = std::numeric_limits<double>::infinity();
+      // row minima are computed with simd, only the optimal row is searched for its minimizer
+      REAL min_val = std::numeric_limits<REAL>::infinity();
       for(std::size_t x1=0; x1<dim1(); ++x1) {
-         for(std::size_t x2=0; x2<dim2(); ++x2) {
-            if(min_val >= (*this)(x1,x2)) {
-               min_val = (*this)(x1,x2);
-               primal_[0] = x1;
-               primal_[1] = x2;
-            }
+         const REAL val = left_msg_[x1] + pairwise_->col_min(x1, right_msg_);
+         if(min_val >= val) {
+            min_val = val;
+            primal_[0] = x1;
          }
       }
+      primal_[1] = row_argmin(primal_[0]);
    } else if(primal_[0] >= dim1() && primal_[1] < dim2()) {
-      double min_val = std::numeric_limits<double>::infinity();
+      REAL min_val = std::numeric_limits<REAL>::infinity();
       for(std::size_t x1=0; x1<dim1(); ++x1) {
-         if(min_val >= (*this)(x1,primal_[1])) {
-            min_val = (*this)(x1,primal_[1]);
+         const REAL val = (*pairwise_)(x1,primal_[1]) + left_msg_[x1];
+         if(min_val >= val) {
+            min_val = val;
             primal_[0] = x1;
          }
       } 
    } else if(primal_[1] >= dim2() && primal_[0] < dim1()) {
-      double min_val = std::numeric_limits<double>::infinity();
-      for(std::size_t x2=0; x2<dim2(); ++x2) {
-         if(min_val >= (*this)(primal_[0],x2)) {
-            min_val = (*this)(primal_[0],x2);
-            primal_[1] = x2;
-         }
-      }
+      primal_[1] = row_argmin(primal_[0]);
    } else {
       assert(primal_[0] < dim1() && primal_[1] < dim2());
    }
 }
 
-vector<double> 
+vector<REAL> 
 PairwiseSimplexFactor::min_marginal_1() const
 {
-   auto min = pairwise_.min1(right_msg_);
-   min += left_msg_;
+   vector<REAL> min(dim1());
+   min_marginal_1(min);
+   return min;
+}
+
+vector<REAL> 
+PairwiseSimplexFactor::min_marginal_2() const
+{
+   vector<REAL> min(dim2());
+   min_marginal_2(min);
+   return min; 
+}
+
+void PairwiseSimplexFactor::min_marginal_1(vector<REAL>& min) const
+{
+   assert(min.size() == dim1());
+   for(std::size_t x1=0; x1<dim1(); ++x1) {
+      min[x1] = left_msg_[x1] + pairwise_->col_min(x1, right_msg_);
+   }
 #ifndef NDEBUG
    for(std::size_t x1=0; x1<dim1(); ++x1) {
        double msg_test = std::numeric_limits<double>::infinity();
        for(std::size_t x2=0; x2<dim2(); ++x2)
-           msg_test = std::min(msg_test, (*this)(x1,x2));
+           msg_test = std::min(msg_test, double((*this)(x1,x2)));
        assert(std::abs(msg_test - min[x1]) <= eps);
    } 
 #endif
-   return min;
 }
 
-vector<double> 
-PairwiseSimplexFactor::min_marginal_2() const
+void PairwiseSimplexFactor::min_marginal_2(vector<REAL>& min) const
 {
-   auto min = pairwise_.min2(left_msg_);
-   min += right_msg_;
+   assert(min.size() == dim2());
+   pairwise_->min2(left_msg_, min);
+   for(std::size_t x2=0; x2<dim2(); x2+=REAL_ALIGNMENT) {
+      REAL_VECTOR m = simdpp::load(min.begin() + x2);
+      REAL_VECTOR r = simdpp::load(right_msg_.begin() + x2);
+      m = m + r;
+      simdpp::store(min.begin() + x2, m);
+   }
 #ifndef NDEBUG
    for(std::size_t x2=0; x2<dim2(); ++x2) {
        double msg_test = std::numeric_limits<double>::infinity();
        for(std::size_t x1=0; x1<dim1(); ++x1)
-           msg_test = std::min(msg_test, (*this)(x1,x2));
+           msg_test = std::min(msg_test, double((*this)(x1,x2)));
        assert(std::abs(msg_test - min[x2]) <= eps);
    } 
 #endif 
-   return min; 
 }
 
 std::array<std::size_t,2> PairwiseSimplexFactor::get_indices(const std::size_t idx) const
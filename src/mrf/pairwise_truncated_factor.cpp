@@ -0,0 +1,201 @@
+#include "mrf/pairwise_truncated_factor.h"
+#include <vector>
+#include <algorithm>
+
+namespace LPMP {
+
+namespace {
+
+// f[x] = min_y h[y] + w*|x-y| by a forward and a backward pass
+void linear_distance_transform(const REAL* h, const std::size_t n_in, const double w, std::vector<double>& f, const std::size_t n_out)
+{
+   const std::size_t n = std::max(n_in, n_out);
+   f.resize(n);
+   for(std::size_t q=0; q<n; ++q) {
+      f[q] = q < n_in ? h[q] : std::numeric_limits<double>::infinity();
+   }
+   for(std::size_t q=1; q<n; ++q) {
+      f[q] = std::min(f[q], f[q-1] + w);
+   }
+   for(std::size_t q=n-1; q>0; --q) {
+      f[q-1] = std::min(f[q-1], f[q] + w);
+   }
+}
+
+// f[x] = min_y h[y] + w*(x-y)^2 by computing the lower envelope of the parabolas rooted at (y,h[y])
+void quadratic_distance_transform(const REAL* h, const std::size_t n_in, const double w, std::vector<double>& f, const std::size_t n_out)
+{
+   assert(w > 0.0);
+   thread_local std::vector<std::size_t> v; // roots of parabolas in lower envelope
+   thread_local std::vector<double> z; // boundaries between parabolas
+   v.resize(n_in);
+   z.resize(n_in+1);
+   f.resize(n_out);
+
+   auto height = [&](const std::size_t q) { return double(h[q]) + w*double(q)*double(q); };
+
+   std::ptrdiff_t k = -1;
+   for(std::size_t q=0; q<n_in; ++q) {
+      if(!std::isfinite(h[q])) { continue; }
+      if(k < 0) {
+         k = 0;
+         v[0] = q;
+         z[0] = -std::numeric_limits<double>::infinity();
+         z[1] = std::numeric_limits<double>::infinity();
+         continue;
+      }
+      double s;
+      while(true) {
+         const std::size_t p = v[k];
+         s = (height(q) - height(p)) / (2.0*w*(double(q) - double(p)));
+         if(s <= z[k]) { --k; } else { break; }
+      }
+      ++k;
+      v[k] = q;
+      z[k] = s;
+      z[k+1] = std::numeric_limits<double>::infinity();
+   }
+
+   if(k < 0) {
+      std::fill(f.begin(), f.end(), std::numeric_limits<double>::infinity());
+      return;
+   }
+
+   k = 0;
+   for(std::size_t x=0; x<n_out; ++x) {
+      while(z[k+1] < double(x)) { ++k; }
+      const double d = double(x) - double(v[k]);
+      f[x] = w*d*d + h[v[k]];
+   }
+}
+
+} // end anonymous namespace
+
+pairwise_truncated_factor::pairwise_truncated_factor(const std::size_t dim1, const std::size_t dim2, const parameters& p)
+   : params_(p),
+   msg1_(dim1),
+   msg2_(dim2)
+{
+   assert(p.weight >= 0.0 && p.truncation >= 0.0);
+   assert(p.type == distance::linear || p.weight > 0.0);
+   std::fill(msg1_.begin(), msg1_.end(), 0.0);
+   std::fill(msg2_.begin(), msg2_.end(), 0.0);
+   init_primal();
+}
+
+REAL pairwise_truncated_factor::operator()(const std::size_t x1, const std::size_t x2) const
+{
+   assert(x1 < dim1() && x2 < dim2());
+   return msg1_[x1] + msg2_[x2] + cost(x1,x2);
+}
+
+void pairwise_truncated_factor::min_marginal(const vector<REAL>& msg_in, const vector<REAL>& msg_out, REAL* m) const
+{
+   thread_local std::vector<double> dt;
+   if(params_.type == distance::linear) {
+      linear_distance_transform(msg_in.begin(), msg_in.size(), params_.weight, dt, msg_out.size());
+   } else {
+      quadratic_distance_transform(msg_in.begin(), msg_in.size(), params_.weight, dt, msg_out.size());
+   }
+
+   // truncated part of the potential is attained by the smallest incoming message
+   const double truncated = double(*std::min_element(msg_in.begin(), msg_in.end())) + params_.truncation;
+   for(std::size_t x=0; x<msg_out.size(); ++x) {
+      m[x] = msg_out[x] + std::min(dt[x], truncated);
+   }
+}
+
+vector<REAL> pairwise_truncated_factor::min_marginal_1() const
+{
+   vector<REAL> m(dim1());
+   min_marginal_1(m);
+   return m;
+}
+
+vector<REAL> pairwise_truncated_factor::min_marginal_2() const
+{
+   vector<REAL> m(dim2());
+   min_marginal_2(m);
+   return m;
+}
+
+void pairwise_truncated_factor::min_marginal_1(vector<REAL>& m) const
+{
+   assert(m.size() == dim1());
+   min_marginal(msg2_, msg1_, m.begin());
+}
+
+void pairwise_truncated_factor::min_marginal_2(vector<REAL>& m) const
+{
+   assert(m.size() == dim2());
+   min_marginal(msg1_, msg2_, m.begin());
+}
+
+double pairwise_truncated_factor::LowerBound() const
+{
+   thread_local std::vector<REAL> m;
+   m.resize(dim1());
+   min_marginal(msg2_, msg1_, m.data());
+   return *std::min_element(m.begin(), m.end());
+}
+
+double pairwise_truncated_factor::EvaluatePrimal() const
+{
+   if(primal_[0] >= dim1() || primal_[1] >= dim2()) {
+      return std::numeric_limits<double>::infinity();
+   }
+   return (*this)(primal_[0], primal_[1]);
+}
+
+double pairwise_truncated_factor::normalize_potential()
+{
+   const double lb = LowerBound();
+   if(!std::isfinite(lb)) { return 0.0; }
+   for(std::size_t x1=0; x1<dim1(); ++x1) { msg1_[x1] -= lb; }
+   return lb;
+}
+
+std::size_t pairwise_truncated_factor::argmin_1(const std::size_t x2) const
+{
+   double min_val = std::numeric_limits<double>::infinity();
+   std::size_t x1_min = 0;
+   for(std::size_t x1=0; x1<dim1(); ++x1) {
+      const double val = msg1_[x1] + cost(x1,x2);
+      if(val < min_val) {
+         min_val = val;
+         x1_min = x1;
+      }
+   }
+   return x1_min;
+}
+
+std::size_t pairwise_truncated_factor::argmin_2(const std::size_t x1) const
+{
+   double min_val = std::numeric_limits<double>::infinity();
+   std::size_t x2_min = 0;
+   for(std::size_t x2=0; x2<dim2(); ++x2) {
+      const double val = msg2_[x2] + cost(x1,x2);
+      if(val < min_val) {
+         min_val = val;
+         x2_min = x2;
+      }
+   }
+   return x2_min;
+}
+
+void pairwise_truncated_factor::MaximizePotentialAndComputePrimal()
+{
+   if(primal_[0] >= dim1() && primal_[1] >= dim2()) {
+      thread_local std::vector<REAL> m;
+      m.resize(dim1());
+      min_marginal(msg2_, msg1_, m.data());
+      primal_[0] = std::min_element(m.begin(), m.end()) - m.begin();
+      primal_[1] = argmin_2(primal_[0]);
+   } else if(primal_[0] >= dim1()) {
+      primal_[0] = argmin_1(primal_[1]);
+   } else if(primal_[1] >= dim2()) {
+      primal_[1] = argmin_2(primal_[0]);
+   }
+}
+
+} // namespace LPMP
@@ -9,6 +9,7 @@
 #include <unordered_map>
 #include <algorithm>
 #include <cassert>
+#include <type_traits>
 
 namespace LPMP {
 
@@ -16,27 +17,37 @@ constexpr static double tolerance = 1e-8;
 
 struct weighted_edge : public std::array<std::size_t,2> { double cost; };
 
-cycle_packing multicut_cycle_packing_impl(const multicut_instance& input, const bool record_cycles)
+template<typename INSTANCE>
+cycle_packing multicut_cycle_packing_impl(const INSTANCE& input, const bool record_cycles)
 {
    const auto begin_time = std::chrono::steady_clock::now();
 
    double lower_bound = 0.0;
    std::vector<weighted_edge> repulsive_edges;
    std::vector<weighted_edge> positive_edges;
+   std::size_t nr_positive_edges = 0;
    for (const auto& e : input.edges()) {
       if(e.cost < 0.0)
          repulsive_edges.push_back({e[0], e[1], e.cost});
-      else if(e.cost > 0.0)
-         positive_edges.push_back({e[0], e[1], e.cost});
+      else if(e.cost > 0.0) {
+         if constexpr(!std::is_base_of_v<cut_base_snapshot, INSTANCE>)
+            positive_edges.push_back({e[0], e[1], e.cost});
+         nr_positive_edges++;
+      }
       lower_bound += std::min(0.0, e.cost[0]);
    }
 
    std::cout << "cycle packing\n";
    std::cout << "initial lower bound = " << lower_bound << "\n";
    std::cout << "#repulsive edges = " << repulsive_edges.size() << "\n";
-   std::cout << "#attractive edges = " << positive_edges.size() << "\n";
-
-   graph<double> pos_edges_graph(positive_edges.begin(), positive_edges.end(), [](const weighted_edge& e) { return e.cost; });
+   std::cout << "#attractive edges = " << nr_positive_edges << "\n";
+
+   // snapshots already store the sorted adjacency, no need to go through the edge list
+   graph<double> pos_edges_graph;
+   if constexpr(std::is_base_of_v<cut_base_snapshot, INSTANCE>)
+      pos_edges_graph.construct_from_adjacency(input, [&](const std::size_t e) { return input.cost(e) > 0.0; }, [&](const std::size_t e) { return input.cost(e); });
+   else
+      pos_edges_graph.construct(positive_edges.begin(), positive_edges.end(), [](const weighted_edge& e) { return e.cost; });
    cycle_packing cp;
 
    const auto initialization_end_time = std::chrono::steady_clock::now();
@@ -154,6 +165,15 @@ cycle_packing compute_multicut_cycle_packing(const multicut_instance& input)
    return multicut_cycle_packing_impl(input, true);
 }
 
+void multicut_cycle_packing(const multicut_snapshot& input)
+{
+   multicut_cycle_packing_impl(input, false);
+}
+cycle_packing compute_multicut_cycle_packing(const multicut_snapshot& input)
+{
+   return multicut_cycle_packing_impl(input, true);
+}
+
 // apply the cycle packing
 triplet_multicut_instance pack_multicut_instance(const multicut_instance& input, const cycle_packing& cp)
 {
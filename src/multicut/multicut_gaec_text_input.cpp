@@ -10,7 +10,17 @@ using namespace LPMP;
 int main(int argc, char** argv)
 {
     if(argc != 2)
-        throw std::runtime_error("input file expected as argument");
+        throw std::runtime_error("input file or cut snapshot expected as argument");
+
+    if(cut_base_snapshot::is_snapshot(argv[1])) {
+        const auto begin_time = std::chrono::steady_clock::now();
+        const multicut_snapshot input(argv[1]);
+        const multicut_edge_labeling sol = greedy_additive_edge_contraction(input);
+        const auto end_time = std::chrono::steady_clock::now();
+        std::cout << "gaec energy = " << input.evaluate(sol) << "\n";
+        std::cout << "Loading snapshot and optimization took " <<  std::chrono::duration_cast<std::chrono::milliseconds>(end_time - begin_time).count() << " milliseconds\n";
+        return 0;
+    }
 
     const multicut_instance input = multicut_text_input::parse_file(argv[1]);
 
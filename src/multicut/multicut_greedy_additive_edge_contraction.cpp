@@ -2,20 +2,32 @@
 #include <queue>
 #include <cassert>
 #include <functional>
+#include <type_traits>
 #include "multicut/multicut_greedy_additive_edge_contraction.h"
 #include "union_find.hxx"
 #include "dynamic_graph.hxx"
 
 namespace LPMP {
 
-    multicut_edge_labeling greedy_additive_edge_contraction(const multicut_instance& instance)
+    template<typename INSTANCE>
+    multicut_edge_labeling greedy_additive_edge_contraction_impl(const INSTANCE& instance)
     {
         struct edge_type {
             double cost;
             std::size_t stamp;
         };
 
-        dynamic_graph<edge_type> g(instance.edges().begin(), instance.edges().end(), [](const auto& e) -> edge_type { return {e.cost, 0}; });
+        // snapshots already store the adjacency, no need to go through the edge list
+        auto construct_graph = [&]() {
+            if constexpr(std::is_base_of_v<cut_base_snapshot, INSTANCE>) {
+                dynamic_graph<edge_type> g(0);
+                g.construct_from_adjacency(instance, [&](const std::size_t e) -> edge_type { return {instance.cost(e), 0}; });
+                return g;
+            } else {
+                return dynamic_graph<edge_type>(instance.edges().begin(), instance.edges().end(), [](const auto& e) -> edge_type { return {e.cost, 0}; });
+            }
+        };
+        dynamic_graph<edge_type> g = construct_graph();
         union_find partition(instance.no_nodes());
 
         struct edge_type_q : public std::array<std::size_t,2> {
@@ -83,4 +95,14 @@ namespace LPMP {
         return multicut_edge_labeling(instance, partition);
     }
 
+    multicut_edge_labeling greedy_additive_edge_contraction(const multicut_instance& instance)
+    {
+        return greedy_additive_edge_contraction_impl(instance);
+    }
+
+    multicut_edge_labeling greedy_additive_edge_contraction(const multicut_snapshot& instance)
+    {
+        return greedy_additive_edge_contraction_impl(instance);
+    }
+
 } // namespace LPMP 
@@ -1,10 +1,19 @@
 #include "multicut/multicut_kernighan_lin.h"
+#include "multicut/multicut_greedy_additive_edge_contraction.h"
+#include "two_dimensional_variable_array.hxx"
+#include "union_find.hxx"
+#include "config.hxx"
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <omp.h>
 //#include "andres/graph/multicut-lifted/BEC.hxx"
 //#include "andres/graph/multicut-lifted/BEC_cut.hxx"
 
 namespace LPMP {
 
-   std::pair<andres::graph::Graph<>, std::vector<double>> construct_andres_multicut_instance(const multicut_instance& instance)
+   template<typename INSTANCE>
+   std::pair<andres::graph::Graph<>, std::vector<double>> construct_andres_multicut_instance(const INSTANCE& instance)
    {
       andres::graph::Graph<> graph(instance.no_nodes());
       std::vector<double> edge_values;
@@ -34,34 +43,346 @@ namespace LPMP {
       return labeling;
    }
 
-   multicut_edge_labeling compute_multicut_kernighan_lin(const multicut_instance& instance, multicut_edge_labeling labeling)
-   { 
-      auto [graph, edge_values] = construct_andres_multicut_instance(instance);
+   // Kernighan&Lin with two-cluster moves as in andres::graph::multicut::kernighanLin, working on an adjacency array built from the instance.
+   // Each outer iteration considers all pairs of neighboring clusters and each cluster together with a new empty one.
+   // Pairs are colored such that pairs of the same color have no cluster in common, pairs of one color are improved in parallel.
+   // The result does not depend on the number of threads.
+   class multicut_kernighan_lin {
+      public:
+      template<typename INSTANCE>
+         multicut_kernighan_lin(const INSTANCE& instance, const multicut_edge_labeling& labeling);
 
-      if(labeling.size() != instance.no_edges()) {
-         labeling.clear();
-         labeling.resize(instance.no_edges(), 1);
+      void optimize(const std::size_t max_outer_iterations = 100);
+
+      template<typename INSTANCE>
+         multicut_edge_labeling edge_labeling(const INSTANCE& instance) const;
+
+      private:
+      struct adjacent_node { std::size_t head; double cost; };
+
+      // per thread data with one entry per node, reset after each two-cut
+      struct two_cut_data {
+         two_cut_data(const std::size_t no_nodes) : side(no_nodes, 0), moved(no_nodes, 0), gain(no_nodes, 0.0) {}
+         std::vector<char> side; // 0: not in current pair, 1: first, 2: second cluster
+         std::vector<char> moved;
+         std::vector<double> gain; // decrease of objective when moving node to other cluster
+         std::vector<std::size_t> nodes;
+         std::vector<std::size_t> moves;
+         std::vector<std::pair<double, std::size_t>> queue;
+      };
+
+      // improve partition of two clusters by greedily moving nodes between them and taking the best prefix of moves, or by joining them.
+      // Returns the decrease of the objective.
+      double two_cut(const std::size_t c1, const std::size_t c2, two_cut_data& d);
+
+      // renumber non-empty clusters consecutively
+      void compact_clusters();
+
+      two_dim_variable_array<adjacent_node> adjacency_;
+      std::vector<std::size_t> cluster_;
+      std::vector<std::vector<std::size_t>> cluster_nodes_;
+      std::vector<char> cluster_changed_;
+   };
+
+   template<typename INSTANCE>
+   multicut_kernighan_lin::multicut_kernighan_lin(const INSTANCE& instance, const multicut_edge_labeling& labeling)
+   {
+      std::vector<std::size_t> degree(instance.no_nodes(), 0);
+      for(const auto& e : instance.edges()) {
+         if(e[0] != e[1]) {
+            degree[e[0]]++;
+            degree[e[1]]++;
+         }
+      }
+      adjacency_ = two_dim_variable_array<adjacent_node>(degree.begin(), degree.end());
+      std::fill(degree.begin(), degree.end(), 0);
+      for(const auto& e : instance.edges()) {
+         if(e[0] != e[1]) {
+            const double cost = e.cost;
+            adjacency_(e[0], degree[e[0]]++) = {e[1], cost};
+            adjacency_(e[1], degree[e[1]]++) = {e[0], cost};
+         }
       }
 
-      if(graph.numberOfEdges() > 0)
-         andres::graph::multicut::kernighanLin(graph, edge_values, labeling, labeling);
+      // clusters are the components of uncut edges, without labeling every node is its own cluster
+      union_find uf(instance.no_nodes());
+      if(labeling.size() == instance.no_edges()) {
+         std::size_t e = 0;
+         for(const auto& edge : instance.edges()) {
+            if(labeling[e++] == 0)
+               uf.merge(edge[0], edge[1]);
+         }
+      }
+      std::vector<std::size_t> root_cluster(instance.no_nodes(), std::numeric_limits<std::size_t>::max());
+      cluster_.resize(instance.no_nodes());
+      for(std::size_t i=0; i<instance.no_nodes(); ++i) {
+         const std::size_t r = uf.find(i);
+         if(root_cluster[r] == std::numeric_limits<std::size_t>::max()) {
+            root_cluster[r] = cluster_nodes_.size();
+            cluster_nodes_.push_back({});
+         }
+         cluster_[i] = root_cluster[r];
+         cluster_nodes_[cluster_[i]].push_back(i);
+      }
+      cluster_changed_.resize(cluster_nodes_.size(), 1);
+   }
 
-      return labeling; 
+   template<typename INSTANCE>
+   multicut_edge_labeling multicut_kernighan_lin::edge_labeling(const INSTANCE& instance) const
+   {
+      multicut_edge_labeling labeling;
+      labeling.reserve(instance.no_edges());
+      for(const auto& e : instance.edges())
+         labeling.push_back(cluster_[e[0]] != cluster_[e[1]]);
+      return labeling;
+   }
+
+   double multicut_kernighan_lin::two_cut(const std::size_t c1, const std::size_t c2, two_cut_data& d)
+   {
+      constexpr double min_gain = 1e-9;
+      auto& nodes1 = cluster_nodes_[c1];
+      auto& nodes2 = cluster_nodes_[c2];
+      if(nodes1.size() + nodes2.size() <= 1)
+         return 0.0;
+
+      d.nodes.clear();
+      d.nodes.insert(d.nodes.end(), nodes1.begin(), nodes1.end());
+      d.nodes.insert(d.nodes.end(), nodes2.begin(), nodes2.end());
+      for(const std::size_t i : nodes1)
+         d.side[i] = 1;
+      for(const std::size_t i : nodes2)
+         d.side[i] = 2;
+
+      // a node is a candidate for moving if it has a neighbor in the other cluster or, if the other cluster is empty, if it is in a non-trivial cluster
+      auto queue_cmp = [](const auto& a, const auto& b) { return a.first < b.first || (a.first == b.first && a.second > b.second); };
+      d.queue.clear();
+      double join_gain = 0.0;
+      for(const std::size_t i : d.nodes) {
+         double gain = 0.0;
+         bool border = nodes2.empty();
+         for(const auto& a : adjacency_[i]) {
+            if(d.side[a.head] == d.side[i]) {
+               gain -= a.cost;
+            } else if(d.side[a.head] != 0) {
+               gain += a.cost;
+               border = true;
+               if(d.side[i] == 1)
+                  join_gain += a.cost;
+            }
+         }
+         d.gain[i] = gain;
+         if(border)
+            d.queue.push_back({gain, i});
+      }
+      std::make_heap(d.queue.begin(), d.queue.end(), queue_cmp);
+
+      d.moves.clear();
+      double cumulative_gain = 0.0;
+      double best_gain = 0.0;
+      std::size_t best_no_moves = 0;
+      while(!d.queue.empty()) {
+         std::pop_heap(d.queue.begin(), d.queue.end(), queue_cmp);
+         const auto [gain, i] = d.queue.back();
+         d.queue.pop_back();
+         if(d.moved[i] || gain != d.gain[i])
+            continue;
+
+         d.moved[i] = 1;
+         d.side[i] = 3 - d.side[i];
+         d.moves.push_back(i);
+         cumulative_gain += gain;
+         if(cumulative_gain > best_gain + min_gain) {
+            best_gain = cumulative_gain;
+            best_no_moves = d.moves.size();
+         }
+
+         for(const auto& a : adjacency_[i]) {
+            const std::size_t j = a.head;
+            if(d.side[j] == 0 || d.moved[j])
+               continue;
+            d.gain[j] += d.side[j] == d.side[i] ? -2.0*a.cost : 2.0*a.cost;
+            d.queue.push_back({d.gain[j], j});
+            std::push_heap(d.queue.begin(), d.queue.end(), queue_cmp);
+         }
+      }
+
+      for(std::size_t k=best_no_moves; k<d.moves.size(); ++k)
+         d.side[d.moves[k]] = 3 - d.side[d.moves[k]];
+
+      double decrease = 0.0;
+      if(join_gain > best_gain + min_gain) {
+         for(const std::size_t i : nodes2)
+            cluster_[i] = c1;
+         nodes1.insert(nodes1.end(), nodes2.begin(), nodes2.end());
+         nodes2.clear();
+         decrease = join_gain;
+      } else if(best_no_moves > 0) {
+         nodes1.clear();
+         nodes2.clear();
+         for(const std::size_t i : d.nodes) {
+            if(d.side[i] == 1) {
+               nodes1.push_back(i);
+               cluster_[i] = c1;
+            } else {
+               nodes2.push_back(i);
+               cluster_[i] = c2;
+            }
+         }
+         decrease = best_gain;
+      }
+
+      for(const std::size_t i : d.nodes) {
+         d.side[i] = 0;
+         d.moved[i] = 0;
+      }
+      return decrease;
+   }
+
+   void multicut_kernighan_lin::compact_clusters()
+   {
+      std::vector<std::size_t> new_id(cluster_nodes_.size(), std::numeric_limits<std::size_t>::max());
+      std::size_t no_clusters = 0;
+      for(std::size_t c=0; c<cluster_nodes_.size(); ++c) {
+         if(cluster_nodes_[c].size() > 0) {
+            new_id[c] = no_clusters;
+            if(c != no_clusters) {
+               cluster_nodes_[no_clusters] = std::move(cluster_nodes_[c]);
+               cluster_changed_[no_clusters] = cluster_changed_[c];
+            }
+            ++no_clusters;
+         }
+      }
+      cluster_nodes_.resize(no_clusters);
+      cluster_changed_.resize(no_clusters);
+      for(auto& c : cluster_)
+         c = new_id[c];
+   }
+
+   void multicut_kernighan_lin::optimize(const std::size_t max_outer_iterations)
+   {
+      constexpr double min_improvement = 1e-9;
+      std::vector<two_cut_data> thread_data;
+      thread_data.reserve(omp_get_max_threads());
+      for(int t=0; t<omp_get_max_threads(); ++t)
+         thread_data.emplace_back(cluster_.size());
+
+      std::vector<std::array<std::size_t,2>> pairs;
+      std::vector<std::vector<std::size_t>> cluster_colors;
+      std::vector<std::vector<std::size_t>> color_classes;
+      std::vector<double> pair_gain;
+
+      for(std::size_t iter=0; iter<max_outer_iterations; ++iter) {
+         // pairs of neighboring clusters, at least one of them changed in the previous iteration
+         pairs.clear();
+         for(std::size_t i=0; i<adjacency_.size(); ++i) {
+            for(const auto& a : adjacency_[i]) {
+               const std::size_t c1 = cluster_[i];
+               const std::size_t c2 = cluster_[a.head];
+               if(c1 < c2 && (cluster_changed_[c1] || cluster_changed_[c2]))
+                  pairs.push_back({c1, c2});
+            }
+         }
+         std::sort(pairs.begin(), pairs.end());
+         pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+         // splitting off nodes into a new cluster
+         const std::size_t no_clusters = cluster_nodes_.size();
+         for(std::size_t c=0; c<no_clusters; ++c) {
+            if(cluster_changed_[c] && cluster_nodes_[c].size() > 1) {
+               pairs.push_back({c, cluster_nodes_.size()});
+               cluster_nodes_.push_back({});
+            }
+         }
+         cluster_changed_.clear();
+         cluster_changed_.resize(cluster_nodes_.size(), 0);
+
+         // greedy edge coloring of the cluster pair graph
+         cluster_colors.clear();
+         cluster_colors.resize(cluster_nodes_.size());
+         color_classes.clear();
+         for(std::size_t p=0; p<pairs.size(); ++p) {
+            auto& colors1 = cluster_colors[pairs[p][0]];
+            auto& colors2 = cluster_colors[pairs[p][1]];
+            std::size_t color = 0;
+            while(std::binary_search(colors1.begin(), colors1.end(), color) || std::binary_search(colors2.begin(), colors2.end(), color))
+               ++color;
+            colors1.insert(std::upper_bound(colors1.begin(), colors1.end(), color), color);
+            colors2.insert(std::upper_bound(colors2.begin(), colors2.end(), color), color);
+            if(color_classes.size() <= color)
+               color_classes.resize(color+1);
+            color_classes[color].push_back(p);
+         }
+
+         pair_gain.clear();
+         pair_gain.resize(pairs.size(), 0.0);
+         for(const auto& color_class : color_classes) {
+#pragma omp parallel for schedule(dynamic)
+            for(std::size_t k=0; k<color_class.size(); ++k) {
+               const auto [c1, c2] = pairs[color_class[k]];
+               const double gain = two_cut(c1, c2, thread_data[omp_get_thread_num()]);
+               if(gain > 0.0) {
+                  pair_gain[color_class[k]] = gain;
+                  cluster_changed_[c1] = 1;
+                  cluster_changed_[c2] = 1;
+               }
+            }
+         }
+
+         compact_clusters();
+         const double improvement = std::accumulate(pair_gain.begin(), pair_gain.end(), 0.0);
+         if(debug())
+            std::cout << "Kernighan&Lin iteration " << iter << ": " << pairs.size() << " cluster pairs in " << color_classes.size() << " colors, objective decrease " << improvement << ", #clusters = " << cluster_nodes_.size() << "\n";
+         if(improvement <= min_improvement)
+            break;
+      }
+   }
+
+   template<typename INSTANCE>
+   multicut_edge_labeling compute_multicut_kernighan_lin_impl(const INSTANCE& instance, multicut_edge_labeling labeling)
+   { 
+      multicut_kernighan_lin kl(instance, labeling);
+      kl.optimize();
+      return kl.edge_labeling(instance);
+   }
+
+   multicut_edge_labeling compute_multicut_kernighan_lin(const multicut_instance& instance, multicut_edge_labeling labeling)
+   {
+      return compute_multicut_kernighan_lin_impl(instance, std::move(labeling));
+   }
+
+   multicut_edge_labeling compute_multicut_kernighan_lin(const multicut_snapshot& instance, multicut_edge_labeling labeling)
+   {
+      return compute_multicut_kernighan_lin_impl(instance, std::move(labeling));
+   }
+
+   template<typename INSTANCE>
+   multicut_edge_labeling compute_multicut_gaec_kernighan_lin_impl(const INSTANCE& instance)
+   {
+      return compute_multicut_kernighan_lin_impl(instance, greedy_additive_edge_contraction(instance));
    }
 
    multicut_edge_labeling compute_multicut_gaec_kernighan_lin(const multicut_instance& instance)
+   {
+      return compute_multicut_gaec_kernighan_lin_impl(instance);
+   }
+
+   multicut_edge_labeling compute_multicut_gaec_kernighan_lin(const multicut_snapshot& instance)
+   {
+      return compute_multicut_gaec_kernighan_lin_impl(instance);
+   }
+
+   multicut_edge_labeling compute_multicut_kernighan_lin_andres(const multicut_instance& instance, multicut_edge_labeling labeling)
    {
       auto [graph, edge_values] = construct_andres_multicut_instance(instance);
 
-      multicut_edge_labeling labeling;
-      labeling.resize(graph.numberOfEdges(),1);
+      if(labeling.size() != instance.no_edges()) {
+         labeling.clear();
+         labeling.resize(instance.no_edges(), 1);
+      }
 
-      if(graph.numberOfEdges() > 0) {
-         andres::graph::multicut::greedyAdditiveEdgeContraction(graph, edge_values, labeling);
+      if(graph.numberOfEdges() > 0)
          andres::graph::multicut::kernighanLin(graph, edge_values, labeling, labeling);
-      }
 
-      return labeling;
+      return labeling; 
    }
 
    multicut_edge_labeling compute_multicut_greedy_edge_fixation(const multicut_instance& instance)
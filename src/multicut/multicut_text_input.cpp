@@ -1,6 +1,7 @@
 #include "multicut/multicut_text_input.h"
 #include "pegtl.hh"
 #include "pegtl_parse_rules.h"
+#include "cut_base/cut_base_edge_list_reader.hxx"
 #include <cassert>
 
 namespace LPMP {
@@ -45,7 +46,7 @@ template<> struct action< edge_line > {
         }
 };
 
-multicut_instance parse_file(const std::string& filename)
+multicut_instance parse_file_pegtl(const std::string& filename)
 {
        multicut_instance input;
        pegtl::file_parser problem(filename);
@@ -57,7 +58,7 @@ multicut_instance parse_file(const std::string& filename)
        return input;
 }
 
-multicut_instance parse_string(const std::string& string)
+multicut_instance parse_string_pegtl(const std::string& string)
 {
        multicut_instance input;
        const bool read_success = pegtl::parse<grammar, action>(string,"",input);
@@ -68,6 +69,38 @@ multicut_instance parse_string(const std::string& string)
        return input;
 }
 
+// grammar above, edges are read with cut_base_edge_list_reader
+static bool parse_streaming(const char* begin, const char* end, multicut_instance& input)
+{
+       const parsing::cursor c{end};
+       const char* p = c.keyword_line(begin, "MULTICUT");
+       if(!p)
+           return false;
+       cut_base_edge_list_reader::read_edges(p, end, input);
+       return true;
+}
+
+multicut_instance parse_file(const std::string& filename)
+{
+       multicut_instance input;
+       mapped_file f(filename);
+       if(!parse_streaming(f.begin(), f.end(), input)) {
+           throw std::runtime_error("could not read file " + filename);
+       }
+
+       return input;
+}
+
+multicut_instance parse_string(const std::string& string)
+{
+       multicut_instance input;
+       if(!parse_streaming(string.data(), string.data() + string.size(), input)) {
+           throw std::runtime_error("could not read string");
+       }
+
+       return input;
+}
+
 } // namespace multicut_text_input
 
 
@@ -22,5 +22,23 @@ int main(int argc, char** argv)
     test(instance.nr_edges() == 3);
     test(instance.nr_labels() == 3);
 
+    const asymmetric_multiway_cut_instance pegtl_instance = asymmetric_multiway_cut_parser::parse_string_pegtl(instance_3x3x3);
+    test(pegtl_instance.nr_nodes() == 3 && pegtl_instance.nr_edges() == 3 && pegtl_instance.nr_labels() == 3);
+    for(std::size_t e=0; e<instance.nr_edges(); ++e) {
+        test(instance.edge_costs.edges()[e][0] == pegtl_instance.edge_costs.edges()[e][0]);
+        test(instance.edge_costs.edges()[e][1] == pegtl_instance.edge_costs.edges()[e][1]);
+        test(instance.edge_costs.edges()[e].cost[0] == pegtl_instance.edge_costs.edges()[e].cost[0]);
+    }
+    for(std::size_t i=0; i<instance.nr_nodes(); ++i)
+        for(std::size_t l=0; l<instance.nr_labels(); ++l)
+            test(instance.node_costs(i,l) == pegtl_instance.node_costs(i,l));
+
+    bool malformed_rejected = false;
+    try {
+        asymmetric_multiway_cut_parser::parse_string("ASYMMETRIC MULTIWAY CUT\nMULTICUT\n0 1 1.0\nNODE COSTS\n0 x\n");
+    } catch(const std::runtime_error&) {
+        malformed_rejected = true;
+    }
+    test(malformed_rejected);
 }
 
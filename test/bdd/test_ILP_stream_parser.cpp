@@ -0,0 +1,132 @@
+#include "bdd/ILP_parser.h"
+#include "test.h"
+#include <string>
+#include <sstream>
+#include <random>
+
+using namespace LPMP;
+
+const std::string ILP_example =
+R"(Minimize
+x1 + 2*x2 + 1.5 * x3 - 0.5*x4 - x5
++ 1e-1 x6 -.25 x_7 + inf x8
+Subject To
+x1 + 2*x2 + 3 * x3 - 5*x4 - x5 >= 1
+c1: x5 + x(1,2) + x{3}
+ + x6 - x7 <= -2
+x2+x1 = 1
+ x3 - x2 - x1   =   0
+Bounds
+Binaries
+x1 x2 x3
+x4
+End)";
+
+const std::string ILP_example_crlf = "Minimize\r\n x1 - 2 x2\r\nSubject To\r\nx1 + x2 + x3 <= 1\r\nEnd\r\n";
+
+const std::string ILP_malformed = "Minimize\nx1\nSubject To\nx1 + x2 <= \nEnd\n";
+
+std::string random_ILP(const std::size_t nr_vars, const std::size_t nr_constraints)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> coeff(-5,5);
+    std::uniform_int_distribution<std::size_t> var(0, nr_vars-1);
+    std::stringstream s;
+    s << "Minimize\n";
+    for(std::size_t i=0; i<nr_vars; i+=3)
+        s << "+ " << 0.5*coeff(gen) << " v" << var(gen) << "\n";
+    s << "Subject To\n";
+    for(std::size_t c=0; c<nr_constraints; ++c) {
+        if(c % 7 == 0)
+            s << "r" << c << ": ";
+        const std::size_t nr_terms = 1 + c % 6;
+        for(std::size_t i=0; i<nr_terms; ++i) {
+            const int a = coeff(gen);
+            s << (a < 0 ? "- " : "+ ") << std::abs(a) << " v" << var(gen) << (i % 4 == 3 ? "\n" : " ");
+        }
+        s << (c % 3 == 0 ? "= " : c % 3 == 1 ? "<= " : ">= ") << coeff(gen) << "\n";
+    }
+    s << "Bounds\nBinaries\n";
+    for(std::size_t i=0; i<nr_vars; ++i)
+        s << "v" << i << (i % 10 == 9 || i+1 == nr_vars ? "\n" : " ");
+    s << "End\n";
+    return s.str();
+}
+
+void test_equal(const ILP_input& a, const ILP_input& b)
+{
+    std::stringstream sa, sb;
+    a.write(sa);
+    b.write(sb);
+    test(sa.str() == sb.str());
+    test(a.nr_variables() == b.nr_variables());
+    for(std::size_t i=0; i<a.nr_variables(); ++i)
+        test(a.get_var_name(i) == b.get_var_name(i));
+    test(a.objective() == b.objective());
+    test(a.nr_constraints() == b.nr_constraints());
+    for(std::size_t c=0; c<a.nr_constraints(); ++c) {
+        const auto& ca = a.constraints()[c];
+        const auto& cb = b.constraints()[c];
+        test(ca.ineq == cb.ineq && ca.right_hand_side == cb.right_hand_side);
+        test(ca.variables.size() == cb.variables.size());
+        for(std::size_t i=0; i<ca.variables.size(); ++i)
+            test(ca.variables[i].var == cb.variables[i].var && ca.variables[i].coefficient == cb.variables[i].coefficient);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for(const std::string& s : {ILP_example, ILP_example_crlf}) {
+        const ILP_input reference = ILP_parser::parse_string(s);
+        for(const std::size_t nr_chunks : {1, 2, 5})
+            test_equal(reference, ILP_parser::parse_string_streaming(s, nr_chunks));
+    }
+
+    {
+        const ILP_input input = ILP_parser::parse_string_streaming(ILP_example, 3);
+        test(input.nr_variables() == 11);
+        test(input.objective("x6") == 0.1);
+        test(input.objective("x_7") == -0.25);
+        test(input.objective("x8") == std::numeric_limits<double>::infinity());
+        test(input.nr_constraints() == 4);
+        test(input.constraints()[1].variables.size() == 5);
+        test(input.constraints()[1].right_hand_side == -2);
+        test(input.constraints()[2].ineq == inequality_type::equal);
+    }
+
+    // objective only, constraints are fingerprinted
+    {
+        ILP_parser::constraint_fingerprint constraints;
+        const ILP_input objective = ILP_parser::parse_objective_string(ILP_example, constraints);
+        test(objective.nr_variables() == 8);
+        test(objective.nr_constraints() == 0);
+        test(objective.objective("x2") == 2.0);
+        test(constraints.nr_constraints == 4);
+        test(constraints == ILP_parser::fingerprint_constraints_string(ILP_example));
+
+        std::string reformatted = ILP_example;
+        reformatted.replace(reformatted.find("x2+x1 = 1"), 9, "x2 + x1   =  1");
+        test(ILP_parser::fingerprint_constraints_string(reformatted) == constraints);
+        std::string other_objective = ILP_example;
+        other_objective.replace(other_objective.find("2*x2"), 4, "3*x2");
+        test(ILP_parser::fingerprint_constraints_string(other_objective) == constraints);
+        std::string other_constraints = ILP_example;
+        other_constraints.replace(other_constraints.find("x2+x1 = 1"), 9, "x2+x1 = 0");
+        test(ILP_parser::fingerprint_constraints_string(other_constraints) != constraints);
+    }
+
+    bool malformed_rejected = false;
+    try {
+        ILP_parser::parse_string_streaming(ILP_malformed, 2);
+    } catch(const std::runtime_error&) {
+        malformed_rejected = true;
+    }
+    test(malformed_rejected);
+
+    {
+        const std::string s = random_ILP(200, 5000);
+        const ILP_input reference = ILP_parser::parse_string(s);
+        for(const std::size_t nr_chunks : {1, 3, 16, 100})
+            test_equal(reference, ILP_parser::parse_string_streaming(s, nr_chunks));
+    }
+}
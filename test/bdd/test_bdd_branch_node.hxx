@@ -0,0 +1,51 @@
+#pragma once
+
+#include "bdd/bdd_branch_node.h"
+#include <vector>
+#include <array>
+
+namespace LPMP {
+
+// simplex constraint x_0 + ... + x_{N-1} = 1 as BDD with nodes ordered by variable:
+// node 0 (var 0), nodes 2v-1 (no variable set yet) and 2v (one variable set) for var v >= 1
+constexpr std::size_t simplex_node_variable(const std::size_t i) { return (i+1)/2; }
+// nodes of variable v are [simplex_first_node(v), simplex_first_node(v+1))
+constexpr std::size_t simplex_first_node(const std::size_t v) { return v == 0 ? 0 : 2*v-1; }
+
+template<typename BDD_BRANCH_NODE>
+void connect(std::vector<BDD_BRANCH_NODE>& nodes, const std::size_t i, BDD_BRANCH_NODE* low, BDD_BRANCH_NODE* high)
+{
+    auto& bdd = nodes[i];
+    bdd.low_outgoing = low;
+    if(!BDD_BRANCH_NODE::is_terminal(low)) {
+        bdd.next_low_incoming = low->first_low_incoming;
+        low->first_low_incoming = &bdd;
+    }
+    bdd.high_outgoing = high;
+    if(!BDD_BRANCH_NODE::is_terminal(high)) {
+        bdd.next_high_incoming = high->first_high_incoming;
+        high->first_high_incoming = &bdd;
+    }
+}
+
+template<typename BDD_BRANCH_NODE, std::size_t N>
+void construct_simplex(std::vector<BDD_BRANCH_NODE>& nodes, std::array<double,N>& costs)
+{
+    static_assert(N >= 2);
+    nodes.resize(2*N-1);
+    BDD_BRANCH_NODE* t0 = BDD_BRANCH_NODE::terminal_0();
+    BDD_BRANCH_NODE* t1 = BDD_BRANCH_NODE::terminal_1();
+    connect(nodes, 0, &nodes[1], &nodes[2]);
+    for(std::size_t v=1; v+1<N; ++v) {
+        connect(nodes, 2*v-1, &nodes[2*v+1], &nodes[2*v+2]);
+        connect(nodes, 2*v, &nodes[2*v+2], t0);
+    }
+    connect(nodes, 2*N-3, t0, t1);
+    connect(nodes, 2*N-2, t1, t0);
+    for(std::size_t i=0; i<nodes.size(); ++i)
+        nodes[i].variable_cost = &costs[simplex_node_variable(i)];
+    for(const auto& bdd : nodes)
+        check_bdd_branch_node(bdd);
+}
+
+}
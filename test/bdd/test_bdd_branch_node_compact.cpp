@@ -0,0 +1,107 @@
+#include "bdd/bdd_branch_node.h"
+#include "test_bdd_branch_node.hxx"
+#include <vector>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include "test.h"
+
+using namespace LPMP;
+
+template<typename BDD_BRANCH_NODE>
+std::vector<std::array<double,2>> min_marginals(std::vector<BDD_BRANCH_NODE>& nodes)
+{
+    for(std::ptrdiff_t i=nodes.size()-1; i>=0; --i)
+        nodes[i].backward_step();
+    std::vector<std::array<double,2>> m(3, {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()});
+    for(std::size_t i=0; i<nodes.size(); ++i) {
+        nodes[i].forward_step();
+        const auto mm = nodes[i].min_marginal();
+        const std::size_t var = simplex_node_variable(i);
+        m[var][0] = std::min(m[var][0], mm[0]);
+        m[var][1] = std::min(m[var][1], mm[1]);
+    }
+    return m;
+}
+
+template<typename BDD_BRANCH_NODE>
+std::array<double,2> smooth_sums(std::vector<BDD_BRANCH_NODE>& nodes)
+{
+    for(std::ptrdiff_t i=nodes.size()-1; i>=0; --i)
+        nodes[i].smooth_backward_step();
+    const std::array<double,2> backward = {nodes[0].m, nodes[0].current_max};
+    for(std::size_t i=0; i<nodes.size(); ++i)
+        nodes[i].smooth_forward_step();
+    return backward;
+}
+
+int main()
+{
+    test(sizeof(bdd_branch_node_opt_compact) < sizeof(bdd_branch_node_opt));
+    test(sizeof(bdd_branch_node_opt_smoothed_compact) < sizeof(bdd_branch_node_opt_smoothed));
+    test(sizeof(bdd_branch_node_fix_compact) < sizeof(bdd_branch_node_fix));
+
+    std::array<double,3> costs;
+    std::vector<bdd_branch_node_opt> nodes;
+    construct_simplex(nodes, costs);
+    std::vector<bdd_branch_node_opt_compact> compact_nodes;
+    construct_simplex(compact_nodes, costs);
+
+    // links resolve to the same structure
+    for(std::size_t i=0; i<nodes.size(); ++i) {
+        auto index = [](const auto* p, const auto* base) -> std::ptrdiff_t {
+            using NODE = std::remove_const_t<std::remove_pointer_t<decltype(p)>>;
+            if(p == nullptr) return -1;
+            if(p == NODE::terminal_0()) return -2;
+            if(p == NODE::terminal_1()) return -3;
+            return p - base;
+        };
+        test(index(nodes[i].low_outgoing, nodes.data()) == index(compact_nodes[i].low_outgoing.get(), compact_nodes.data()));
+        test(index(nodes[i].high_outgoing, nodes.data()) == index(compact_nodes[i].high_outgoing.get(), compact_nodes.data()));
+        test(index(nodes[i].first_low_incoming, nodes.data()) == index(compact_nodes[i].first_low_incoming.get(), compact_nodes.data()));
+        test(index(nodes[i].first_high_incoming, nodes.data()) == index(compact_nodes[i].first_high_incoming.get(), compact_nodes.data()));
+        test(index(nodes[i].next_low_incoming, nodes.data()) == index(compact_nodes[i].next_low_incoming.get(), compact_nodes.data()));
+        test(index(nodes[i].next_high_incoming, nodes.data()) == index(compact_nodes[i].next_high_incoming.get(), compact_nodes.data()));
+    }
+
+    std::uniform_int_distribution<> d(-10,10);
+    std::mt19937 gen;
+    for(std::size_t iter=0; iter<100; ++iter) {
+        for(auto& c : costs)
+            c = d(gen);
+        const auto m = min_marginals(nodes);
+        const auto m_compact = min_marginals(compact_nodes);
+        test(m == m_compact);
+        for(std::size_t v=0; v<3; ++v) {
+            double m0 = std::numeric_limits<double>::infinity();
+            for(std::size_t w=0; w<3; ++w)
+                if(w != v)
+                    m0 = std::min(m0, costs[w]);
+            test(m[v][0] == m0);
+            test(m[v][1] == costs[v]);
+        }
+    }
+
+    {
+        std::vector<bdd_branch_node_opt_smoothed> smoothed_nodes;
+        construct_simplex(smoothed_nodes, costs);
+        std::vector<bdd_branch_node_opt_smoothed_compact> smoothed_compact_nodes;
+        construct_simplex(smoothed_compact_nodes, costs);
+        costs = {0.5, -0.25, 0.125};
+        const auto s = smooth_sums(smoothed_nodes);
+        const auto s_compact = smooth_sums(smoothed_compact_nodes);
+        test(s == s_compact);
+        // -log sum_i exp(-c_i)
+        const double smooth_lb = -std::log(std::exp(-costs[0]) + std::exp(-costs[1]) + std::exp(-costs[2]));
+        test(std::abs(-(std::log(s[0]) + s[1]) - smooth_lb) <= 1e-8);
+    }
+
+    {
+        std::vector<bdd_branch_node_fix_compact> fix_nodes;
+        construct_simplex(fix_nodes, costs);
+        for(std::ptrdiff_t i=fix_nodes.size()-1; i>=0; --i)
+            fix_nodes[i].count_backward_step();
+        test(fix_nodes[0].m == 3.0);
+    }
+}
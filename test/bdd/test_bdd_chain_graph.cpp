@@ -1,58 +1,57 @@
 #include "bdd/ILP_parser.h"
 #include "bdd/bdd_min_marginal_averaging.h"
 #include "bdd/bdd_primal_fixing.h"
-#include "bdd/bdd_anisotropic_diffusion.h"
-#include "bdd/convert_pb_to_bdd.h"
-#include "ILP_sample_problems.h"
 #include <vector>
 #include <string>
+#include <fstream>
+#include <cstdio>
 #include <iostream>
+#include <iomanip>
+#include <numeric>
 #include "test.h"
 
 using namespace LPMP;
 
-void test_problem_anisotropic(const std::string input_string, const double expected_lb)
-{
-    const ILP_input input = ILP_parser::parse_string(input_string);
-    bdd_anisotropic_diffusion bdds;
-    bdds.init(input);
-
-    const double initial_lb = bdds.lower_bound();
-    test(initial_lb <= expected_lb + 1e-8);
-
-    std::cout << std::setprecision(10);
-    std::cout << "initial lower bound = " << initial_lb << std::endl;
-
-    double old_lb = initial_lb;
-    double new_lb = old_lb;
-
-    for(std::size_t iter=0; iter<1; ++iter) {
-        bdds.iteration();
-        new_lb = bdds.lower_bound();
-        std::cout << "lower bound = " << new_lb << std::endl;
-        if (new_lb - old_lb < 1e-08)
-            break;
-        old_lb = new_lb;
+// two node chain with two labels each, optimum 1.0 at mu_1_1 = mu_2_1 = mu_11 = 1
+const char * small_chain =
+R"(Minimize
+2 mu_1_0 + 1 mu_1_1 - 1 mu_2_0 + 0 mu_2_1
++ 1 mu_00 + 2 mu_10 + 1 mu_01 + 0 mu_11
+Subject To
+mu_1_0 + mu_1_1 = 1
+mu_2_0 + mu_2_1 = 1
+mu_00 + mu_10 + mu_01 + mu_11 = 1
+mu_1_0 - mu_00 - mu_01 = 0
+mu_1_1 - mu_10 - mu_11 = 0
+mu_2_0 - mu_00 - mu_10 = 0
+mu_2_1 - mu_01 - mu_11 = 0
+End)";
+
+// solvers are constructed from the command line, the input is passed as file
+template<typename BDD_SOLVER>
+struct solver_from_command_line {
+    solver_from_command_line(const std::string& input_string, const std::vector<std::string>& options)
+        : cmd("test of bdd solvers on a chain"), solver(cmd)
+    {
+        const std::string filename = "test_bdd_chain_graph.lp";
+        {
+            std::ofstream f(filename);
+            f << input_string;
+        }
+        std::vector<std::string> args = {"test_bdd_chain_graph", "-i", filename};
+        args.insert(args.end(), options.begin(), options.end());
+        cmd.parse(args);
+        solver.init();
+        std::remove(filename.c_str());
     }
 
-    const double lb = bdds.lower_bound();
+    TCLAP::CmdLine cmd;
+    BDD_SOLVER solver;
+};
 
-    test(std::abs(lb - expected_lb) <= 1e-8);
-}
-
-
-void test_problem_fixing(const std::string input_string, const double expected_lb)
+template<typename BDD_SOLVER>
+double run(BDD_SOLVER& bdds, const double expected_lb)
 {
-    ILP_input input = ILP_parser::parse_string(input_string);
-    // input.reorder_bfs();
-    // input.reorder_Cuthill_McKee();
-
-    bdd_mma_fixing bdds;
-    bdd_min_marginal_averaging_options bdd_options;
-    bdd_options.averaging_type = bdd_min_marginal_averaging_options::averaging_type::SRMP;
-    bdds.set_options(bdd_options);
-    bdds.init(input); 
-
     const double initial_lb = bdds.lower_bound();
     test(initial_lb <= expected_lb + 1e-8);
 
@@ -67,82 +66,67 @@ void test_problem_fixing(const std::string input_string, const double expected_l
         bdds.iteration();
         new_lb = bdds.lower_bound();
         std::cout << "lower bound = " << new_lb << std::endl;
-        // const double ub = bdds.compute_upper_bound();
-        // std::cout << "upper bound = " << ub << std::endl;
         if (new_lb - old_lb < 1e-09)
             break;
         old_lb = new_lb;
     }
 
-    double ub = std::numeric_limits<double>::infinity();
-    if (bdds.fix_variables())
-        ub = bdds.compute_upper_bound();
+    return bdds.lower_bound();
+}
 
-    std::cout << "Primal solution value: " << ub << std::endl;
+void test_problem_fixing(const std::string input_string, const double expected_lb, const std::string& fixing_order)
+{
+    solver_from_command_line<bdd_mma_fixing> s(input_string, {"--averaging", "SRMP", "--fixing", fixing_order});
+    auto& bdds = s.solver;
+    const double lb = run(bdds, expected_lb);
+    test(std::abs(lb - expected_lb) <= 1e-8);
 
-    const double lb = bdds.lower_bound();
+    // only the portfolio of fixing orders is required to find a primal solution
+    const bool found = bdds.fix_variables();
+    test(found || fixing_order != "portfolio");
+    if(!found)
+        return;
+    const double ub = bdds.compute_upper_bound();
+    std::cout << "Primal solution value: " << ub << std::endl;
 
-    test(std::abs(lb - expected_lb) <= 1e-8);
+    test(ub < std::numeric_limits<double>::infinity());
+    test(ub >= lb - 1e-8);
+    const std::vector<char>& primal = bdds.primal_solution();
+    const ILP_input& input = bdds.ilp_input();
+    test(primal.size() == input.nr_variables());
+    test(input.check_feasibility(primal.begin(), primal.end()));
+    test(std::abs(input.evaluate(primal.begin(), primal.end()) - ub) <= 1e-8);
 }
 
-
 template<typename BDD_SOLVER>
 void test_problem(const std::string input_string, const double expected_lb)
 {
-    ILP_input input = ILP_parser::parse_string(input_string);
-    // input.reorder_bfs();
-    // input.reorder_Cuthill_McKee();
-
-    BDD_SOLVER bdds;
-    bdds.init(input);
-
-    const double initial_lb = bdds.lower_bound();
-    test(initial_lb <= expected_lb + 1e-8);
-
-    std::cout << std::setprecision(10);
-    std::cout << "initial lower bound = " << initial_lb << std::endl;
-
-    double old_lb = initial_lb;
-    double new_lb = old_lb;
-
-    for(std::size_t iter=0; iter<100; ++iter) {
-        std::cout << "iteration " << iter << ": " << std::flush;
-        bdds.min_marginal_averaging_iteration_SRMP();
-        // bdds.min_marginal_averaging_iteration();
-        new_lb = bdds.lower_bound();
-        std::cout << "lower bound = " << new_lb << std::endl;
-        if (new_lb - old_lb < 1e-09)
-            break;
-        old_lb = new_lb;
-    }
-
-    const double lb = bdds.lower_bound();
-
+    solver_from_command_line<BDD_SOLVER> s(input_string, {"--averaging", "SRMP"});
+    const double lb = run(s.solver, expected_lb);
     test(std::abs(lb - expected_lb) <= 1e-8);
 }
 
 void test_fixing(const std::string input_string)
 {
-    const ILP_input input = ILP_parser::parse_string(input_string);
-
-    bdd_mma_fixing bdds_test;
-    bdds_test.init(input);
-
-    std::vector<size_t> indices{0,1,2,3,4,5,6,7};
-
-    std::vector<char> feasible{1,0,1,0,1,0,0,0};
+    solver_from_command_line<bdd_mma_fixing> s(input_string, {});
+    auto& bdds_test = s.solver;
+    const ILP_input& input = bdds_test.ilp_input();
+
+    // mu_1_0 = mu_2_0 = mu_00 = 1
+    std::vector<char> feasible(input.nr_variables(), 0);
+    for(const char* var : {"mu_1_0", "mu_2_0", "mu_00"})
+        feasible[input.get_var_index(var)] = 1;
+    std::vector<size_t> indices(input.nr_variables());
+    std::iota(indices.begin(), indices.end(), 0);
     test(bdds_test.fix_variables(indices, feasible));
-
 }
 
 int main(int argc, char** arv)
 {
-    // test_problem_anisotropic(small_chain, 1.0);
-    // test_problem_anisotropic(small_chain_reversed, 1.0);
-
     test_problem<bdd_min_marginal_averaging>(small_chain, 1.0);
 
     test_fixing(small_chain);
 
-    test_problem_fixing(small_chain, 1.0);
+    test_problem_fixing(small_chain, 1.0, "up");
+    test_problem_fixing(small_chain, 1.0, "portfolio");
 }
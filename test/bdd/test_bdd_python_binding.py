@@ -0,0 +1,54 @@
+import bdd_solver_py as bdd
+import numpy as np
+import itertools
+
+# x0 + x1 + x2 = 1, x1 + x3 <= 1, x2 - x3 >= 0
+objective = np.array([1.0, -1.0, 2.0, -0.5])
+indptr = np.array([0, 3, 5, 7])
+indices = np.array([0, 1, 2, 1, 3, 2, 3])
+coefficients = np.array([1, 1, 1, 1, 1, 1, -1])
+sense = np.array([0, -1, 1])
+rhs = np.array([1, 1, 0])
+
+def feasible(x):
+    lhs = [sum(coefficients[k] * x[indices[k]] for k in range(indptr[c], indptr[c+1])) for c in range(len(sense))]
+    return all((l <= r if s < 0 else l == r if s == 0 else l >= r) for l, s, r in zip(lhs, sense, rhs))
+
+def optimum(costs):
+    return min(np.dot(costs, x) for x in itertools.product([0, 1], repeat=len(costs)) if feasible(x))
+
+ilp = bdd.ILP_input(objective, indptr, indices, coefficients, sense, rhs)
+assert ilp.nr_variables() == 4
+assert ilp.nr_constraints() == 3
+
+opt = optimum(objective)
+for args in [[], ["--averaging", "SRMP"], ["--order", "bfs"]]:
+    solver = bdd.bdd_min_marginal_averaging(ilp, args)
+    assert solver.nr_variables() == 4
+    solver.iterations(20)
+    lb = solver.lower_bound()
+    assert np.isfinite(lb) and lb <= opt + 1e-8
+    assert solver.min_marginals().shape == (4,)
+
+    # changed costs are taken in input order
+    costs = np.array([-2.0, -1.0, 2.0, -0.5])
+    solver.set_costs(costs)
+    solver.iterations(20)
+    assert solver.lower_bound() <= optimum(costs) + 1e-8
+
+solver = bdd.bdd_mma_fixing(ilp, ["--fixing", "portfolio"])
+solver.iterations(20)
+lb = solver.lower_bound()
+assert solver.fix_variables()
+x = solver.primal_solution()
+assert feasible(x)
+ub = solver.upper_bound()
+assert abs(ub - np.dot(objective, x)) <= 1e-8
+assert lb <= ub + 1e-8 and opt <= ub + 1e-8
+
+# malformed input is rejected
+try:
+    bdd.ILP_input(objective, indptr[:-1], indices, coefficients, sense, rhs)
+    assert False
+except RuntimeError:
+    pass
@@ -0,0 +1,171 @@
+#include "bdd/bdd_min_marginal_averaging_parallel.h"
+#include "bdd/ILP_parser.h"
+#include "test.h"
+#include <omp.h>
+#include <random>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <functional>
+
+using namespace LPMP;
+
+// constraints with up to five terms, such that cuts of split BDDs have more than two nodes and need several split variables
+std::string random_ILP(const std::size_t nr_vars, const std::size_t nr_constraints)
+{
+    std::mt19937 gen(2);
+    std::uniform_int_distribution<int> coeff(1,3);
+    std::uniform_real_distribution<double> cost(-1.0,1.0);
+    std::uniform_int_distribution<std::size_t> var(0, nr_vars-1);
+    std::stringstream s;
+    s << "Minimize\n";
+    for(std::size_t i=0; i<nr_vars; ++i) {
+        const double c = cost(gen);
+        s << (c >= 0 ? "+ " : "- ") << std::abs(c) << " x" << i << "\n";
+    }
+    s << "Subject To\n";
+    for(std::size_t c=0; c<nr_constraints; ++c) {
+        const std::size_t first = var(gen);
+        const std::size_t nr_terms = 3 + c % 3;
+        for(std::size_t i=0; i<nr_terms; ++i)
+            s << "+ " << coeff(gen) << " x" << (first + i) % nr_vars << " ";
+        s << (c % 2 == 0 ? "<= " : ">= ") << 2 + c % 3 << "\n";
+    }
+    s << "End\n";
+    return s.str();
+}
+
+// consecutive variables form a chain of at most one constraints. The constraint matrix has consecutive ones, hence the LP relaxation is tight.
+std::string chain_ILP(const std::size_t nr_vars)
+{
+    std::mt19937 gen(3);
+    std::uniform_real_distribution<double> cost(-1.0,1.0);
+    std::stringstream s;
+    s << "Minimize\n";
+    for(std::size_t i=0; i<nr_vars; ++i) {
+        const double c = cost(gen);
+        s << (c >= 0 ? "+ " : "- ") << std::abs(c) << " x" << i << "\n";
+    }
+    s << "Subject To\n";
+    for(std::size_t i=0; i+2<nr_vars; ++i)
+        s << "x" << i << " + x" << i+1 << " + x" << i+2 << " <= 1\n";
+    s << "End\n";
+    return s.str();
+}
+
+// Does some assignment of the variables free in values satisfy all BDDs? values holds 0, 1 or -1 for free variables.
+bool satisfiable(const bdd_storage& s, std::vector<signed char> values, const std::size_t bdd_nr = 0)
+{
+    if(bdd_nr == s.nr_bdds())
+        return true;
+    std::function<bool(std::size_t)> walk = [&](const std::size_t node) -> bool {
+        if(node == bdd_storage::bdd_node::terminal_0)
+            return false;
+        if(node == bdd_storage::bdd_node::terminal_1)
+            return satisfiable(s, values, bdd_nr+1);
+        const auto& n = s.bdd_nodes()[node];
+        if(values[n.variable] != -1)
+            return walk(values[n.variable] == 1 ? n.high : n.low);
+        for(const signed char b : {0, 1}) {
+            values[n.variable] = b;
+            const bool sat = walk(b == 1 ? n.high : n.low);
+            values[n.variable] = -1;
+            if(sat)
+                return true;
+        }
+        return false;
+    };
+    // nodes are stored bottom up, the root comes last
+    return walk(s.bdd_delimiters()[bdd_nr+1]-1);
+}
+
+double optimum(const ILP_input& input)
+{
+    double opt = std::numeric_limits<double>::infinity();
+    std::vector<char> x(input.nr_variables());
+    for(std::size_t l=0; l<(std::size_t(1) << x.size()); ++l) {
+        for(std::size_t i=0; i<x.size(); ++i)
+            x[i] = (l >> i) & 1;
+        if(!input.check_feasibility(x.begin(), x.end()))
+            continue;
+        double cost = 0.0;
+        for(std::size_t i=0; i<x.size(); ++i)
+            cost += input.objective()[i] * x[i];
+        opt = std::min(opt, cost);
+    }
+    return opt;
+}
+
+template<typename SOLVER>
+double lower_bound(const std::string& ilp, std::vector<std::string> args, const std::size_t nr_iterations)
+{
+    const std::string filename = "test_bdd_split.lp";
+    {
+        std::ofstream f(filename);
+        f << ilp;
+    }
+    TCLAP::CmdLine cmd("test of split bdds");
+    SOLVER solver(cmd);
+    args.insert(args.begin(), {"test_bdd_split", "-i", filename});
+    cmd.parse(args);
+    solver.init();
+    std::remove(filename.c_str());
+    for(std::size_t iter=0; iter<nr_iterations; ++iter)
+        solver.iteration();
+    return solver.compute_lower_bound();
+}
+
+int main()
+{
+    // split BDDs have the same feasible set on the original variables as the unsplit ones
+    {
+        const ILP_input input = ILP_parser::parse_string(random_ILP(12, 10));
+        bdd_storage unsplit;
+        unsplit.init(input);
+        for(const std::size_t nr_intervals : {2, 3, 5}) {
+            bdd_storage split = unsplit;
+            const auto decomposition = split.split_bdds(nr_intervals);
+            test(decomposition.variable_index.size() == unsplit.nr_variables());
+            test(split.nr_variables() >= unsplit.nr_variables());
+
+            std::size_t nr_feasible = 0;
+            for(std::size_t l=0; l<(std::size_t(1) << input.nr_variables()); ++l) {
+                std::vector<signed char> x(unsplit.nr_variables());
+                std::vector<signed char> x_split(split.nr_variables(), -1);
+                for(std::size_t i=0; i<x.size(); ++i) {
+                    x[i] = (l >> i) & 1;
+                    x_split[decomposition.variable_index[i]] = x[i];
+                }
+                const bool feasible = satisfiable(unsplit, x);
+                test(feasible == satisfiable(split, x_split));
+                nr_feasible += feasible;
+            }
+            test(nr_feasible > 0);
+        }
+    }
+
+    // parallel min-marginal averaging on split BDDs reaches the lower bound of serial min-marginal averaging
+    {
+        const std::string ilp = chain_ILP(16);
+        const double opt = optimum(ILP_parser::parse_string(ilp));
+        const double serial_lb = lower_bound<bdd_min_marginal_averaging>(ilp, {}, 500);
+        test(serial_lb <= opt + 1e-8);
+        for(const std::string nr_intervals : {"2", "4"}) {
+            const double parallel_lb = lower_bound<bdd_min_marginal_averaging_parallel>(ilp, {"--nr_intervals", nr_intervals}, 2000);
+            test(parallel_lb <= opt + 1e-8);
+            test(std::abs(parallel_lb - serial_lb) <= 1e-6);
+        }
+    }
+
+    // the result does not depend on the number of threads
+    {
+        const std::string ilp = random_ILP(40, 60);
+        omp_set_num_threads(1);
+        const double lb_1 = lower_bound<bdd_min_marginal_averaging_parallel>(ilp, {"--nr_intervals", "4"}, 50);
+        for(const int nr_threads : {2, 4}) {
+            omp_set_num_threads(nr_threads);
+            const double lb_n = lower_bound<bdd_min_marginal_averaging_parallel>(ilp, {"--nr_intervals", "4"}, 50);
+            test(std::abs(lb_1 - lb_n) <= 1e-10);
+        }
+    }
+}
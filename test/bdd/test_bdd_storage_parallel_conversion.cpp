@@ -0,0 +1,55 @@
+#include "bdd/bdd_storage.h"
+#include "bdd/ILP_parser.h"
+#include "test.h"
+#include <omp.h>
+#include <random>
+#include <sstream>
+
+using namespace LPMP;
+
+// many feasible and non-trivial constraints, some of them identical up to scaling, such that caches of different threads are hit
+std::string random_ILP(const std::size_t nr_vars, const std::size_t nr_constraints)
+{
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<int> coeff(-3,3);
+    std::uniform_int_distribution<std::size_t> var(0, nr_vars-1);
+    std::stringstream s;
+    s << "Minimize\n";
+    for(std::size_t i=0; i<nr_vars; ++i)
+        s << (coeff(gen) >= 0 ? "+ " : "- ") << 1+std::abs(coeff(gen)) << " x" << i << "\n";
+    s << "Subject To\n";
+    for(std::size_t c=0; c<nr_constraints; ++c) {
+        const std::size_t first = var(gen);
+        const std::size_t nr_terms = 2 + c % 5;
+        const int scale = 1 + c % 2;
+        for(std::size_t i=0; i<nr_terms; ++i)
+            s << "+ " << scale*(c % 3 == 0 ? 1 : 1 + std::abs(coeff(gen))) << " x" << (first + i) % nr_vars << " ";
+        s << (c % 3 == 0 ? "= " : c % 3 == 1 ? "<= " : ">= ") << scale << "\n";
+    }
+    s << "End\n";
+    return s.str();
+}
+
+int main(int argc, char** argv)
+{
+    const ILP_input input = ILP_parser::parse_string(random_ILP(50, 500));
+
+    omp_set_num_threads(1);
+    bdd_storage sequential;
+    sequential.init(input);
+
+    for(const int nr_threads : {2, 3, 8}) {
+        omp_set_num_threads(nr_threads);
+        bdd_storage parallel;
+        parallel.init(input);
+
+        test(sequential.nr_variables() == parallel.nr_variables());
+        test(sequential.bdd_delimiters() == parallel.bdd_delimiters());
+        test(sequential.bdd_nodes().size() == parallel.bdd_nodes().size());
+        for(std::size_t i=0; i<sequential.bdd_nodes().size(); ++i) {
+            const auto& n1 = sequential.bdd_nodes()[i];
+            const auto& n2 = parallel.bdd_nodes()[i];
+            test(n1.low == n2.low && n1.high == n2.high && n1.variable == n2.variable);
+        }
+    }
+}
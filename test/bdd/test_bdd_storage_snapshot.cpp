@@ -0,0 +1,71 @@
+#include "bdd/bdd_storage.h"
+#include "bdd/ILP_parser.h"
+#include "test.h"
+#include <fstream>
+#include <cstdio>
+
+using namespace LPMP;
+
+const std::string ILP_example =
+R"(Minimize
+x1 + 2*x2 + 1.5 * x3 - 0.5*x4 - x5
+Subject To
+x1 + x2 + x3 = 1
+x3 + x4 + x5 <= 2
+x1 - x5 >= 0
+End)";
+
+int main(int argc, char** argv)
+{
+    const ILP_input input = ILP_parser::parse_string(ILP_example);
+    bdd_storage stor;
+    stor.init(input);
+
+    std::vector<std::string> names;
+    for(std::size_t i=0; i<input.nr_variables(); ++i)
+        names.push_back(input.get_var_name(i));
+
+    const ILP_parser::constraint_fingerprint constraints = ILP_parser::fingerprint_constraints_string(ILP_example);
+    const std::string filename = "test_bdd_storage_snapshot.bin";
+    stor.write_snapshot(filename, names, constraints);
+
+    bdd_storage loaded;
+    test(loaded.read_snapshot(filename, constraints) == names);
+    test(loaded.nr_variables() == stor.nr_variables());
+    test(loaded.bdd_delimiters() == stor.bdd_delimiters());
+    test(loaded.bdd_nodes().size() == stor.bdd_nodes().size());
+    for(std::size_t i=0; i<stor.bdd_nodes().size(); ++i) {
+        const auto& n1 = stor.bdd_nodes()[i];
+        const auto& n2 = loaded.bdd_nodes()[i];
+        test(n1.low == n2.low && n1.high == n2.high && n1.variable == n2.variable);
+    }
+
+    // snapshot of other constraints is rejected
+    std::string other_constraints = ILP_example;
+    other_constraints.replace(other_constraints.find("<= 2"), 4, "<= 1");
+    bool other_rejected = false;
+    try {
+        bdd_storage other;
+        other.read_snapshot(filename, ILP_parser::fingerprint_constraints_string(other_constraints));
+    } catch(const std::runtime_error&) {
+        other_rejected = true;
+    }
+    test(other_rejected);
+
+    // truncated snapshot is rejected
+    {
+        std::ifstream in(filename, std::ios::binary);
+        const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(filename, std::ios::binary);
+        out.write(content.data(), content.size()-1);
+    }
+    bool rejected = false;
+    try {
+        bdd_storage truncated;
+        truncated.read_snapshot(filename, constraints);
+    } catch(const std::runtime_error&) {
+        rejected = true;
+    }
+    test(rejected);
+    std::remove(filename.c_str());
+}
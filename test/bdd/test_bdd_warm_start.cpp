@@ -0,0 +1,87 @@
+#include "bdd/bdd_min_marginal_averaging.h"
+#include "bdd/ILP_parser.h"
+#include "test.h"
+#include <fstream>
+#include <cstdio>
+#include <vector>
+
+using namespace LPMP;
+
+const std::string ILP_example =
+R"(Minimize
+x1 + 2*x2 + 1.5 * x3 - 0.5*x4 - x5 + x6
+Subject To
+x1 + x2 + x3 = 1
+x3 + x4 + x5 <= 2
+x1 - x5 >= 0
+x2 + x4 + x6 = 1
+x5 + x6 <= 1
+End)";
+
+// brute force optimum
+double optimum(const ILP_input& input, const std::vector<double>& costs)
+{
+    double opt = std::numeric_limits<double>::infinity();
+    std::vector<char> x(input.nr_variables());
+    for(std::size_t l=0; l<(std::size_t(1) << x.size()); ++l) {
+        for(std::size_t i=0; i<x.size(); ++i)
+            x[i] = (l >> i) & 1;
+        if(!input.check_feasibility(x.begin(), x.end()))
+            continue;
+        double cost = 0.0;
+        for(std::size_t i=0; i<x.size(); ++i)
+            cost += costs[i] * x[i];
+        opt = std::min(opt, cost);
+    }
+    return opt;
+}
+
+int main(int argc, char** argv)
+{
+    const std::string filename = "test_bdd_warm_start.lp";
+    {
+        std::ofstream f(filename);
+        f << ILP_example;
+    }
+
+    TCLAP::CmdLine cmd("test of warm started reoptimization");
+    bdd_min_marginal_averaging solver(cmd);
+    std::vector<std::string> args = {"test_bdd_warm_start", "-i", filename};
+    cmd.parse(args);
+    solver.init();
+    std::remove(filename.c_str());
+
+    const ILP_input& input = solver.ilp_input();
+    for(std::size_t iter=0; iter<50; ++iter)
+        solver.iteration();
+    const double lb = solver.lower_bound();
+    test(lb <= optimum(input, input.objective()) + 1e-8);
+
+    // importing with unchanged costs keeps the lower bound
+    const std::vector<double> multipliers = solver.export_Lagrange_multipliers();
+    solver.import_Lagrange_multipliers(multipliers, input.objective().begin(), input.objective().end());
+    test(std::abs(solver.compute_lower_bound() - lb) <= 1e-8);
+
+    std::vector<double> costs = input.objective();
+    costs[0] += 0.25;
+    costs[3] -= 0.5;
+    costs[5] += 0.125;
+    const double opt = optimum(input, costs);
+
+    solver.update_costs(costs.begin(), costs.end());
+    for(std::size_t var=0; var<solver.nr_variables(); ++var) {
+        double sum = 0.0;
+        for(std::size_t bdd_index=0; bdd_index<solver.nr_bdds(var); ++bdd_index)
+            sum += solver.get_bdd_variable(var, bdd_index).cost;
+        test(std::abs(sum - costs[var]) <= 1e-8);
+    }
+    // lower bound changes at most by the cost difference
+    const double warm_lb = solver.compute_lower_bound();
+    test(warm_lb <= opt + 1e-8);
+    test(warm_lb >= lb - 0.5 - 1e-8);
+
+    for(std::size_t iter=0; iter<50; ++iter)
+        solver.iteration();
+    test(solver.lower_bound() <= opt + 1e-8);
+    test(solver.lower_bound() >= warm_lb - 1e-8);
+}
@@ -0,0 +1,108 @@
+#include "bdd/exp_log_approximation.h"
+#include "bdd/bdd_branch_node.h"
+#include "test_bdd_branch_node.hxx"
+#include "tclap/CmdLine.h"
+#include <vector>
+#include <array>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include "test.h"
+
+using namespace LPMP;
+
+// error bounds from exp_log_approximation.h with some slack for rounding
+double exp_error(const std::size_t degree)
+{
+    const double r = std::log(2.0)/2.0;
+    return 1.02 * std::exp(r) * std::pow(r, degree+1) / std::tgamma(degree+2) + 1e-15;
+}
+
+double log_error(const std::size_t degree)
+{
+    const double s = 0.1716;
+    return 1.02 * 2.0 * std::pow(s, 2*degree+3) / (2*degree+3) / (1.0 - s*s) + 1e-13;
+}
+
+template<typename BDD_BRANCH_NODE>
+void test_batched_steps(const std::size_t degree)
+{
+    // log-sum-exp values are exact up to the relative error of exp
+    const double tolerance = std::max(1e-12, 4.0*exp_error(degree));
+    std::array<double,4> costs = {0.5, -0.25, 3.0, -2.0};
+    std::vector<BDD_BRANCH_NODE> nodes;
+    construct_simplex(nodes, costs);
+    std::vector<BDD_BRANCH_NODE> batched_nodes;
+    construct_simplex(batched_nodes, costs);
+    smooth_step_batch batch;
+
+    for(std::ptrdiff_t i=nodes.size()-1; i>=0; --i)
+        nodes[i].smooth_backward_step();
+    for(std::ptrdiff_t v=3; v>=0; --v)
+        BDD_BRANCH_NODE::batch_smooth_backward_step(batched_nodes.begin() + simplex_first_node(v), batched_nodes.begin() + simplex_first_node(v+1), batch, degree);
+    for(std::size_t i=0; i<nodes.size(); ++i) {
+        const double exact = nodes[i].m * std::exp(nodes[i].current_max);
+        test(std::abs(exact - batched_nodes[i].m * std::exp(batched_nodes[i].current_max)) <= tolerance * std::max(1.0, exact));
+    }
+    const double smooth_lb = -std::log(std::exp(-costs[0]) + std::exp(-costs[1]) + std::exp(-costs[2]) + std::exp(-costs[3]));
+    test(std::abs(-(std::log(batched_nodes[0].m) + batched_nodes[0].current_max) - smooth_lb) <= tolerance);
+
+    // exp sums need forward values of the variable's nodes and backward values of their successors
+    for(std::size_t v=0; v<4; ++v) {
+        for(std::size_t i=simplex_first_node(v); i<simplex_first_node(v+1); ++i)
+            nodes[i].smooth_forward_step();
+        BDD_BRANCH_NODE::batch_smooth_forward_step(batched_nodes.begin() + simplex_first_node(v), batched_nodes.begin() + simplex_first_node(v+1), batch, degree);
+        const auto e = BDD_BRANCH_NODE::exp_sums(nodes.begin() + simplex_first_node(v), nodes.begin() + simplex_first_node(v+1));
+        const auto e_batched = BDD_BRANCH_NODE::batch_exp_sums(batched_nodes.begin() + simplex_first_node(v), batched_nodes.begin() + simplex_first_node(v+1), batch, degree);
+        for(std::size_t l=0; l<2; ++l)
+            test(std::abs(std::log(e.sum[l]) + e.max[l] - (std::log(e_batched.sum[l]) + e_batched.max[l])) <= tolerance);
+    }
+    for(std::size_t i=0; i<nodes.size(); ++i) {
+        const double exact = nodes[i].m * std::exp(nodes[i].current_max);
+        test(std::abs(exact - batched_nodes[i].m * std::exp(batched_nodes[i].current_max)) <= tolerance * std::max(1.0, exact));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    TCLAP::CmdLine cmd("test of vectorized exp and log approximations");
+    TCLAP::ValueArg<std::size_t> degree_arg("d","degree","only test the given polynomial degree and use it for the batched smoothed steps, 0 tests degrees 3, 5, 7 and 11",false,0,"degree",cmd);
+    cmd.parse(argc, argv);
+    if(degree_arg.getValue() > max_exp_log_approximation_degree)
+        throw std::runtime_error("degree must be at most " + std::to_string(max_exp_log_approximation_degree));
+    const std::vector<std::size_t> degrees = degree_arg.getValue() > 0 ? std::vector<std::size_t>{degree_arg.getValue()} : std::vector<std::size_t>{3, 5, 7, 11};
+
+    std::mt19937 gen;
+    std::uniform_real_distribution<> exp_dist(-700.0, 700.0);
+    std::uniform_real_distribution<> log_dist(-300.0, 300.0);
+
+    // sizes not divisible by the vector width exercise the padded remainder
+    std::vector<double> x(1001);
+    std::vector<double> y;
+    for(const std::size_t d : degrees) {
+        for(auto& v : x)
+            v = exp_dist(gen);
+        y = x;
+        exp_approximation(y.data(), y.data() + y.size(), d);
+        for(std::size_t i=0; i<x.size(); ++i)
+            test(std::abs(y[i] - std::exp(x[i])) <= exp_error(d) * std::exp(x[i]));
+
+        for(auto& v : x)
+            v = std::exp(log_dist(gen));
+        y = x;
+        log_approximation(y.data(), y.data() + y.size(), d);
+        for(std::size_t i=0; i<x.size(); ++i)
+            test(std::abs(y[i] - std::log(x[i])) <= log_error(d));
+    }
+
+    // exponents of terminal_0 arcs
+    std::array<double,3> special = {-std::numeric_limits<double>::infinity(), 0.0, 1.0};
+    exp_approximation(special.data(), special.data() + special.size(), 11);
+    test(special[0] >= 0.0 && special[0] <= 1e-300);
+    test(special[1] == 1.0);
+    test(std::abs(special[2] - std::exp(1.0)) <= 1e-14);
+
+    const std::size_t batch_degree = degree_arg.getValue() > 0 ? degree_arg.getValue() : 11;
+    test_batched_steps<bdd_branch_node_opt_smoothed>(batch_degree);
+    test_batched_steps<bdd_branch_node_opt_smoothed_compact>(batch_degree);
+}
@@ -62,5 +62,6 @@ void test_single_bdd_inference()
 int main(int argc, char** arv)
 {
     test_single_bdd_inference<bdd_min_marginal_averaging>();
+    test_single_bdd_inference<bdd_min_marginal_averaging_compact>();
     test_single_bdd_inference<bdd_anisotropic_diffusion>();
 }
@@ -3,6 +3,10 @@
 #include "dynamic_graph.hxx"
 #include "dynamic_graph_thread_safe.hxx"
 #include <atomic>
+#include <random>
+#include <set>
+#include <map>
+#include <omp.h>
 
 using namespace LPMP;
 
@@ -60,6 +64,106 @@ void test_maximal_clique_enumeration()
     test(std::count(clique_visited.begin(), clique_visited.end(), false) == 0);
 }
 
+// compare triangle enumerations against brute force on a random graph, edge information identifies the edge
+void test_triangle_enumeration()
+{
+    const std::size_t n = 60;
+    std::mt19937 gen(0);
+    std::bernoulli_distribution edge_present(0.3);
+    std::vector<std::array<std::size_t,2>> random_edges;
+    for(std::size_t i=0; i<n; ++i)
+        for(std::size_t j=i+1; j<n; ++j)
+            if(edge_present(gen))
+                random_edges.push_back({i,j});
+    std::shuffle(random_edges.begin(), random_edges.end(), gen);
+    graph<std::size_t> g(random_edges.begin(), random_edges.end(), [&](const auto& e) { return e[0]*n + e[1]; });
+
+    std::set<std::array<std::size_t,2>> edge_set(random_edges.begin(), random_edges.end());
+    std::vector<std::array<std::size_t,3>> expected;
+    for(std::size_t i=0; i<n; ++i)
+        for(std::size_t j=i+1; j<n; ++j)
+            for(std::size_t k=j+1; k<n; ++k)
+                if(edge_set.count({i,j}) && edge_set.count({i,k}) && edge_set.count({j,k}))
+                    expected.push_back({i,j,k});
+
+    auto check_edges = [&](const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t ij, const std::size_t ik, const std::size_t jk) {
+        test(i < j && j < k);
+        test(ij == i*n + j && ik == i*n + k && jk == j*n + k);
+    };
+
+    std::vector<std::array<std::size_t,3>> triangles;
+    g.for_each_triangle([&](const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t ij, const std::size_t ik, const std::size_t jk) {
+        check_edges(i,j,k,ij,ik,jk);
+        triangles.push_back({i,j,k});
+    });
+    test(triangles == expected); // lexicographic order
+
+    std::vector<std::vector<std::array<std::size_t,3>>> thread_triangles(omp_get_max_threads());
+    g.for_each_triangle_parallel([&](const std::size_t i, const std::size_t j, const std::size_t k, const std::size_t ij, const std::size_t ik, const std::size_t jk) {
+        check_edges(i,j,k,ij,ik,jk);
+        thread_triangles[omp_get_thread_num()].push_back({i,j,k});
+    });
+    triangles.clear();
+    for(const auto& t : thread_triangles)
+        triangles.insert(triangles.end(), t.begin(), t.end());
+    std::sort(triangles.begin(), triangles.end());
+    test(triangles == expected);
+}
+
+// multi-target search finds paths of the same length as individual searches
+void test_find_paths()
+{
+    const std::size_t n = 200;
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::size_t> node(0, n-1);
+    std::uniform_real_distribution<double> cost(0.0, 1.0);
+    std::set<std::array<std::size_t,2>> edge_set;
+    for(std::size_t e=0; e<400; ++e) {
+        const std::size_t i = node(gen);
+        const std::size_t j = node(gen);
+        if(i != j)
+            edge_set.insert({std::min(i,j), std::max(i,j)});
+    }
+    std::vector<std::array<std::size_t,2>> edges(edge_set.begin(), edge_set.end());
+    std::vector<double> costs;
+    for(std::size_t e=0; e<edges.size(); ++e)
+        costs.push_back(cost(gen));
+    graph<double> g(edges.begin(), edges.end(), [&](const auto& e) { return costs[std::lower_bound(edges.begin(), edges.end(), e) - edges.begin()]; });
+    bfs_data<graph<double>> mp(g);
+
+    const double th = 0.3;
+    auto mask = [th](const std::size_t i, const std::size_t j, const double c, const std::size_t distance) { return c >= th; };
+    for(std::size_t start=0; start<g.no_nodes(); start+=7) {
+        std::vector<std::size_t> targets;
+        for(std::size_t t=1; t<g.no_nodes(); t+=5)
+            if(t != start)
+                targets.push_back(t);
+
+        std::map<std::size_t, std::pair<std::size_t,double>> found; // path length and capacity
+        double capacity = std::numeric_limits<double>::infinity();
+        mp.find_paths(start, targets.begin(), targets.end(), mask,
+                [&](const std::size_t i, const std::size_t j, const double c) { capacity = std::min(capacity, c); },
+                [&](const std::vector<std::size_t>& path) {
+                    test(path.front() == start);
+                    for(std::size_t k=0; k+1<path.size(); ++k)
+                        test(edge_set.count({std::min(path[k], path[k+1]), std::max(path[k], path[k+1])}) == 1);
+                    test(found.count(path.back()) == 0);
+                    found[path.back()] = {path.size(), capacity};
+                    capacity = std::numeric_limits<double>::infinity();
+                });
+
+        for(const std::size_t t : targets) {
+            double single_capacity = std::numeric_limits<double>::infinity();
+            const auto path = mp.find_path(start, t, mask, [&](const std::size_t i, const std::size_t j, const double c) { single_capacity = std::min(single_capacity, c); });
+            test(path.empty() == (found.count(t) == 0));
+            if(!path.empty()) {
+                test(path.size() == found[t].first);
+                test(found[t].second >= th && single_capacity >= th);
+            }
+        }
+    }
+}
+
 int main(int argc, char** argv)
 {
 	std::sort(edges.begin(), edges.end(), [](const auto& e1, const auto& e2) { return std::lexicographical_compare(e1.begin(), e1.end(), e2.begin(), e2.end()); });
@@ -82,6 +186,9 @@ int main(int argc, char** argv)
 	test(triangles[0][0] == 0 && triangles[0][1] == 1 && triangles[0][2] == 2);
 	test(triangles[1][0] == 0 && triangles[1][1] == 2 && triangles[1][2] == 3);
 
+    test_triangle_enumeration();
+    test_find_paths();
+
 	std::vector<std::array<std::size_t,4>> quadrangles;
 	g.for_each_quadrangle([&](std::array<std::size_t,4> nodes) { 
 			std::sort(nodes.begin(), nodes.end());
@@ -0,0 +1,34 @@
+#include "test.h"
+#include "max_cut/max_cut_text_input.h"
+#include <string>
+#include <vector>
+
+using namespace LPMP;
+
+const std::vector<std::string> max_cut_examples = {
+    // identifier, #vertices #edges and offset nodes
+    "# comment\nMAX-CUT\n\n3 3\n1 2 1.0\n2 3 -2.5\nc comment\n1 3 .5\n",
+    // no identifier and no init line
+    "0 1 1.0\n1 2 2.0\n",
+    // init line on the line of the identifier, trailing lines not matching are ignored
+    "MAX-CUT 3 2\n0 1 1.0\r\n1 2 5\n2 0 x\n0 2 1.0\n"
+};
+
+int main(int argc, char** argv)
+{
+    for(const std::string& s : max_cut_examples) {
+        const max_cut_instance pegtl_input = max_cut_text_input::parse_string_pegtl(s);
+        const max_cut_instance input = max_cut_text_input::parse_string(s);
+        test(input.no_nodes() == pegtl_input.no_nodes());
+        test(input.no_edges() == pegtl_input.no_edges());
+        for(std::size_t e=0; e<input.no_edges(); ++e) {
+            test(input.edges()[e][0] == pegtl_input.edges()[e][0] && input.edges()[e][1] == pegtl_input.edges()[e][1]);
+            test(input.edges()[e].cost[0] == pegtl_input.edges()[e].cost[0]);
+        }
+    }
+
+    const max_cut_instance input = max_cut_text_input::parse_string(max_cut_examples[0]);
+    test(input.no_nodes() == 3 && input.no_edges() == 3);
+    test(input.edges()[0][0] == 0 && input.edges()[0][1] == 1 && input.edges()[0].cost[0] == -1.0);
+    test(input.edges()[1].cost[0] == 2.5);
+}
@@ -0,0 +1,47 @@
+#include "test_mrf.hxx"
+
+using namespace LPMP;
+
+// partition and overlapping partition passes must reach the same lower bound as the plain forward/backward pass, for each reparametrization mode.
+template<typename INSTANCE>
+void test_partition_reparametrization(const INSTANCE& instance)
+{
+    using SolverType = Solver<LP<FMC_SRMP>, StandardVisitor>;
+
+    const REAL optimum = instance.optimum();
+
+    auto lower_bound = [&](const std::string& reparametrization_type, const std::string& repam) {
+        std::vector<std::string> options = {
+            {"partition reparametrization test"},
+            {"--maxIter"}, {"1000"},
+            {"--lowerBoundComputationInterval"}, {"1"},
+            {"--primalComputationInterval"}, {"1000"},
+            {"--standardReparametrization"}, repam,
+            {"--roundingReparametrization"}, repam,
+            {"--reparametrizationType"}, reparametrization_type,
+            {"--partitionSize"}, {"1"}, // 1KB, several partitions
+            {"-v"}, {"0"}
+        };
+        SolverType s(options);
+        instance.construct(s.GetProblemConstructor());
+        s.Solve();
+        return s.GetLP().LowerBound();
+    };
+
+    for(const std::string repam : {"anisotropic", "uniform"}) {
+        const REAL plain_lb = lower_bound("shared", repam);
+        test(std::abs(plain_lb - optimum) <= 1e-4);
+        for(const std::string reparametrization_type : {"partition", "overlapping_partition"}) {
+            const REAL lb = lower_bound(reparametrization_type, repam);
+            test(lb <= optimum + eps);
+            test(std::abs(lb - plain_lb) <= 1e-4);
+        }
+    }
+}
+
+int main()
+{
+    test_partition_reparametrization(random_potts_chain(40, 4, 0.5));
+    // messages between the unary of node i/2 and the pairwise factor (i/2,i) cross two or more partitions, no overlapping window covers them
+    test_partition_reparametrization(random_potts_tree(100, 4, 0.5));
+}
@@ -0,0 +1,61 @@
+#include "test_mrf.hxx"
+#include "LP_FWMAP.hxx"
+
+using namespace LPMP;
+
+// grid with random unaries and one Potts cost table, either shared by all pairwise factors or copied into each of them
+template<typename SOLVER>
+void construct_grid(SOLVER& s, const std::size_t n, const bool shared_pairwise)
+{
+    auto& mrf = s.GetProblemConstructor();
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> cost(-1.0, 1.0);
+    const std::size_t nr_labels = 3;
+    for(std::size_t i=0; i<n*n; ++i) {
+        std::vector<REAL> u(nr_labels);
+        for(auto& x : u)
+            x = cost(gen);
+        mrf.add_unary_factor(u);
+    }
+
+    const auto potts = construct_potts(nr_labels, nr_labels, 0.0, 0.5);
+    auto table = std::make_shared<const matrix<REAL>>(potts);
+    auto add_pairwise = [&](const std::size_t i, const std::size_t j) {
+        if(shared_pairwise)
+            mrf.add_shared_pairwise_factor(i, j, table);
+        else
+            mrf.add_pairwise_factor(i, j, potts);
+    };
+    for(std::size_t x=0; x<n; ++x) {
+        for(std::size_t y=0; y<n; ++y) {
+            if(x+1 < n) add_pairwise(x*n+y, (x+1)*n+y);
+            if(y+1 < n) add_pairwise(x*n+y, x*n+y+1);
+        }
+    }
+}
+
+// sharing the pairwise cost table must not change the lower bound of tree decomposition solvers, neither of the decomposition nor after writing back the reparametrization
+template<typename SOLVER_TYPE>
+void test_shared_pairwise()
+{
+    std::array<double,2> decomposition_lb, lb;
+    for(const bool shared_pairwise : {false, true}) {
+        SOLVER_TYPE s(solver_options);
+        construct_grid(s, 5, shared_pairwise);
+        auto trees = s.GetProblemConstructor().compute_forest_cover();
+        for(auto& tree : trees) { s.GetLP().add_tree(tree); }
+        s.Solve();
+        decomposition_lb[shared_pairwise] = s.GetLP().decomposition_lower_bound();
+        s.GetLP().write_back_reparametrization();
+        lb[shared_pairwise] = s.GetLP().LowerBound();
+    }
+    test(std::abs(decomposition_lb[0] - decomposition_lb[1]) <= eps);
+    test(std::abs(lb[0] - lb[1]) <= eps);
+    test(lb[1] <= decomposition_lb[1] + eps);
+}
+
+int main()
+{
+    test_shared_pairwise<Solver<LP_subgradient_ascent<FMC_SRMP>, StandardVisitor>>();
+    test_shared_pairwise<Solver<LP_tree_FWMAP<FMC_SRMP>, StandardVisitor>>();
+}
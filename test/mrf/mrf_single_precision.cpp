@@ -0,0 +1,29 @@
+#include "test_mrf.hxx"
+
+using namespace LPMP;
+
+// Built twice, against LPMP and against LPMP_single_precision. Both builds must reach the optimum of the same chain, which is computed in double independently of REAL.
+int main()
+{
+    using SolverType = Solver<LP<FMC_SRMP>, StandardVisitor>;
+
+#ifdef LPMP_SINGLE_PRECISION
+    static_assert(std::is_same_v<REAL, float>);
+    const double tolerance = 1e-3;
+#else
+    static_assert(std::is_same_v<REAL, double>);
+    const double tolerance = 1e-6;
+#endif
+
+    for(const unsigned int seed : {0, 1, 2}) {
+        const random_potts_chain chain(200, 5, 0.5, seed);
+        const double optimum = chain.optimum();
+
+        SolverType s(solver_options);
+        chain.construct(s.GetProblemConstructor());
+        s.Solve();
+        const double lb = s.GetLP().LowerBound();
+        test(lb <= optimum + tolerance*std::abs(optimum));
+        test(std::abs(lb - optimum) <= tolerance*std::abs(optimum));
+    }
+}
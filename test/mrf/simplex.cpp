@@ -1,8 +1,11 @@
 #include "test.h"
 #include "../test_message.hxx"
 #include "mrf/simplex_factor.hxx"
+#include "mrf/mrf_input.h"
 #include <vector>
 #include <random>
+#include <algorithm>
+#include <memory>
 
 using namespace LPMP;
 
@@ -51,6 +54,43 @@ int main() {
     test(simplex.EvaluatePrimal() ==simplex.LowerBound());
   }
 
+  { // simd min-marginals, lower bound and sensitivity against explicit enumeration
+     std::mt19937 gen(0);
+     std::uniform_real_distribution<REAL> dist(-1.0, 1.0);
+     for(std::size_t i=1; i<12; ++i) {
+        for(std::size_t j=1; j<12; ++j) {
+           PairwiseSimplexFactor p(i,j);
+           for(std::size_t x1=0; x1<i; ++x1) { p.msg1(x1) = dist(gen); }
+           for(std::size_t x2=0; x2<j; ++x2) { p.msg2(x2) = dist(gen); }
+           for(std::size_t x1=0; x1<i; ++x1) { for(std::size_t x2=0; x2<j; ++x2) { p.pairwise(x1,x2) = dist(gen); } }
+
+           std::vector<double> vals;
+           for(std::size_t x1=0; x1<i; ++x1) { for(std::size_t x2=0; x2<j; ++x2) { vals.push_back(p(x1,x2)); } }
+           std::sort(vals.begin(), vals.end());
+           test(std::abs(p.LowerBound() - vals[0]) <= eps);
+           if(vals.size() > 1) { test(std::abs(p.sensitivity() - (vals[1] - vals[0])) <= eps); }
+
+           vector<REAL> m1(i), m2(j);
+           p.min_marginal_1(m1);
+           p.min_marginal_2(m2);
+           for(std::size_t x1=0; x1<i; ++x1) {
+              REAL min = std::numeric_limits<REAL>::infinity();
+              for(std::size_t x2=0; x2<j; ++x2) { min = std::min(min, p(x1,x2)); }
+              test(std::abs(m1[x1] - min) <= eps);
+           }
+           for(std::size_t x2=0; x2<j; ++x2) {
+              REAL min = std::numeric_limits<REAL>::infinity();
+              for(std::size_t x1=0; x1<i; ++x1) { min = std::min(min, p(x1,x2)); }
+              test(std::abs(m2[x2] - min) <= eps);
+           }
+
+           p.init_primal();
+           p.MaximizePotentialAndComputePrimal();
+           test(std::abs(p.EvaluatePrimal() - vals[0]) <= eps);
+        }
+     }
+  }
+
   {
      for(std::size_t i=1; i<100; ++i) {
         for(std::size_t j=1; j<100; ++j) {
@@ -60,6 +100,55 @@ int main() {
      }
   }
 
+  { // pairwise factors sharing one cost table
+     auto table = std::make_shared<matrix<REAL>>(3,4);
+     for(std::size_t x1=0; x1<3; ++x1) {
+        for(std::size_t x2=0; x2<4; ++x2) {
+           (*table)(x1,x2) = REAL(x1+2*x2);
+        }
+     }
+     PairwiseSimplexFactor p1{PairwiseSimplexFactor::cost_table(table)};
+     PairwiseSimplexFactor p2{PairwiseSimplexFactor::cost_table(table)};
+     test(p1.shares_pairwise() && p2.shares_pairwise());
+     test(table.use_count() == 3);
+
+     p1.msg1(1) = -5.0;
+     test(p1.LowerBound() == -4.0);
+     test(p2.LowerBound() == 0.0);
+     test(p1.lower_bound_except(std::array<std::size_t,1>{1*4+0}) == -2.0);
+
+     PairwiseSimplexFactor p3(p2);
+     test(p3.shares_pairwise() && table.use_count() == 4);
+
+     // writing to the cost table makes a private copy
+     p2.cost(0,0) = 10.0;
+     test(!p2.shares_pairwise() && table.use_count() == 3);
+     test(p2(0,0) == 10.0 && p3(0,0) == 0.0 && (*table)(0,0) == 0.0);
+     test(p2.LowerBound() == 1.0);
+
+     test_factor(p3, rd);
+  }
+
+  { // identical pairwise potentials get the same table id
+     mrf_input input;
+     input.unaries = two_dim_variable_array<double>(std::vector<std::size_t>{2,2,3});
+     input.pairwise_indices = {{0,1}, {1,2}, {0,2}, {0,1}};
+     std::vector<std::array<std::size_t,2>> dims = {{2,2}, {2,3}, {2,3}, {2,2}};
+     input.pairwise_values = three_dimensional_variable_array<double>(dims.begin(), dims.end());
+     for(std::size_t i=0; i<4; ++i) {
+        auto pot = input.pairwise_values[i];
+        for(std::size_t x1=0; x1<pot.dim1(); ++x1) {
+           for(std::size_t x2=0; x2<pot.dim2(); ++x2) {
+              pot(x1,x2) = x1 == x2 ? 0.0 : 1.0;
+           }
+        }
+     }
+     input.pairwise_values[3](0,1) = 2.0;
+     input.compute_pairwise_table_ids();
+     test(input.pairwise_table_ids == std::vector<std::size_t>({0,1,1,2}));
+     test(input.no_pairwise_tables() == 3);
+  }
+
   {
      for(std::size_t i=1; i<20; ++i) {
         for(std::size_t j=1; j<20; ++j) {
@@ -1,6 +1,10 @@
 #include "mrf/graphical_model.h"
 #include "visitors/standard_visitor.hxx"
 #include "test.h"
+#include <random>
+#include <memory>
+#include <limits>
+#include <algorithm>
 
 namespace LPMP {
 
@@ -107,4 +111,89 @@ matrix<REAL> construct_potts(const std::size_t n1, const std::size_t n2, const R
     return p;
 }
 
+// chain with random unaries and a common Potts potential. The local polytope relaxation is tight on chains, hence every message passing schedule must converge to optimum().
+// Costs are drawn and the optimum is computed in double, so that builds with different REAL see the same instance.
+struct random_potts_chain {
+    random_potts_chain(const std::size_t nr_nodes, const std::size_t nr_labels, const REAL potts_weight, const unsigned int seed = 0)
+        : pairwise(construct_potts(nr_labels, nr_labels, 0.0, potts_weight))
+    {
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<double> cost(-1.0, 1.0);
+        unaries.resize(nr_nodes, std::vector<double>(nr_labels));
+        for(auto& u : unaries)
+            for(auto& x : u)
+                x = cost(gen);
+    }
+
+    template<typename MRF_CONSTRUCTOR>
+    void construct(MRF_CONSTRUCTOR& mrf) const
+    {
+        for(const auto& u : unaries)
+            mrf.add_unary_factor(u);
+        for(std::size_t i=0; i+1<unaries.size(); ++i)
+            mrf.add_pairwise_factor(i, i+1, pairwise);
+    }
+
+    // all pairwise factors reference the same cost table
+    template<typename MRF_CONSTRUCTOR>
+    void construct_shared(MRF_CONSTRUCTOR& mrf) const
+    {
+        for(const auto& u : unaries)
+            mrf.add_unary_factor(u);
+        auto table = std::make_shared<const matrix<REAL>>(pairwise);
+        for(std::size_t i=0; i+1<unaries.size(); ++i)
+            mrf.add_shared_pairwise_factor(i, i+1, table);
+    }
+
+    // Viterbi
+    double optimum() const
+    {
+        std::vector<double> cur = unaries[0];
+        for(std::size_t i=1; i<unaries.size(); ++i) {
+            std::vector<double> next(unaries[i].size());
+            for(std::size_t x=0; x<next.size(); ++x) {
+                double best = std::numeric_limits<double>::infinity();
+                for(std::size_t y=0; y<cur.size(); ++y)
+                    best = std::min(best, cur[y] + pairwise(y,x));
+                next[x] = best + unaries[i][x];
+            }
+            std::swap(cur, next);
+        }
+        return *std::min_element(cur.begin(), cur.end());
+    }
+
+    std::vector<std::vector<double>> unaries;
+    matrix<REAL> pairwise;
+};
+
+// binary tree with node i attached to node i/2. Edges near the leaves join nodes far apart in the factor ordering.
+struct random_potts_tree : public random_potts_chain {
+    using random_potts_chain::random_potts_chain;
+
+    template<typename MRF_CONSTRUCTOR>
+    void construct(MRF_CONSTRUCTOR& mrf) const
+    {
+        for(const auto& u : unaries)
+            mrf.add_unary_factor(u);
+        for(std::size_t i=1; i<unaries.size(); ++i)
+            mrf.add_pairwise_factor(i/2, i, pairwise);
+    }
+
+    // dynamic programming from the leaves, children have larger indices than their parent
+    double optimum() const
+    {
+        std::vector<std::vector<double>> cost = unaries;
+        for(std::size_t i=unaries.size()-1; i>0; --i) {
+            auto& parent = cost[i/2];
+            for(std::size_t x=0; x<parent.size(); ++x) {
+                double best = std::numeric_limits<double>::infinity();
+                for(std::size_t y=0; y<cost[i].size(); ++y)
+                    best = std::min(best, cost[i][y] + pairwise(x,y));
+                parent[x] += best;
+            }
+        }
+        return *std::min_element(cost[0].begin(), cost[0].end());
+    }
+};
+
 }
@@ -0,0 +1,79 @@
+#include "test.h"
+#include "../test_message.hxx"
+#include "mrf/simplex_factor.hxx"
+#include <random>
+
+using namespace LPMP;
+
+void set_truncated(PairwiseSimplexFactor& p, const pairwise_truncated_factor::parameters& params)
+{
+   for(std::size_t x1=0; x1<p.dim1(); ++x1) {
+      for(std::size_t x2=0; x2<p.dim2(); ++x2) {
+         p.cost(x1,x2) = pairwise_truncated_factor::cost(params, x1, x2);
+      }
+   }
+}
+
+void test_factor_equal(const pairwise_truncated_factor& p1, const PairwiseSimplexFactor& p2)
+{
+   test(std::abs(p1.LowerBound() - p2.LowerBound()) <= eps);
+
+   const auto msg1 = p1.min_marginal_1();
+   const auto msg1_dense = p2.min_marginal_1();
+   for(std::size_t i=0; i<msg1.size(); ++i) { test(std::abs(msg1[i] - msg1_dense[i]) <= eps); }
+
+   const auto msg2 = p1.min_marginal_2();
+   const auto msg2_dense = p2.min_marginal_2();
+   for(std::size_t i=0; i<msg2.size(); ++i) { test(std::abs(msg2[i] - msg2_dense[i]) <= eps); }
+}
+
+int main()
+{
+   std::mt19937 gen(0);
+   std::uniform_real_distribution<double> dist(-2.0, 2.0);
+
+   for(const auto type : {pairwise_truncated_factor::distance::linear, pairwise_truncated_factor::distance::quadratic}) {
+      for(std::size_t dim1=2; dim1<20; dim1+=3) {
+         for(std::size_t dim2=2; dim2<20; dim2+=4) {
+            const pairwise_truncated_factor::parameters params = {type, 0.3, 1.5};
+            pairwise_truncated_factor p(dim1, dim2, params);
+            PairwiseSimplexFactor p_dense(dim1, dim2);
+            set_truncated(p_dense, params);
+
+            // structure is recognized from the dense table
+            const auto detected = pairwise_truncated_factor::detect(p_dense);
+            test(detected.has_value());
+            test(detected->type == type || std::max(dim1,dim2) <= 2);
+            for(std::size_t x1=0; x1<dim1; ++x1) {
+               for(std::size_t x2=0; x2<dim2; ++x2) {
+                  test(std::abs(pairwise_truncated_factor::cost(*detected, x1, x2) - p_dense(x1,x2)) <= eps);
+               }
+            }
+
+            test_factor_equal(p, p_dense);
+
+            for(std::size_t x1=0; x1<dim1; ++x1) { p.msg1(x1) = dist(gen); p_dense.msg1(x1) = p.msg1(x1); }
+            for(std::size_t x2=0; x2<dim2; ++x2) { p.msg2(x2) = dist(gen); p_dense.msg2(x2) = p.msg2(x2); }
+            test_factor_equal(p, p_dense);
+
+            p.init_primal();
+            p.MaximizePotentialAndComputePrimal();
+            test(std::abs(p.EvaluatePrimal() - p_dense.LowerBound()) <= eps);
+         }
+      }
+   }
+
+   { // non-truncated tables are not recognized
+      PairwiseSimplexFactor p(4,4);
+      for(std::size_t x1=0; x1<4; ++x1) { for(std::size_t x2=0; x2<4; ++x2) { p.cost(x1,x2) = dist(gen); } }
+      test(!pairwise_truncated_factor::detect(p).has_value());
+   }
+
+   {
+      std::random_device rd;
+      for(std::size_t i=2; i<50; ++i) {
+         pairwise_truncated_factor p(i, i, {pairwise_truncated_factor::distance::quadratic, 1.0, 10.0});
+         test_factor(p, rd);
+      }
+   }
+}
@@ -0,0 +1,74 @@
+#include "multicut/multicut_kernighan_lin.h"
+#include "multicut/multicut_greedy_additive_edge_contraction.h"
+#include "test.h"
+#include <random>
+#include <set>
+#include <omp.h>
+
+using namespace LPMP;
+
+// clusters of consecutive nodes, attractive edges inside and repulsive edges between clusters, some edges with flipped sign
+multicut_instance planted_multicut(const std::size_t nr_nodes, const std::size_t cluster_size, const std::size_t nr_edges, std::vector<std::size_t>& clusters)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::size_t> node(0, nr_nodes-1);
+    std::uniform_int_distribution<std::size_t> offset(1, 2*cluster_size);
+    std::uniform_real_distribution<double> cost(0.5, 1.5);
+    std::bernoulli_distribution noise(0.1);
+
+    clusters.clear();
+    for(std::size_t i=0; i<nr_nodes; ++i)
+        clusters.push_back(i / cluster_size);
+
+    multicut_instance instance;
+    std::set<std::array<std::size_t,2>> edges;
+    while(edges.size() < nr_edges) {
+        const std::size_t i = node(gen);
+        const std::size_t j = (i + offset(gen)) % nr_nodes;
+        if(!edges.insert({std::min(i,j), std::max(i,j)}).second)
+            continue;
+        const double sign = (clusters[i] == clusters[j]) != noise(gen) ? 1.0 : -1.0;
+        instance.add_edge(std::min(i,j), std::max(i,j), sign*cost(gen));
+    }
+    return instance;
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::size_t> clusters;
+    const multicut_instance instance = planted_multicut(2000, 20, 20000, clusters);
+    multicut_edge_labeling planted;
+    for(const auto& e : instance.edges())
+        planted.push_back(clusters[e[0]] != clusters[e[1]]);
+    const double planted_cost = instance.evaluate(planted);
+
+    // starting from every node being its own cluster
+    const multicut_edge_labeling kl = compute_multicut_kernighan_lin(instance);
+    test(instance.feasible(kl));
+    test(instance.evaluate(kl) <= 0.95*planted_cost);
+
+    const multicut_edge_labeling kl_andres = compute_multicut_kernighan_lin_andres(instance);
+    test(instance.feasible(kl_andres));
+    test(instance.evaluate(kl) <= instance.evaluate(kl_andres) + 0.01*std::abs(instance.evaluate(kl_andres)));
+
+    // improving a given solution
+    const multicut_edge_labeling gaec = compute_gaec(instance);
+    const multicut_edge_labeling gaec_kl = compute_multicut_kernighan_lin(instance, gaec);
+    test(instance.feasible(gaec_kl));
+    test(instance.evaluate(gaec_kl) <= instance.evaluate(gaec) + 1e-8);
+    test(instance.evaluate(gaec_kl) <= instance.evaluate(compute_multicut_kernighan_lin_andres(instance, gaec)) + 0.01*std::abs(instance.evaluate(gaec_kl)));
+
+    // gaec+kl starts from the native gaec
+    const multicut_edge_labeling native_gaec = greedy_additive_edge_contraction(instance);
+    const multicut_edge_labeling native_gaec_kl = compute_multicut_gaec_kernighan_lin(instance);
+    test(instance.feasible(native_gaec_kl));
+    test(native_gaec_kl == compute_multicut_kernighan_lin(instance, native_gaec));
+    test(instance.evaluate(native_gaec_kl) <= instance.evaluate(native_gaec) + 1e-8);
+
+    // result does not depend on the number of threads
+    for(const int nr_threads : {1, 2, 4}) {
+        omp_set_num_threads(nr_threads);
+        test(compute_multicut_kernighan_lin(instance) == kl);
+        test(compute_multicut_kernighan_lin(instance, gaec) == gaec_kl);
+    }
+}
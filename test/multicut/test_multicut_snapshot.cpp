@@ -0,0 +1,120 @@
+#include "multicut/multicut_instance.h"
+#include "multicut/multicut_greedy_additive_edge_contraction.h"
+#include "graph.hxx"
+#include "dynamic_graph.hxx"
+#include "test.h"
+#include <random>
+#include <fstream>
+#include <cstdio>
+
+using namespace LPMP;
+
+multicut_instance random_multicut(const std::size_t nr_nodes, const std::size_t nr_edges)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::size_t> node(0, nr_nodes-1);
+    std::uniform_real_distribution<double> cost(-10.0, 10.0);
+    multicut_instance instance;
+    for(std::size_t e=0; e<nr_edges; ++e) {
+        const std::size_t i = node(gen);
+        const std::size_t j = node(gen);
+        if(i != j)
+            instance.add_edge(i, j, cost(gen));
+    }
+    instance.add_to_constant(1.5);
+    instance.normalize();
+    return instance;
+}
+
+int main(int argc, char** argv)
+{
+    const multicut_instance instance = random_multicut(100, 1000);
+    const std::string filename = "test_multicut_snapshot.bin";
+
+    for(const bool single_precision : {false, true}) {
+        cut_base_snapshot::write(instance, filename, single_precision);
+        test(cut_base_snapshot::is_snapshot(filename));
+        const multicut_snapshot snapshot(filename);
+        test(snapshot.single_precision() == single_precision);
+        test(snapshot.no_nodes() == instance.no_nodes());
+        test(snapshot.no_edges() == instance.no_edges());
+        test(snapshot.constant() == instance.constant());
+        const double tolerance = single_precision ? 1e-5 : 0.0;
+        for(std::size_t e=0; e<instance.no_edges(); ++e) {
+            test(snapshot.edges()[e][0] == instance.edges()[e][0] && snapshot.edges()[e][1] == instance.edges()[e][1]);
+            test(std::abs(snapshot.edges()[e].cost[0] - instance.edges()[e].cost[0]) <= tolerance);
+        }
+
+        // adjacency
+        std::size_t nr_incidences = 0;
+        for(std::size_t i=0; i<snapshot.no_nodes(); ++i) {
+            test(std::is_sorted(snapshot.neighbors(i).begin(), snapshot.neighbors(i).end()));
+            for(std::size_t k=0; k<snapshot.no_edges(i); ++k) {
+                const auto ij = snapshot.endpoints(snapshot.incident_edges(i)[k]);
+                test((ij[0] == i && ij[1] == snapshot.neighbors(i)[k]) || (ij[1] == i && ij[0] == snapshot.neighbors(i)[k]));
+            }
+            nr_incidences += snapshot.no_edges(i);
+        }
+        test(nr_incidences == 2*instance.no_edges());
+
+        // graphs built from the adjacency agree with graphs built from the edge list
+        {
+            graph<double> g(instance.edges().begin(), instance.edges().end(), [](const auto& e) -> double { return e.cost; });
+            graph<double> g_snapshot;
+            g_snapshot.construct_from_adjacency(snapshot, [](const std::size_t e) { return true; }, [&](const std::size_t e) { return snapshot.cost(e); });
+            test(g_snapshot.no_nodes() == g.no_nodes() && g_snapshot.no_edges() == g.no_edges());
+            for(std::size_t i=0; i<g.no_nodes(); ++i) {
+                test(g_snapshot.no_edges(i) == g.no_edges(i));
+                for(auto it=g.begin(i), it_snapshot=g_snapshot.begin(i); it!=g.end(i); ++it, ++it_snapshot) {
+                    test(it->head() == it_snapshot->head());
+                    test(std::abs(it->edge() - it_snapshot->edge()) <= tolerance);
+                    test(it_snapshot->sister().head() == i);
+                }
+            }
+
+            graph<double> pos_g;
+            pos_g.construct_from_adjacency(snapshot, [&](const std::size_t e) { return snapshot.cost(e) > 0.0; }, [&](const std::size_t e) { return snapshot.cost(e); });
+            pos_g.for_each_edge([&](const std::size_t i, const std::size_t j, const double cost) { test(cost > 0.0 && g.edge_present(i,j)); });
+
+            dynamic_graph<double> dg(instance.edges().begin(), instance.edges().end(), [](const auto& e) -> double { return e.cost; });
+            dynamic_graph<double> dg_snapshot(0);
+            dg_snapshot.construct_from_adjacency(snapshot, [&](const std::size_t e) { return snapshot.cost(e); });
+            test(dg_snapshot.no_nodes() == dg.no_nodes());
+            for(std::size_t i=0; i<dg.no_nodes(); ++i) {
+                test(dg_snapshot.no_edges(i) == dg.no_edges(i));
+                for(std::size_t e=dg.first_outgoing_edge_index(i); e!=dynamic_graph<double>::no_next_edge; e=dg.next_outgoing_edge_index(e)) {
+                    const std::size_t j = dg.head(e);
+                    test(dg_snapshot.edge_present(i,j));
+                    test(std::abs(dg.edge(i,j) - dg_snapshot.edge(i,j)) <= tolerance);
+                }
+            }
+        }
+
+        const multicut_instance copy = snapshot.instance<multicut_instance>();
+        test(copy.no_nodes() == instance.no_nodes() && copy.no_edges() == instance.no_edges());
+        test(std::abs(copy.lower_bound() - snapshot.lower_bound()) <= 1e-8);
+
+        if(!single_precision) {
+            const multicut_edge_labeling sol = greedy_additive_edge_contraction(instance);
+            const multicut_edge_labeling snapshot_sol = greedy_additive_edge_contraction(snapshot);
+            test(sol == snapshot_sol);
+            test(instance.evaluate(sol) == snapshot.evaluate(snapshot_sol));
+        }
+    }
+
+    // truncated snapshot is rejected
+    {
+        std::ifstream in(filename, std::ios::binary);
+        const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(filename, std::ios::binary);
+        out.write(content.data(), content.size()-1);
+    }
+    bool rejected = false;
+    try {
+        const cut_base_snapshot truncated(filename);
+    } catch(const std::runtime_error&) {
+        rejected = true;
+    }
+    test(rejected);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,120 @@
+#include "multicut/multicut_text_input.h"
+#include "cut_base/cut_base_edge_list_reader.hxx"
+#include "test.h"
+#include <random>
+#include <sstream>
+#include <map>
+#include <limits>
+
+using namespace LPMP;
+
+const std::string multicut_example =
+"MULTICUT\n"
+"c comment\n"
+"0 1 1.5\n"
+"\t1   2 -2.0  \n"
+"\n"
+"# another comment\n"
+"2 0 1e-1\r\n"
+"3 1 -.25\n"
+"  1 3 +7.\n"
+"4 3 1.0e+2";
+
+// edge section stops at the first line not matching, rest is ignored
+const std::string multicut_trailing =
+"MULTICUT\n"
+"0 1 1.0\n"
+"1 2 x\n"
+"2 3 1.0\n";
+
+std::string random_multicut(const std::size_t nr_nodes, const std::size_t nr_edges)
+{
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<std::size_t> node(0, nr_nodes-1);
+    std::uniform_real_distribution<double> cost(-10.0, 10.0);
+    std::stringstream s;
+    s << "MULTICUT\n";
+    for(std::size_t e=0; e<nr_edges; ++e) {
+        const std::size_t i = node(gen);
+        std::size_t j = node(gen);
+        if(i == j)
+            j = (i+1) % nr_nodes;
+        if(e % 97 == 0)
+            s << "# comment " << e << "\n";
+        if(e % 13 == 0)
+            s << "  " << i << "\t" << j << "  " << cost(gen) << " \r\n";
+        else
+            s << i << " " << j << " " << cost(gen) << "\n";
+    }
+    return s.str();
+}
+
+void test_equal(const cut_base_instance& a, const cut_base_instance& b)
+{
+    test(a.no_nodes() == b.no_nodes());
+    test(a.no_edges() == b.no_edges());
+    for(std::size_t e=0; e<a.no_edges(); ++e) {
+        test(a.edges()[e][0] == b.edges()[e][0] && a.edges()[e][1] == b.edges()[e][1]);
+        test(a.edges()[e].cost[0] == b.edges()[e].cost[0]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for(const std::string& s : {multicut_example, multicut_trailing, random_multicut(100, 10000)})
+        test_equal(multicut_text_input::parse_string_pegtl(s), multicut_text_input::parse_string(s));
+
+    {
+        const multicut_instance input = multicut_text_input::parse_string(multicut_example);
+        test(input.no_nodes() == 5);
+        test(input.no_edges() == 6);
+        test(input.edges()[2][0] == 0 && input.edges()[2][1] == 2 && input.edges()[2].cost[0] == 0.1);
+        test(input.edges()[4].cost[0] == 7.0);
+    }
+
+    test(multicut_text_input::parse_string(multicut_trailing).no_edges() == 1);
+
+    // header as last line without line break
+    test(multicut_text_input::parse_string("MULTICUT").no_edges() == 0);
+
+    // inf costs give infinity, the former istringstream conversion turned them into 0
+    {
+        const multicut_instance input = multicut_text_input::parse_string("MULTICUT\n0 1 inf\n1 2 Inf\n2 3 -1\n");
+        test(input.no_edges() == 3);
+        test(input.edges()[0].cost[0] == std::numeric_limits<double>::infinity());
+        test(input.edges()[1].cost[0] == std::numeric_limits<double>::infinity());
+        test(input.edges()[2].cost[0] == -1.0);
+    }
+
+    bool malformed_rejected = false;
+    try {
+        multicut_text_input::parse_string("0 1 1.0\n");
+    } catch(const std::runtime_error&) {
+        malformed_rejected = true;
+    }
+    test(malformed_rejected);
+
+    // result does not depend on the number of chunks
+    const std::string s = random_multicut(1000, 50000);
+    const char* edges_begin = s.data() + std::string("MULTICUT\n").size();
+    cut_base_instance reference;
+    test(cut_base_edge_list_reader::read_edges(edges_begin, s.data() + s.size(), reference, 1.0, 1) == s.data() + s.size());
+    for(const std::size_t nr_chunks : {2, 7, 64, 1000}) {
+        cut_base_instance input;
+        cut_base_edge_list_reader::read_edges(edges_begin, s.data() + s.size(), input, 1.0, nr_chunks);
+        test_equal(reference, input);
+    }
+
+    // parallel normalize merges parallel edges
+    std::map<std::array<std::size_t,2>, double> merged;
+    for(const auto& e : reference.edges())
+        merged[{e[0], e[1]}] += e.cost[0];
+    reference.normalize();
+    test(reference.no_edges() == merged.size());
+    std::size_t k = 0;
+    for(const auto& [nodes, cost] : merged) {
+        test(reference.edges()[k][0] == nodes[0] && reference.edges()[k][1] == nodes[1]);
+        test(std::abs(reference.edges()[k].cost[0] - cost) <= 1e-8);
+        ++k;
+    }
+}
@@ -0,0 +1,45 @@
+#include "multicut/multicut.h"
+#include "solver.hxx"
+#include "test.h"
+#include "visitors/standard_visitor.hxx"
+
+using namespace LPMP;
+
+int main(int argc, char** argv)
+{
+    // path separation adds triplets for violated cycles and packs them, raising the lower bound to the optimum
+    Solver<LP<FMC_MULTICUT>,StandardVisitor> s;
+    auto& mc = s.GetProblemConstructor();
+
+    multicut_instance instance;
+    // cycle of length 5 with one repulsive edge, optimum 0
+    instance.add_edge(0, 1, 2.0);
+    instance.add_edge(1, 2, 2.0);
+    instance.add_edge(2, 3, 2.0);
+    instance.add_edge(3, 4, 2.0);
+    instance.add_edge(0, 4, -1.0);
+    // two repulsive edges whose shortest paths share the attractive edges 5-6 and 6-7, optimum -1 by cutting 5-6
+    instance.add_edge(5, 6, 1.0);
+    instance.add_edge(6, 7, 1.0);
+    instance.add_edge(7, 8, 1.0);
+    instance.add_edge(5, 7, -1.0);
+    instance.add_edge(5, 8, -1.0);
+    mc.construct(instance);
+
+    test(mc.number_of_triplets() == 0);
+    test(std::abs(s.GetLP().LowerBound() - (-3.0)) <= 1e-8);
+
+    const std::size_t nr_triplets = mc.find_violated_cycles(std::numeric_limits<std::size_t>::max());
+    test(nr_triplets > 0);
+    test(mc.number_of_triplets() == nr_triplets);
+    test(mc.has_triplet_factor(5,6,7));
+
+    // capacity of the shared edges is only packed once
+    test(std::abs(s.GetLP().LowerBound() - (-1.0)) <= 1e-8);
+    for(const auto& e : instance.edges())
+        if(e.cost[0] > 0.0)
+            test(mc.get_edge_cost(e[0], e[1]) >= -1e-8);
+
+    // nothing violated is left
+    test(mc.find_violated_cycles(std::numeric_limits<std::size_t>::max()) == 0);
+}
@@ -0,0 +1,64 @@
+#include "clique_graph.hxx"
+#include "cuthill-mckee.h"
+#include "bfs_ordering.hxx"
+#include "minimum_degree_ordering.hxx"
+#include "test.h"
+#include <random>
+#include <set>
+
+using namespace LPMP;
+
+int main(int argc, char** argv)
+{
+    std::mt19937 gen(0);
+
+    for(std::size_t iter=0; iter<20; ++iter) {
+        const std::size_t n = 50 + gen()%100;
+        const std::size_t nr_cliques = 5 + gen()%30;
+
+        two_dim_variable_array<std::size_t> cliques;
+        std::vector<std::set<std::size_t>> expected_adj(n);
+        for(std::size_t c=0; c<nr_cliques; ++c) {
+            // some long cliques, nodes may repeat
+            const std::size_t size = c%5 == 0 ? n/2 : 1 + gen()%6;
+            std::vector<std::size_t> clique;
+            for(std::size_t k=0; k<size; ++k)
+                clique.push_back(gen()%n);
+            for(const std::size_t i : clique)
+                for(const std::size_t j : clique)
+                    if(i != j)
+                        expected_adj[i].insert(j);
+            cliques.push_back(clique.begin(), clique.end());
+        }
+
+        const clique_graph g(n, std::move(cliques));
+        test(g.size() == n);
+        test(g.nr_cliques() == nr_cliques);
+
+        const auto adj = g.adjacency();
+        test(adj.size() == n);
+        for(std::size_t i=0; i<n; ++i) {
+            test(adj[i].size() == expected_adj[i].size());
+            test(std::equal(adj[i].begin(), adj[i].end(), expected_adj[i].begin()));
+            test(g.degree_bound(i) >= adj[i].size());
+        }
+
+        const auto bfs_order = bfs_ordering(g);
+        test(bfs_order.size() == n && bfs_order.is_permutation());
+        const auto cm_order = Cuthill_McKee(g);
+        test(cm_order.size() == n && cm_order.is_permutation());
+        const auto md_order = minimum_degree_ordering(g);
+        test(md_order.size() == n && md_order.is_permutation());
+    }
+
+    // path of triangles 0-1-2, 2-3-4, 4-5-6: breadth first orders start at one end and keep nodes of a triangle together
+    two_dim_variable_array<std::size_t> path(std::vector<std::vector<std::size_t>>{{0,1,2}, {2,3,4}, {4,5,6}});
+    const clique_graph p(7, std::move(path));
+    const auto order = Cuthill_McKee(p);
+    test(order[0] == 0 || order[0] == 1 || order[0] == 5 || order[0] == 6);
+    std::vector<std::size_t> position(7);
+    for(std::size_t i=0; i<7; ++i)
+        position[order[i]] = i;
+    test((position[0] < position[3]) == (position[2] < position[3]));
+    test(std::max(position[0], position[6]) > position[3] && std::min(position[0], position[6]) < position[3]);
+}
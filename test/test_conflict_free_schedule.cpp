@@ -0,0 +1,118 @@
+#include "test.h"
+#include "factors_messages.hxx"
+#include "factors_storage.hxx"
+#include "messages_storage.hxx"
+#include "message_passing_weight_computation.hxx"
+#include "conflict_free_schedule.hxx"
+#include <iostream>
+#include <limits>
+
+using namespace LPMP;
+
+struct dummy_factor {
+   REAL EvaluatePrimal() const { return 0.0; }
+   REAL LowerBound() const { return 0.0; }
+
+   void init_primal() {}
+
+   template<typename ARCHIVE>
+   void serialize_dual(ARCHIVE& ar) {}
+
+   template<typename ARCHIVE>
+   void serialize_primal(ARCHIVE& ar) {}
+
+   auto export_variables() { return std::tie(); }
+};
+
+struct dummy_message {
+
+template<typename FACTOR, typename MSG>
+void send_message_to_left(const FACTOR& f, MSG& msg, const REAL omega) {}
+
+template<typename FACTOR, typename MSG>
+void send_message_to_right(const FACTOR& f, MSG& msg, const REAL omega) {}
+
+};
+
+struct dummy_mrf_FMC {
+   using unary_dummy = FactorContainer<dummy_factor, dummy_mrf_FMC, 0>;
+   using pairwise_dummy = FactorContainer<dummy_factor, dummy_mrf_FMC, 1>;
+
+   using unary_pairwise_dummy = MessageContainer<dummy_message, 0, 1, message_passing_schedule::left, variableMessageNumber, 2, dummy_mrf_FMC, 0>;
+
+   using FactorList = meta::list<unary_dummy, pairwise_dummy>;
+   using MessageList = meta::list<unary_pairwise_dummy>;
+   using ProblemDecompositionList = meta::list<>;
+};
+
+int main(int argc, char** argv)
+{
+   factors_storage<dummy_mrf_FMC> fs;
+   messages_storage<dummy_mrf_FMC> ms;
+
+   using unary_dummy = typename dummy_mrf_FMC::unary_dummy;
+   using pairwise_dummy = typename dummy_mrf_FMC::pairwise_dummy;
+   using unary_pairwise_dummy = typename dummy_mrf_FMC::unary_pairwise_dummy;
+
+   // chain of n unaries connected by pairwise factors. Only unaries are updated.
+   const std::size_t n = 10;
+   std::vector<FactorTypeAdapter*> unaries;
+   for(std::size_t i=0; i<n; ++i) {
+      unaries.push_back(fs.template add_factor<unary_dummy>());
+   }
+   for(std::size_t i=0; i+1<n; ++i) {
+      auto* u1 = static_cast<unary_dummy*>(unaries[i]);
+      auto* u2 = static_cast<unary_dummy*>(unaries[i+1]);
+      auto* p = fs.template add_factor<pairwise_dummy>();
+      ms.template add_message<unary_pairwise_dummy>(u1, p);
+      ms.template add_message<unary_pairwise_dummy>(u2, p);
+      fs.add_factor_relation(u1, p);
+      fs.add_factor_relation(p, u2);
+   }
+
+   auto [forward_sorting, forward_update_sorting] = fs.get_sorted_factors(Direction::forward);
+   test(forward_update_sorting.size() == n);
+
+   auto schedule = compute_conflict_free_schedule(forward_update_sorting.begin(), forward_update_sorting.end());
+   test(schedule.no_elements() == n);
+
+   // every update position occurs exactly once, ascending within levels
+   std::vector<std::size_t> level_of(n, std::numeric_limits<std::size_t>::max());
+   for(std::size_t l=0; l<schedule.size(); ++l) {
+      test(schedule[l].size() > 0);
+      for(std::size_t k=0; k<schedule[l].size(); ++k) {
+         const std::size_t i = schedule(l,k);
+         test(i < n && level_of[i] == std::numeric_limits<std::size_t>::max());
+         level_of[i] = l;
+         if(k > 0) { test(schedule(l,k-1) < i); }
+      }
+   }
+
+   // unaries i and i+1 share a pairwise factor, hence conflict and must be in increasing levels
+   auto update_indices = get_factor_indices(forward_update_sorting.begin(), forward_update_sorting.end());
+   for(std::size_t i=0; i+1<n; ++i) {
+      test(level_of[update_indices[unaries[i]]] < level_of[update_indices[unaries[i+1]]]);
+   }
+
+   // on a chain each unary conflicts with its successor, hence no two unaries share a level
+   test(schedule.size() == n);
+
+   // disjoint pairs of unaries connected by a pairwise factor: the first and second unaries of all pairs form one level each
+   factors_storage<dummy_mrf_FMC> fs2;
+   messages_storage<dummy_mrf_FMC> ms2;
+   for(std::size_t i=0; i<n; ++i) {
+      auto* u1 = fs2.template add_factor<unary_dummy>();
+      auto* u2 = fs2.template add_factor<unary_dummy>();
+      auto* p = fs2.template add_factor<pairwise_dummy>();
+      ms2.template add_message<unary_pairwise_dummy>(u1, p);
+      ms2.template add_message<unary_pairwise_dummy>(u2, p);
+      fs2.add_factor_relation(u1, p);
+      fs2.add_factor_relation(p, u2);
+   }
+
+   auto [forward_sorting_2, forward_update_sorting_2] = fs2.get_sorted_factors(Direction::forward);
+   auto schedule_2 = compute_conflict_free_schedule(forward_update_sorting_2.begin(), forward_update_sorting_2.end());
+   test(schedule_2.no_elements() == 2*n);
+   test(schedule_2.size() == 2);
+   test(schedule_2[0].size() == n && schedule_2[1].size() == n);
+}